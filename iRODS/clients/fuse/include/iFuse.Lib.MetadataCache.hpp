@@ -0,0 +1,42 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+#ifndef IFUSE_LIB_METADATACACHE_HPP
+#define	IFUSE_LIB_METADATACACHE_HPP
+
+#include <sys/stat.h>
+#include <string>
+#include <list>
+
+#define IFUSE_METADATA_CACHE_TIMEOUT_SEC    (30)
+#define IFUSE_METADATA_CACHE_MAX_ENTRIES    (100000)
+
+// returned by lookups when nothing valid is cached for the path
+#define IFUSE_METADATA_CACHE_MISS           1
+
+/*
+ * Usage pattern
+ * - iFuseMetadataCacheInit
+ * - iFuseMetadataCacheGetAttr
+ * - on a miss, iFuseMetadataCacheGetGeneration, ask iRODS and iFuseMetadataCachePutAttr
+ * - iFuseMetadataCacheInvalidate after every local change to the namespace
+ * - iFuseMetadataCacheInvalidateAttr after a local change to the content or
+ *   the attributes of a file only
+ * - iFuseMetadataCacheDestroy
+ *
+ * The cache is off unless the mount is made with -ometacache. Entries
+ * expire after the timeout, changes made by other clients are visible once
+ * the cached entry has expired.
+ */
+void iFuseMetadataCacheInit();
+void iFuseMetadataCacheDestroy();
+unsigned long iFuseMetadataCacheGetGeneration();
+int iFuseMetadataCacheGetAttr(const char *iRodsPath, struct stat *stbuf);
+void iFuseMetadataCachePutAttr(const char *iRodsPath, const struct stat *stbuf, unsigned long generation);
+void iFuseMetadataCachePutNegative(const char *iRodsPath, unsigned long generation);
+int iFuseMetadataCacheGetDirEntries(const char *iRodsPath, std::list<std::string> &entries);
+void iFuseMetadataCachePutDirEntries(const char *iRodsPath, const std::list<std::string> &entries, unsigned long generation);
+void iFuseMetadataCacheInvalidate(const char *iRodsPath);
+void iFuseMetadataCacheInvalidateAttr(const char *iRodsPath);
+
+#endif	/* IFUSE_LIB_METADATACACHE_HPP */
+
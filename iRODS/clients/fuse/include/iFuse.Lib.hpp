@@ -22,6 +22,9 @@ typedef struct IFuseOpt {
     int maxConn;
     int connTimeoutSec;
     int connKeepAliveSec;
+    bool metadataCache;
+    int metadataCacheTimeoutSec;
+    int writeBackThreads;
     char *mountpoint;
     iFuseExtendedOpt_t *extendedOpts;
 } iFuseOpt_t;
@@ -10,7 +10,10 @@
 #include "iFuse.BufferedFS.hpp"
 #include "iFuse.Lib.Fd.hpp"
 
-#define IFUSE_PRELOAD_PBLOCK_NUM         3
+// number of blocks read ahead, doubled on every sequential block and
+// dropped to none on random access
+#define IFUSE_PRELOAD_MIN_WINDOW         2
+#define IFUSE_PRELOAD_MAX_WINDOW         64
 
 #define IFUSE_PRELOAD_PBLOCK_STATUS_INIT                 0
 #define IFUSE_PRELOAD_PBLOCK_STATUS_RUNNING              1
@@ -31,6 +34,9 @@ typedef struct IFusePreloadPBlock {
 typedef struct IFusePreload {
     unsigned long fdId;
     char *iRodsPath;
+    off_t size;
+    unsigned int lastBlockID;
+    unsigned int window;
     std::list<iFusePreloadPBlock_t*> *pblocks;
     pthread_mutexattr_t lockAttr;
     pthread_mutex_t lock;
@@ -0,0 +1,52 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+#ifndef IFUSE_WRITEBACK_HPP
+#define	IFUSE_WRITEBACK_HPP
+
+#include <list>
+#include <pthread.h>
+#include "iFuse.BufferedFS.hpp"
+#include "iFuse.Lib.Fd.hpp"
+
+#define IFUSE_WRITEBACK_THREAD_NUM          4
+#define IFUSE_WRITEBACK_MAX_DIRTY_SIZE      (IFUSE_BUFFER_CACHE_BLOCK_SIZE * 32)
+
+struct IFuseWriteBack;
+
+typedef struct IFuseWriteBackJob {
+    struct IFuseWriteBack *writeBack;
+    char *buffer;
+    off_t offset;
+    size_t size;
+} iFuseWriteBackJob_t;
+
+typedef struct IFuseWriteBack {
+    char *iRodsPath;
+    int pending;
+    int error;
+    std::list<iFuseWriteBackJob_t*> *jobs;
+    std::list<iFuseFd_t*> *fds;
+} iFuseWriteBack_t;
+
+/*
+ * Usage pattern
+ * - iFuseWriteBackInit
+ * - iFuseWriteBackWrite for every block to upload, returns once the block is queued
+ * - iFuseWriteBackWait before reading blocks back from iRODS
+ * - iFuseWriteBackSync before the file is flushed or closed
+ * - iFuseWriteBackDestroy
+ *
+ * Blocks are uploaded by a pool of threads, each with its own file descriptor
+ * on a pooled connection. An error of an upload is returned by the next write
+ * or sync of the file.
+ */
+void iFuseWriteBackInit();
+void iFuseWriteBackDestroy();
+
+int iFuseWriteBackWrite(iFuseFd_t *iFuseFd, char *buf, off_t off, size_t size);
+int iFuseWriteBackWait(const char *iRodsPath);
+int iFuseWriteBackSync(const char *iRodsPath);
+off_t iFuseWriteBackGetSize(const char *iRodsPath);
+
+#endif	/* IFUSE_WRITEBACK_HPP */
+
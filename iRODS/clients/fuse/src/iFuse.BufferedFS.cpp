@@ -14,6 +14,7 @@
 #include "iFuse.Lib.hpp"
 #include "iFuse.Lib.Fd.hpp"
 #include "iFuse.BufferedFS.hpp"
+#include "iFuse.WriteBack.hpp"
 #include "iFuse.Lib.Util.hpp"
 #include "iFuse.Lib.RodsClientAPI.hpp"
 #include "miscUtil.h"
@@ -140,6 +141,14 @@ static int _flushDelta(iFuseFd_t *iFuseFd) {
     assert(iFuseFd != NULL);
 
     if((iFuseFd->openFlag & O_ACCMODE) != O_RDONLY) {
+        // blocks uploaded in background must reach iRODS before the last one
+        status = iFuseWriteBackSync(iFuseFd->iRodsPath);
+        if (status < 0) {
+            iFuseRodsClientLogError(LOG_ERROR, status, "_flushDelta: iFuseWriteBackSync of %s error, status = %d",
+                    iFuseFd->iRodsPath, status);
+            return -ENOENT;
+        }
+
         pthread_mutex_lock(&g_BufferCacheLock);
 
         it_deltamap = g_DeltaMap.find(pathkey);
@@ -222,6 +231,15 @@ static int _readBlock(iFuseFd_t *iFuseFd, char *buf, unsigned int blockID) {
 
         assert(iFuseBufferCache != NULL);
         
+        // blocks being uploaded in background must be read back as written
+        status = iFuseWriteBackWait(iFuseFd->iRodsPath);
+        if (status < 0) {
+            iFuseRodsClientLogError(LOG_ERROR, status, "_readBlock: iFuseWriteBackWait of %s error, status = %d",
+                    iFuseFd->iRodsPath, status);
+            _freeBufferCache(iFuseBufferCache);
+            return -ENOENT;
+        }
+        
         // read from server
         blockBuffer = (char*)calloc(1, IFUSE_BUFFER_CACHE_BLOCK_SIZE);
         if(blockBuffer == NULL) {
@@ -354,15 +372,13 @@ static int _writeBlock(iFuseFd_t *iFuseFd, const char *buf, off_t off, size_t si
             // release mutex before making write request
             pthread_mutex_unlock(&g_BufferCacheLock);
             
-            // flush
-            status = iFuseFsWrite(iFuseFd, bufFlush, offFlush, sizeFlush);
+            // flush in background, the write-back owns bufFlush from now on
+            status = iFuseWriteBackWrite(iFuseFd, bufFlush, offFlush, sizeFlush);
             if (status < 0) {
-                iFuseRodsClientLogError(LOG_ERROR, status, "_writeBlock: iFuseFsWrite of %s error, status = %d",
+                iFuseRodsClientLogError(LOG_ERROR, status, "_writeBlock: iFuseWriteBackWrite of %s error, status = %d",
                         iFuseFd->iRodsPath, status);
                 return -ENOENT;
             }
-
-            free(bufFlush);
         }
     } else {
         char *newBuf = (char*)calloc(1, size);
@@ -452,6 +468,7 @@ int iFuseBufferedFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
     std::map<std::string, iFuseBufferCache_t*>::iterator it_deltamap;
     iFuseBufferCache_t *iFuseBufferCache = NULL;
     std::string pathkey(iRodsPath);
+    off_t writeBackSize = 0;
 
     assert(iRodsPath != NULL);
     assert(stbuf != NULL);
@@ -465,6 +482,12 @@ int iFuseBufferedFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
         return status;
     }
 
+    // blocks still being uploaded
+    writeBackSize = iFuseWriteBackGetSize(iRodsPath);
+    if(writeBackSize > stbuf->st_size) {
+        stbuf->st_size = writeBackSize;
+    }
+
     pthread_mutex_lock(&g_BufferCacheLock);
 
     it_deltamap = g_DeltaMap.find(pathkey);
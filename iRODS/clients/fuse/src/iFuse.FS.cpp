@@ -7,12 +7,15 @@
 #include <errno.h>
 #include <time.h>
 #include <assert.h>
+#include <string>
+#include <list>
 #include "iFuse.FS.hpp"
 #include "iFuse.Lib.hpp"
 #include "iFuse.Lib.RodsClientAPI.hpp"
 #include "iFuse.Lib.Fd.hpp"
 #include "iFuse.Lib.Conn.hpp"
 #include "iFuse.Lib.Util.hpp"
+#include "iFuse.Lib.MetadataCache.hpp"
 #include "sockComm.h"
 
 #ifdef _MYSQL_ICAT_DRIVER_PATCH_
@@ -74,12 +77,20 @@ int iFuseFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
     dataObjInp_t dataObjInp;
     rodsObjStat_t *rodsObjStatOut = NULL;
     iFuseConn_t *iFuseConn = NULL;
+    unsigned long cacheGeneration;
 
     assert(iRodsPath != NULL);
     assert(stbuf != NULL);
 
     iFuseRodsClientLog(LOG_DEBUG, "iFuseFsGetAttr: %s", iRodsPath);
 
+    status = iFuseMetadataCacheGetAttr(iRodsPath, stbuf);
+    if (status != IFUSE_METADATA_CACHE_MISS) {
+        return status;
+    }
+
+    cacheGeneration = iFuseMetadataCacheGetGeneration();
+
     // temporarily obtain a connection
     // must be marked unused and release lock after use
 #ifdef _MYSQL_ICAT_DRIVER_PATCH_
@@ -119,6 +130,7 @@ int iFuseFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
                     // file not exists!
                     iFuseConnUnlock(iFuseConn);
                     iFuseConnUnuse(iFuseConn);
+                    iFuseMetadataCachePutNegative(iRodsPath, cacheGeneration);
                     return -ENOENT;
                 }
             }
@@ -133,6 +145,7 @@ int iFuseFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
         // file not exists!
         iFuseConnUnlock(iFuseConn);
         iFuseConnUnuse(iFuseConn);
+        iFuseMetadataCachePutNegative(iRodsPath, cacheGeneration);
         return -ENOENT;
     }
 
@@ -166,6 +179,12 @@ int iFuseFsGetAttr(const char *iRodsPath, struct stat *stbuf) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    if (status == 0) {
+        iFuseMetadataCachePutAttr(iRodsPath, stbuf, cacheGeneration);
+    } else {
+        iFuseMetadataCachePutNegative(iRodsPath, cacheGeneration);
+    }
     return status;
 }
 
@@ -225,6 +244,8 @@ int iFuseFsClose(iFuseFd_t *iFuseFd) {
         return -ENOENT;
     }
 
+    iFuseMetadataCacheInvalidateAttr(iRodsPath);
+
     free(iRodsPath);
     iFuseConnUnuse(iFuseConn);
     return 0;
@@ -533,6 +554,8 @@ int iFuseFsWrite(iFuseFd_t *iFuseFd, const char *buf, off_t off, size_t size) {
     }
 
     iFuseFd->lastFilePointer += status;
+
+    iFuseMetadataCacheInvalidateAttr(iFuseFd->iRodsPath);
     
     iFuseConnUnlock(iFuseConn);
     iFuseFdUnlock(iFuseFd);
@@ -555,6 +578,7 @@ int iFuseFsFlush(iFuseFd_t *iFuseFd) {
         return -ENOENT;
     }
 
+    iFuseMetadataCacheInvalidateAttr(iFuseFd->iRodsPath);
     return 0;
 }
 
@@ -663,6 +687,8 @@ int iFuseFsCreate(const char *iRodsPath, mode_t mode) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidate(iRodsPath);
     return status;
 }
 
@@ -729,6 +755,8 @@ int iFuseFsUnlink(const char *iRodsPath) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidate(iRodsPath);
     return 0;
 }
 
@@ -798,6 +826,9 @@ int iFuseFsReadDir(iFuseDir_t *iFuseDir, iFuseDirFiller filler, void *buf, off_t
     int status = 0;
     iFuseConn_t *iFuseConn = NULL;
     collEnt_t collEnt;
+    std::list<std::string> entries;
+    std::list<std::string>::iterator it;
+    unsigned long cacheGeneration;
 
     assert(iFuseDir != NULL);
     assert(iFuseDir->iRodsPath != NULL);
@@ -807,6 +838,15 @@ int iFuseFsReadDir(iFuseDir_t *iFuseDir, iFuseDirFiller filler, void *buf, off_t
 
     iFuseRodsClientLog(LOG_DEBUG, "iFuseFsReadDir: %s", iFuseDir->iRodsPath);
 
+    if (iFuseMetadataCacheGetDirEntries(iFuseDir->iRodsPath, entries) == 0) {
+        for (it = entries.begin(); it != entries.end(); it++) {
+            filler(buf, it->c_str(), NULL, 0);
+        }
+        return 0;
+    }
+
+    cacheGeneration = iFuseMetadataCacheGetGeneration();
+
     iFuseConn = iFuseDir->conn;
 
     iFuseDirLock(iFuseDir);
@@ -814,9 +854,26 @@ int iFuseFsReadDir(iFuseDir_t *iFuseDir, iFuseDirFiller filler, void *buf, off_t
 
     bzero(&collEnt, sizeof ( collEnt_t));
 
+    // the query returns attributes of every entry, cache them for the stats which follow
     while ((status = iFuseRodsClientReadCollection(iFuseConn->conn, iFuseDir->handle, &collEnt)) >= 0) {
+        char entryPath[MAX_NAME_LEN];
+        struct stat stbuf;
+
+        bzero(&stbuf, sizeof ( struct stat));
+
         if (collEnt.objType == DATA_OBJ_T) {
             filler(buf, collEnt.dataName, NULL, 0);
+            entries.push_back(collEnt.dataName);
+
+            _fillFileStat(&stbuf,
+                    collEnt.dataMode,
+                    collEnt.dataSize,
+                    collEnt.createTime != NULL ? atoi(collEnt.createTime) : 0,
+                    collEnt.modifyTime != NULL ? atoi(collEnt.modifyTime) : 0,
+                    collEnt.modifyTime != NULL ? atoi(collEnt.modifyTime) : 0);
+
+            snprintf(entryPath, MAX_NAME_LEN, "%s/%s", collEnt.collName, collEnt.dataName);
+            iFuseMetadataCachePutAttr(entryPath, &stbuf, cacheGeneration);
         } else if (collEnt.objType == COLL_OBJ_T) {
             char myDir[MAX_NAME_LEN];
             char mySubDir[MAX_NAME_LEN];
@@ -824,10 +881,23 @@ int iFuseFsReadDir(iFuseDir_t *iFuseDir, iFuseDirFiller filler, void *buf, off_t
             splitPathByKey(collEnt.collName, myDir, MAX_NAME_LEN, mySubDir, MAX_NAME_LEN, '/');
             if (mySubDir[0] != '\0') {
                 filler(buf, mySubDir, NULL, 0);
+                entries.push_back(mySubDir);
+
+                _fillDirStat(&stbuf,
+                        collEnt.createTime != NULL ? atoi(collEnt.createTime) : 0,
+                        collEnt.modifyTime != NULL ? atoi(collEnt.modifyTime) : 0,
+                        collEnt.modifyTime != NULL ? atoi(collEnt.modifyTime) : 0);
+
+                iFuseMetadataCachePutAttr(collEnt.collName, &stbuf, cacheGeneration);
             }
         }
     }
 
+    // only a complete listing is cached
+    if (status == CAT_NO_ROWS_FOUND) {
+        iFuseMetadataCachePutDirEntries(iFuseDir->iRodsPath, entries, cacheGeneration);
+    }
+
     iFuseConnUnlock(iFuseConn);
     iFuseDirUnlock(iFuseDir);
     return 0;
@@ -887,6 +957,8 @@ int iFuseFsMakeDir(const char *iRodsPath, mode_t mode) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidate(iRodsPath);
     return status;
 }
 
@@ -969,6 +1041,8 @@ int iFuseFsRemoveDir(const char *iRodsPath) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidate(iRodsPath);
     return 0;
 }
 
@@ -1038,6 +1112,9 @@ int iFuseFsRename(const char *iRodsFromPath, const char *iRodsToPath) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidate(iRodsFromPath);
+    iFuseMetadataCacheInvalidate(iRodsToPath);
     return 0;
 }
 
@@ -1096,6 +1173,8 @@ int iFuseFsTruncate(const char *iRodsPath, off_t size) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidateAttr(iRodsPath);
     return 0;
 }
 
@@ -1172,5 +1251,7 @@ int iFuseFsChmod(const char *iRodsPath, mode_t mode) {
 
     iFuseConnUnlock(iFuseConn);
     iFuseConnUnuse(iFuseConn);
+
+    iFuseMetadataCacheInvalidateAttr(iRodsPath);
     return 0;
 }
\ No newline at end of file
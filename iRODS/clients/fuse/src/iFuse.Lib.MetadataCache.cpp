@@ -0,0 +1,369 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <pthread.h>
+#include <map>
+#include <string>
+#include <list>
+#include "iFuse.Lib.hpp"
+#include "iFuse.Lib.MetadataCache.hpp"
+#include "iFuse.Lib.Util.hpp"
+
+typedef struct IFuseAttrCacheEntry {
+    time_t expireTime;
+    bool exists;
+    // left by iFuseMetadataCacheInvalidateAttr, no attributes are cached
+    bool invalidated;
+    unsigned long invalidatedAt;
+    struct stat stbuf;
+} iFuseAttrCacheEntry_t;
+
+typedef struct IFuseDirCacheEntry {
+    time_t expireTime;
+    std::list<std::string> entries;
+} iFuseDirCacheEntry_t;
+
+static pthread_mutexattr_t g_MetadataCacheLockAttr;
+static pthread_mutex_t g_MetadataCacheLock;
+static std::map<std::string, iFuseAttrCacheEntry_t> g_AttrCache;
+static std::map<std::string, iFuseDirCacheEntry_t> g_DirCache;
+
+// counts every invalidation, generations handed out to lookups are taken from it
+static unsigned long g_MetadataCacheClock;
+// the value of the clock at the last change to the namespace
+static unsigned long g_MetadataCacheGeneration;
+static bool g_MetadataCacheEnabled = false;
+static int g_MetadataCacheTimeoutSec = IFUSE_METADATA_CACHE_TIMEOUT_SEC;
+
+/*
+ * Remove the path and everything below it from a cache map
+ */
+template <typename T>
+static void _removeTree(std::map<std::string, T> &cache, const std::string &path) {
+    std::string prefix = path;
+    typename std::map<std::string, T>::iterator it;
+
+    cache.erase(path);
+
+    if(prefix.empty() || prefix[prefix.length() - 1] != '/') {
+        prefix += "/";
+    }
+
+    it = cache.lower_bound(prefix);
+    while(it != cache.end() && it->first.compare(0, prefix.length(), prefix) == 0) {
+        cache.erase(it++);
+    }
+}
+
+// invalidation markers are only dropped when nothing else can be evicted
+static bool _isEvictable(const iFuseAttrCacheEntry_t &entry) {
+    return !entry.invalidated;
+}
+
+static bool _isEvictable(const iFuseDirCacheEntry_t &entry) {
+    return true;
+}
+
+/*
+ * Drop expired entries, then other entries than invalidation markers, and
+ * everything if that is not enough to keep the cache bounded
+ */
+template <typename T>
+static void _limitSize(std::map<std::string, T> &cache, time_t now) {
+    typename std::map<std::string, T>::iterator it;
+
+    if(cache.size() < IFUSE_METADATA_CACHE_MAX_ENTRIES) {
+        return;
+    }
+
+    it = cache.begin();
+    while(it != cache.end()) {
+        if(it->second.expireTime <= now) {
+            cache.erase(it++);
+        } else {
+            it++;
+        }
+    }
+
+    if(cache.size() < IFUSE_METADATA_CACHE_MAX_ENTRIES) {
+        return;
+    }
+
+    it = cache.begin();
+    while(it != cache.end()) {
+        if(_isEvictable(it->second)) {
+            cache.erase(it++);
+        } else {
+            it++;
+        }
+    }
+
+    if(cache.size() >= IFUSE_METADATA_CACHE_MAX_ENTRIES) {
+        // without the markers, lookups in flight must not be cached
+        cache.clear();
+        g_MetadataCacheGeneration = g_MetadataCacheClock;
+    }
+}
+
+static std::string _getParentPath(const std::string &path) {
+    size_t pos = path.find_last_of('/');
+    if(pos == std::string::npos) {
+        return std::string();
+    } else if(pos == 0) {
+        return std::string("/");
+    }
+    return path.substr(0, pos);
+}
+
+/*
+ * Initialize metadata cache
+ */
+void iFuseMetadataCacheInit() {
+    pthread_mutexattr_init(&g_MetadataCacheLockAttr);
+    pthread_mutexattr_settype(&g_MetadataCacheLockAttr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&g_MetadataCacheLock, &g_MetadataCacheLockAttr);
+
+    g_MetadataCacheEnabled = iFuseLibGetOption()->metadataCache;
+    if(iFuseLibGetOption()->metadataCacheTimeoutSec > 0) {
+        g_MetadataCacheTimeoutSec = iFuseLibGetOption()->metadataCacheTimeoutSec;
+    } else {
+        g_MetadataCacheEnabled = false;
+    }
+}
+
+/*
+ * Destroy metadata cache
+ */
+void iFuseMetadataCacheDestroy() {
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    g_AttrCache.clear();
+    g_DirCache.clear();
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+
+    pthread_mutex_destroy(&g_MetadataCacheLock);
+    pthread_mutexattr_destroy(&g_MetadataCacheLockAttr);
+}
+
+/*
+ * Get the current generation of the cache
+ * must be taken before asking iRODS for metadata that is put into the cache,
+ * the metadata is not cached if the namespace or the attributes of the path
+ * are invalidated in the meantime
+ */
+unsigned long iFuseMetadataCacheGetGeneration() {
+    unsigned long generation;
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+    generation = g_MetadataCacheClock;
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+    return generation;
+}
+
+/*
+ * Look up cached attributes of a path
+ * returns 0 and fills stbuf if the path exists, -ENOENT if it is known not
+ * to exist, IFUSE_METADATA_CACHE_MISS otherwise
+ */
+int iFuseMetadataCacheGetAttr(const char *iRodsPath, struct stat *stbuf) {
+    int status = IFUSE_METADATA_CACHE_MISS;
+    std::map<std::string, iFuseAttrCacheEntry_t>::iterator it;
+
+    assert(iRodsPath != NULL);
+    assert(stbuf != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return IFUSE_METADATA_CACHE_MISS;
+    }
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    it = g_AttrCache.find(iRodsPath);
+    if(it != g_AttrCache.end()) {
+        if(it->second.expireTime <= iFuseLibGetCurrentTime()) {
+            g_AttrCache.erase(it);
+        } else if(it->second.invalidated) {
+            status = IFUSE_METADATA_CACHE_MISS;
+        } else if(it->second.exists) {
+            memcpy(stbuf, &it->second.stbuf, sizeof(struct stat));
+            status = 0;
+        } else {
+            status = -ENOENT;
+        }
+    }
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+    return status;
+}
+
+static void _putAttr(const char *iRodsPath, const struct stat *stbuf, unsigned long generation) {
+    time_t now = iFuseLibGetCurrentTime();
+    iFuseAttrCacheEntry_t entry;
+
+    bzero(&entry, sizeof(iFuseAttrCacheEntry_t));
+    entry.expireTime = now + g_MetadataCacheTimeoutSec;
+    if(stbuf != NULL) {
+        entry.exists = true;
+        memcpy(&entry.stbuf, stbuf, sizeof(struct stat));
+    }
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    // the path may have been changed while its attributes were fetched
+    if(generation >= g_MetadataCacheGeneration) {
+        std::map<std::string, iFuseAttrCacheEntry_t>::iterator it = g_AttrCache.find(iRodsPath);
+        if(it == g_AttrCache.end() || !it->second.invalidated || generation >= it->second.invalidatedAt) {
+            _limitSize(g_AttrCache, now);
+            g_AttrCache[iRodsPath] = entry;
+        }
+    }
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+}
+
+/*
+ * Cache attributes of a path
+ */
+void iFuseMetadataCachePutAttr(const char *iRodsPath, const struct stat *stbuf, unsigned long generation) {
+    assert(iRodsPath != NULL);
+    assert(stbuf != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return;
+    }
+
+    _putAttr(iRodsPath, stbuf, generation);
+}
+
+/*
+ * Cache that a path does not exist
+ */
+void iFuseMetadataCachePutNegative(const char *iRodsPath, unsigned long generation) {
+    assert(iRodsPath != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return;
+    }
+
+    _putAttr(iRodsPath, NULL, generation);
+}
+
+/*
+ * Look up cached entry names of a directory
+ * returns 0 and fills entries if cached, IFUSE_METADATA_CACHE_MISS otherwise
+ */
+int iFuseMetadataCacheGetDirEntries(const char *iRodsPath, std::list<std::string> &entries) {
+    int status = IFUSE_METADATA_CACHE_MISS;
+    std::map<std::string, iFuseDirCacheEntry_t>::iterator it;
+
+    assert(iRodsPath != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return IFUSE_METADATA_CACHE_MISS;
+    }
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    it = g_DirCache.find(iRodsPath);
+    if(it != g_DirCache.end()) {
+        if(it->second.expireTime <= iFuseLibGetCurrentTime()) {
+            g_DirCache.erase(it);
+        } else {
+            entries = it->second.entries;
+            status = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+    return status;
+}
+
+/*
+ * Cache entry names of a directory
+ */
+void iFuseMetadataCachePutDirEntries(const char *iRodsPath, const std::list<std::string> &entries, unsigned long generation) {
+    time_t now = iFuseLibGetCurrentTime();
+
+    assert(iRodsPath != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    if(generation >= g_MetadataCacheGeneration) {
+        _limitSize(g_DirCache, now);
+        iFuseDirCacheEntry_t &entry = g_DirCache[iRodsPath];
+        entry.expireTime = now + g_MetadataCacheTimeoutSec;
+        entry.entries = entries;
+    }
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+}
+
+/*
+ * Forget a path which is changed locally
+ * cached attributes of the path and of everything below it are dropped,
+ * along with the listing and the attributes of its parent directory
+ */
+void iFuseMetadataCacheInvalidate(const char *iRodsPath) {
+    std::string path;
+    std::string parent;
+
+    assert(iRodsPath != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return;
+    }
+
+    path = iRodsPath;
+    parent = _getParentPath(path);
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    g_MetadataCacheGeneration = ++g_MetadataCacheClock;
+    _removeTree(g_AttrCache, path);
+    _removeTree(g_DirCache, path);
+
+    if(!parent.empty()) {
+        g_AttrCache.erase(parent);
+        g_DirCache.erase(parent);
+    }
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+}
+
+/*
+ * Forget the attributes of a file whose content or attributes are changed locally
+ * the namespace is unchanged, so other paths and directory listings are kept.
+ * attributes of the path fetched before the change are not cached afterwards
+ */
+void iFuseMetadataCacheInvalidateAttr(const char *iRodsPath) {
+    time_t now = iFuseLibGetCurrentTime();
+    iFuseAttrCacheEntry_t entry;
+
+    assert(iRodsPath != NULL);
+
+    if(!g_MetadataCacheEnabled) {
+        return;
+    }
+
+    bzero(&entry, sizeof(iFuseAttrCacheEntry_t));
+    entry.expireTime = now + g_MetadataCacheTimeoutSec;
+    entry.invalidated = true;
+
+    pthread_mutex_lock(&g_MetadataCacheLock);
+
+    entry.invalidatedAt = ++g_MetadataCacheClock;
+    _limitSize(g_AttrCache, now);
+    g_AttrCache[iRodsPath] = entry;
+
+    pthread_mutex_unlock(&g_MetadataCacheLock);
+}
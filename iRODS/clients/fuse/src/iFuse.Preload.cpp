@@ -9,10 +9,12 @@
 #include <assert.h>
 #include <pthread.h>
 #include <map>
+#include <algorithm>
 #include <cstring>
 #include "iFuse.FS.hpp"
 #include "iFuse.Lib.hpp"
 #include "iFuse.Lib.Fd.hpp"
+#include "iFuse.Lib.Conn.hpp"
 #include "iFuse.Preload.hpp"
 #include "iFuse.BufferedFS.hpp"
 #include "iFuse.Lib.Util.hpp"
@@ -24,6 +26,10 @@ static pthread_mutex_t g_PreloadLock;
 
 static std::map<unsigned long, iFusePreload_t*> g_PreloadMap;
 
+// every block ahead is fetched on its own connection, so the window never
+// grows past the number of connections
+static unsigned int g_PreloadMaxWindow = IFUSE_PRELOAD_MAX_WINDOW;
+
 static int _newPreloadPBlock(const char *iRodsPath, iFusePreloadPBlock_t **iFusePreloadPBlock) {
     int status = 0;
     iFusePreloadPBlock_t *tmpIFusePreloadPBlock = NULL;
@@ -281,8 +287,9 @@ int _readPreload(iFusePreload_t *iFusePreload, char *buf, unsigned int blockID)
     iFusePreloadPBlock_t *iFusePreloadPBlock = NULL;
     iFuseFd_t *iFuseFd = NULL;
     bool hasBlock = false;
-    bool *pblockExistance = (bool*)calloc(IFUSE_PRELOAD_PBLOCK_NUM, sizeof(bool));
-    int i;
+    bool *pblockExistance = (bool*)calloc(IFUSE_PRELOAD_MAX_WINDOW, sizeof(bool));
+    unsigned int window;
+    unsigned int i;
     
     assert(iFusePreload != NULL);
     assert(buf != NULL);
@@ -291,10 +298,37 @@ int _readPreload(iFusePreload_t *iFusePreload, char *buf, unsigned int blockID)
         return SYS_MALLOC_ERR;
     }
     
-    bzero(pblockExistance, IFUSE_PRELOAD_PBLOCK_NUM * sizeof(bool));
+    bzero(pblockExistance, IFUSE_PRELOAD_MAX_WINDOW * sizeof(bool));
     
     pthread_mutex_lock(&iFusePreload->lock);
     
+    // adapt the readahead window to the access pattern
+    if(blockID == iFusePreload->lastBlockID + 1) {
+        if(iFusePreload->window == 0) {
+            iFusePreload->window = std::min((unsigned int)IFUSE_PRELOAD_MIN_WINDOW, g_PreloadMaxWindow);
+        } else if(iFusePreload->window * 2 <= g_PreloadMaxWindow) {
+            iFusePreload->window *= 2;
+        } else {
+            iFusePreload->window = g_PreloadMaxWindow;
+        }
+    } else if(blockID != iFusePreload->lastBlockID) {
+        iFusePreload->window = 0;
+    }
+    iFusePreload->lastBlockID = blockID;
+    
+    // never read ahead past the end of the file
+    window = iFusePreload->window;
+    if(iFusePreload->size >= 0) {
+        unsigned int lastBlockID = iFusePreload->size > 0 ? getBlockID(iFusePreload->size - 1) : 0;
+        if(blockID >= lastBlockID) {
+            window = 0;
+        } else if(lastBlockID - blockID < window) {
+            window = lastBlockID - blockID;
+        }
+    }
+    
+    iFuseRodsClientLog(LOG_DEBUG, "_readPreload: %s, blockID: %u, window: %u", iFusePreload->iRodsPath, blockID, window);
+    
     // check loaded
     for(it_preloadpblock=iFusePreload->pblocks->begin();it_preloadpblock!=iFusePreload->pblocks->end();it_preloadpblock++) {
         iFusePreloadPBlock = *it_preloadpblock;
@@ -303,16 +337,17 @@ int _readPreload(iFusePreload_t *iFusePreload, char *buf, unsigned int blockID)
             // has block
             hasBlock = true;
         } else if(blockID > iFusePreloadPBlock->blockID ||
-                blockID + IFUSE_PRELOAD_PBLOCK_NUM < iFusePreloadPBlock->blockID) {
+                blockID + IFUSE_PRELOAD_MAX_WINDOW < iFusePreloadPBlock->blockID) {
             // remove old blocks
             // if block id is less than current block id
             // or block id is far larger than current block id (for backward read)
+            // blocks ahead are kept when the window shrinks, they may still be read
             
             iFuseRodsClientLog(LOG_DEBUG, "_readPreload: found old preloaded data of %s, blockID: %u, cur blockID: %u", iFusePreload->iRodsPath, iFusePreloadPBlock->blockID, blockID);
             removeList.push_back(iFusePreloadPBlock);
         } else {
             // preloaded blocks
-            if(iFusePreloadPBlock->blockID - blockID - 1 < IFUSE_PRELOAD_PBLOCK_NUM) {
+            if(iFusePreloadPBlock->blockID - blockID - 1 < IFUSE_PRELOAD_MAX_WINDOW) {
                 pblockExistance[iFusePreloadPBlock->blockID - blockID - 1] = true;
             }
         }
@@ -417,7 +452,7 @@ int _readPreload(iFusePreload_t *iFusePreload, char *buf, unsigned int blockID)
         }
     }
     
-    for(i=0;i<IFUSE_PRELOAD_PBLOCK_NUM;i++) {
+    for(i=0;i<window;i++) {
         if(!pblockExistance[i]) {
             // start preload
             iFuseFd = NULL;
@@ -439,7 +474,7 @@ int _readPreload(iFusePreload_t *iFusePreload, char *buf, unsigned int blockID)
     // release entries in recycleList that will not be used
     while(!recycleList.empty()) {
         iFusePreloadPBlock = recycleList.front();
-        removeList.pop_front();
+        recycleList.pop_front();
         _freePreloadPBlock(iFusePreloadPBlock);
     }
     
@@ -455,6 +490,12 @@ void iFusePreloadInit() {
     pthread_mutexattr_init(&g_PreloadLockAttr);
     pthread_mutexattr_settype(&g_PreloadLockAttr, PTHREAD_MUTEX_RECURSIVE);
     pthread_mutex_init(&g_PreloadLock, &g_PreloadLockAttr);
+
+    if(iFuseLibGetOption()->maxConn > 0) {
+        g_PreloadMaxWindow = std::min(IFUSE_PRELOAD_MAX_WINDOW, iFuseLibGetOption()->maxConn);
+    } else {
+        g_PreloadMaxWindow = std::min(IFUSE_PRELOAD_MAX_WINDOW, IFUSE_MAX_NUM_CONN);
+    }
 }
 
 /*
@@ -474,7 +515,8 @@ int iFusePreloadOpen(const char *iRodsPath, iFuseFd_t **iFuseFd, int openFlag) {
     int status = 0;
     std::map<unsigned long, iFusePreload_t*>::iterator it_preloadmap;
     iFusePreload_t *iFusePreload = NULL;
-    int i;
+    struct stat stbuf;
+    unsigned int i;
     
     assert(iRodsPath != NULL);
     assert(iFuseFd != NULL);
@@ -493,9 +535,24 @@ int iFusePreloadOpen(const char *iRodsPath, iFuseFd_t **iFuseFd, int openFlag) {
         iFusePreload->fdId = (*iFuseFd)->fdId;
         iFusePreload->iRodsPath = strdup(iRodsPath);
 
+        // size is unknown if it can't be stat-ed
+        bzero(&stbuf, sizeof(struct stat));
+        if(iFuseFsGetAttr(iRodsPath, &stbuf) == 0 && (openFlag & O_ACCMODE) == O_RDONLY) {
+            iFusePreload->size = stbuf.st_size;
+        } else {
+            iFusePreload->size = -1;
+        }
+
+        // reads are expected to start sequentially from the first block
+        iFusePreload->lastBlockID = 0;
+        iFusePreload->window = std::min((unsigned int)IFUSE_PRELOAD_MIN_WINDOW, g_PreloadMaxWindow);
+
         // start preload thread - only when the file is opened for read
         if((openFlag & O_ACCMODE) == O_RDONLY || (openFlag & O_ACCMODE) == O_RDWR) {
-            for(i=0;i<IFUSE_PRELOAD_PBLOCK_NUM;i++) {
+            for(i=0;i<iFusePreload->window;i++) {
+                if(iFusePreload->size >= 0 && (off_t)getBlockStartOffset(i) >= iFusePreload->size) {
+                    break;
+                }
                 _startPreload(iFusePreload, i, NULL);
             }
         }
@@ -544,12 +601,18 @@ int iFusePreloadClose(iFuseFd_t *iFuseFd) {
         // has it
         iFusePreload = it_preloadmap->second;
         g_PreloadMap.erase(it_preloadmap);
-
-        _freePreload(iFusePreload);
     }
     
     pthread_mutex_unlock(&g_PreloadLock);
     
+    if(iFusePreload != NULL) {
+        // wait for a read in progress
+        pthread_mutex_lock(&iFusePreload->lock);
+        pthread_mutex_unlock(&iFusePreload->lock);
+        
+        _freePreload(iFusePreload);
+    }
+    
     return status;
 }
 
@@ -577,6 +640,10 @@ int iFusePreloadRead(iFuseFd_t *iFuseFd, char *buf, off_t off, size_t size) {
         // has it
         iFusePreload = it_preloadmap->second;
         
+        // other files are read in parallel, only reads of this fd wait for each other
+        pthread_mutex_lock(&iFusePreload->lock);
+        pthread_mutex_unlock(&g_PreloadLock);
+        
         // read in block level
         remain = size;
         curOffset = off;
@@ -595,12 +662,12 @@ int iFusePreloadRead(iFuseFd_t *iFuseFd, char *buf, off_t off, size_t size) {
                 if (status < 0) {
                     iFuseRodsClientLogError(LOG_ERROR, status, "iFusePreloadRead: iFuseBufferedFsRead of %s error, status = %d",
                             iFuseFd->iRodsPath, status);
-                    pthread_mutex_unlock(&g_PreloadLock);
+                    pthread_mutex_unlock(&iFusePreload->lock);
                     free(blockBuffer);
                     return -ENOENT;
                 }
                 
-                pthread_mutex_unlock(&g_PreloadLock);
+                pthread_mutex_unlock(&iFusePreload->lock);
                 free(blockBuffer);
                 return status;
             } else if(status == 0) {
@@ -632,7 +699,7 @@ int iFusePreloadRead(iFuseFd_t *iFuseFd, char *buf, off_t off, size_t size) {
             }
         }
         
-        pthread_mutex_unlock(&g_PreloadLock);
+        pthread_mutex_unlock(&iFusePreload->lock);
         free(blockBuffer);
         return readSize;
     }
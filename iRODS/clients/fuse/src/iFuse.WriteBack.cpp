@@ -0,0 +1,433 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include <pthread.h>
+#include <map>
+#include <list>
+#include <string>
+#include <cstring>
+#include "iFuse.FS.hpp"
+#include "iFuse.Lib.hpp"
+#include "iFuse.Lib.Fd.hpp"
+#include "iFuse.WriteBack.hpp"
+#include "iFuse.Lib.Util.hpp"
+#include "iFuse.Lib.RodsClientAPI.hpp"
+#include "miscUtil.h"
+
+static pthread_mutex_t g_WriteBackLock;
+static pthread_cond_t g_WriteBackJobCond;
+static pthread_cond_t g_WriteBackDoneCond;
+
+static std::map<std::string, iFuseWriteBack_t*> g_WriteBackMap;
+static std::list<iFuseWriteBackJob_t*> g_WriteBackQueue;
+static size_t g_WriteBackDirtySize;
+
+static pthread_t *g_WriteBackThreads;
+static int g_WriteBackThreadNum;
+static bool g_WriteBackRunning;
+
+/*
+ * Lock order :
+ * - g_WriteBackLock
+ * - iFuseFd_t
+ * file descriptors are opened, written and closed without holding g_WriteBackLock
+ */
+
+static int _newWriteBack(const char *iRodsPath, iFuseWriteBack_t **iFuseWriteBack) {
+    iFuseWriteBack_t *tmpIFuseWriteBack = NULL;
+
+    assert(iRodsPath != NULL);
+    assert(iFuseWriteBack != NULL);
+
+    tmpIFuseWriteBack = (iFuseWriteBack_t *) calloc(1, sizeof ( iFuseWriteBack_t));
+    if (tmpIFuseWriteBack == NULL) {
+        *iFuseWriteBack = NULL;
+        return SYS_MALLOC_ERR;
+    }
+
+    // we must use new keyword instead of calloc since it contains c++ stl list object
+    tmpIFuseWriteBack->jobs = new std::list<iFuseWriteBackJob_t*>();
+    tmpIFuseWriteBack->fds = new std::list<iFuseFd_t*>();
+    tmpIFuseWriteBack->iRodsPath = strdup(iRodsPath);
+
+    *iFuseWriteBack = tmpIFuseWriteBack;
+    return 0;
+}
+
+static int _freeWriteBack(iFuseWriteBack_t *iFuseWriteBack) {
+    assert(iFuseWriteBack != NULL);
+    assert(iFuseWriteBack->pending == 0);
+
+    delete iFuseWriteBack->jobs;
+    delete iFuseWriteBack->fds;
+
+    if(iFuseWriteBack->iRodsPath != NULL) {
+        free(iFuseWriteBack->iRodsPath);
+        iFuseWriteBack->iRodsPath = NULL;
+    }
+
+    free(iFuseWriteBack);
+    return 0;
+}
+
+static bool _overlapsPendingJob(iFuseWriteBack_t *iFuseWriteBack, off_t off, size_t size) {
+    std::list<iFuseWriteBackJob_t*>::iterator it;
+
+    for(it = iFuseWriteBack->jobs->begin(); it != iFuseWriteBack->jobs->end(); it++) {
+        iFuseWriteBackJob_t *job = *it;
+        if(job->offset < (off_t)(off + size) && off < (off_t)(job->offset + job->size)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void _runJob(iFuseWriteBackJob_t *job) {
+    int status = 0;
+    iFuseWriteBack_t *iFuseWriteBack = job->writeBack;
+    iFuseFd_t *iFuseFd = NULL;
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    // reuse a descriptor of a finished upload of the file
+    if(!iFuseWriteBack->fds->empty()) {
+        iFuseFd = iFuseWriteBack->fds->front();
+        iFuseWriteBack->fds->pop_front();
+    }
+
+    pthread_mutex_unlock(&g_WriteBackLock);
+
+    if(iFuseFd == NULL) {
+        // never truncate, other descriptors are writing the same file
+        status = iFuseFsOpen(iFuseWriteBack->iRodsPath, &iFuseFd, O_WRONLY);
+        if (status < 0) {
+            iFuseRodsClientLogError(LOG_ERROR, status, "_runJob: iFuseFsOpen of %s error, status = %d",
+                    iFuseWriteBack->iRodsPath, status);
+            iFuseFd = NULL;
+        }
+    }
+
+    if(iFuseFd != NULL) {
+        status = iFuseFsWrite(iFuseFd, job->buffer, job->offset, job->size);
+        if (status < 0) {
+            iFuseRodsClientLogError(LOG_ERROR, status, "_runJob: iFuseFsWrite of %s error, status = %d",
+                    iFuseWriteBack->iRodsPath, status);
+        }
+    }
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    if(iFuseFd != NULL) {
+        iFuseWriteBack->fds->push_back(iFuseFd);
+    }
+
+    if(status < 0 && iFuseWriteBack->error == 0) {
+        iFuseWriteBack->error = status;
+    }
+
+    iFuseWriteBack->jobs->remove(job);
+    iFuseWriteBack->pending--;
+    g_WriteBackDirtySize -= job->size;
+
+    pthread_cond_broadcast(&g_WriteBackDoneCond);
+    pthread_mutex_unlock(&g_WriteBackLock);
+
+    free(job->buffer);
+    free(job);
+}
+
+static void* _writeBackTask(void* param) {
+    iFuseWriteBackJob_t *job;
+
+    UNUSED(param);
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    while(g_WriteBackRunning) {
+        if(g_WriteBackQueue.empty()) {
+            pthread_cond_wait(&g_WriteBackJobCond, &g_WriteBackLock);
+            continue;
+        }
+
+        job = g_WriteBackQueue.front();
+        g_WriteBackQueue.pop_front();
+
+        pthread_mutex_unlock(&g_WriteBackLock);
+
+        iFuseRodsClientLog(LOG_DEBUG, "_writeBackTask: %s, offset: %lld, size: %lld", job->writeBack->iRodsPath, (long long)job->offset, (long long)job->size);
+
+        _runJob(job);
+
+        pthread_mutex_lock(&g_WriteBackLock);
+    }
+
+    pthread_mutex_unlock(&g_WriteBackLock);
+    return NULL;
+}
+
+/*
+ * Initialize write-back threads
+ */
+void iFuseWriteBackInit() {
+    int i;
+
+    pthread_mutex_init(&g_WriteBackLock, NULL);
+    pthread_cond_init(&g_WriteBackJobCond, NULL);
+    pthread_cond_init(&g_WriteBackDoneCond, NULL);
+
+    g_WriteBackDirtySize = 0;
+    g_WriteBackThreadNum = 0;
+    g_WriteBackThreads = NULL;
+    g_WriteBackRunning = true;
+
+    if(iFuseLibGetOption()->writeBackThreads <= 0) {
+        // blocks are written synchronously
+        return;
+    }
+
+    g_WriteBackThreads = (pthread_t*)calloc(iFuseLibGetOption()->writeBackThreads, sizeof(pthread_t));
+    if(g_WriteBackThreads == NULL) {
+        return;
+    }
+
+    for(i=0;i<iFuseLibGetOption()->writeBackThreads;i++) {
+        if(pthread_create(&g_WriteBackThreads[i], NULL, _writeBackTask, NULL) != 0) {
+            iFuseRodsClientLog(LOG_ERROR, "iFuseWriteBackInit: failed to create a write-back thread");
+            break;
+        }
+        g_WriteBackThreadNum++;
+    }
+}
+
+/*
+ * Destroy write-back threads
+ */
+void iFuseWriteBackDestroy() {
+    std::list<std::string> paths;
+    std::map<std::string, iFuseWriteBack_t*>::iterator it_writebackmap;
+    std::list<std::string>::iterator it_path;
+    int i;
+
+    // upload what is left
+    pthread_mutex_lock(&g_WriteBackLock);
+    for(it_writebackmap = g_WriteBackMap.begin(); it_writebackmap != g_WriteBackMap.end(); it_writebackmap++) {
+        paths.push_back(it_writebackmap->first);
+    }
+    pthread_mutex_unlock(&g_WriteBackLock);
+
+    for(it_path = paths.begin(); it_path != paths.end(); it_path++) {
+        iFuseWriteBackSync(it_path->c_str());
+    }
+
+    pthread_mutex_lock(&g_WriteBackLock);
+    g_WriteBackRunning = false;
+    pthread_cond_broadcast(&g_WriteBackJobCond);
+    pthread_mutex_unlock(&g_WriteBackLock);
+
+    for(i=0;i<g_WriteBackThreadNum;i++) {
+        pthread_join(g_WriteBackThreads[i], NULL);
+    }
+
+    if(g_WriteBackThreads != NULL) {
+        free(g_WriteBackThreads);
+        g_WriteBackThreads = NULL;
+    }
+    g_WriteBackThreadNum = 0;
+
+    pthread_cond_destroy(&g_WriteBackDoneCond);
+    pthread_cond_destroy(&g_WriteBackJobCond);
+    pthread_mutex_destroy(&g_WriteBackLock);
+}
+
+/*
+ * Queue a block to be uploaded
+ * the buffer is owned (and freed) by the write-back from now on.
+ * blocks in flight for the file that overlap the new one are uploaded first
+ * and the total size of queued blocks is bounded, so this may wait.
+ */
+int iFuseWriteBackWrite(iFuseFd_t *iFuseFd, char *buf, off_t off, size_t size) {
+    int status = 0;
+    std::map<std::string, iFuseWriteBack_t*>::iterator it_writebackmap;
+    iFuseWriteBack_t *iFuseWriteBack = NULL;
+    iFuseWriteBackJob_t *job = NULL;
+
+    assert(iFuseFd != NULL);
+    assert(iFuseFd->iRodsPath != NULL);
+    assert(buf != NULL);
+
+    if(g_WriteBackThreadNum <= 0) {
+        // no threads, write through the descriptor of the caller
+        status = iFuseFsWrite(iFuseFd, buf, off, size);
+        free(buf);
+        return status < 0 ? status : 0;
+    }
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    while(true) {
+        iFuseWriteBack = NULL;
+        it_writebackmap = g_WriteBackMap.find(iFuseFd->iRodsPath);
+        if(it_writebackmap != g_WriteBackMap.end()) {
+            iFuseWriteBack = it_writebackmap->second;
+
+            if(iFuseWriteBack->error < 0) {
+                status = iFuseWriteBack->error;
+                pthread_mutex_unlock(&g_WriteBackLock);
+                free(buf);
+                return status;
+            }
+
+            if(_overlapsPendingJob(iFuseWriteBack, off, size)) {
+                pthread_cond_wait(&g_WriteBackDoneCond, &g_WriteBackLock);
+                continue;
+            }
+        }
+
+        if(g_WriteBackDirtySize > 0 && g_WriteBackDirtySize + size > IFUSE_WRITEBACK_MAX_DIRTY_SIZE) {
+            pthread_cond_wait(&g_WriteBackDoneCond, &g_WriteBackLock);
+            continue;
+        }
+        break;
+    }
+
+    if(iFuseWriteBack == NULL) {
+        status = _newWriteBack(iFuseFd->iRodsPath, &iFuseWriteBack);
+        if(status < 0) {
+            pthread_mutex_unlock(&g_WriteBackLock);
+            free(buf);
+            return status;
+        }
+        g_WriteBackMap[iFuseFd->iRodsPath] = iFuseWriteBack;
+    }
+
+    job = (iFuseWriteBackJob_t *) calloc(1, sizeof ( iFuseWriteBackJob_t));
+    if(job == NULL) {
+        pthread_mutex_unlock(&g_WriteBackLock);
+        free(buf);
+        return SYS_MALLOC_ERR;
+    }
+
+    job->writeBack = iFuseWriteBack;
+    job->buffer = buf;
+    job->offset = off;
+    job->size = size;
+
+    iFuseWriteBack->jobs->push_back(job);
+    iFuseWriteBack->pending++;
+    g_WriteBackDirtySize += size;
+    g_WriteBackQueue.push_back(job);
+
+    pthread_cond_signal(&g_WriteBackJobCond);
+    pthread_mutex_unlock(&g_WriteBackLock);
+    return 0;
+}
+
+/*
+ * Wait until queued blocks of a file are uploaded
+ */
+int iFuseWriteBackWait(const char *iRodsPath) {
+    int status = 0;
+    std::map<std::string, iFuseWriteBack_t*>::iterator it_writebackmap;
+
+    assert(iRodsPath != NULL);
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    // look up again after every wakeup, a sync may have released the file
+    while((it_writebackmap = g_WriteBackMap.find(iRodsPath)) != g_WriteBackMap.end() &&
+            it_writebackmap->second->pending > 0) {
+        pthread_cond_wait(&g_WriteBackDoneCond, &g_WriteBackLock);
+    }
+
+    if(it_writebackmap != g_WriteBackMap.end()) {
+        status = it_writebackmap->second->error;
+    }
+
+    pthread_mutex_unlock(&g_WriteBackLock);
+    return status;
+}
+
+/*
+ * Wait until queued blocks of a file are uploaded and close the descriptors
+ * used to upload them, so iRODS has registered the new size of the file
+ * returns the first error of the uploads
+ */
+int iFuseWriteBackSync(const char *iRodsPath) {
+    int status = 0;
+    std::map<std::string, iFuseWriteBack_t*>::iterator it_writebackmap;
+    iFuseWriteBack_t *iFuseWriteBack = NULL;
+    iFuseFd_t *iFuseFd = NULL;
+
+    assert(iRodsPath != NULL);
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    while((it_writebackmap = g_WriteBackMap.find(iRodsPath)) != g_WriteBackMap.end() &&
+            it_writebackmap->second->pending > 0) {
+        pthread_cond_wait(&g_WriteBackDoneCond, &g_WriteBackLock);
+    }
+
+    if(it_writebackmap == g_WriteBackMap.end()) {
+        pthread_mutex_unlock(&g_WriteBackLock);
+        return 0;
+    }
+
+    iFuseWriteBack = it_writebackmap->second;
+    g_WriteBackMap.erase(it_writebackmap);
+
+    pthread_mutex_unlock(&g_WriteBackLock);
+
+    iFuseRodsClientLog(LOG_DEBUG, "iFuseWriteBackSync: %s", iRodsPath);
+
+    status = iFuseWriteBack->error;
+
+    while(!iFuseWriteBack->fds->empty()) {
+        int closeStatus;
+
+        iFuseFd = iFuseWriteBack->fds->front();
+        iFuseWriteBack->fds->pop_front();
+
+        closeStatus = iFuseFsClose(iFuseFd);
+        if (closeStatus < 0) {
+            iFuseRodsClientLogError(LOG_ERROR, closeStatus, "iFuseWriteBackSync: iFuseFsClose of %s error, status = %d",
+                    iRodsPath, closeStatus);
+            if(status == 0) {
+                status = closeStatus;
+            }
+        }
+    }
+
+    _freeWriteBack(iFuseWriteBack);
+    return status;
+}
+
+/*
+ * Get the end of the last queued block of a file, 0 if there is none
+ */
+off_t iFuseWriteBackGetSize(const char *iRodsPath) {
+    off_t size = 0;
+    std::map<std::string, iFuseWriteBack_t*>::iterator it_writebackmap;
+    std::list<iFuseWriteBackJob_t*>::iterator it_job;
+
+    assert(iRodsPath != NULL);
+
+    pthread_mutex_lock(&g_WriteBackLock);
+
+    it_writebackmap = g_WriteBackMap.find(iRodsPath);
+    if(it_writebackmap != g_WriteBackMap.end()) {
+        iFuseWriteBack_t *iFuseWriteBack = it_writebackmap->second;
+        for(it_job = iFuseWriteBack->jobs->begin(); it_job != iFuseWriteBack->jobs->end(); it_job++) {
+            off_t end = (*it_job)->offset + (*it_job)->size;
+            if(end > size) {
+                size = end;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&g_WriteBackLock);
+    return size;
+}
@@ -12,6 +12,8 @@
 #include <unistd.h>
 #include "iFuseCmdLineOpt.hpp"
 #include "iFuse.Lib.Conn.hpp"
+#include "iFuse.Lib.MetadataCache.hpp"
+#include "iFuse.WriteBack.hpp"
 #include "miscUtil.h"
 
 static iFuseOpt_t g_Opt;
@@ -24,6 +26,9 @@ void iFuseCmdOptsInit() {
     g_Opt.maxConn = IFUSE_MAX_NUM_CONN;
     g_Opt.connTimeoutSec = IFUSE_FREE_CONN_TIMEOUT_SEC;
     g_Opt.connKeepAliveSec = IFUSE_FREE_CONN_KEEPALIVE_SEC;
+    g_Opt.metadataCache = false;
+    g_Opt.metadataCacheTimeoutSec = IFUSE_METADATA_CACHE_TIMEOUT_SEC;
+    g_Opt.writeBackThreads = IFUSE_WRITEBACK_THREAD_NUM;
 }
 
 void iFuseCmdOptsDestroy() {
@@ -97,6 +102,24 @@ void iFuseCmdOptsParse(int argc, char **argv) {
                 argv[i+1] = "-Z";
             }
             argv[i] = "-Z";
+        } else if(strcmp("-ometacache", argv[i]) == 0) {
+            g_Opt.metadataCache = true;
+            argv[i] = "-Z";
+        } else if(strcmp("-onometacache", argv[i]) == 0) {
+            g_Opt.metadataCache = false;
+            argv[i] = "-Z";
+        } else if(strcmp("-ometacachetimeout", argv[i]) == 0) {
+            if(argc > i+1) {
+                g_Opt.metadataCacheTimeoutSec = atoi(argv[i+1]);
+                argv[i+1] = "-Z";
+            }
+            argv[i] = "-Z";
+        } else if(strcmp("-owritebackthreads", argv[i]) == 0) {
+            if(argc > i+1) {
+                g_Opt.writeBackThreads = atoi(argv[i+1]);
+                argv[i+1] = "-Z";
+            }
+            argv[i] = "-Z";
         }
     }
 
@@ -10,6 +10,7 @@
 #include "iFuseOper.hpp"
 #include "iFuse.Preload.hpp"
 #include "iFuse.BufferedFS.hpp"
+#include "iFuse.WriteBack.hpp"
 #include "iFuse.FS.hpp"
 #include "iFuse.Lib.Fd.hpp"
 #include "iFuse.Lib.Conn.hpp"
@@ -23,6 +24,7 @@ void *iFuseInit(struct fuse_conn_info *conn) {
     iFuseLibInit();
     iFuseFsInit();
     iFuseBufferedFSInit();
+    iFuseWriteBackInit();
     iFusePreloadInit();
     return NULL;
 }
@@ -31,6 +33,7 @@ void iFuseDestroy(void *data) {
     UNUSED(data);
     
     iFusePreloadDestroy();
+    iFuseWriteBackDestroy();
     iFuseBufferedFSDestroy();
     iFuseFsDestroy();
     iFuseLibDestroy();
@@ -361,6 +364,9 @@ int iFuseUnlink(const char *path) {
         return -ENOTDIR;
     }
     
+    // blocks still being uploaded would recreate the file
+    iFuseWriteBackSync(iRodsPath);
+    
     status = iFuseFsUnlink(iRodsPath);
     if (status < 0) {
         iFuseRodsClientLogError(LOG_ERROR, status, 
@@ -567,6 +573,10 @@ int iFuseRename(const char *from, const char *to) {
         return -ENOTDIR;
     }
     
+    // blocks still being uploaded are written by path
+    iFuseWriteBackSync(iRodsFromPath);
+    iFuseWriteBackSync(iRodsToPath);
+    
     bzero(&stbuf, sizeof(struct stat));
     status = iFuseFsGetAttr(iRodsToPath, &stbuf);
     if (status >= 0) {
@@ -601,6 +611,9 @@ int iFuseTruncate(const char *path, off_t size) {
         return -ENOTDIR;
     }
     
+    // blocks still being uploaded would be written past the new size
+    iFuseWriteBackSync(iRodsPath);
+    
     status = iFuseFsTruncate(iRodsPath, size);
     if (status < 0) {
         iFuseRodsClientLogError(LOG_ERROR, status, 
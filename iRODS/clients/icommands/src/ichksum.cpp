@@ -27,7 +27,7 @@ main( int argc, char **argv ) {
     rodsPathInp_t rodsPathInp;
 
 
-    optStr = "hKfarR:vVn:Z";
+    optStr = "hKfarR:vVn:N:Z";
 
     status = parseCmdLineOpt( argc, argv, optStr, 1, &myRodsArgs );
     if ( status < 0 ) {
@@ -97,7 +97,7 @@ main( int argc, char **argv ) {
 void
 usage() {
     char *msgs[] = {
-        "Usage: ichksum [-harvV] [-K|f] [-n replNum] [-R resource] [--silent]",
+        "Usage: ichksum [-harvV] [-K|f] [-n replNum] [-R resource] [-N numConn] [--silent]",
         "           dataObj|collection ... ",
         "Checksum one or more data-object or collection from iRODS space.",
         "Options are:",
@@ -110,6 +110,8 @@ usage() {
         " -r  recursive - checksum the whole subtree; the collection, all data-objects",
         "     in the collection, and any subcollections and sub-data-objects in the",
         "     collection.",
+        " -N  numConn - checksum the data-objects of collections over numConn",
+        "     connections at once, and report the aggregate rate at the end.",
         " --silent  - No checksum output except error",
         " -v  verbose",
         " -V  Very verbose",
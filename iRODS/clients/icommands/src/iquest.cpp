@@ -129,6 +129,57 @@ printBasicGenQueryOut( genQueryOut_t *genQueryOut, char *format ) {
     }
 }
 
+/* queryAndShowStream - run the query as a streaming general query, so
+ * the server sends the batches without waiting for a request for each.
+ * Returns SYS_UNMATCHED_API_NUM if the server does not support it.
+ */
+int
+queryAndShowStream( rcComm_t *conn, char *hint, char *format,
+                    genQueryInp_t *genQueryInp, int noPageFlag ) {
+    genQueryStreamInp_t genQueryStreamInp;
+    genQueryStream_t stream;
+    genQueryOut_t *genQueryOut = NULL;
+    int batchCnt = 0;
+    int status, closeStatus;
+
+    memset( &genQueryStreamInp, 0, sizeof( genQueryStreamInp ) );
+    genQueryStreamInp.genQueryInp = *genQueryInp;
+    status = rcGenQueryStreamOpen( conn, &genQueryStreamInp, &stream );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    while ( ( status = rcGenQueryStreamNext( &stream, &genQueryOut ) ) == 0 ) {
+        if ( batchCnt > 0 && noPageFlag == 0 ) {
+            char inbuf[100];
+            printf( "Continue? [Y/n]" );
+            std::string response = "";
+            getline( std::cin, response );
+            strncpy( inbuf, response.c_str(), 90 );
+            if ( strncmp( inbuf, "n", 1 ) == 0 ) {
+                freeGenQueryOut( &genQueryOut );
+                break;
+            }
+        }
+        status = printGenQueryOut( stdout, format, hint, genQueryOut );
+        freeGenQueryOut( &genQueryOut );
+        if ( status < 0 ) {
+            break;
+        }
+        batchCnt++;
+    }
+
+    /* cancels the query if it was stopped early */
+    closeStatus = rcGenQueryStreamClose( &stream );
+    if ( status == CAT_NO_ROWS_FOUND && batchCnt > 0 ) {
+        status = 0;
+    }
+    if ( status >= 0 && closeStatus < 0 ) {
+        status = closeStatus;
+    }
+    return status < 0 ? status : 0;
+}
+
 int
 queryAndShowStrCond( rcComm_t *conn, char *hint, char *format,
                      char *selectConditionString, int noDistinctFlag,
@@ -161,6 +212,12 @@ queryAndShowStrCond( rcComm_t *conn, char *hint, char *format,
 
     genQueryInp.maxRows = MAX_SQL_ROWS;
     genQueryInp.continueInx = 0;
+    i = queryAndShowStream( conn, hint, format, &genQueryInp, noPageFlag );
+    if ( i != SYS_UNMATCHED_API_NUM ) {
+        return i;
+    }
+
+    /* older servers, page through the result one request at a time */
     i = rcGenQuery( conn, &genQueryInp, &genQueryOut );
     if ( i < 0 ) {
         return i;
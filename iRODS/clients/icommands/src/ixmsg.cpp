@@ -6,6 +6,8 @@
 #include "irods_client_api_table.hpp"
 #include "irods_pack_table.hpp"
 #include "irods_configuration_keywords.hpp"
+#include <sys/time.h>
+#include <sys/wait.h>
 rodsEnv myRodsEnv;
 rErrMsg_t errMsg;
 int  connectFlag = 0;
@@ -19,12 +21,15 @@ printIxmsgHelp( const char *cmd ) {
     printf( "Usage: %s d -t ticketNum \n" , cmd );
     printf( "Usage: %s c -t ticketNum \n" , cmd );
     printf( "Usage: %s c -t ticketNum -s sequenceNum \n" , cmd );
+    printf( "Usage: %s b [-n NumberOfMessages] [-r numOfClients] \n" , cmd );
     printf( "    s: send messages. If no ticketNum is given, 1 is used \n" );
     printf( "    r: receive messages. If no ticketNum is given, 1 is used \n" );
     printf( "    t: create new message stream and get a new ticketNum \n" );
     printf( "    d: drop message Stream \n" );
     printf( "    c: clear message Stream \n" );
     printf( "    e: erase a message \n" );
+    printf( "    b: benchmark. Each client sends and then receives NumberOfMessages\n" );
+    printf( "       on its own new message stream, the rate of all clients is printed \n" );
     printReleaseInfo( "ixmsg" );
 }
 
@@ -69,6 +74,172 @@ sendIxmsg( rcComm_t **inconn, sendXmsgInp_t *sendXmsgInp ) {
     return status;
 }
 
+rcComm_t *
+connIxmsg() {
+    rcComm_t *conn = rcConnectXmsg( &myRodsEnv, &errMsg );
+    if ( conn == NULL ) {
+        fprintf( stderr, "rcConnect error\n" );
+        return NULL;
+    }
+    if ( clientLogin( conn ) != 0 ) {
+        fprintf( stderr, "clientLogin error\n" );
+        rcDisconnect( conn );
+        return NULL;
+    }
+    return conn;
+}
+
+/* a benchmark client, sends msgCnt messages on its own stream and then
+ * receives them back */
+int
+benchIxmsgClient( xmsgTicketInfo_t *xmsgTicketInfo, int msgCnt ) {
+    int status;
+    int i;
+    char msgBuf[] = "ixmsg benchmark";
+    sendXmsgInp_t sendXmsgInp;
+    rcvXmsgInp_t rcvXmsgInp;
+    rcvXmsgOut_t *rcvXmsgOut = NULL;
+
+    rcComm_t *conn = connIxmsg();
+    if ( conn == NULL ) {
+        return 7;
+    }
+
+    memset( &sendXmsgInp, 0, sizeof( sendXmsgInp ) );
+    sendXmsgInp.ticket = *xmsgTicketInfo;
+    snprintf( sendXmsgInp.sendAddr, NAME_LEN, "bench:%i", getpid() );
+    sendXmsgInp.sendXmsgInfo.numRcv = 1;
+    strcpy( sendXmsgInp.sendXmsgInfo.msgType, "ixmsg" );
+    sendXmsgInp.sendXmsgInfo.msg = msgBuf;
+    for ( i = 0; i < msgCnt; i++ ) {
+        status = rcSendXmsg( conn, &sendXmsgInp );
+        if ( status < 0 ) {
+            fprintf( stderr, "rcSendXmsg error. status = %d\n", status );
+            rcDisconnect( conn );
+            return 8;
+        }
+    }
+
+    memset( &rcvXmsgInp, 0, sizeof( rcvXmsgInp ) );
+    rcvXmsgInp.rcvTicket = xmsgTicketInfo->rcvTicket;
+    for ( i = 0; i < msgCnt; ) {
+        status = rcRcvXmsg( conn, &rcvXmsgInp, &rcvXmsgOut );
+        if ( status == SYS_NO_XMSG_FOR_MSG_NUMBER ) {
+            /* not queued yet, try again */
+            usleep( 1000 );
+            continue;
+        }
+        else if ( status < 0 ) {
+            fprintf( stderr, "rcRcvXmsg error. status = %d\n", status );
+            rcDisconnect( conn );
+            return 8;
+        }
+        free( rcvXmsgOut->msg );
+        free( rcvXmsgOut );
+        rcvXmsgOut = NULL;
+        i++;
+    }
+
+    rcDisconnect( conn );
+    return 0;
+}
+
+/* drop the stream of a benchmark ticket */
+void
+dropBenchStream( rcComm_t *conn, xmsgTicketInfo_t *xmsgTicketInfo ) {
+    char emptyBuf[] = "";
+    sendXmsgInp_t sendXmsgInp;
+
+    memset( &sendXmsgInp, 0, sizeof( sendXmsgInp ) );
+    sendXmsgInp.ticket = *xmsgTicketInfo;
+    sendXmsgInp.sendXmsgInfo.msg = emptyBuf;
+    sendXmsgInp.sendXmsgInfo.miscInfo = strdup( "DROP_STREAM" );
+    rcSendXmsg( conn, &sendXmsgInp );
+}
+
+int
+benchIxmsg( int msgCnt, int clientCnt ) {
+    int status;
+    int i;
+    int ticketCnt = 0;
+    int failCnt = 0;
+    struct timeval startTime, endTime;
+    float elapsed;
+    getXmsgTicketInp_t getXmsgTicketInp;
+    xmsgTicketInfo_t **outXmsgTicketInfo;
+
+    if ( msgCnt <= 0 ) {
+        msgCnt = 1000;
+    }
+    if ( clientCnt <= 0 ) {
+        clientCnt = 1;
+    }
+
+    irods::api_entry_table&  api_tbl = irods::get_client_api_table();
+    irods::pack_entry_table& pk_tbl  = irods::get_pack_table();
+    init_api_table( api_tbl, pk_tbl );
+
+    rcComm_t *conn = connIxmsg();
+    if ( conn == NULL ) {
+        return 7;
+    }
+
+    /* one stream per client, so the clients hash to different slots */
+    outXmsgTicketInfo = ( xmsgTicketInfo_t ** )
+                        calloc( clientCnt, sizeof( xmsgTicketInfo_t * ) );
+    memset( &getXmsgTicketInp, 0, sizeof( getXmsgTicketInp ) );
+    getXmsgTicketInp.flag = 1;
+    for ( ticketCnt = 0; ticketCnt < clientCnt; ticketCnt++ ) {
+        status = rcGetXmsgTicket( conn, &getXmsgTicketInp,
+                                  &outXmsgTicketInfo[ticketCnt] );
+        if ( status != 0 ) {
+            fprintf( stderr, "rcGetXmsgTicket error. status = %d\n", status );
+            failCnt++;
+            break;
+        }
+    }
+
+    gettimeofday( &startTime, NULL );
+    for ( i = 0; i < clientCnt && failCnt == 0; i++ ) {
+        pid_t pid = fork();
+        if ( pid == 0 ) {
+            exit( benchIxmsgClient( outXmsgTicketInfo[i], msgCnt ) );
+        }
+        else if ( pid < 0 ) {
+            fprintf( stderr, "fork error. errno = %d\n", errno );
+            failCnt++;
+        }
+    }
+    while ( wait( &status ) > 0 ) {
+        if ( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) {
+            failCnt++;
+        }
+    }
+    gettimeofday( &endTime, NULL );
+
+    if ( ticketCnt == clientCnt ) {
+        elapsed = ( endTime.tv_sec - startTime.tv_sec ) +
+                  ( endTime.tv_usec - startTime.tv_usec ) / 1000000.0;
+        printf( "%d clients sent and received %d messages each in %.3f sec\n",
+                clientCnt, msgCnt, elapsed );
+        if ( elapsed > 0 ) {
+            printf( "%.0f msgs/sec\n", clientCnt * msgCnt / elapsed );
+        }
+    }
+    if ( failCnt > 0 ) {
+        fprintf( stderr, "%d clients failed\n", failCnt );
+    }
+
+    for ( i = 0; i < ticketCnt; i++ ) {
+        dropBenchStream( conn, outXmsgTicketInfo[i] );
+        free( outXmsgTicketInfo[i] );
+    }
+    free( outXmsgTicketInfo );
+    rcDisconnect( conn );
+
+    return failCnt > 0 ? 8 : 0;
+}
+
 int
 main( int argc, char **argv ) {
 
@@ -310,6 +481,9 @@ main( int argc, char **argv ) {
         printf( "Ticket Flag       = %i\n", outXmsgTicketInfo->flag );
         free( outXmsgTicketInfo );
     }
+    else if ( !strcmp( cmd, "b" ) ) {
+        return benchIxmsg( mNum, rNum );
+    }
     else if ( !strcmp( cmd, "c" ) || !strcmp( cmd, "d" ) || !strcmp( cmd, "e" ) ) {
         memset( &sendXmsgInp, 0, sizeof( sendXmsgInp ) );
         xmsgTicketInfo.sendTicket = tNum;
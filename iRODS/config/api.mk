@@ -113,6 +113,8 @@ LIB_API_OBJS += $(libApiObjDir)/rcChkNVPathPerm.o
 
 SVR_API_OBJS += $(svrApiObjDir)/rsGenQuery.o
 LIB_API_OBJS += $(libApiObjDir)/rcGenQuery.o
+SVR_API_OBJS += $(svrApiObjDir)/rsGenQueryStream.o
+LIB_API_OBJS += $(libApiObjDir)/rcGenQueryStream.o
 
 SVR_API_OBJS += $(svrApiObjDir)/rsAuthRequest.o
 LIB_API_OBJS += $(libApiObjDir)/rcAuthRequest.o
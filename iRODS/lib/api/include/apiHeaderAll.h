@@ -45,6 +45,7 @@
 #include "fileChksum.h"
 #include "chkNVPathPerm.h"
 #include "genQuery.h"
+#include "genQueryStream.h"
 #include "authRequest.h"
 #include "authResponse.h"
 #include "authCheck.h"
@@ -150,6 +150,7 @@
 #define GET_TEMP_PASSWORD_FOR_OTHER_AN              724
 #define PAM_AUTH_REQUEST_AN                         725
 #define GET_LIMITED_PASSWORD_AN                     726
+#define GEN_QUERY_STREAM_AN                         727
 
 /* 1100 - 1200 - SSL API calls */
 #define SSL_START_AN 			1100
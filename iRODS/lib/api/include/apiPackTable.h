@@ -76,6 +76,7 @@ packInstructArray_t api_pack_table_init[] = {
     {"getRescQuotaInp_PI", getRescQuotaInp_PI, irods::clearInStruct_noop},
     {"rescQuota_PI", rescQuota_PI, irods::clearInStruct_noop},
     {"BulkOprInp_PI", BulkOprInp_PI, irods::clearInStruct_noop},
+    {"GenQueryStreamInp_PI", GenQueryStreamInp_PI, irods::clearInStruct_noop},
     {"endTransactionInp_PI", endTransactionInp_PI, irods::clearInStruct_noop},
     {"ProcStatInp_PI", ProcStatInp_PI, irods::clearInStruct_noop},
     {"specificQueryInp_PI", specificQueryInp_PI, irods::clearInStruct_noop},
@@ -197,6 +197,11 @@ static irods::apidef_t client_api_table_inp[] = {
         REMOTE_USER_AUTH, REMOTE_USER_AUTH,
         "GenQueryInp_PI", 0, "GenQueryOut_PI", 0, ( funcPtr ) RS_GEN_QUERY, clearGenQueryInp
     },
+    {
+        GEN_QUERY_STREAM_AN, RODS_API_VERSION,
+        REMOTE_USER_AUTH, REMOTE_USER_AUTH,
+        "GenQueryStreamInp_PI", 0, "GenQueryOut_PI", 0, ( funcPtr ) RS_GEN_QUERY_STREAM, clearGenQueryStreamInp
+    },
     {
         AUTH_REQUEST_AN, RODS_API_VERSION, NO_USER_AUTH | XMSG_SVR_ALSO,
         NO_USER_AUTH | XMSG_SVR_ALSO,
@@ -199,6 +199,7 @@ typedef struct PortalOpr {
     dataOprInp_t dataOprInp;
     portList_t portList;
     char shared_secret[ NAME_LEN ]; // shared secret for encryption
+    int l1descInx;                  // the data object being transferred, 0 if unknown
 } portalOpr_t;
 
 /* definition for flags */
@@ -29,6 +29,11 @@ typedef struct FileChksumInp {
 #define RS_FILE_CHKSUM rsFileChksum
 /* prototype for the server handler */
 #include "rodsConnect.h"
+#include <string>
+#include <vector>
+namespace irods {
+    class Hasher;
+}
 int
 rsFileChksum( rsComm_t *rsComm, fileChksumInp_t *fileChksumInp,
               char **chksumStr );
@@ -40,6 +45,12 @@ remoteFileChksum( rsComm_t *rsComm, fileChksumInp_t *fileChksumInp,
                   char **chksumStr, rodsServerHost_t *rodsServerHost );
 int
 fileChksum( rsComm_t *rsComm, char* objPath, char *fileName, char* rescHier, char* orig_chksum, char *chksumStr );
+int
+fileChksumScheme( char* orig_chksum, std::string& final_scheme );
+int
+fileChksumFrom( rsComm_t *rsComm, char* objPath, char *fileName, char* rescHier, rodsLong_t offset, irods::Hasher& hasher, char *chksumStr );
+int
+fileChksumTreeFrom( rsComm_t *rsComm, char* objPath, char *fileName, char* rescHier, rodsLong_t size, std::vector< std::string >& leaves, char *chksumStr );
 #else
 #define RS_FILE_CHKSUM NULL
 #endif
@@ -0,0 +1,78 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* genQueryStream.h
+   Streaming General Query.
+
+   Runs a general query once and has the server push the results back in
+   batches of genQueryInp.maxRows rows over the connection, rather than
+   the client asking for each batch with continueInx.  The server may run
+   up to "window" batches ahead of the client; the client acknowledges
+   each batch as it asks for the next one.
+ */
+
+#ifndef GEN_QUERY_STREAM_H__
+#define GEN_QUERY_STREAM_H__
+
+/* This is a metadata API call */
+#include "rcConnect.h"
+#include "rodsGenQuery.h"
+
+/* batches the server may send before waiting for the client */
+#define GEN_QUERY_STREAM_DEFAULT_WINDOW 4
+#define GEN_QUERY_STREAM_MAX_WINDOW     64
+
+typedef struct {
+    int window;                 /* batches in flight, 0 for the default */
+    genQueryInp_t genQueryInp;  /* maxRows is the batch size */
+} genQueryStreamInp_t;
+
+#define GenQueryStreamInp_PI "int window; struct GenQueryInp_PI;"
+
+/* client side state of an open stream */
+typedef struct {
+    rcComm_t *conn;
+    int status;     /* status of the last reply from the server */
+    int done;       /* the final reply has been read */
+} genQueryStream_t;
+
+#if defined(RODS_SERVER)
+#define RS_GEN_QUERY_STREAM rsGenQueryStream
+#include "rodsConnect.h"
+/* prototype for the server handler */
+int
+rsGenQueryStream( rsComm_t *rsComm, genQueryStreamInp_t *genQueryStreamInp,
+                  genQueryOut_t **genQueryOut );
+#else
+#define RS_GEN_QUERY_STREAM NULL
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* prototypes for the client calls */
+
+/* rcGenQueryStreamOpen - send the query.  The batches are then read with
+ * rcGenQueryStreamNext, and the stream must be finished with
+ * rcGenQueryStreamClose before the connection is used for anything else.
+ */
+int
+rcGenQueryStreamOpen( rcComm_t *conn, genQueryStreamInp_t *genQueryStreamInp,
+                      genQueryStream_t *stream );
+
+/* rcGenQueryStreamNext - return the next batch of rows in genQueryOut.
+ * Returns 0 with a batch, CAT_NO_ROWS_FOUND once all the rows have been
+ * returned, or a negative error.
+ */
+int
+rcGenQueryStreamNext( genQueryStream_t *stream, genQueryOut_t **genQueryOut );
+
+/* rcGenQueryStreamClose - stop the query if it has not finished and
+ * discard any batches still in flight.
+ */
+int
+rcGenQueryStreamClose( genQueryStream_t *stream );
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// GEN_QUERY_STREAM_H__
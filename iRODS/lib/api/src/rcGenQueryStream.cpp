@@ -0,0 +1,163 @@
+/**
+ * @file  rcGenQueryStream.cpp
+ *
+ */
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* See genQueryStream.h for a description of this API call.*/
+
+#include "genQueryStream.h"
+#include "procApiRequest.h"
+#include "apiNumber.h"
+#include "rcMisc.h"
+#include "sockComm.h"
+
+/* tell the server whether to keep sending batches */
+static int
+_cliSendGenQueryStreamReply( rcComm_t *conn, int reply ) {
+    int myBuf = htonl( reply );
+    int status = myWrite( conn->sock, ( void * ) &myBuf, sizeof( myBuf ), NULL );
+    if ( status != sizeof( myBuf ) ) {
+        rodsLog( LOG_ERROR,
+                 "_cliSendGenQueryStreamReply: write failed, status = %d", status );
+        return status < 0 ? status : SYS_HEADER_WRITE_LEN_ERR;
+    }
+    return 0;
+}
+
+/* read the next reply, acknowledging the previous batch first */
+static int
+_cliReadGenQueryStreamReply( genQueryStream_t *stream, int reply,
+                             genQueryOut_t **genQueryOut ) {
+    if ( stream->status == SYS_SVR_TO_CLI_GEN_QUERY_BATCH ) {
+        int status = _cliSendGenQueryStreamReply( stream->conn, reply );
+        if ( status < 0 ) {
+            stream->status = status;
+            stream->done = 1;
+            return status;
+        }
+    }
+
+    stream->status = readAndProcApiReply( stream->conn, stream->conn->apiInx,
+                                          ( void ** ) genQueryOut, NULL );
+    if ( stream->status != SYS_SVR_TO_CLI_GEN_QUERY_BATCH ) {
+        stream->done = 1;
+    }
+    return stream->status;
+}
+
+/**
+ * \fn rcGenQueryStreamOpen (rcComm_t *conn, genQueryStreamInp_t *genQueryStreamInp, genQueryStream_t *stream)
+ *
+ * \brief Start a streaming general-query.
+ *
+ * \user client
+ *
+ * \ingroup metadata
+ *
+ * \since 4.1.0
+ *
+ *
+ * \remark
+ * Start a streaming general-query:
+ * \n The query is run once on the server, which then sends every batch
+ * \n of genQueryInp.maxRows rows without waiting for the client to ask
+ * \n for it, staying at most genQueryStreamInp->window batches ahead.
+ * \n Read the batches with rcGenQueryStreamNext and finish with
+ * \n rcGenQueryStreamClose.  The connection cannot be used for other
+ * \n calls while the stream is open.
+ *
+ * \note none
+ *
+ * \usage
+ *
+ * \param[in] conn - A rcComm_t connection handle to the server
+ * \param[in] genQueryStreamInp - the window and the general-query
+ * \param[out] stream - the state of the stream
+ * \return integer
+ * \retval 0 on success
+ *
+ * \sideeffect none
+ * \pre none
+ * \post none
+ * \sa rcGenQuery
+**/
+
+int
+rcGenQueryStreamOpen( rcComm_t *conn, genQueryStreamInp_t *genQueryStreamInp,
+                      genQueryStream_t *stream ) {
+    memset( stream, 0, sizeof( genQueryStream_t ) );
+    if ( conn == NULL || genQueryStreamInp == NULL ) {
+        stream->done = 1;
+        return USER__NULL_INPUT_ERR;
+    }
+    stream->conn = conn;
+
+    freeRError( conn->rError );
+    conn->rError = NULL;
+
+    int apiInx = apiTableLookup( GEN_QUERY_STREAM_AN );
+    if ( apiInx < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "rcGenQueryStreamOpen: apiTableLookup of apiNumber %d failed",
+                 GEN_QUERY_STREAM_AN );
+        stream->status = apiInx;
+        stream->done = 1;
+        return apiInx;
+    }
+
+    int status = sendApiRequest( conn, apiInx, genQueryStreamInp, NULL );
+    if ( status < 0 ) {
+        rodsLogError( LOG_DEBUG, status,
+                      "rcGenQueryStreamOpen: sendApiRequest failed. status = %d",
+                      status );
+        stream->status = status;
+        stream->done = 1;
+        return status;
+    }
+
+    conn->apiInx = apiInx;
+    return 0;
+}
+
+int
+rcGenQueryStreamNext( genQueryStream_t *stream, genQueryOut_t **genQueryOut ) {
+    *genQueryOut = NULL;
+    if ( stream->done ) {
+        return stream->status < 0 ? stream->status : CAT_NO_ROWS_FOUND;
+    }
+
+    while ( !stream->done ) {
+        int status = _cliReadGenQueryStreamReply( stream,
+                     SYS_CLI_TO_SVR_GEN_QUERY_ACK, genQueryOut );
+        if ( status < 0 ) {
+            freeGenQueryOut( genQueryOut );
+            return status;
+        }
+        if ( *genQueryOut != NULL && ( *genQueryOut )->rowCnt > 0 ) {
+            return 0;
+        }
+
+        /* the final reply may not carry any rows */
+        freeGenQueryOut( genQueryOut );
+    }
+
+    return CAT_NO_ROWS_FOUND;
+}
+
+int
+rcGenQueryStreamClose( genQueryStream_t *stream ) {
+    /* ask the server to stop, then drain whatever it already sent */
+    while ( !stream->done ) {
+        genQueryOut_t *genQueryOut = NULL;
+        _cliReadGenQueryStreamReply( stream, SYS_CLI_TO_SVR_GEN_QUERY_CANCEL,
+                                     &genQueryOut );
+        freeGenQueryOut( &genQueryOut );
+    }
+
+    if ( stream->status < 0 && stream->status != CAT_NO_ROWS_FOUND ) {
+        return stream->status;
+    }
+    return 0;
+}
@@ -37,6 +37,8 @@ namespace irods {
                 int,           // salt size in bytes
                 int,           // num hash rounds
                 const char* ); // algorithm
+            buffer_crypt( const buffer_crypt& );
+            buffer_crypt& operator=( const buffer_crypt& );
             ~buffer_crypt();
 
             /// =-=-=-=-=-=-=-
@@ -47,6 +49,16 @@ namespace irods {
                 const array_t&, // plaintext buffer
                 array_t& );     // encrypted buffer
 
+            /// =-=-=-=-=-=-=-
+            /// @brief given a string, encrypt it.  for aead modes the
+            ///        additional data is authenticated with the tag
+            irods::error encrypt(
+                const array_t&, // key
+                const array_t&, // initialization vector
+                const array_t&, // additional authenticated data
+                const array_t&, // plaintext buffer
+                array_t& );     // encrypted buffer
+
             /// =-=-=-=-=-=-=-
             /// @brief given a string, decrypt it
             irods::error decrypt(
@@ -55,11 +67,31 @@ namespace irods {
                 const array_t&, // encrypted buffer
                 array_t& );     // plaintext buffer
 
+            /// =-=-=-=-=-=-=-
+            /// @brief given a string, decrypt it.  for aead modes the
+            ///        additional data must match that given to encrypt
+            irods::error decrypt(
+                const array_t&, // key
+                const array_t&, // initialization vector
+                const array_t&, // additional authenticated data
+                const array_t&, // encrypted buffer
+                array_t& );     // plaintext buffer
+
             /// =-=-=-=-=-=-=-
             /// @brief given a key, create a hashed key and IV
             irods::error initialization_vector(
                 array_t& );     // intialization vector
 
+            /// =-=-=-=-=-=-=-
+            /// @brief size in bytes of the iv generated by
+            ///        initialization_vector
+            int iv_size();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief true if the cipher is an AEAD mode ( GCM ) which
+            ///        appends an authentication tag rather than padding
+            bool is_aead();
+
             /// =-=-=-=-=-=-=-
             /// @brief generate a random byte key
             static irods::error generate_key(
@@ -89,7 +121,23 @@ namespace irods {
 
             static std::string gen_hash( unsigned char*, int );
 
+            static const int AEAD_IV_SIZE  = 12;
+            static const int AEAD_TAG_SIZE = 16;
+
         private:
+            /// =-=-=-=-=-=-=-
+            /// @brief the cipher for the algorithm name, looked up on
+            ///        first use.  unknown names fall back to aes-256-cbc
+            const EVP_CIPHER* cipher();
+
+            /// =-=-=-=-=-=-=-
+            /// @brief (re)initialize the cipher context for a new key and
+            ///        iv, creating it on first use
+            irods::error init_context(
+                const array_t&, // key
+                const array_t&, // initialization vector
+                int );          // 1 for encryption, 0 for decryption
+
             // =-=-=-=-=-=-=-
             // attributes
             int         key_size_;
@@ -97,6 +145,12 @@ namespace irods {
             int         num_hash_rounds_;
             std::string algorithm_;
 
+            // =-=-=-=-=-=-=-
+            // cipher context kept across calls so a stream does not
+            // pay for a context allocation and cipher lookup per buffer
+            EVP_CIPHER_CTX*   context_;
+            const EVP_CIPHER* cipher_;
+
     }; // class buffer_crypt
 
 }; // namespace irods
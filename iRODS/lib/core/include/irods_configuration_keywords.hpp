@@ -51,6 +51,10 @@ namespace irods {
         "maximum_temporary_password_lifetime_in_seconds" );
     const std::string CFG_MAX_NUMBER_OF_CONCURRENT_RE_PROCS(
         "maximum_number_of_concurrent_rule_engine_server_processes" );
+    const std::string CFG_RE_FLATTEN_RULES(
+        "rule_engine_flatten_rules" );
+    const std::string CFG_NUMBER_OF_CHECKSUM_THREADS(
+        "number_of_threads_for_tree_checksum" );
 
     // service_account_environment.json keywords
     const std::string CFG_IRODS_USER_NAME_KW( "irods_user_name" );
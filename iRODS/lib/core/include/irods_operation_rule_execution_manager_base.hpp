@@ -47,6 +47,11 @@ namespace irods {
                 keyValPair_t&,      // vars from fco
                 std::string& ) = 0; // rule results
 
+            /// =-=-=-=-=-=-=-
+            /// @brief true if there is a pre or post operation rule,
+            ///        otherwise both may be skipped entirely
+            virtual bool has_rules() = 0;
+
         protected:
             /// =-=-=-=-=-=-=-
             /// @brief execute rule for post operation
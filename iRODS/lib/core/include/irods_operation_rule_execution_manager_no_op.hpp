@@ -42,6 +42,12 @@ namespace irods {
                 return SUCCESS();
             }
 
+            /// =-=-=-=-=-=-=-
+            /// @brief there are no rules on the client side
+            bool has_rules() {
+                return false;
+            }
+
             /// =-=-=-=-=-=-=-
             /// @brief execute rule for post operation
             error exec_op(
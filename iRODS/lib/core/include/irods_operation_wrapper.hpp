@@ -72,6 +72,18 @@ namespace irods {
             error call(
                 plugin_context& _ctx ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -123,6 +135,18 @@ namespace irods {
                 plugin_context& _ctx,
                 T1              _t1 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -174,6 +198,18 @@ namespace irods {
                 T1              _t1,
                 T2              _t2 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -226,6 +262,18 @@ namespace irods {
                 T2              _t2,
                 T3              _t3 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -279,6 +327,18 @@ namespace irods {
                 T3              _t3,
                 T4              _t4 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = operation_( _ctx, _t1, _t2, _t3, _t4 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -334,6 +394,18 @@ namespace irods {
                 T4              _t4,
                 T5              _t5 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -389,6 +461,18 @@ namespace irods {
                 T5              _t5,
                 T6              _t6 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -445,6 +529,18 @@ namespace irods {
                 T6              _t6,
                 T7              _t7 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6, _t7 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -503,6 +599,18 @@ namespace irods {
                 T7              _t7,
                 T8              _t8 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6, _t7, _t8 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -561,6 +669,18 @@ namespace irods {
                 T8              _t8,
                 T9              _t9 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6, _t7, _t8, _t9 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -620,6 +740,18 @@ namespace irods {
                 T9              _t9,
                 T10             _t10 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6, _t7, _t8, _t9, _t10 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -680,6 +812,18 @@ namespace irods {
                 T10             _t10,
                 T11             _t11 ) {
                 if ( operation_ ) {
+                    // =-=-=-=-=-=-=-
+                    // skip building the rule environment if there
+                    // is neither a pre nor a post rule for this op
+                    if ( !rule_exec_mgr_->has_rules() ) {
+                        _ctx.rule_results( "" );
+                        error op_err = ( *operation_ )( _ctx, _t1, _t2, _t3, _t4, _t5, _t6, _t7, _t8, _t9, _t10, _t11 );
+                        if ( !op_err.ok() ) {
+                            _ctx.rule_results( OP_FAILED );
+                        }
+                        return op_err;
+                    }
+
                     // =-=-=-=-=-=-=-
                     // get vars from fco
                     keyValPair_t kvp;
@@ -7,6 +7,20 @@ namespace irods {
 
     irods::pack_entry_table& get_pack_table();
 
+/// =-=-=-=-=-=-=-
+/// @brief cached version of parsePackInstruct. each pack instruction is
+///        parsed once per process and every call gets a fresh copy of
+///        the parsed items, to be freed with freePackedItem as before
+    int parse_pack_instruct(
+        const char*  _pack_instruct,
+        packItem_t** _pack_item_head );
+
+/// =-=-=-=-=-=-=-
+/// @brief turn the cache of parse_pack_instruct on or off. with it off
+///        every call parses the instruction text, so tests can compare
+///        the packed output of both
+    void set_pack_instruct_cache(
+        bool _enabled );
 
 }; // namespace irods
 
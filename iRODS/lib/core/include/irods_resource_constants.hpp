@@ -19,6 +19,12 @@ namespace irods {
 ///        used in the "resource_rebalance" operation below
     const std::string REPL_LIMIT_KEY( "replication_rebalance_limit" );
 
+// =-=-=-=-=-=-=-
+/// @brief key for the replicating resource node which defines the
+///        number of data objects to replicate at once during a
+///        rebalance (defaults to 1)
+    const std::string REPL_WORKERS_KEY( "replication_rebalance_workers" );
+
 // =-=-=-=-=-=-=-
 /// @brief key for compound resource cache staging policy
     const std::string RESOURCE_STAGE_TO_CACHE_POLICY( "compound_resource_cache_refresh_policy" );
@@ -98,6 +104,7 @@ namespace irods {
     const std::string RESOURCE_CONTEXT( "resource_property_context" );
     const std::string RESOURCE_CHECK_PATH_PERM( "resource_property_check_path_perm" );
     const std::string RESOURCE_CREATE_PATH( "resource_property_create_path" );
+    const std::string RESOURCE_NATIVE_FD( "resource_property_native_fd" );
     const std::string RESOURCE_OBJCOUNT( "resource_property_objcount" );
 
 
@@ -0,0 +1,114 @@
+#ifndef IRODS_TRANSFER_PIPELINE_HPP
+#define IRODS_TRANSFER_PIPELINE_HPP
+
+// =-=-=-=-=-=-=-
+// irods includes
+#include "rodsType.h"
+#include "irods_buffer_encryption.hpp"
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief runs the stages of a single portal stream ( e.g. disk read,
+    ///        encrypt, socket write ) on their own threads, passing a
+    ///        fixed set of buffers between them so each stage works on
+    ///        one buffer while its neighbors work on the others
+    class transfer_pipeline {
+        public:
+            /// @brief a buffer in flight between the stages
+            struct frame {
+                buffer_crypt::array_t plain;
+                buffer_crypt::array_t cipher;
+                buffer_crypt::array_t iv;
+                int                   length;
+                rodsLong_t            offset;
+            };
+
+            /// @brief a stage returns > 0 to pass the frame along, 0 when
+            ///        the first stage has no more data, < 0 on error
+            typedef boost::function< int( frame& ) > stage_t;
+
+            transfer_pipeline();
+
+            /// @brief add the next stage of the pipeline
+            void add_stage( stage_t _stage );
+
+            /// @brief run the stages until the first one runs out of
+            ///        data, returning the first error status if any.
+            ///        the last stage runs on the calling thread.  the
+            ///        frames are kept so later runs reuse their buffers
+            int run();
+
+        private:
+            class frame_queue {
+                public:
+                    frame_queue();
+                    void   push( frame* );
+                    frame* pop();
+                    void   close();
+                    void   abort();
+
+                private:
+                    boost::mutex       mutex_;
+                    boost::condition   cond_;
+                    std::deque<frame*> frames_;
+                    bool               closed_;
+            };
+
+            void run_stage( size_t );
+            void abort( int );
+
+            std::vector< stage_t >      stages_;
+            std::vector< frame >        frames_;
+            std::vector< frame_queue* > queues_;
+            boost::mutex                status_mutex_;
+            int                         status_;
+
+    }; // class transfer_pipeline
+
+    // =-=-=-=-=-=-=-
+    // stages shared by the encrypted portal streams.  the wire format of
+    // a frame is [ int size ][ iv ][ cipher text ] where size covers the
+    // iv and the cipher text.  aead ciphers authenticate the file offset
+    // of the frame along with it, so a frame which is replayed or moved
+    // within the transfer fails to decrypt
+
+    /// @brief the additional authenticated data of the frame at an offset
+    void frame_aad(
+        rodsLong_t,                   // file offset of the frame
+        buffer_crypt::array_t& );     // additional authenticated data
+
+    /// @brief encrypt the plain text of a frame under a fresh iv, the
+    ///        offset of the frame must be set
+    int encrypt_frame(
+        buffer_crypt&,                // per stream cipher
+        const buffer_crypt::array_t&, // shared secret
+        transfer_pipeline::frame& );
+
+    /// @brief send an encrypted frame
+    int write_encrypted_frame(
+        int,                          // socket
+        transfer_pipeline::frame& );
+
+    /// @brief read an encrypted frame expected at an offset and decrypt
+    ///        it into the plain text
+    int read_encrypted_frame(
+        int,                          // socket
+        int,                          // largest acceptable frame size
+        buffer_crypt&,                // per stream cipher
+        const buffer_crypt::array_t&, // shared secret
+        rodsLong_t,                   // file offset of the frame
+        transfer_pipeline::frame& );
+
+}; // namespace irods
+
+#endif // IRODS_TRANSFER_PIPELINE_HPP
@@ -31,6 +31,8 @@ typedef struct {
     char cachedSubPhyBunDir[MAX_NAME_LEN];
     char phyBunPath[MAX_NUM_BULK_OPR_FILES][MAX_NAME_LEN];
     bytesBuf_t bytesBuf;
+    void *sender;   // bundle in flight while the next one is filled, NULL
+                    // when every bundle is sent before putting more files
 } bulkOprInfo_t;
 
 int
@@ -66,6 +68,8 @@ int
 sendBulkPut( rcComm_t *conn, bulkOprInp_t *bulkOprInp,
              bulkOprInfo_t *bulkOprInfo, rodsArguments_t *rodsArgs );
 int
+waitBulkPut( bulkOprInfo_t *bulkOprInfo );
+int
 clearBulkOprInfo( bulkOprInfo_t *bulkOprInfo );
 int
 setForceFlagForRestart( bulkOprInp_t *bulkOprInp, bulkOprInfo_t *bulkOprInfo );
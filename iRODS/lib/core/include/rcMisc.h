@@ -118,6 +118,8 @@ int
 freeGenQueryInp( genQueryInp_t **genQueryInp );
 void
 clearGenQueryInp( void * voidInp );
+void
+clearGenQueryStreamInp( void * voidInp );
 sqlResult_t *
 getSqlResultByInx( genQueryOut_t *genQueryOut, int attriInx );
 void
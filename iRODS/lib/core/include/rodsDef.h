@@ -113,6 +113,9 @@
 #define SYS_SVR_TO_CLI_PUT_ACTION 99999990
 #define SYS_SVR_TO_CLI_GET_ACTION 99999991
 #define SYS_RSYNC_TARGET_MODIFIED 99999992	/* target modified */
+#define SYS_SVR_TO_CLI_GEN_QUERY_BATCH 99999988
+#define SYS_CLI_TO_SVR_GEN_QUERY_ACK 99999987
+#define SYS_CLI_TO_SVR_GEN_QUERY_CANCEL 99999986
 
 /* definition for iRODS server to client action request from a microservice.
  * these definitions are put in the "label" field of MsParam */
@@ -264,6 +267,7 @@ typedef struct startupPack {
 #define SP_LOG_SQL	"spLogSql"
 #define SP_LOG_LEVEL	"spLogLevel"
 #define SP_RE_CACHE_SALT "reCacheSalt"
+#define SP_AGENT_POOL_SOCK "spAgentPoolSock"
 #define SERVER_BOOT_TIME "serverBootTime"
 
 // =-=-=-=-=-=-=-
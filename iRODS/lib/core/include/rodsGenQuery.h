@@ -537,4 +537,9 @@ primary ordering column.
 #define COL_TICKET_OWNER_NAME 2229
 #define COL_TICKET_OWNER_ZONE 2230
 
+/* Grid configuration */
+#define COL_GRID_CONF_NAMESPACE 2300
+#define COL_GRID_CONF_OPTION_NAME 2301
+#define COL_GRID_CONF_OPTION_VALUE 2302
+
 #endif /* RODS_GEN_QUERY_H__ */
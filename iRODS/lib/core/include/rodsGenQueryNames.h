@@ -373,6 +373,10 @@ columnName_t columnNames[] = {
     { COL_TICKET_OWNER_NAME,               "TICKET_OWNER_NAME", },
     { COL_TICKET_OWNER_ZONE,               "TICKET_OWNER_ZONE", },
 
+    { COL_GRID_CONF_NAMESPACE,             "GRID_CONF_NAMESPACE", },
+    { COL_GRID_CONF_OPTION_NAME,           "GRID_CONF_OPTION_NAME", },
+    { COL_GRID_CONF_OPTION_VALUE,          "GRID_CONF_OPTION_VALUE", },
+
 };
 
 int NumOfColumnNames = sizeof( columnNames ) / sizeof( columnName_t );
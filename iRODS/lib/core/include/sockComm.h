@@ -16,6 +16,8 @@
 #define SOCK_WINDOW_SIZE	(1*1024*1024)   /* sock window size = 1 Mb */
 #define MIN_SOCK_WINDOW_SIZE	(16*1024)   /* min sock window size = 16 kb */
 #define MAX_SOCK_WINDOW_SIZE	(16*1024*1024) /* max window size = 16 Mb */
+#define SPLICE_PIPE_SIZE	(1*1024*1024)	/* pipe size for mySpliceToFile */
+#define SPLICE_DRAIN_BUF_SIZE	(64*1024)	/* fallback buffer for mySpliceToFile */
 #define DEF_NUMBER_SVR_PORT	200	/* default number of of server ports */
 #define CONNECT_TIMEOUT_TIME    100	/* connection timeout time in sec */
 #define RECONNECT_WAIT_TIME  100	/* re-connection timeout time in sec */
@@ -51,6 +53,10 @@ int sockOpenForInConn( rsComm_t *rsComm, int *portNum, char **addr, int proto );
 int rodsSetSockOpt( int sock, int windowSize );
 int myRead( int sock, void *buf, int len, int *bytesRead, struct timeval *tv );
 int myWrite( int sock, void *buf, int len, int *bytesWritten );
+int mySendFile( int sock, int fd, rodsLong_t offset, int len,
+                int *bytesWritten );
+int mySpliceToFile( int sock, int fd, rodsLong_t offset, int len,
+                    int *bytesWritten );
 int connectToRhost( rcComm_t *conn, int connectCnt, int reconnFlag );
 int connectToRhostWithRaddr( struct sockaddr_in *remoteAddr, int windowSize,
                              int timeoutFlag );
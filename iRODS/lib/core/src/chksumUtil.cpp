@@ -10,8 +10,166 @@
 #include "chksumUtil.h"
 #include "rcGlobalExtern.h"
 
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+
+#define MAX_CHKSUM_BATCH 1000
+
 static int ChksumCnt = 0;
 static int FailedChksumCnt = 0;
+
+/* Checksums the data objects of a collection over connections of its own,
+ * with one request in flight per connection.  Objects are queued in the
+ * order the collection is listed and are reported in that order once the
+ * batch is done, so the output is the same as a serial run. */
+class chksumPool {
+    public:
+        chksumPool( rodsEnv *myRodsEnv, int numConn ) :
+            next_( 0 ),
+            dataObjInp_( NULL ),
+            objects_( 0 ),
+            bytes_( 0 ) {
+            for ( int i = 0; i < numConn; i++ ) {
+                rErrMsg_t errMsg;
+                rcComm_t *conn = rcConnect( myRodsEnv->rodsHost, myRodsEnv->rodsPort,
+                                            myRodsEnv->rodsUserName, myRodsEnv->rodsZone, 1, &errMsg );
+                if ( conn == NULL ) {
+                    break;
+                }
+                if ( clientLogin( conn ) != 0 ) {
+                    rcDisconnect( conn );
+                    break;
+                }
+                conns_.push_back( conn );
+            }
+            ( void ) gettimeofday( &startTime_, ( struct timezone * )0 );
+        }
+
+        ~chksumPool() {
+            for ( size_t i = 0; i < conns_.size(); i++ ) {
+                printErrorStack( conns_[i]->rError );
+                rcDisconnect( conns_[i] );
+            }
+        }
+
+        size_t size() {
+            return conns_.size();
+        }
+
+        /* queue a data object, returns true once the batch is full */
+        bool add( char *objPath, rodsLong_t dataSize ) {
+            chksumJob job;
+            job.objPath = objPath;
+            job.dataSize = dataSize;
+            job.status = 0;
+            job.chksumStr = NULL;
+            job.conn = NULL;
+            jobs_.push_back( job );
+            return jobs_.size() >= MAX_CHKSUM_BATCH;
+        }
+
+        /* checksum the queued data objects and report them in order.
+         * returns the last error, if any */
+        int flush( rodsArguments_t *rodsArgs, dataObjInp_t *dataObjInp ) {
+            if ( jobs_.empty() ) {
+                return 0;
+            }
+            next_ = 0;
+            dataObjInp_ = dataObjInp;
+            boost::thread_group threads;
+            for ( size_t i = 0; i < conns_.size() && i < jobs_.size(); i++ ) {
+                threads.create_thread( boost::bind( &chksumPool::run, this, conns_[i] ) );
+            }
+            threads.join_all();
+
+            int savedStatus = 0;
+            char myDir[MAX_NAME_LEN], myFile[MAX_NAME_LEN];
+            for ( size_t i = 0; i < jobs_.size(); i++ ) {
+                chksumJob& job = jobs_[i];
+                ChksumCnt++;
+                if ( job.status < 0 ) {
+                    FailedChksumCnt++;
+                    rodsLogError( LOG_ERROR, job.status,
+                                  "chksumCollUtil: rcDataObjChksum error for %s",
+                                  job.objPath.c_str() );
+                    savedStatus = job.status;
+                    continue;
+                }
+                objects_++;
+                bytes_ += job.dataSize;
+                if ( rodsArgs->silent == False ) {
+                    splitPathByKey( job.objPath.c_str(), myDir, MAX_NAME_LEN, myFile, MAX_NAME_LEN, '/' );
+                    printf( "    %-30.30s    %s\n", myFile, job.chksumStr );
+                    if ( rodsArgs->verbose == True ) {
+                        printTiming( job.conn, ( char * ) job.objPath.c_str(), -1, NULL,
+                                     &job.startTime, &job.endTime );
+                    }
+                }
+                free( job.chksumStr );
+            }
+            jobs_.clear();
+            return savedStatus;
+        }
+
+        void report() {
+            struct timeval endTime;
+            ( void ) gettimeofday( &endTime, ( struct timezone * )0 );
+            float timeInSec = ( float )( endTime.tv_sec - startTime_.tv_sec ) +
+                              ( float )( endTime.tv_usec - startTime_.tv_usec ) / 1000000.0;
+            if ( timeInSec <= 0.0 ) {
+                timeInSec = 0.000001;
+            }
+            printf( "Checksummed %lld objects, %lld bytes in %.3f sec over %d connections: "
+                    "%.1f objects/s, %.3f MB/s\n",
+                    objects_, bytes_, timeInSec, ( int ) conns_.size(),
+                    ( float ) objects_ / timeInSec,
+                    ( float ) bytes_ / 1048576.0 / timeInSec );
+        }
+
+    private:
+        struct chksumJob {
+            std::string objPath;
+            rodsLong_t  dataSize;
+            int         status;
+            char       *chksumStr;
+            rcComm_t   *conn;
+            struct timeval startTime;
+            struct timeval endTime;
+        };
+
+        void run( rcComm_t *conn ) {
+            /* the keywords are shared, only the path differs */
+            dataObjInp_t myDataObjInp = *dataObjInp_;
+            while ( true ) {
+                size_t inx;
+                {
+                    boost::mutex::scoped_lock lock( mutex_ );
+                    if ( next_ >= jobs_.size() ) {
+                        return;
+                    }
+                    inx = next_++;
+                }
+                chksumJob& job = jobs_[inx];
+                rstrcpy( myDataObjInp.objPath, job.objPath.c_str(), MAX_NAME_LEN );
+                job.conn = conn;
+                ( void ) gettimeofday( &job.startTime, ( struct timezone * )0 );
+                job.status = rcDataObjChksum( conn, &myDataObjInp, &job.chksumStr );
+                ( void ) gettimeofday( &job.endTime, ( struct timezone * )0 );
+            }
+        }
+
+        std::vector<rcComm_t *> conns_;
+        std::vector<chksumJob>  jobs_;
+        size_t                  next_;
+        boost::mutex            mutex_;
+        dataObjInp_t           *dataObjInp_;
+        rodsLong_t              objects_;
+        rodsLong_t              bytes_;
+        struct timeval          startTime_;
+};
+
+static chksumPool *ChksumPool = NULL;
 int
 chksumUtil( rcComm_t *conn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
             rodsPathInp_t *rodsPathInp ) {
@@ -27,6 +185,17 @@ chksumUtil( rcComm_t *conn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
         return savedStatus;
     }
 
+    /* -N checksums the objects of collections over several connections */
+    if ( myRodsArgs->number == True && myRodsArgs->numberValue > 1 ) {
+        ChksumPool = new chksumPool( myRodsEnv, myRodsArgs->numberValue );
+        if ( ChksumPool->size() < 2 ) {
+            rodsLog( LOG_NOTICE, "chksumUtil: could only open %d connections, checksumming serially",
+                     ( int ) ChksumPool->size() );
+            delete ChksumPool;
+            ChksumPool = NULL;
+        }
+    }
+
     for ( int i = 0; i < rodsPathInp->numSrc; i++ ) {
         if ( rodsPathInp->srcPath[i].objType == UNKNOWN_OBJ_T ) {
             getRodsObjType( conn, &rodsPathInp->srcPath[i] );
@@ -65,6 +234,11 @@ chksumUtil( rcComm_t *conn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
 
     printf( "Total checksum performed = %d, Failed checksum = %d\n",
             ChksumCnt, FailedChksumCnt );
+    if ( ChksumPool != NULL ) {
+        ChksumPool->report();
+        delete ChksumPool;
+        ChksumPool = NULL;
+    }
 
     return savedStatus;
 }
@@ -141,7 +315,7 @@ initCondForChksum( rodsArguments_t *rodsArgs,
 
     if ( rodsArgs->all == True && rodsArgs->replNum == True ) {
         rodsLog( LOG_ERROR,
-                 "initCondForChksum: the 'N' and 'a' option cannot be used together" );
+                 "initCondForChksum: the 'n' and 'a' option cannot be used together" );
         return USER_OPTION_INPUT_ERR;
     }
 
@@ -220,6 +394,16 @@ chksumCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
         if ( collEnt.objType == DATA_OBJ_T ) {
             snprintf( srcChildPath, MAX_NAME_LEN, "%s/%s",
                       collEnt.collName, collEnt.dataName );
+            if ( ChksumPool != NULL ) {
+                if ( ChksumPool->add( srcChildPath, collEnt.dataSize ) ) {
+                    status = ChksumPool->flush( rodsArgs, dataObjInp );
+                    if ( status < 0 ) {
+                        savedStatus = status;
+                    }
+                }
+                status = 0;
+                continue;
+            }
             /* screen unnecessary call to chksumDataObjUtil if user input a
              * resource. */
             status = chksumDataObjUtil( conn, srcChildPath,
@@ -234,6 +418,10 @@ chksumCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
             }
         }
         else if ( collEnt.objType == COLL_OBJ_T ) {
+            /* report the objects of this collection before the subcollection */
+            if ( ChksumPool != NULL && ( status = ChksumPool->flush( rodsArgs, dataObjInp ) ) < 0 ) {
+                savedStatus = status;
+            }
             dataObjInp_t childDataObjInp;
             childDataObjInp = *dataObjInp;
             if ( collEnt.specColl.collClass != NO_SPEC_COLL ) {
@@ -249,6 +437,12 @@ chksumCollUtil( rcComm_t *conn, char *srcColl, rodsEnv *myRodsEnv,
             }
         }
     }
+    if ( ChksumPool != NULL ) {
+        int flushStatus = ChksumPool->flush( rodsArgs, dataObjInp );
+        if ( flushStatus < 0 ) {
+            savedStatus = flushStatus;
+        }
+    }
     rclCloseCollection( &collHandle );
     if ( savedStatus < 0 ) {
         return savedStatus;
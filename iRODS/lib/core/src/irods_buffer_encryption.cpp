@@ -1,6 +1,7 @@
 // =-=-=-=-=-=-=-
 #include "irods_buffer_encryption.hpp"
 #include "irods_log.hpp"
+#include "rodsErrorTable.h"
 
 // =-=-=-=-=-=-=-
 // ssl includes
@@ -53,7 +54,9 @@ namespace irods {
         key_size_( 32 ),
         salt_size_( 8 ),
         num_hash_rounds_( 16 ),
-        algorithm_( "AES-256-CBC" ) {
+        algorithm_( "AES-256-CBC" ),
+        context_( 0 ),
+        cipher_( 0 ) {
 
         std::transform(
             algorithm_.begin(),
@@ -71,7 +74,9 @@ namespace irods {
         key_size_( _key_sz ),
         salt_size_( _salt_sz ),
         num_hash_rounds_( _num_rnds ),
-        algorithm_( _algo ) {
+        algorithm_( _algo ),
+        context_( 0 ),
+        cipher_( 0 ) {
 
         std::transform(
             algorithm_.begin(),
@@ -100,11 +105,136 @@ namespace irods {
 
     } // ctor
 
+// =-=-=-=-=-=-=-
+// public - copy constructor, the cipher context is not shared
+    buffer_crypt::buffer_crypt(
+        const buffer_crypt& _rhs ) :
+        key_size_( _rhs.key_size_ ),
+        salt_size_( _rhs.salt_size_ ),
+        num_hash_rounds_( _rhs.num_hash_rounds_ ),
+        algorithm_( _rhs.algorithm_ ),
+        context_( 0 ),
+        cipher_( 0 ) {
+    } // cctor
+
+    buffer_crypt& buffer_crypt::operator=(
+        const buffer_crypt& _rhs ) {
+        if ( this != &_rhs ) {
+            if ( context_ ) {
+                EVP_CIPHER_CTX_free( context_ );
+            }
+            key_size_        = _rhs.key_size_;
+            salt_size_       = _rhs.salt_size_;
+            num_hash_rounds_ = _rhs.num_hash_rounds_;
+            algorithm_       = _rhs.algorithm_;
+            context_         = 0;
+            cipher_          = 0;
+        }
+
+        return *this;
+
+    } // operator=
+
 // =-=-=-=-=-=-=-
 // public - destructor
     buffer_crypt::~buffer_crypt() {
+        if ( context_ ) {
+            EVP_CIPHER_CTX_free( context_ );
+        }
     } // dtor
 
+// =-=-=-=-=-=-=-
+// private - resolve the cipher once, so the iv size, the tag and the
+// context all follow the cipher actually used
+    const EVP_CIPHER* buffer_crypt::cipher() {
+        if ( !cipher_ ) {
+            cipher_ = EVP_get_cipherbyname( algorithm_.c_str() );
+            if ( !cipher_ ) {
+                rodsLog(
+                    LOG_NOTICE,
+                    "buffer_crypt::cipher - algorithm not supported [%s]",
+                    algorithm_.c_str() );
+                // default to aes 256 cbc
+                cipher_ = EVP_aes_256_cbc();
+            }
+        }
+
+        return cipher_;
+
+    } // buffer_crypt::cipher
+
+// =-=-=-=-=-=-=-
+// public - aead modes carry an authentication tag instead of padding
+    bool buffer_crypt::is_aead() {
+        return EVP_CIPH_GCM_MODE == EVP_CIPHER_mode( cipher() );
+    }
+
+// =-=-=-=-=-=-=-
+// public - legacy modes use an iv as long as the key
+    int buffer_crypt::iv_size() {
+        return is_aead() ? AEAD_IV_SIZE : key_size_;
+    }
+
+// =-=-=-=-=-=-=-
+// private - set up the context for the next buffer
+    irods::error buffer_crypt::init_context(
+        const array_t& _key,
+        const array_t& _iv,
+        int            _enc ) {
+        if ( _iv.empty() && is_aead() ) {
+            return ERROR(
+                       SYS_INVALID_INPUT_PARAM,
+                       "an initialization vector is required for " + algorithm_ );
+        }
+
+        const EVP_CIPHER* algo = 0;
+        if ( !context_ ) {
+            context_ = EVP_CIPHER_CTX_new();
+            if ( !context_ ) {
+                return ERROR( ERR_get_error(), "EVP_CIPHER_CTX_new failed" );
+            }
+
+            // =-=-=-=-=-=-=-
+            // only the first init pays for the cipher setup, later
+            // buffers just load a new key and iv
+            algo = cipher();
+        }
+
+        int ret = EVP_CipherInit_ex(
+                      context_,
+                      algo,
+                      NULL,
+                      NULL,
+                      NULL,
+                      _enc );
+        if ( 0 != ret && is_aead() ) {
+            ret = EVP_CIPHER_CTX_ctrl(
+                      context_,
+                      EVP_CTRL_GCM_SET_IVLEN,
+                      _iv.size(),
+                      NULL );
+        }
+        if ( 0 != ret ) {
+            ret = EVP_CipherInit_ex(
+                      context_,
+                      NULL,
+                      NULL,
+                      &_key[0],
+                      &_iv[0],
+                      _enc );
+        }
+        if ( 0 == ret ) {
+            char err[ 256 ];
+            ERR_error_string_n( ERR_get_error(), err, 256 );
+            std::string msg( "failed in EVP_CipherInit_ex - " );
+            msg += err;
+            return ERROR( ERR_get_error(), msg );
+        }
+
+        return SUCCESS();
+
+    } // buffer_crypt::init_context
+
 // =-=-=-=-=-=-=-
 // public static - generate a random key
     irods::error buffer_crypt::generate_key(
@@ -147,10 +277,10 @@ namespace irods {
         array_t& _out_iv ) {
         // =-=-=-=-=-=-=-
         // generate a random initialization vector
-        unsigned char* iv = new unsigned char[ key_size_ ];
+        _out_iv.resize( iv_size() );
         int rnd_err = RAND_bytes(
-                          iv,
-                          key_size_ );
+                          &_out_iv[0],
+                          _out_iv.size() );
         if ( 1 != rnd_err ) {
             char err[ 256 ];
             ERR_error_string_n( ERR_get_error(), err, 256 );
@@ -160,16 +290,6 @@ namespace irods {
 
         }
 
-        // =-=-=-=-=-=-=-
-        // copy the iv to the out variable
-        _out_iv.assign(
-            &iv[0],
-            &iv[ key_size_ ] );
-
-        // =-=-=-=-=-=-=-
-        // clean up
-        delete [] iv;
-
         return SUCCESS();
 
     } // buffer_crypt::initialization_vector
@@ -181,49 +301,57 @@ namespace irods {
         const array_t& _iv,
         const array_t& _in_buf,
         array_t&       _out_buf ) {
+        return encrypt( _key, _iv, array_t(), _in_buf, _out_buf );
 
-        // =-=-=-=-=-=-=-
-        // create an encryption context
-        EVP_CIPHER_CTX context;
-        EVP_CIPHER_CTX_init( &context );
-
-        const EVP_CIPHER* algo = EVP_get_cipherbyname( algorithm_.c_str() );
-        if ( !algo ) {
-            rodsLog(
-                LOG_NOTICE,
-                "buffer_crypt::encrypt - algorithm not supported [%s]",
-                algorithm_.c_str() );
-            // default to aes 256 cbc
-            algo = EVP_aes_256_cbc();
-        }
+    } // encrypt
 
-        int ret = EVP_EncryptInit_ex(
-                      &context,
-                      algo,
-                      NULL,
-                      &_key[0],
-                      &_iv[0] );
-        if ( 0 == ret ) {
-            char err[ 256 ];
-            ERR_error_string_n( ERR_get_error(), err, 256 );
-            std::string msg( "failed in EVP_EncryptInit_ex - " );
-            msg += err;
-            return ERROR( ERR_get_error(), msg );
+// =-=-=-=-=-=-=-
+// public - encryptor with additional authenticated data
+    irods::error buffer_crypt::encrypt(
+        const array_t& _key,
+        const array_t& _iv,
+        const array_t& _aad,
+        const array_t& _in_buf,
+        array_t&       _out_buf ) {
+
+        // =-=-=-=-=-=-=-
+        // reset the encryption context with this key and iv
+        irods::error err = init_context( _key, _iv, 1 );
+        if ( !err.ok() ) {
+            return PASS( err );
         }
 
+        // =-=-=-=-=-=-=-
+        // max ciphertext len for a n bytes of plaintext is n + AES_BLOCK_SIZE -1 bytes,
+        // aead modes do not pad but append a tag.  encrypt directly into the
+        // out variable rather than through a temporary
+        bool aead = is_aead();
+        _out_buf.resize( _in_buf.size() + AES_BLOCK_SIZE + AEAD_TAG_SIZE );
+        int cipher_len = 0;
 
         // =-=-=-=-=-=-=-
-        // max ciphertext len for a n bytes of plaintext is n + AES_BLOCK_SIZE -1 bytes
-        int            cipher_len  = _in_buf.size() + AES_BLOCK_SIZE;
-        unsigned char* cipher_text = new unsigned char[ cipher_len ] ;
+        // feed the additional data to the tag before the plain text
+        if ( aead && !_aad.empty() ) {
+            int aad_len = 0;
+            int ret = EVP_CipherUpdate(
+                          context_,
+                          NULL,
+                          &aad_len,
+                          &_aad[0],
+                          _aad.size() );
+            if ( 0 == ret ) {
+                return ERROR( ERR_get_error(), "failed to add the GCM additional data" );
+            }
+        }
+
         // =-=-=-=-=-=-=-
         // update ciphertext, cipher_len is filled with the length of ciphertext generated,
-        ret = EVP_EncryptUpdate(
-                  &context,
-                  cipher_text,
-                  &cipher_len,
-                  &_in_buf[0],
-                  _in_buf.size() );
+        int ret = EVP_EncryptUpdate(
+                      context_,
+                      &_out_buf[0],
+                      &cipher_len,
+                      _in_buf.empty() ? NULL : &_in_buf[0],
+                      _in_buf.size() );
         if ( 0 == ret ) {
             char err[ 256 ];
             ERR_error_string_n( ERR_get_error(), err, 256 );
@@ -236,8 +364,8 @@ namespace irods {
         // update ciphertext with the final remaining bytes
         int final_len = 0;
         ret = EVP_EncryptFinal_ex(
-                  &context,
-                  cipher_text + cipher_len,
+                  context_,
+                  &_out_buf[ cipher_len ],
                   &final_len );
         if ( 0 == ret ) {
             char err[ 256 ];
@@ -246,23 +374,24 @@ namespace irods {
             msg += err;
             return ERROR( ERR_get_error(), msg );
         }
+        cipher_len += final_len;
 
         // =-=-=-=-=-=-=-
-        // clean up and assign out variables before exit
-        _out_buf.resize( cipher_len + final_len );
-
-        // =-=-=-=-=-=-=-
-        // copy the iv to the out variable
-        _out_buf.assign(
-            &cipher_text[0],
-            &cipher_text[ cipher_len + final_len ] );
-
-        delete [] cipher_text;
-
-        if ( 0 == EVP_CIPHER_CTX_cleanup( &context ) ) {
-            return ERROR( ERR_get_error(), "EVP_CIPHER_CTX_cleanup failed" );
+        // append the authentication tag for aead modes
+        if ( aead ) {
+            ret = EVP_CIPHER_CTX_ctrl(
+                      context_,
+                      EVP_CTRL_GCM_GET_TAG,
+                      AEAD_TAG_SIZE,
+                      &_out_buf[ cipher_len ] );
+            if ( 0 == ret ) {
+                return ERROR( ERR_get_error(), "failed to get the GCM tag" );
+            }
+            cipher_len += AEAD_TAG_SIZE;
         }
 
+        _out_buf.resize( cipher_len );
+
         return SUCCESS();
 
     } // encrypt
@@ -274,49 +403,73 @@ namespace irods {
         const array_t& _iv,
         const array_t& _in_buf,
         array_t&       _out_buf ) {
+        return decrypt( _key, _iv, array_t(), _in_buf, _out_buf );
+
+    } // decrypt
+
+// =-=-=-=-=-=-=-
+// public - decryptor with additional authenticated data
+    irods::error buffer_crypt::decrypt(
+        const array_t& _key,
+        const array_t& _iv,
+        const array_t& _aad,
+        const array_t& _in_buf,
+        array_t&       _out_buf ) {
         // =-=-=-=-=-=-=-
-        // create an decryption context
-        EVP_CIPHER_CTX context;
-        EVP_CIPHER_CTX_init( &context );
-
-        const EVP_CIPHER* algo = EVP_get_cipherbyname( algorithm_.c_str() );
-        if ( !algo ) {
-            rodsLog(
-                LOG_NOTICE,
-                "buffer_crypt::decrypt - algorithm not supported [%s]",
-                algorithm_.c_str() );
-            // default to aes 256 cbc
-            algo = EVP_aes_256_cbc();
+        // reset the decryption context with this key and iv
+        irods::error err = init_context( _key, _iv, 0 );
+        if ( !err.ok() ) {
+            return PASS( err );
         }
 
-        int ret = EVP_DecryptInit_ex(
-                      &context,
-                      algo,
-                      NULL,
-                      &_key[0],
-                      &_iv [0] );
-        if ( 0 == ret ) {
-            char err[ 256 ];
-            ERR_error_string_n( ERR_get_error(), err, 256 );
-            std::string msg( "failed in EVP_DecryptInit_ex - " );
-            msg += err;
-            return ERROR( ERR_get_error(), msg );
+        // =-=-=-=-=-=-=-
+        // aead modes carry the tag at the end of the cipher text
+        bool   aead       = is_aead();
+        size_t cipher_len = _in_buf.size();
+        if ( aead ) {
+            if ( cipher_len < static_cast< size_t >( AEAD_TAG_SIZE ) ) {
+                return ERROR(
+                           SYS_INVALID_INPUT_PARAM,
+                           "cipher text is shorter than the GCM tag" );
+            }
+            cipher_len -= AEAD_TAG_SIZE;
+            int ret = EVP_CIPHER_CTX_ctrl(
+                          context_,
+                          EVP_CTRL_GCM_SET_TAG,
+                          AEAD_TAG_SIZE,
+                          const_cast< unsigned char* >( &_in_buf[ cipher_len ] ) );
+            if ( 0 == ret ) {
+                return ERROR( ERR_get_error(), "failed to set the GCM tag" );
+            }
+
+            if ( !_aad.empty() ) {
+                int aad_len = 0;
+                ret = EVP_CipherUpdate(
+                          context_,
+                          NULL,
+                          &aad_len,
+                          &_aad[0],
+                          _aad.size() );
+                if ( 0 == ret ) {
+                    return ERROR( ERR_get_error(), "failed to add the GCM additional data" );
+                }
+            }
         }
 
         // =-=-=-=-=-=-=-
-        // allocate a plain text buffer
+        // size the plain text buffer
         // because we have padding ON, we must allocate an extra cipher block size of memory
-        int            plain_len  = 0;
-        unsigned char* plain_text = new unsigned char[ _in_buf.size() + AES_BLOCK_SIZE ];
+        _out_buf.resize( cipher_len + AES_BLOCK_SIZE );
+        int plain_len = 0;
 
         // =-=-=-=-=-=-=-
         // update the plain text, plain_len is filled with the length of the plain text
-        ret = EVP_DecryptUpdate(
-                  &context,
-                  plain_text,
-                  &plain_len,
-                  &_in_buf[0],
-                  _in_buf.size() );
+        int ret = EVP_DecryptUpdate(
+                      context_,
+                      &_out_buf[0],
+                      &plain_len,
+                      cipher_len ? &_in_buf[0] : NULL,
+                      cipher_len );
         if ( 0 == ret ) {
             char err[ 256 ];
             ERR_error_string_n( ERR_get_error(), err, 256 );
@@ -326,36 +479,25 @@ namespace irods {
         }
 
         // =-=-=-=-=-=-=-
-        // finalize the plain text, final_len is filled with the resulting length of the plain text
+        // finalize the plain text, final_len is filled with the resulting length of the plain text.
+        // for aead modes this is where the tag is verified
         int final_len = 0;
         ret = EVP_DecryptFinal_ex(
-                  &context,
-                  plain_text + plain_len,
+                  context_,
+                  &_out_buf[ plain_len ],
                   &final_len );
         if ( 0 == ret ) {
             char err[ 256 ];
             ERR_error_string_n( ERR_get_error(), err, 256 );
-            std::string msg( "failed in EVP_DecryptFinal_ex - " );
+            std::string msg( aead ?
+                             "GCM tag verification failed - " :
+                             "failed in EVP_DecryptFinal_ex - " );
             msg += err;
             return ERROR( ERR_get_error(), msg );
         }
 
-        // =-=-=-=-=-=-=-
-        // assign the plain text to the outvariable and clean up
         _out_buf.resize( plain_len + final_len );
 
-        // =-=-=-=-=-=-=-
-        // copy the iv to the out variable
-        _out_buf.assign(
-            &plain_text[0],
-            &plain_text[ plain_len + final_len ] );
-
-        delete [] plain_text;
-
-        if ( 0 == EVP_CIPHER_CTX_cleanup( &context ) ) {
-            return ERROR( ERR_get_error(), "EVP_CIPHER_CTX_cleanup failed" );
-        }
-
         return SUCCESS();
 
     } // decrypt
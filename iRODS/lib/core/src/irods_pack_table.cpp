@@ -1,6 +1,11 @@
 #include "irods_pack_table.hpp"
 #include "apiPackTable.h"
 
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
 namespace irods {
 
     pack_entry_table& get_pack_table() {
@@ -10,6 +15,118 @@ namespace irods {
 
     } // get_pack_table
 
+// =-=-=-=-=-=-=-
+// a parsed pack instruction. the items are kept in order with their
+// links cleared, the names are owned by the plan
+    class pack_plan {
+        public:
+            explicit pack_plan( const char* _pi ) : instruct_( _pi ) {};
+            ~pack_plan() {
+                for ( size_t i = 0; i < items_.size(); ++i ) {
+                    free( items_[ i ].name );
+                }
+            }
+
+            int compile() {
+                packItem_t* head = NULL;
+                int status = parsePackInstruct( instruct_.c_str(), &head );
+                if ( status < 0 ) {
+                    freePackedItem( head );
+                    return status;
+                }
+
+                for ( packItem_t* item = head; item != NULL; item = item->next ) {
+                    items_.push_back( *item );
+                    items_.back().parent = items_.back().prev = items_.back().next = NULL;
+                    // =-=-=-=-=-=-=-
+                    // take over the name so freePackedItem leaves it alone
+                    item->name = NULL;
+                }
+                freePackedItem( head );
+                return 0;
+            }
+
+            int instantiate( packItem_t** _head ) const {
+                packItem_t* prev = NULL;
+                for ( size_t i = 0; i < items_.size(); ++i ) {
+                    packItem_t* item = ( packItem_t* )malloc( sizeof( packItem_t ) );
+                    *item = items_[ i ];
+                    if ( items_[ i ].name != NULL ) {
+                        item->name = strdup( items_[ i ].name );
+                    }
+                    item->prev = prev;
+                    if ( prev != NULL ) {
+                        prev->next = item;
+                    }
+                    else {
+                        *_head = item;
+                    }
+                    prev = item;
+                }
+                return 0;
+            }
+
+            bool matches( const char* _pi ) const {
+                return instruct_ == _pi;
+            }
+
+        private:
+            std::string               instruct_;
+            std::vector< packItem_t > items_;
+
+    }; // class pack_plan
+
+// =-=-=-=-=-=-=-
+// the instructions come from the static pack tables or the api pack
+// table, so the plans are keyed by the instruction address. the text is
+// compared on every hit in case a caller hands in a reused buffer
+    static boost::mutex                           pack_plan_mutex;
+    static std::map< const char*, pack_plan* >    pack_plans;
+    static bool                                   pack_plan_enabled = true;
+
+    void set_pack_instruct_cache(
+        bool _enabled ) {
+        boost::unique_lock< boost::mutex > lock( pack_plan_mutex );
+        pack_plan_enabled = _enabled;
+
+    } // set_pack_instruct_cache
+
+    int parse_pack_instruct(
+        const char*  _pack_instruct,
+        packItem_t** _pack_item_head ) {
+        if ( _pack_instruct == NULL || _pack_item_head == NULL ) {
+            return SYS_INTERNAL_NULL_INPUT_ERR;
+        }
+
+        boost::unique_lock< boost::mutex > lock( pack_plan_mutex );
+        if ( !pack_plan_enabled ) {
+            lock.unlock();
+            return parsePackInstruct( _pack_instruct, _pack_item_head );
+        }
+
+        std::map< const char*, pack_plan* >::iterator itr = pack_plans.find( _pack_instruct );
+        if ( itr == pack_plans.end() || !itr->second->matches( _pack_instruct ) ) {
+            pack_plan* plan = new pack_plan( _pack_instruct );
+            int status = plan->compile();
+            if ( status < 0 ) {
+                delete plan;
+                return status;
+            }
+
+            if ( itr != pack_plans.end() ) {
+                delete itr->second;
+                itr->second = plan;
+            }
+            else {
+                pack_plans[ _pack_instruct ] = plan;
+            }
+            return plan->instantiate( _pack_item_head );
+        }
+
+        return itr->second->instantiate( _pack_item_head );
+
+    } // parse_pack_instruct
+
 };
 
 
@@ -0,0 +1,260 @@
+// =-=-=-=-=-=-=-
+// irods includes
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "sockComm.h"
+#include "irods_log.hpp"
+#include "irods_transfer_pipeline.hpp"
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace irods {
+
+    transfer_pipeline::frame_queue::frame_queue() :
+        closed_( false ) {
+    }
+
+    void transfer_pipeline::frame_queue::push( frame* _frame ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        frames_.push_back( _frame );
+        cond_.notify_one();
+    }
+
+    transfer_pipeline::frame* transfer_pipeline::frame_queue::pop() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        while ( frames_.empty() && !closed_ ) {
+            cond_.wait( lock );
+        }
+
+        if ( frames_.empty() ) {
+            return 0;
+        }
+
+        frame* f = frames_.front();
+        frames_.pop_front();
+        return f;
+    }
+
+    void transfer_pipeline::frame_queue::close() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        closed_ = true;
+        cond_.notify_all();
+    }
+
+    void transfer_pipeline::frame_queue::abort() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        closed_ = true;
+        frames_.clear();
+        cond_.notify_all();
+    }
+
+    transfer_pipeline::transfer_pipeline() :
+        status_( 0 ) {
+    }
+
+    void transfer_pipeline::add_stage( stage_t _stage ) {
+        stages_.push_back( _stage );
+    }
+
+    void transfer_pipeline::abort( int _status ) {
+        {
+            boost::mutex::scoped_lock lock( status_mutex_ );
+            if ( 0 == status_ ) {
+                status_ = _status;
+            }
+        }
+
+        for ( size_t i = 0; i < queues_.size(); ++i ) {
+            queues_[ i ]->abort();
+        }
+
+    } // abort
+
+    void transfer_pipeline::run_stage( size_t _idx ) {
+        frame_queue* in  = queues_[ _idx ];
+        frame_queue* out = queues_[ ( _idx + 1 ) % queues_.size() ];
+
+        while ( frame* f = in->pop() ) {
+            int status = stages_[ _idx ]( *f );
+            if ( status < 0 ) {
+                abort( status );
+                break;
+            }
+            else if ( 0 == status && 0 == _idx ) {
+                // =-=-=-=-=-=-=-
+                // out of data, the rest of the stages drain what
+                // is in flight and then stop
+                break;
+            }
+
+            out->push( f );
+
+        } // while
+
+        // =-=-=-=-=-=-=-
+        // the last stage feeds the first, which has already stopped
+        if ( _idx + 1 < queues_.size() ) {
+            out->close();
+        }
+
+    } // run_stage
+
+    int transfer_pipeline::run() {
+        if ( stages_.empty() ) {
+            return 0;
+        }
+
+        status_ = 0;
+
+        // =-=-=-=-=-=-=-
+        // one frame per stage keeps every stage busy once the
+        // pipeline fills.  queue zero is the free list feeding
+        // the first stage
+        frames_.resize( stages_.size() );
+        queues_.clear();
+        for ( size_t i = 0; i < stages_.size(); ++i ) {
+            queues_.push_back( new frame_queue );
+        }
+        for ( size_t i = 0; i < frames_.size(); ++i ) {
+            frames_[ i ].length = 0;
+            frames_[ i ].offset = 0;
+            queues_[ 0 ]->push( &frames_[ i ] );
+        }
+
+        boost::thread_group threads;
+        try {
+            for ( size_t i = 0; i + 1 < stages_.size(); ++i ) {
+                threads.create_thread(
+                    boost::bind( &transfer_pipeline::run_stage, this, i ) );
+            }
+        }
+        catch ( const boost::thread_resource_error& ) {
+            rodsLog( LOG_ERROR, "transfer_pipeline::run - failed to create a stage thread" );
+            abort( SYS_THREAD_RESOURCE_ERR );
+        }
+
+        if ( 0 == status_ ) {
+            run_stage( stages_.size() - 1 );
+        }
+        threads.join_all();
+
+        for ( size_t i = 0; i < queues_.size(); ++i ) {
+            delete queues_[ i ];
+        }
+        queues_.clear();
+
+        return status_;
+
+    } // run
+
+    void frame_aad(
+        rodsLong_t             _offset,
+        buffer_crypt::array_t& _aad ) {
+        // =-=-=-=-=-=-=-
+        // big endian, so both ends agree whatever their byte order
+        _aad.resize( sizeof( rodsLong_t ) );
+        for ( size_t i = 0; i < _aad.size(); ++i ) {
+            _aad[ _aad.size() - 1 - i ] =
+                static_cast< unsigned char >( ( _offset >> ( 8 * i ) ) & 0xff );
+        }
+
+    } // frame_aad
+
+    int encrypt_frame(
+        buffer_crypt&                   _crypt,
+        const buffer_crypt::array_t&    _key,
+        transfer_pipeline::frame&       _frame ) {
+        buffer_crypt::array_t aad;
+        frame_aad( _frame.offset, aad );
+        error ret = _crypt.initialization_vector( _frame.iv );
+        if ( ret.ok() ) {
+            ret = _crypt.encrypt(
+                      _key,
+                      _frame.iv,
+                      aad,
+                      _frame.plain,
+                      _frame.cipher );
+        }
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return SYS_COPY_LEN_ERR;
+        }
+
+        return 0;
+
+    } // encrypt_frame
+
+    int write_encrypted_frame(
+        int                       _sock,
+        transfer_pipeline::frame& _frame ) {
+        // =-=-=-=-=-=-=-
+        // the size goes first as encryption may change the size
+        // of the data from the plain text length
+        int frame_size = _frame.iv.size() + _frame.cipher.size();
+        if ( myWrite( _sock, &frame_size, sizeof( frame_size ), NULL ) !=
+                sizeof( frame_size ) ||
+                myWrite( _sock, &_frame.iv[0], _frame.iv.size(), NULL ) !=
+                static_cast< int >( _frame.iv.size() ) ||
+                myWrite( _sock, &_frame.cipher[0], _frame.cipher.size(), NULL ) !=
+                static_cast< int >( _frame.cipher.size() ) ) {
+            return SYS_COPY_LEN_ERR - errno;
+        }
+
+        return 0;
+
+    } // write_encrypted_frame
+
+    int read_encrypted_frame(
+        int                             _sock,
+        int                             _max_size,
+        buffer_crypt&                   _crypt,
+        const buffer_crypt::array_t&    _key,
+        rodsLong_t                      _offset,
+        transfer_pipeline::frame&       _frame ) {
+        int frame_size = 0;
+        if ( myRead( _sock, &frame_size, sizeof( frame_size ), NULL, NULL ) !=
+                sizeof( frame_size ) ) {
+            return SYS_COPY_LEN_ERR - errno;
+        }
+
+        int iv_size = _crypt.iv_size();
+        if ( frame_size <= iv_size || frame_size > _max_size ) {
+            rodsLog(
+                LOG_ERROR,
+                "read_encrypted_frame - invalid frame size %d",
+                frame_size );
+            return SYS_COPY_LEN_ERR;
+        }
+
+        _frame.iv.resize( iv_size );
+        _frame.cipher.resize( frame_size - iv_size );
+        if ( myRead( _sock, &_frame.iv[0], iv_size, NULL, NULL ) != iv_size ||
+                myRead( _sock, &_frame.cipher[0], _frame.cipher.size(), NULL, NULL ) !=
+                static_cast< int >( _frame.cipher.size() ) ) {
+            return SYS_COPY_LEN_ERR - errno;
+        }
+
+        buffer_crypt::array_t aad;
+        frame_aad( _offset, aad );
+        error ret = _crypt.decrypt(
+                        _key,
+                        _frame.iv,
+                        aad,
+                        _frame.cipher,
+                        _frame.plain );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return SYS_COPY_LEN_ERR;
+        }
+
+        _frame.length = _frame.plain.size();
+        _frame.offset = _offset;
+
+        return 0;
+
+    } // read_encrypted_frame
+
+}; // namespace irods
@@ -12,9 +12,32 @@
 #include "rcMisc.h"
 
 #include "irods_pack_table.hpp"
+#include <boost/thread/once.hpp>
 #include <iostream>
+#include <map>
 #include <string>
 
+// =-=-=-=-=-=-=-
+// index of RodsPackTable by name, built once. the table is const so the
+// index never goes stale
+struct PackNameLess {
+    bool operator()( const char *a, const char *b ) const {
+        return strcmp( a, b ) < 0;
+    }
+};
+typedef std::map<const char *, const char *, PackNameLess> packInstructIndex_t;
+static packInstructIndex_t RodsPackIndex;
+static boost::once_flag RodsPackIndexOnce = BOOST_ONCE_INIT;
+
+static void
+initRodsPackIndex() {
+    for ( int i = 0; strcmp( RodsPackTable[i].name, PACK_TABLE_END_PI ) != 0; i++ ) {
+        /* keep the first entry of a name, as the linear search did */
+        RodsPackIndex.insert( std::make_pair( RodsPackTable[i].name,
+                                              RodsPackTable[i].packInstruct ) );
+    }
+}
+
 int
 packStruct( void *inStruct, bytesBuf_t **packedResult, const char *packInstName,
             const packInstructArray_t *myPackTable, int packFlag, irodsProt_t irodsProt ) {
@@ -735,13 +758,10 @@ matchPackInstruct( char *name, const packInstructArray_t *myPackTable ) {
 
     /* Try the Rods Global table */
 
-    i = 0;
-    while ( strcmp( RodsPackTable[i].name, PACK_TABLE_END_PI ) != 0 ) {
-        /* not the end */
-        if ( strcmp( RodsPackTable[i].name, name ) == 0 ) {
-            return RodsPackTable[i].packInstruct;
-        }
-        i++;
+    boost::call_once( initRodsPackIndex, RodsPackIndexOnce );
+    packInstructIndex_t::const_iterator rodsItr = RodsPackIndex.find( name );
+    if ( rodsItr != RodsPackIndex.end() ) {
+        return rodsItr->second;
     }
 
     /* Try the API table */
@@ -1809,7 +1829,7 @@ packChildStruct( void **inPtr, packedOutput_t *packedOutput,
     for ( i = 0; i < numElement; i++ ) {
         packItemHead = NULL;
 
-        status = parsePackInstruct( ( const char* )packInstruct, &packItemHead );
+        status = irods::parse_pack_instruct( ( const char* )packInstruct, &packItemHead );
         if ( status < 0 ) {
             freePackedItem( packItemHead );
             return status;
@@ -2716,7 +2736,7 @@ unpackChildStruct( void **inPtr, packedOutput_t *unpackedOutput,
     for ( i = 0; i < numElement; i++ ) {
         unpackItemHead = NULL;
 
-        status = parsePackInstruct( static_cast<const char*>( packInstruct ), &unpackItemHead );
+        status = irods::parse_pack_instruct( static_cast<const char*>( packInstruct ), &unpackItemHead );
         if ( status < 0 ) {
             freePackedItem( unpackItemHead );
             return status;
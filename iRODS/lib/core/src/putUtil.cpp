@@ -19,6 +19,127 @@
 #include "sockComm.h"
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include <boost/thread.hpp>
+
+static void
+reportBulkPut( rcComm_t *conn, int count, rodsLong_t size, char *cachedTargPath,
+               struct timeval *startTime, struct timeval *endTime,
+               rodsArguments_t *rodsArgs ) {
+    if ( rodsArgs->verbose == True ) {
+        printf( "Bulk upload %d files.\n", count );
+        printTiming( conn, cachedTargPath, size, cachedTargPath,
+                     startTime, endTime );
+    }
+    if ( gGuiProgressCB != NULL ) {
+        rstrcpy( conn->operProgress.curFileName, cachedTargPath, MAX_NAME_LEN );
+        conn->operProgress.totalNumFilesDone += count;
+        conn->operProgress.totalFileSizeDone += size;
+        gGuiProgressCB( &conn->operProgress );
+    }
+}
+
+/* Sends a full bundle from a thread of its own so the next bundle can be
+ * read from disk while the server untars and registers this one.  The
+ * connection belongs to the sending thread until wait() returns. */
+class bulkPutSender {
+    public:
+        bulkPutSender( rodsArguments_t *rodsArgs ) :
+            rodsArgs_( rodsArgs ),
+            conn_( NULL ),
+            thread_( NULL ),
+            status_( 0 ),
+            count_( 0 ),
+            size_( 0 ) {
+            bzero( &inp_, sizeof( inp_ ) );
+            initAttriArrayOfBulkOprInp( &inp_ );
+            bytesBuf_.len = 0;
+            bytesBuf_.buf = malloc( BULK_OPR_BUF_SIZE );
+            cachedTargPath_[0] = '\0';
+        }
+
+        ~bulkPutSender() {
+            wait();
+            clearBulkOprInp( &inp_ );
+            free( bytesBuf_.buf );
+        }
+
+        /* hand the filled bundle over and give the filler the buffers of
+         * the previous one, returns the status of the previous one */
+        int send( rcComm_t *conn, bulkOprInp_t *bulkOprInp,
+                  bulkOprInfo_t *bulkOprInfo ) {
+            int status = wait();
+            if ( bytesBuf_.buf == NULL ) {
+                return SYS_MALLOC_ERR;
+            }
+
+            conn_ = conn;
+            std::swap( inp_.attriArray, bulkOprInp->attriArray );
+            rstrcpy( inp_.objPath, bulkOprInp->objPath, MAX_NAME_LEN );
+            clearKeyVal( &inp_.condInput );
+            copyKeyVal( &bulkOprInp->condInput, &inp_.condInput );
+            std::swap( bytesBuf_.buf, bulkOprInfo->bytesBuf.buf );
+            bytesBuf_.len = bulkOprInfo->bytesBuf.len;
+            count_ = bulkOprInfo->count;
+            size_ = bulkOprInfo->size;
+            rstrcpy( cachedTargPath_, bulkOprInfo->cachedTargPath, MAX_NAME_LEN );
+
+            try {
+                thread_ = new boost::thread( boost::bind( &bulkPutSender::run, this ) );
+            }
+            catch ( const boost::thread_resource_error& ) {
+                /* no thread to spare, send it from this one */
+                thread_ = NULL;
+                run();
+                return status < 0 ? status : report();
+            }
+            return status;
+        }
+
+        /* wait for the bundle in flight, if any, and return its status */
+        int wait() {
+            if ( thread_ == NULL ) {
+                return 0;
+            }
+            thread_->join();
+            delete thread_;
+            thread_ = NULL;
+            return report();
+        }
+
+    private:
+        void run() {
+            ( void ) gettimeofday( &startTime_, ( struct timezone * )0 );
+            status_ = rcBulkDataObjPut( conn_, &inp_, &bytesBuf_ );
+            ( void ) gettimeofday( &endTime_, ( struct timezone * )0 );
+        }
+
+        int report() {
+            int status = status_;
+            status_ = 0;
+            if ( status >= 0 ) {
+                reportBulkPut( conn_, count_, size_, cachedTargPath_,
+                               &startTime_, &endTime_, rodsArgs_ );
+            }
+            else {
+                rodsLogError( LOG_ERROR, status,
+                              "bulkPutSender: rcBulkDataObjPut error for %s",
+                              cachedTargPath_ );
+            }
+            return status;
+        }
+
+        rodsArguments_t *rodsArgs_;
+        rcComm_t        *conn_;
+        boost::thread   *thread_;
+        bulkOprInp_t     inp_;
+        bytesBuf_t       bytesBuf_;
+        int              status_;
+        int              count_;
+        rodsLong_t       size_;
+        char             cachedTargPath_[MAX_NAME_LEN];
+        struct timeval   startTime_;
+        struct timeval   endTime_;
+};
 
 int
 setSessionTicket( rcComm_t *myConn, char *ticket ) {
@@ -694,6 +815,11 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
             }
         }
         else {        /* a directory */
+            /* the connection is needed, let the bundle in flight finish */
+            status = waitBulkPut( bulkOprInfo );
+            if ( status < 0 ) {
+                savedStatus = status;
+            }
             status = mkColl( conn, targChildPath );
             if ( status < 0 ) {
                 rodsLogError( LOG_ERROR, status,
@@ -747,12 +873,22 @@ bulkPutDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
     bulkOprInfo.bytesBuf.len = 0;
     bulkOprInfo.bytesBuf.buf = malloc( BULK_OPR_BUF_SIZE );
 
+    /* send each bundle while the next one is read, unless the restart
+     * file has to record exactly which bundles made it */
+    bulkPutSender *sender = NULL;
+    if ( rodsRestart->fd <= 0 ) {
+        sender = new bulkPutSender( rodsArgs );
+        bulkOprInfo.sender = sender;
+    }
+
     status = putDirUtil( myConn, srcDir, targColl, myRodsEnv, rodsArgs,
                          dataObjOprInp, bulkOprInp, rodsRestart, &bulkOprInfo );
 
     if ( status < 0 ) {
         rodsLogError( LOG_ERROR, status,
                       "bulkPutDirUtil: Small files bulkPut error for %s", srcDir );
+        delete sender;
+        free( bulkOprInfo.bytesBuf.buf );
         return status;
     }
 
@@ -777,6 +913,14 @@ bulkPutDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
         }
 
     }
+
+    /* the last bundle may still be in flight */
+    int waitStatus = waitBulkPut( &bulkOprInfo );
+    if ( status >= 0 ) {
+        status = waitStatus;
+    }
+    delete sender;
+    free( bulkOprInfo.bytesBuf.buf );
     return status;
 }
 
@@ -901,8 +1045,15 @@ sendBulkPut( rcComm_t *conn, bulkOprInp_t *bulkOprInp,
         ( void ) gettimeofday( &startTime, ( struct timezone * )0 );
     }
 
-    /* send it */
-    if ( bulkOprInfo->bytesBuf.buf != NULL ) {
+    /* send it, the status of a pipelined send is that of the previous
+     * bundle, which is reported by the sender once it is done */
+    int pipelined = 0;
+    if ( bulkOprInfo->sender != NULL ) {
+        status = static_cast< bulkPutSender * >( bulkOprInfo->sender )->send(
+                     conn, bulkOprInp, bulkOprInfo );
+        pipelined = 1;
+    }
+    else if ( bulkOprInfo->bytesBuf.buf != NULL ) {
         status = rcBulkDataObjPut( conn, bulkOprInp, &bulkOprInfo->bytesBuf );
     }
     /* reset the row count */
@@ -911,26 +1062,26 @@ sendBulkPut( rcComm_t *conn, bulkOprInp_t *bulkOprInp,
         rmKeyVal( &bulkOprInp->condInput, FORCE_FLAG_KW );
         bulkOprInfo->forceFlagAdded = 0;
     }
-    if ( status >= 0 ) {
+    if ( status >= 0 && !pipelined ) {
         if ( rodsArgs->verbose == True ) {
-            printf( "Bulk upload %d files.\n", bulkOprInfo->count );
             ( void ) gettimeofday( &endTime, ( struct timezone * )0 );
-            printTiming( conn, bulkOprInfo->cachedTargPath,
-                         bulkOprInfo->size, bulkOprInfo->cachedTargPath,
-                         &startTime, &endTime );
-        }
-        if ( gGuiProgressCB != NULL ) {
-            rstrcpy( conn->operProgress.curFileName,
-                     bulkOprInfo->cachedTargPath, MAX_NAME_LEN );
-            conn->operProgress.totalNumFilesDone +=  bulkOprInfo->count;
-            conn->operProgress.totalFileSizeDone += bulkOprInfo->size;
-            gGuiProgressCB( &conn->operProgress );
         }
+        reportBulkPut( conn, bulkOprInfo->count, bulkOprInfo->size,
+                       bulkOprInfo->cachedTargPath, &startTime, &endTime,
+                       rodsArgs );
     }
 
     return status;
 }
 
+int
+waitBulkPut( bulkOprInfo_t *bulkOprInfo ) {
+    if ( bulkOprInfo == NULL || bulkOprInfo->sender == NULL ) {
+        return 0;
+    }
+    return static_cast< bulkPutSender * >( bulkOprInfo->sender )->wait();
+}
+
 int
 clearBulkOprInfo( bulkOprInfo_t *bulkOprInfo ) {
     if ( bulkOprInfo == NULL || bulkOprInfo->count <= 0 ) {
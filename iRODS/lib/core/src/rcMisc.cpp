@@ -677,21 +677,39 @@ getDataObjInfoCnt( dataObjInfo_t *dataObjInfoHead ) {
     return cnt;
 }
 
+/* findKeyInx - return the index of keyWord in condInput, or -1.
+ * The server looks up the condInput of every request many times, nearly
+ * always for a keyword that is not there, so the first character is
+ * compared inline and strcmp is only called when it matches.
+ */
+static int
+findKeyInx( const keyValPair_t *condInput, const char *keyWord ) {
+    char c = keyWord[0];
+
+    for ( int i = 0; i < condInput->len; i++ ) {
+        const char *kw = condInput->keyWord[i];
+        if ( kw != NULL && kw[0] == c && strcmp( kw, keyWord ) == 0 ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 char *
 getValByKey( const keyValPair_t *condInput, const char *keyWord ) {
     int i;
 
-    if ( condInput == NULL ) {
+    if ( condInput == NULL || condInput->keyWord == NULL || keyWord == NULL ) {
         return NULL;
     }
 
-    for ( i = 0; i < condInput->len; i++ ) {
-        if ( strcmp( condInput->keyWord[i], keyWord ) == 0 ) {
-            return condInput->value[i];
-        }
+    i = findKeyInx( condInput, keyWord );
+    if ( i < 0 ) {
+        return NULL;
     }
 
-    return NULL;
+    return condInput->value[i];
 }
 
 int
@@ -716,27 +734,26 @@ int
 rmKeyVal( keyValPair_t *condInput, char *keyWord ) {
     int i, j;
 
-    if ( condInput == NULL ) {
+    if ( condInput == NULL || condInput->keyWord == NULL || keyWord == NULL ) {
         return 0;
     }
 
-    for ( i = 0; i < condInput->len; i++ ) {
-        if ( condInput->keyWord[i] != NULL &&
-                strcmp( condInput->keyWord[i], keyWord ) == 0 ) {
-            free( condInput->keyWord[i] );
-            free( condInput->value[i] );
-            condInput->len--;
-            for ( j = i; j < condInput->len; j++ ) {
-                condInput->keyWord[j] = condInput->keyWord[j + 1];
-                condInput->value[j] = condInput->value[j + 1];
-            }
-            if ( condInput->len <= 0 ) {
-                free( condInput->keyWord );
-                free( condInput->value );
-                condInput->value = condInput->keyWord = NULL;
-            }
-            break;
-        }
+    i = findKeyInx( condInput, keyWord );
+    if ( i < 0 ) {
+        return 0;
+    }
+
+    free( condInput->keyWord[i] );
+    free( condInput->value[i] );
+    condInput->len--;
+    for ( j = i; j < condInput->len; j++ ) {
+        condInput->keyWord[j] = condInput->keyWord[j + 1];
+        condInput->value[j] = condInput->value[j + 1];
+    }
+    if ( condInput->len <= 0 ) {
+        free( condInput->keyWord );
+        free( condInput->value );
+        condInput->value = condInput->keyWord = NULL;
     }
     return 0;
 }
@@ -801,15 +818,17 @@ addKeyVal( keyValPair_t *condInput, const char *keyWord, const char *value ) {
     }
 
     /* check if the keyword exists */
+    char c = keyWord[0];
     for ( int i = 0; i < condInput->len; i++ ) {
-        if ( condInput->keyWord[i] == NULL || strlen( condInput->keyWord[i] ) == 0 ) {
+        const char *kw = condInput->keyWord[i];
+        if ( kw == NULL || kw[0] == '\0' ) {
             free( condInput->keyWord[i] );
             free( condInput->value[i] );
             condInput->keyWord[i] = strdup( keyWord );
             condInput->value[i] = value ? strdup( value ) : NULL;
             return 0;
         }
-        else if ( strcmp( keyWord, condInput->keyWord[i] ) == 0 ) {
+        else if ( kw[0] == c && strcmp( keyWord, kw ) == 0 ) {
             free( condInput->value[i] );
             condInput->value[i] = value ? strdup( value ) : NULL;
             return 0;
@@ -1135,6 +1154,19 @@ clearGenQueryInp( void* voidInp ) {
     return;
 }
 
+void
+clearGenQueryStreamInp( void* voidInp ) {
+
+    if ( voidInp == NULL ) {
+        return;
+    }
+
+    genQueryStreamInp_t *genQueryStreamInp = ( genQueryStreamInp_t* ) voidInp;
+    clearGenQueryInp( &genQueryStreamInp->genQueryInp );
+
+    return;
+}
+
 int
 freeGenQueryOut( genQueryOut_t **genQueryOut ) {
     if ( genQueryOut == NULL ) {
@@ -14,10 +14,12 @@
 // =-=-=-=-=-=-=-
 #include "irods_stacktrace.hpp"
 #include "irods_buffer_encryption.hpp"
+#include "irods_transfer_pipeline.hpp"
 #include "irods_client_server_negotiation.hpp"
 
 #include <openssl/md5.h>
 
+#include <boost/bind.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
@@ -285,6 +287,138 @@ fillRcPortalTransferInp( rcComm_t *conn, rcPortalTransferInp_t *myInput,
 }
 
 
+/* state shared by the stages of an encrypted client portal stream */
+typedef struct CryptStreamInp {
+    rcPortalTransferInp_t *myInput;
+    int fd;
+    rodsLong_t offset;
+    rodsLong_t toXfer;
+    int bufSize;
+    int maxFrameSize;
+    irods::buffer_crypt *crypt;
+    irods::buffer_crypt::array_t sharedSecret;
+} cryptStreamInp_t;
+
+static void
+updateLfRestartInfo( rcPortalTransferInp_t *myInput, rodsLong_t len,
+                     const char *caller ) {
+    rcComm_t *conn = myInput->conn;
+    fileRestartInfo_t *info = &conn->fileRestart.info;
+    int threadNum = myInput->threadNum;
+
+    if ( info->numSeg <= 0 ) {  /* not a file restart */
+        return;
+    }
+
+    info->dataSeg[threadNum].len += len;
+    conn->fileRestart.writtenSinceUpdated += len;
+    if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
+            RESTART_FILE_UPDATE_SIZE ) {
+        int status;
+        /* time to write to the restart file */
+        status = writeLfRestartFile( conn->fileRestart.infoFile,
+                                     &conn->fileRestart.info );
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "%s: writeLfRestartFile for %s, status = %d",
+                     caller, conn->fileRestart.info.fileName, status );
+        }
+        conn->fileRestart.writtenSinceUpdated = 0;
+    }
+}
+
+static int
+readLocalFileStage( cryptStreamInp_t *stream,
+                    irods::transfer_pipeline::frame& frame ) {
+    if ( stream->toXfer <= 0 ) {
+        return 0;
+    }
+
+    int toRead = stream->toXfer > stream->bufSize ?
+                 stream->bufSize : stream->toXfer;
+    frame.plain.resize( toRead );
+    if ( pread( stream->fd, &frame.plain[0], toRead, stream->offset ) != toRead ) {
+        int status = SYS_COPY_LEN_ERR - errno;
+        rodsLogError( LOG_ERROR, status,
+                      "rcPartialDataPut: read of %d bytes at %lld failed",
+                      toRead, stream->offset );
+        return status;
+    }
+
+    frame.length = toRead;
+    frame.offset = stream->offset;
+    stream->offset += toRead;
+    stream->toXfer -= toRead;
+    return 1;
+}
+
+static int
+encryptStage( cryptStreamInp_t *stream,
+              irods::transfer_pipeline::frame& frame ) {
+    int status = irods::encrypt_frame( *stream->crypt, stream->sharedSecret,
+                                       frame );
+    return status < 0 ? status : 1;
+}
+
+static int
+sendFrameStage( cryptStreamInp_t *stream,
+                irods::transfer_pipeline::frame& frame ) {
+    int status = irods::write_encrypted_frame( stream->myInput->destFd, frame );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "rcPartialDataPut: write of %d bytes failed",
+                      frame.length );
+        return status;
+    }
+
+    updateLfRestartInfo( stream->myInput, frame.length, "rcPartialDataPut" );
+    return 1;
+}
+
+static int
+rcvFrameStage( cryptStreamInp_t *stream,
+               irods::transfer_pipeline::frame& frame ) {
+    if ( stream->toXfer <= 0 ) {
+        return 0;
+    }
+
+    int status = irods::read_encrypted_frame( stream->myInput->srcFd,
+                 stream->maxFrameSize, *stream->crypt, stream->sharedSecret,
+                 stream->offset, frame );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "rcPartialDataGet: toGet %lld, frame read failed",
+                      stream->toXfer );
+        return status;
+    }
+    else if ( frame.length <= 0 || frame.length > stream->toXfer ) {
+        rodsLog( LOG_ERROR,
+                 "rcPartialDataGet: toGet %lld, bad frame length %d",
+                 stream->toXfer, frame.length );
+        return SYS_COPY_LEN_ERR;
+    }
+
+    stream->offset += frame.length;
+    stream->toXfer -= frame.length;
+    return 1;
+}
+
+static int
+writeLocalFileStage( cryptStreamInp_t *stream,
+                     irods::transfer_pipeline::frame& frame ) {
+    if ( pwrite( stream->fd, &frame.plain[0], frame.length, frame.offset ) !=
+            frame.length ) {
+        int status = SYS_COPY_LEN_ERR - errno;
+        rodsLogError( LOG_ERROR, status,
+                      "rcPartialDataGet: write of %d bytes at %lld failed",
+                      frame.length, frame.offset );
+        return status;
+    }
+
+    updateLfRestartInfo( stream->myInput, frame.length, "rcPartialDataGet" );
+    return 1;
+}
+
 void
 rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
     int destFd = 0;
@@ -333,34 +467,43 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
     }
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t in_buf;
-    irods::buffer_crypt::array_t shared_secret;
+    // create an encryption context, kept for the life of the stream
     irods::buffer_crypt crypt(
         rods_env.rodsEncryptionKeySize,
         rods_env.rodsEncryptionSaltSize,
         rods_env.rodsEncryptionNumHashRounds,
         rods_env.rodsEncryptionAlgorithm );
 
+    rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
+
     // =-=-=-=-=-=-=-
-    // set iv size
+    // encrypted streams overlap the file read, the encryption and
+    // the socket write of consecutive buffers
+    cryptStreamInp_t cryptStream;
+    irods::transfer_pipeline pipeline;
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        cryptStream.myInput = myInput;
+        cryptStream.fd = srcFd;
+        cryptStream.bufSize = trans_buff_sz;
+        cryptStream.maxFrameSize = 0;
+        cryptStream.crypt = &crypt;
+        cryptStream.sharedSecret.assign(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        pipeline.add_stage( boost::bind( readLocalFileStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( encryptStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( sendFrameStage, &cryptStream, _1 ) );
     }
 
     // =-=-=-=-=-=-=-
     // allocate a buffer for writing
-    rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
-    rodsLong_t buf_size = 2 * trans_buff_sz * sizeof( unsigned char );
-    unsigned char* buf = ( unsigned char* )malloc( buf_size );
+    unsigned char* buf = ( unsigned char* )malloc( trans_buff_sz );
     transferHeader_t myHeader;
 
+    // =-=-=-=-=-=-=-
+    // unencrypted transfers skip the user space buffer when possible
+    bool use_zero_copy_flg = !use_encryption_flg;
+
     while ( myInput->status >= 0 ) {
         rodsLong_t toPut;
 
@@ -387,7 +530,16 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
             }
         }
 
-        toPut = myHeader.length;
+        if ( use_encryption_flg ) {
+            cryptStream.offset = curOffset;
+            cryptStream.toXfer = myHeader.length;
+            myInput->status = pipeline.run();
+            if ( myInput->status < 0 ) {
+                break;
+            }
+        }
+
+        toPut = use_encryption_flg ? 0 : myHeader.length;
         while ( toPut > 0 ) {
             rodsLong_t toRead;
             int bytesRead, bytesWritten;
@@ -399,107 +551,65 @@ rcPartialDataPut( rcPortalTransferInp_t *myInput ) {
                 toRead = toPut;
             }
 
-            bytesRead = myRead(
-                            srcFd,
-                            buf,
-                            toRead,
-                            &bytesRead,
-                            NULL );
-            if ( bytesRead != toRead ) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError( LOG_ERROR, myInput->status,
-                              "rcPartialDataPut: toPut %lld, bytesRead %d",
-                              toPut, bytesRead );
-                break;
-            }
-
-            // =-=-=-=-=-=-=-
-            // compute an iv for this particular transmission and use
-            // it to encrypt this buffer
-            int new_size = bytesRead;
-            if ( use_encryption_flg ) {
-                irods::error ret = crypt.initialization_vector( iv );
-                if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
-                    break;
-                }
-
+            if ( use_zero_copy_flg ) {
                 // =-=-=-=-=-=-=-
-                // encrypt
-                in_buf.assign(
-                    &buf[0],
-                    &buf[ bytesRead ] );
-                ret = crypt.encrypt(
-                          shared_secret,
-                          iv,
-                          in_buf,
-                          cipher );
-                if ( !ret.ok() ) {
-                    ret = PASS( ret );
-                    printf( "%s", ret.result().c_str() );
+                // hand the file pages straight to the socket
+                rodsLong_t srcOffset = curOffset + myHeader.length - toPut;
+                bytesRead = mySendFile(
+                                destFd,
+                                srcFd,
+                                srcOffset,
+                                toRead,
+                                NULL );
+                if ( bytesRead != toRead ) {
+                    // =-=-=-=-=-=-=-
+                    // finish with the buffered path, sendfile does not
+                    // move the file offset so position it for myRead
+                    use_zero_copy_flg = false;
+                    if ( lseek( srcFd, srcOffset + bytesRead, SEEK_SET ) < 0 ) {
+                        myInput->status = UNIX_FILE_LSEEK_ERR - errno;
+                        rodsLogError( LOG_ERROR, myInput->status,
+                                      "rcPartialDataPut: lseek to %lld error, status = %d",
+                                      srcOffset + bytesRead, myInput->status );
+                        break;
+                    }
+                    if ( bytesRead <= 0 ) {
+                        continue;
+                    }
+                }
+            }
+            else {
+                bytesRead = myRead(
+                                srcFd,
+                                buf,
+                                toRead,
+                                &bytesRead,
+                                NULL );
+                if ( bytesRead != toRead ) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError( LOG_ERROR, myInput->status,
+                                  "rcPartialDataPut: toPut %lld, bytesRead %d",
+                                  toPut, bytesRead );
                     break;
                 }
 
-                // =-=-=-=-=-=-=-
-                // capture the iv with the cipher text
-                memset( buf, 0,  buf_size );
-                std::copy(
-                    iv.begin(),
-                    iv.end(),
-                    &buf[0] );
-                std::copy(
-                    cipher.begin(),
-                    cipher.end(),
-                    &buf[iv_size] );
-
-                new_size = iv_size + cipher.size();
-
-                // =-=-=-=-=-=-=-
-                // need to send the incoming size as encryption might change
-                // the size of the data from the writen values
                 bytesWritten = myWrite(
                                    destFd,
-                                   &new_size,
-                                   sizeof( int ),
+                                   buf,
+                                   bytesRead,
                                    &bytesWritten );
 
-            }
-
-            // =-=-=-=-=-=-=-
-            // then write the actual buffer
-            bytesWritten = myWrite(
-                               destFd,
-                               buf,
-                               new_size,
-                               &bytesWritten );
-
-            if ( bytesWritten != new_size ) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError( LOG_ERROR, myInput->status,
-                              "rcPartialDataPut: toWrite %d, bytesWritten %d, errno = %d",
-                              bytesRead, bytesWritten, errno );
-                break;
+                if ( bytesWritten != bytesRead ) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError( LOG_ERROR, myInput->status,
+                                  "rcPartialDataPut: toWrite %d, bytesWritten %d, errno = %d",
+                                  bytesRead, bytesWritten, errno );
+                    break;
+                }
             }
 
             toPut -= bytesRead;
-            if ( info->numSeg > 0 ) {   /* file restart */
-                info->dataSeg[threadNum].len += bytesRead;
-                conn->fileRestart.writtenSinceUpdated += bytesRead;
-                if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
-                        RESTART_FILE_UPDATE_SIZE ) {
-                    int status;
-                    /* time to write to the restart file */
-                    status = writeLfRestartFile( conn->fileRestart.infoFile,
-                                                 &conn->fileRestart.info );
-                    if ( status < 0 ) {
-                        rodsLog( LOG_ERROR,
-                                 "rcPartialDataPut: writeLfRestartFile for %s, status = %d",
-                                 conn->fileRestart.info.fileName, status );
-                    }
-                    conn->fileRestart.writtenSinceUpdated = 0;
-                }
-            }
+            updateLfRestartInfo( myInput, bytesRead, "rcPartialDataPut" );
 
         } // while
 
@@ -1019,31 +1129,38 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
     }
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t this_iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t plain;
-    irods::buffer_crypt::array_t shared_secret;
+    // create an encryption context, kept for the life of the stream
     irods::buffer_crypt crypt(
         rods_env.rodsEncryptionKeySize,
         rods_env.rodsEncryptionSaltSize,
         rods_env.rodsEncryptionNumHashRounds,
         rods_env.rodsEncryptionAlgorithm );
 
+    rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
+
     // =-=-=-=-=-=-=-
-    // set iv size
+    // encrypted streams overlap the socket read and decryption of
+    // one buffer with the file write of the previous one
+    cryptStreamInp_t cryptStream;
+    irods::transfer_pipeline pipeline;
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
+        cryptStream.myInput = myInput;
+        cryptStream.fd = destFd;
+        cryptStream.bufSize = trans_buff_sz;
+        cryptStream.maxFrameSize = 2 * trans_buff_sz;
+        cryptStream.crypt = &crypt;
+        cryptStream.sharedSecret.assign(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
+        pipeline.add_stage( boost::bind( rcvFrameStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( writeLocalFileStage, &cryptStream, _1 ) );
     }
 
-    rodsLong_t trans_buff_sz = ( rodsLong_t )rods_env.irodsTransBufferSizeForParaTrans * 1024 * 1024;
-    rodsLong_t buf_size = ( 2 * trans_buff_sz ) * sizeof( unsigned char );
-    buf = ( unsigned char* )malloc( buf_size );
+    buf = ( unsigned char* )malloc( trans_buff_sz );
+
+    // =-=-=-=-=-=-=-
+    // unencrypted transfers skip the user space buffer when possible
+    bool use_zero_copy_flg = !use_encryption_flg;
 
     while ( myInput->status >= 0 ) {
 
@@ -1070,7 +1187,16 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
             }
         }
 
-        rodsLong_t toGet = myHeader.length;
+        if ( use_encryption_flg ) {
+            cryptStream.offset = curOffset;
+            cryptStream.toXfer = myHeader.length;
+            myInput->status = pipeline.run();
+            if ( myInput->status < 0 ) {
+                break;
+            }
+        }
+
+        rodsLong_t toGet = use_encryption_flg ? 0 : myHeader.length;
         while ( toGet > 0 ) {
             int toRead, bytesRead, bytesWritten;
 
@@ -1081,104 +1207,71 @@ rcPartialDataGet( rcPortalTransferInp_t *myInput ) {
                 toRead = toGet;
             }
 
-            // =-=-=-=-=-=-=-
-            // read the incoming size as it might differ due to encryption
-            int new_size = toRead;
-            if ( use_encryption_flg ) {
+            if ( use_zero_copy_flg ) {
+                // =-=-=-=-=-=-=-
+                // move the socket data into the file through a pipe
+                rodsLong_t destOffset = curOffset + myHeader.length - toGet;
+                bytesWritten = mySpliceToFile(
+                                   srcFd,
+                                   destFd,
+                                   destOffset,
+                                   toRead,
+                                   NULL );
+                if ( bytesWritten < 0 ) {
+                    myInput->status = bytesWritten;
+                    rodsLogError( LOG_ERROR, myInput->status,
+                                  "rcPartialDataGet: toGet %lld, splice failed",
+                                  toGet );
+                    break;
+                }
+                else if ( bytesWritten != toRead ) {
+                    // =-=-=-=-=-=-=-
+                    // finish with the buffered path, splice does not
+                    // move the file offset so position it for myWrite
+                    use_zero_copy_flg = false;
+                    if ( lseek( destFd, destOffset + bytesWritten, SEEK_SET ) < 0 ) {
+                        myInput->status = UNIX_FILE_LSEEK_ERR - errno;
+                        rodsLogError( LOG_ERROR, myInput->status,
+                                      "rcPartialDataGet: lseek to %lld error, status = %d",
+                                      destOffset + bytesWritten, myInput->status );
+                        break;
+                    }
+                    if ( bytesWritten == 0 ) {
+                        continue;
+                    }
+                }
+            }
+            else {
                 bytesRead = myRead(
                                 srcFd,
-                                &new_size,
-                                sizeof( int ),
-                                NULL, NULL );
-                if ( bytesRead != sizeof( int ) ) {
-                    rodsLog(
-                        LOG_ERROR,
-                        "_partialDataGet:Bytes Read != %d",
-                        sizeof( int ) );
+                                buf,
+                                toRead,
+                                &bytesRead,
+                                NULL );
+                if ( bytesRead != toRead ) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError( LOG_ERROR, myInput->status,
+                                  "rcPartialDataGet: toGet %lld, bytesRead %d",
+                                  toGet, bytesRead );
                     break;
                 }
-            }
-
-            // =-=-=-=-=-=-=-
-            // now read the provided number of bytes as suggested by
-            // the incoming size
-            bytesRead = myRead(
-                            srcFd,
-                            buf,
-                            new_size,
-                            &bytesRead,
-                            NULL );
-            if ( bytesRead != new_size ) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError( LOG_ERROR, myInput->status,
-                              "rcPartialDataGet: toGet %lld, bytesRead %d",
-                              toGet, bytesRead );
-                break;
-            }
 
-            // =-=-=-=-=-=-=-
-            // if using encryption, strip off the iv
-            // and decrypt before writing
-            int plain_size = bytesRead;
-            if ( use_encryption_flg ) {
-                this_iv.assign(
-                    &buf[ 0 ],
-                    &buf[ iv_size ] );
-                cipher.assign(
-                    &buf[ iv_size ],
-                    &buf[ new_size ] );
-                irods::error ret = crypt.decrypt(
-                                       shared_secret,
-                                       this_iv,
-                                       cipher,
-                                       plain );
-                if ( !ret.ok() ) {
-                    irods::log( PASS( ret ) );
-                    myInput->status = SYS_COPY_LEN_ERR;
+                bytesWritten = myWrite(
+                                   destFd,
+                                   buf,
+                                   bytesRead,
+                                   &bytesWritten );
+                if ( bytesWritten != bytesRead ) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError( LOG_ERROR, myInput->status,
+                                  "rcPartialDataGet: toWrite %d, bytesWritten %d",
+                                  bytesRead, bytesWritten );
                     break;
                 }
-
-                memset( buf, 0, buf_size );
-                std::copy(
-                    plain.begin(),
-                    plain.end(),
-                    &buf[0] );
-                plain_size = plain.size();
-
-            }
-
-            bytesWritten = myWrite(
-                               destFd,
-                               buf,
-                               plain_size,
-                               &bytesWritten );
-            if ( bytesWritten != plain_size ) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError( LOG_ERROR, myInput->status,
-                              "rcPartialDataGet: toWrite %d, bytesWritten %d",
-                              plain_size, bytesWritten );
-                break;
             }
 
             toGet -= bytesWritten;
-
-            if ( info->numSeg > 0 ) {   /* file restart */
-                info->dataSeg[threadNum].len += bytesWritten;
-                conn->fileRestart.writtenSinceUpdated += bytesWritten;
-                if ( threadNum == 0 && conn->fileRestart.writtenSinceUpdated >=
-                        RESTART_FILE_UPDATE_SIZE ) {
-                    int status;
-                    /* time to write to the restart file */
-                    status = writeLfRestartFile( conn->fileRestart.infoFile,
-                                                 &conn->fileRestart.info );
-                    if ( status < 0 ) {
-                        rodsLog( LOG_ERROR,
-                                 "rcPartialDataGet: writeLfRestartFile for %s, status = %d",
-                                 conn->fileRestart.info.fileName, status );
-                    }
-                    conn->fileRestart.writtenSinceUpdated = 0;
-                }
-            }
+            updateLfRestartInfo( myInput, bytesWritten, "rcPartialDataGet" );
         }
         curOffset += myHeader.length;
         myInput->bytesWritten += myHeader.length;
@@ -23,6 +23,11 @@ int win_connect_timeout;
 MMRESULT win_connect_timer_id;
 #endif
 
+#if defined(linux_platform)
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
+
 #ifndef _WIN32
 
 #include <setjmp.h>
@@ -590,6 +595,146 @@ myWrite( int sock, void *buf, int len,
     return len - toWrite;
 }
 
+/* mySendFile - write len bytes of the local file fd starting at offset
+ * to sock without copying through a user space buffer.  The file offset
+ * of fd is not changed.  Returns the number of bytes sent; a short count
+ * (with errno set) tells the caller to finish with the buffered path.
+ */
+int
+mySendFile( int sock, int fd, rodsLong_t offset, int len,
+            int *bytesWritten ) {
+    int toWrite = len;
+
+    if ( bytesWritten != NULL ) {
+        *bytesWritten = 0;
+    }
+
+#if defined(linux_platform)
+    off_t fileOffset = offset;
+    while ( toWrite > 0 ) {
+        ssize_t nbytes = sendfile( sock, fd, &fileOffset, toWrite );
+        if ( nbytes < 0 ) {
+            if ( errno == EINTR ) {
+                errno = 0;
+                continue;
+            }
+            break;
+        }
+        else if ( nbytes == 0 ) {
+            /* premature end of file */
+            break;
+        }
+        toWrite -= nbytes;
+        if ( bytesWritten != NULL ) {
+            *bytesWritten += nbytes;
+        }
+    }
+#else
+    errno = ENOSYS;
+#endif
+    return len - toWrite;
+}
+
+/* mySpliceToFile - move len bytes from sock into the local file fd at
+ * offset through a kernel pipe.  The file offset of fd is not changed.
+ * Returns the number of bytes written to the file.  A short count (with
+ * errno set) means the remaining bytes are still on the socket and can
+ * be read with myRead.  If the data could not be written after it was
+ * taken off the socket, the stream is out of sync and a negative
+ * status is returned.
+ */
+int
+mySpliceToFile( int sock, int fd, rodsLong_t offset, int len,
+                int *bytesWritten ) {
+    int toWrite = len;
+
+    if ( bytesWritten != NULL ) {
+        *bytesWritten = 0;
+    }
+
+#if defined(linux_platform)
+    int pipeFd[2];
+    if ( pipe( pipeFd ) < 0 ) {
+        return 0;
+    }
+    /* best effort, a larger pipe means fewer round trips */
+    fcntl( pipeFd[1], F_SETPIPE_SZ, SPLICE_PIPE_SIZE );
+
+    int status = 0;
+    loff_t fileOffset = offset;
+    while ( toWrite > 0 && status == 0 ) {
+        ssize_t inPipe = splice( sock, NULL, pipeFd[1], NULL, toWrite,
+                                 SPLICE_F_MOVE | SPLICE_F_MORE );
+        if ( inPipe < 0 ) {
+            if ( errno == EINTR ) {
+                errno = 0;
+                continue;
+            }
+            break;
+        }
+        else if ( inPipe == 0 ) {
+            /* peer closed the connection */
+            break;
+        }
+
+        while ( inPipe > 0 ) {
+            ssize_t nbytes = splice( pipeFd[0], NULL, fd, &fileOffset, inPipe,
+                                     SPLICE_F_MOVE );
+            if ( nbytes < 0 && errno == EINTR ) {
+                errno = 0;
+                continue;
+            }
+            else if ( nbytes <= 0 ) {
+                /* the file system cannot take a splice.  the bytes are
+                 * already off the socket so drain the pipe the slow way */
+                int savedErrno = errno;
+                char drainBuf[SPLICE_DRAIN_BUF_SIZE];
+                while ( inPipe > 0 ) {
+                    size_t toDrain = inPipe < ( ssize_t ) sizeof( drainBuf ) ?
+                                     inPipe : sizeof( drainBuf );
+                    ssize_t drained = read( pipeFd[0], drainBuf, toDrain );
+                    if ( drained < 0 && errno == EINTR ) {
+                        continue;
+                    }
+                    else if ( drained <= 0 ||
+                              pwrite( fd, drainBuf, drained, fileOffset ) != drained ) {
+                        status = SYS_COPY_LEN_ERR - errno;
+                        break;
+                    }
+                    fileOffset += drained;
+                    inPipe -= drained;
+                    toWrite -= drained;
+                    if ( bytesWritten != NULL ) {
+                        *bytesWritten += drained;
+                    }
+                }
+                if ( status == 0 ) {
+                    /* stop splicing, the rest is read by the caller */
+                    errno = savedErrno;
+                    status = 1;
+                }
+                break;
+            }
+            inPipe -= nbytes;
+            toWrite -= nbytes;
+            if ( bytesWritten != NULL ) {
+                *bytesWritten += nbytes;
+            }
+        }
+    }
+
+    close( pipeFd[0] );
+    close( pipeFd[1] );
+
+    if ( status < 0 ) {
+        return status;
+    }
+#else
+    errno = ENOSYS;
+#endif
+    return len - toWrite;
+}
+
 // =-=-=-=-=-=-=-
 //
 irods::error readVersion(
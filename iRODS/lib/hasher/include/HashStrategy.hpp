@@ -14,7 +14,7 @@ namespace irods {
 
             virtual std::string name() const = 0;
             virtual error init( boost::any& context ) const = 0;
-            virtual error update( const std::string&, boost::any& context ) const = 0;
+            virtual error update( const char*, size_t, boost::any& context ) const = 0;
             virtual error digest( std::string& messageDigest, boost::any& context ) const = 0;
             virtual bool isChecksum( const std::string& ) const = 0;
     };
@@ -18,6 +18,7 @@ namespace irods {
 
             error init( const HashStrategy* );
             error update( const std::string& );
+            error update( const char*, size_t );
             error digest( std::string& messageDigest );
 
         private:
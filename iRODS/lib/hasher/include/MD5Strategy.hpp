@@ -14,7 +14,7 @@ namespace irods {
                 return MD5_NAME;
             }
             virtual error init( boost::any& context ) const;
-            virtual error update( const std::string&, boost::any& context ) const;
+            virtual error update( const char*, size_t, boost::any& context ) const;
             virtual error digest( std::string& messageDigest, boost::any& context ) const;
             virtual bool isChecksum( const std::string& ) const;
 
@@ -16,7 +16,7 @@ namespace irods {
                 return SHA256_NAME;
             }
             virtual error init( boost::any& context ) const;
-            virtual error update( const std::string& data, boost::any& context ) const;
+            virtual error update( const char* data, size_t len, boost::any& context ) const;
             virtual error digest( std::string& messageDigest, boost::any& context ) const;
             virtual bool isChecksum( const std::string& ) const;
 
@@ -0,0 +1,81 @@
+#ifndef _SHA256_TREE_STRATEGY_HPP_
+#define _SHA256_TREE_STRATEGY_HPP_
+
+#include "HashStrategy.hpp"
+#include "rodsType.h"
+#include <string>
+#include <vector>
+#include <openssl/sha.h>
+
+namespace irods {
+    const std::string SHA256_TREE_NAME( "sha256tree" );
+
+    // =-=-=-=-=-=-=-
+    // the file is split into chunks of this size, the checksum is the
+    // sha256 of the sha256 digests of the chunks in order
+    const rodsLong_t SHA256_TREE_CHUNK_SIZE( 64 * 1024 * 1024 );
+
+    class SHA256TreeStrategy : public HashStrategy {
+        public:
+            SHA256TreeStrategy() {};
+            virtual ~SHA256TreeStrategy() {};
+
+            virtual std::string name() const {
+                return SHA256_TREE_NAME;
+            }
+            virtual error init( boost::any& context ) const;
+            virtual error update( const char* data, size_t len, boost::any& context ) const;
+            virtual error digest( std::string& messageDigest, boost::any& context ) const;
+            virtual bool isChecksum( const std::string& ) const;
+
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief a file hashed by sha256_tree_hash. every thread opens the
+    ///        file for itself, a handle is only used by the thread which
+    ///        opened it
+    class tree_hash_file {
+        public:
+            virtual ~tree_hash_file() {};
+
+            /// @brief open the file positioned at an offset
+            virtual error open( rodsLong_t _offset, boost::any& _handle ) = 0;
+
+            /// @brief read up to _len bytes, the code of the result is the
+            ///        number of bytes read, 0 at the end of the file
+            virtual error read( boost::any& _handle, char* _buf, int _len ) = 0;
+
+            /// @brief close a handle returned by open
+            virtual error close( boost::any& _handle ) = 0;
+    };
+
+    /// =-=-=-=-=-=-=-
+    /// @brief compute the sha256tree checksum of the first _size bytes of
+    ///        a file, with up to _threads threads each hashing a range of
+    ///        chunks. the result is the same as hashing the file with a
+    ///        SHA256TreeStrategy hasher
+    error sha256_tree_hash(
+        tree_hash_file& _file,
+        rodsLong_t      _size,
+        int             _threads,
+        std::string&    _digest );
+
+    /// =-=-=-=-=-=-=-
+    /// @brief the sha256 digests of the chunks of a file in chunk order,
+    ///        an empty string for a chunk whose digest is not known
+    typedef std::vector< std::string > tree_leaves_t;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief as above, given the digests of the chunks which are already
+    ///        known. only the other chunks are read, and their digests are
+    ///        filled into _leaves
+    error sha256_tree_hash(
+        tree_hash_file& _file,
+        rodsLong_t      _size,
+        int             _threads,
+        tree_leaves_t&  _leaves,
+        std::string&    _digest );
+
+}; // namespace irods
+
+#endif // _SHA256_TREE_STRATEGY_HPP_
@@ -0,0 +1,29 @@
+#ifndef _XXH64_STRATEGY_HPP_
+#define _XXH64_STRATEGY_HPP_
+
+#include "HashStrategy.hpp"
+#include <string>
+
+namespace irods {
+    const std::string XXH64_NAME( "xxh64" );
+
+    // =-=-=-=-=-=-=-
+    // xxHash64 with a seed of 0. not a cryptographic hash, it only
+    // detects accidental corruption, but is many times faster than md5
+    class XXH64Strategy : public HashStrategy {
+        public:
+            XXH64Strategy() {};
+            virtual ~XXH64Strategy() {};
+
+            virtual std::string name() const {
+                return XXH64_NAME;
+            }
+            virtual error init( boost::any& context ) const;
+            virtual error update( const char* data, size_t len, boost::any& context ) const;
+            virtual error digest( std::string& messageDigest, boost::any& context ) const;
+            virtual bool isChecksum( const std::string& ) const;
+
+    };
+}; // namespace irods
+
+#endif // _XXH64_STRATEGY_HPP_
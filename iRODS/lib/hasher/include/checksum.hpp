@@ -15,6 +15,8 @@ extern "C" {
 #endif
 
 #define SHA256_CHKSUM_PREFIX "sha2:"
+#define SHA256_TREE_CHKSUM_PREFIX "sha2t:"
+#define XXH64_CHKSUM_PREFIX "xxh64:"
 int verifyChksumLocFile( char *fileName, char *myChksum, char *chksumStr );
 
 int
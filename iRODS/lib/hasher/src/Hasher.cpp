@@ -20,13 +20,18 @@ namespace irods {
 
     error
     Hasher::update( const std::string& _data ) {
+        return update( _data.c_str(), _data.size() );
+    }
+
+    error
+    Hasher::update( const char* _data, size_t _len ) {
         if ( NULL == _strategy ) {
             return ERROR( SYS_UNINITIALIZED, "Update called on a hasher that has not been initialized" );
         }
         if ( !_stored_digest.empty() ) {
             return ERROR( SYS_HASH_IMMUTABLE, "Update called on a hasher that has already generated a digest" );
         }
-        error ret = _strategy->update( _data, _context );
+        error ret = _strategy->update( _data, _len, _context );
 
         return PASS( ret );
     }
@@ -19,8 +19,8 @@ namespace irods {
     }
 
     error
-    MD5Strategy::update( const std::string& data, boost::any& _context ) const {
-        MD5_Update( boost::any_cast<MD5_CTX>( &_context ), ( const unsigned char * )data.c_str(), data.size() );
+    MD5Strategy::update( const char* data, size_t len, boost::any& _context ) const {
+        MD5_Update( boost::any_cast<MD5_CTX>( &_context ), ( const unsigned char * )data, len );
         return SUCCESS();
     }
 
@@ -21,8 +21,8 @@ namespace irods {
     }
 
     error
-    SHA256Strategy::update( const std::string& data, boost::any& _context ) const {
-        SHA256_Update( boost::any_cast<SHA256_CTX>( &_context ), data.c_str(), data.size() );
+    SHA256Strategy::update( const char* data, size_t len, boost::any& _context ) const {
+        SHA256_Update( boost::any_cast<SHA256_CTX>( &_context ), data, len );
         return SUCCESS();
     }
 
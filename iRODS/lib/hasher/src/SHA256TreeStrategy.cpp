@@ -0,0 +1,213 @@
+#include "SHA256TreeStrategy.hpp"
+#include "checksum.hpp"
+#include "rodsErrorTable.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <openssl/sha.h>
+
+#include "base64.h"
+
+#define TREE_HASH_BUF_SZ (1024*1024)
+
+namespace irods {
+
+    namespace {
+        // =-=-=-=-=-=-=-
+        // the chunk being hashed and the digests of the chunks before it
+        struct tree_context {
+            SHA256_CTX leaf;
+            SHA256_CTX root;
+            rodsLong_t leaf_size;
+        };
+
+        void encode_root(
+            SHA256_CTX&  _root,
+            std::string& _messageDigest ) {
+            unsigned char final_buffer[SHA256_DIGEST_LENGTH];
+            SHA256_Final( final_buffer, &_root );
+            int len = strlen( SHA256_TREE_CHKSUM_PREFIX );
+            unsigned long out_len = CHKSUM_LEN - len;
+
+            unsigned char out_buffer[CHKSUM_LEN];
+            base64_encode( final_buffer, SHA256_DIGEST_LENGTH, out_buffer, &out_len );
+
+            _messageDigest = SHA256_TREE_CHKSUM_PREFIX;
+            _messageDigest += std::string( ( char* )out_buffer, out_len );
+        }
+
+        // =-=-=-=-=-=-=-
+        // hash the chunks _chunks[_first, _last) of the file into their slots
+        // of _leaves. the file is reopened wherever the chunks are not contiguous
+        void hash_chunks(
+            tree_hash_file*                _file,
+            rodsLong_t                     _size,
+            const std::vector<rodsLong_t>* _chunks,
+            size_t                         _first,
+            size_t                         _last,
+            tree_leaves_t*                 _leaves,
+            error*                         _result ) {
+            boost::any handle;
+            bool       opened = false;
+            rodsLong_t offset = 0;
+            std::vector<char> buffer( TREE_HASH_BUF_SZ );
+            for ( size_t i = _first; i < _last; ++i ) {
+                rodsLong_t chunk = ( *_chunks )[ i ];
+                if ( !opened || offset != chunk * SHA256_TREE_CHUNK_SIZE ) {
+                    if ( opened ) {
+                        _file->close( handle );
+                    }
+                    offset = chunk * SHA256_TREE_CHUNK_SIZE;
+                    *_result = _file->open( offset, handle );
+                    if ( !_result->ok() ) {
+                        return;
+                    }
+                    opened = true;
+                }
+
+                rodsLong_t to_read = std::min( SHA256_TREE_CHUNK_SIZE, _size - offset );
+                SHA256_CTX leaf;
+                SHA256_Init( &leaf );
+                while ( to_read > 0 ) {
+                    int len = ( int ) std::min( ( rodsLong_t ) TREE_HASH_BUF_SZ, to_read );
+                    error ret = _file->read( handle, &buffer[0], len );
+                    if ( !ret.ok() || ret.code() <= 0 ) {
+                        std::stringstream msg;
+                        msg << "failed to read the file at offset " << offset;
+                        *_result = ret.ok() ?
+                                   ERROR( UNIX_FILE_READ_ERR, msg.str() ) :
+                                   PASSMSG( msg.str(), ret );
+                        _file->close( handle );
+                        return;
+                    }
+                    SHA256_Update( &leaf, &buffer[0], ret.code() );
+                    to_read -= ret.code();
+                    offset  += ret.code();
+                }
+                unsigned char digest[SHA256_DIGEST_LENGTH];
+                SHA256_Final( digest, &leaf );
+                ( *_leaves )[ chunk ].assign( ( char* ) digest, SHA256_DIGEST_LENGTH );
+            }
+
+            *_result = opened ? _file->close( handle ) : SUCCESS();
+        }
+
+    }; // namespace
+
+    error
+    SHA256TreeStrategy::init( boost::any& _context ) const {
+        _context = tree_context();
+        tree_context* ctx = boost::any_cast<tree_context>( &_context );
+        SHA256_Init( &ctx->leaf );
+        SHA256_Init( &ctx->root );
+        ctx->leaf_size = 0;
+        return SUCCESS();
+    }
+
+    error
+    SHA256TreeStrategy::update( const char* data, size_t len, boost::any& _context ) const {
+        tree_context* ctx = boost::any_cast<tree_context>( &_context );
+        const char* buf = data;
+        while ( len > 0 ) {
+            size_t n = std::min( ( size_t )( SHA256_TREE_CHUNK_SIZE - ctx->leaf_size ), len );
+            SHA256_Update( &ctx->leaf, buf, n );
+            ctx->leaf_size += n;
+            buf += n;
+            len -= n;
+
+            // =-=-=-=-=-=-=-
+            // a full chunk is added to the root as soon as it is complete
+            if ( ctx->leaf_size == SHA256_TREE_CHUNK_SIZE ) {
+                unsigned char leaf[SHA256_DIGEST_LENGTH];
+                SHA256_Final( leaf, &ctx->leaf );
+                SHA256_Update( &ctx->root, leaf, SHA256_DIGEST_LENGTH );
+                SHA256_Init( &ctx->leaf );
+                ctx->leaf_size = 0;
+            }
+        }
+        return SUCCESS();
+    }
+
+    error
+    SHA256TreeStrategy::digest( std::string& _messageDigest, boost::any& _context ) const {
+        tree_context* ctx = boost::any_cast<tree_context>( &_context );
+        if ( ctx->leaf_size > 0 ) {
+            unsigned char leaf[SHA256_DIGEST_LENGTH];
+            SHA256_Final( leaf, &ctx->leaf );
+            SHA256_Update( &ctx->root, leaf, SHA256_DIGEST_LENGTH );
+        }
+        encode_root( ctx->root, _messageDigest );
+        return SUCCESS();
+    }
+
+    bool
+    SHA256TreeStrategy::isChecksum( const std::string& _chksum ) const {
+        return boost::starts_with( _chksum, SHA256_TREE_CHKSUM_PREFIX );
+    }
+
+    error sha256_tree_hash(
+        tree_hash_file& _file,
+        rodsLong_t      _size,
+        int             _threads,
+        std::string&    _digest ) {
+        tree_leaves_t leaves;
+        return sha256_tree_hash( _file, _size, _threads, leaves, _digest );
+    }
+
+    error sha256_tree_hash(
+        tree_hash_file& _file,
+        rodsLong_t      _size,
+        int             _threads,
+        tree_leaves_t&  _leaves,
+        std::string&    _digest ) {
+        rodsLong_t chunks = ( _size + SHA256_TREE_CHUNK_SIZE - 1 ) / SHA256_TREE_CHUNK_SIZE;
+        _leaves.resize( chunks );
+        std::vector<rodsLong_t> missing;
+        for ( rodsLong_t chunk = 0; chunk < chunks; ++chunk ) {
+            if ( _leaves[ chunk ].size() != SHA256_DIGEST_LENGTH ) {
+                missing.push_back( chunk );
+            }
+        }
+
+        if ( _threads > ( int ) missing.size() ) {
+            _threads = ( int ) missing.size();
+        }
+        if ( _threads < 1 && !missing.empty() ) {
+            _threads = 1;
+        }
+
+        // =-=-=-=-=-=-=-
+        // every thread hashes a contiguous range of the missing chunks, the
+        // digests are combined in chunk order once all of them are done
+        std::vector<error> results( _threads );
+        boost::thread_group threads;
+        size_t first = 0;
+        for ( int i = 0; i < _threads; ++i ) {
+            size_t last = first + missing.size() / _threads + ( i < ( int )( missing.size() % _threads ) ? 1 : 0 );
+            threads.create_thread( boost::bind( hash_chunks, &_file, _size, &missing, first, last, &_leaves, &results[i] ) );
+            first = last;
+        }
+        threads.join_all();
+
+        for ( int i = 0; i < _threads; ++i ) {
+            if ( !results[i].ok() ) {
+                return PASS( results[i] );
+            }
+        }
+
+        SHA256_CTX root;
+        SHA256_Init( &root );
+        for ( rodsLong_t chunk = 0; chunk < chunks; ++chunk ) {
+            SHA256_Update( &root, _leaves[ chunk ].c_str(), SHA256_DIGEST_LENGTH );
+        }
+        encode_root( root, _digest );
+        return SUCCESS();
+    }
+
+}; // namespace irods
@@ -0,0 +1,165 @@
+#include "XXH64Strategy.hpp"
+#include "checksum.hpp"
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace irods {
+
+    namespace {
+        const uint64_t PRIME64_1 = 11400714785074694791ULL;
+        const uint64_t PRIME64_2 = 14029467366897019727ULL;
+        const uint64_t PRIME64_3 =  1609587929392839161ULL;
+        const uint64_t PRIME64_4 =  9650029242287828579ULL;
+        const uint64_t PRIME64_5 =  2870177450012600261ULL;
+
+        // =-=-=-=-=-=-=-
+        // the four lanes over the 32 byte stripes hashed so far, and the
+        // bytes of an incomplete stripe
+        struct xxh64_context {
+            uint64_t      total_len;
+            uint64_t      v[4];
+            unsigned char mem[32];
+            size_t        mem_size;
+        };
+
+        uint64_t rotl( uint64_t _x, int _r ) {
+            return ( _x << _r ) | ( _x >> ( 64 - _r ) );
+        }
+
+        // =-=-=-=-=-=-=-
+        // the input is little endian whatever the host is
+        uint64_t read64( const unsigned char* _p ) {
+            uint64_t val = 0;
+            for ( int i = 7; i >= 0; --i ) {
+                val = ( val << 8 ) | _p[i];
+            }
+            return val;
+        }
+
+        uint64_t read32( const unsigned char* _p ) {
+            return ( uint64_t )_p[0] | ( ( uint64_t )_p[1] << 8 ) |
+                   ( ( uint64_t )_p[2] << 16 ) | ( ( uint64_t )_p[3] << 24 );
+        }
+
+        uint64_t xxh_round( uint64_t _acc, uint64_t _input ) {
+            _acc += _input * PRIME64_2;
+            _acc  = rotl( _acc, 31 );
+            return _acc * PRIME64_1;
+        }
+
+        uint64_t merge_round( uint64_t _acc, uint64_t _val ) {
+            _acc ^= xxh_round( 0, _val );
+            return _acc * PRIME64_1 + PRIME64_4;
+        }
+
+        void stripe( uint64_t* _v, const unsigned char* _p ) {
+            _v[0] = xxh_round( _v[0], read64( _p ) );
+            _v[1] = xxh_round( _v[1], read64( _p + 8 ) );
+            _v[2] = xxh_round( _v[2], read64( _p + 16 ) );
+            _v[3] = xxh_round( _v[3], read64( _p + 24 ) );
+        }
+
+    }; // namespace
+
+    error
+    XXH64Strategy::init( boost::any& _context ) const {
+        xxh64_context ctx;
+        memset( &ctx, 0, sizeof( ctx ) );
+        ctx.v[0] = PRIME64_1 + PRIME64_2;
+        ctx.v[1] = PRIME64_2;
+        ctx.v[2] = 0;
+        ctx.v[3] = 0 - PRIME64_1;
+        _context = ctx;
+        return SUCCESS();
+    }
+
+    error
+    XXH64Strategy::update( const char* data, size_t len, boost::any& _context ) const {
+        xxh64_context* ctx = boost::any_cast<xxh64_context>( &_context );
+        const unsigned char* p = ( const unsigned char* )data;
+        const unsigned char* end = p + len;
+        ctx->total_len += len;
+
+        // =-=-=-=-=-=-=-
+        // complete a stripe left over from the last update
+        if ( ctx->mem_size > 0 ) {
+            size_t n = std::min( sizeof( ctx->mem ) - ctx->mem_size, len );
+            memcpy( ctx->mem + ctx->mem_size, p, n );
+            ctx->mem_size += n;
+            p += n;
+            if ( ctx->mem_size < sizeof( ctx->mem ) ) {
+                return SUCCESS();
+            }
+            stripe( ctx->v, ctx->mem );
+            ctx->mem_size = 0;
+        }
+
+        while ( end - p >= 32 ) {
+            stripe( ctx->v, p );
+            p += 32;
+        }
+
+        if ( p < end ) {
+            memcpy( ctx->mem, p, end - p );
+            ctx->mem_size = end - p;
+        }
+        return SUCCESS();
+    }
+
+    error
+    XXH64Strategy::digest( std::string& _messageDigest, boost::any& _context ) const {
+        xxh64_context* ctx = boost::any_cast<xxh64_context>( &_context );
+        uint64_t h;
+        if ( ctx->total_len >= 32 ) {
+            h = rotl( ctx->v[0], 1 ) + rotl( ctx->v[1], 7 ) +
+                rotl( ctx->v[2], 12 ) + rotl( ctx->v[3], 18 );
+            for ( int i = 0; i < 4; ++i ) {
+                h = merge_round( h, ctx->v[i] );
+            }
+        }
+        else {
+            h = PRIME64_5;
+        }
+        h += ctx->total_len;
+
+        const unsigned char* p = ctx->mem;
+        const unsigned char* end = p + ctx->mem_size;
+        while ( end - p >= 8 ) {
+            h ^= xxh_round( 0, read64( p ) );
+            h  = rotl( h, 27 ) * PRIME64_1 + PRIME64_4;
+            p += 8;
+        }
+        if ( end - p >= 4 ) {
+            h ^= read32( p ) * PRIME64_1;
+            h  = rotl( h, 23 ) * PRIME64_2 + PRIME64_3;
+            p += 4;
+        }
+        while ( p < end ) {
+            h ^= ( *p ) * PRIME64_5;
+            h  = rotl( h, 11 ) * PRIME64_1;
+            p++;
+        }
+
+        h ^= h >> 33;
+        h *= PRIME64_2;
+        h ^= h >> 29;
+        h *= PRIME64_3;
+        h ^= h >> 32;
+
+        std::stringstream ins;
+        ins << XXH64_CHKSUM_PREFIX << std::setfill( '0' ) << std::setw( 16 ) << std::hex << h;
+        _messageDigest = ins.str();
+        return SUCCESS();
+    }
+
+    bool
+    XXH64Strategy::isChecksum( const std::string& _chksum ) const {
+        return boost::starts_with( _chksum, XXH64_CHKSUM_PREFIX );
+    }
+}; // namespace irods
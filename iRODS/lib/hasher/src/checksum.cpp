@@ -7,15 +7,59 @@
 #include "irods_log.hpp"
 #include "objInfo.h"
 #include "MD5Strategy.hpp"
+#include "SHA256TreeStrategy.hpp"
 #include "rodsKeyWdDef.h"
 #include "rcMisc.h"
 #include "checksum.hpp"
 
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <boost/thread/thread.hpp>
 #include "irods_stacktrace.hpp"
 
 #define HASH_BUF_SZ (1024*1024)
 
+namespace {
+    // =-=-=-=-=-=-=-
+    // a local file for the parallel tree hash, the handle is the file descriptor
+    class local_tree_hash_file : public irods::tree_hash_file {
+        public:
+            local_tree_hash_file( const char* _file_name ) : file_name_( _file_name ) {}
+
+            irods::error open( rodsLong_t _offset, boost::any& _handle ) {
+                int fd = ::open( file_name_, O_RDONLY );
+                if ( fd < 0 ) {
+                    return ERROR( UNIX_FILE_OPEN_ERR - errno, file_name_ );
+                }
+                if ( lseek( fd, _offset, SEEK_SET ) < 0 ) {
+                    int status = UNIX_FILE_LSEEK_ERR - errno;
+                    ::close( fd );
+                    return ERROR( status, file_name_ );
+                }
+                _handle = fd;
+                return SUCCESS();
+            }
+
+            irods::error read( boost::any& _handle, char* _buf, int _len ) {
+                int bytes_read = ::read( boost::any_cast<int>( _handle ), _buf, _len );
+                if ( bytes_read < 0 ) {
+                    return ERROR( UNIX_FILE_READ_ERR - errno, file_name_ );
+                }
+                return CODE( bytes_read );
+            }
+
+            irods::error close( boost::any& _handle ) {
+                ::close( boost::any_cast<int>( _handle ) );
+                return SUCCESS();
+            }
+
+        private:
+            const char* file_name_;
+    };
+}; // namespace
+
 int chksumLocFile(
     char*       _file_name,
     char*       _checksum,
@@ -124,6 +168,39 @@ int chksumLocFile(
 
     }
 
+    // =-=-=-=-=-=-=-
+    // the chunks of a tree hash are hashed by a thread per core
+    if ( irods::SHA256_TREE_NAME == final_scheme ) {
+        struct stat stat_buf;
+        if ( stat( _file_name, &stat_buf ) < 0 ) {
+            status = UNIX_FILE_STAT_ERR - errno;
+            rodsLogError(
+                LOG_ERROR,
+                status,
+                "chksumLocFile - stat failed for %s, status = %d",
+                _file_name,
+                status );
+            return status;
+        }
+
+        local_tree_hash_file tree_file( _file_name );
+        std::string digest;
+        ret = irods::sha256_tree_hash(
+                  tree_file,
+                  stat_buf.st_size,
+                  boost::thread::hardware_concurrency(),
+                  digest );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return ret.code();
+        }
+        strncpy(
+            _checksum,
+            digest.c_str(),
+            digest.size() + 1 );
+        return 0;
+    }
+
     // =-=-=-=-=-=-=-
     // open the local file
     std::ifstream in_file(
@@ -2,6 +2,8 @@
 #include "checksum.hpp"
 #include "MD5Strategy.hpp"
 #include "SHA256Strategy.hpp"
+#include "SHA256TreeStrategy.hpp"
+#include "XXH64Strategy.hpp"
 #include "rodsErrorTable.h"
 #include <sstream>
 #include <boost/unordered_map.hpp>
@@ -11,12 +13,16 @@ namespace irods {
     namespace {
         const SHA256Strategy _sha256;
         const MD5Strategy _md5;
+        const SHA256TreeStrategy _sha256_tree;
+        const XXH64Strategy _xxh64;
 
         boost::unordered_map<const std::string, const HashStrategy*>
         make_map() {
             boost::unordered_map<const std::string, const HashStrategy*> map;
             map[ SHA256_NAME ] = &_sha256;
             map[ MD5_NAME ] = &_md5;
+            map[ SHA256_TREE_NAME ] = &_sha256_tree;
+            map[ XXH64_NAME ] = &_xxh64;
             return map;
         }
 
@@ -0,0 +1,280 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* bulkregtest.c - register more data objects with one rcBulkDataObjReg
+ * call than the catalog inserts in one statement, then check that every
+ * object was registered once, with a distinct data id and an owner ACL.
+ * The objects are unregistered again afterwards; no files are created.
+ *
+ * usage: bulkregtest [-n rows] collection resource
+ */
+
+#include "rodsClient.h"
+
+#include <set>
+#include <string>
+
+/* more than the rows per INSERT statement of the database plugin */
+#define DEF_BULK_REG_TEST_ROWS 250
+
+#define BULK_REG_TEST_PREFIX   "bulkregtest"
+
+static void
+allocBulkRegColumn( genQueryOut_t *bulkDataObjRegInp, int inx, int attriInx,
+                    int len, int rowCnt ) {
+    bulkDataObjRegInp->sqlResult[inx].attriInx = attriInx;
+    bulkDataObjRegInp->sqlResult[inx].len = len;
+    bulkDataObjRegInp->sqlResult[inx].value = ( char * )malloc( len * rowCnt );
+    bzero( bulkDataObjRegInp->sqlResult[inx].value, len * rowCnt );
+}
+
+/* the columns of initBulkDataObjRegInp, for rowCnt rows rather than
+ * MAX_NUM_BULK_OPR_FILES */
+static void
+initBulkRegInp( genQueryOut_t *bulkDataObjRegInp, const char *collection,
+                const char *rescName, const char *vaultPath, int rowCnt ) {
+    int i;
+
+    memset( bulkDataObjRegInp, 0, sizeof( genQueryOut_t ) );
+    bulkDataObjRegInp->attriCnt = 10;
+    allocBulkRegColumn( bulkDataObjRegInp, 0, COL_DATA_NAME, MAX_NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 1, COL_DATA_TYPE_NAME, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 2, COL_DATA_SIZE, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 3, COL_D_RESC_NAME, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 4, COL_D_DATA_PATH, MAX_NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 5, COL_DATA_MODE, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 6, OPR_TYPE_INX, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 7, COL_DATA_REPL_NUM, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 8, COL_D_DATA_CHECKSUM, NAME_LEN, rowCnt );
+    allocBulkRegColumn( bulkDataObjRegInp, 9, COL_D_RESC_HIER, MAX_NAME_LEN, rowCnt );
+    bulkDataObjRegInp->continueInx = -1;
+
+    for ( i = 0; i < rowCnt; i++ ) {
+        snprintf( &bulkDataObjRegInp->sqlResult[0].value[MAX_NAME_LEN * i],
+                  MAX_NAME_LEN, "%s/%s.%d", collection, BULK_REG_TEST_PREFIX, i );
+        rstrcpy( &bulkDataObjRegInp->sqlResult[1].value[NAME_LEN * i],
+                 "generic", NAME_LEN );
+        snprintf( &bulkDataObjRegInp->sqlResult[2].value[NAME_LEN * i],
+                  NAME_LEN, "%d", i );
+        rstrcpy( &bulkDataObjRegInp->sqlResult[3].value[NAME_LEN * i],
+                 rescName, NAME_LEN );
+        snprintf( &bulkDataObjRegInp->sqlResult[4].value[MAX_NAME_LEN * i],
+                  MAX_NAME_LEN, "%s/%s/%s.%d", vaultPath, BULK_REG_TEST_PREFIX,
+                  BULK_REG_TEST_PREFIX, i );
+        snprintf( &bulkDataObjRegInp->sqlResult[5].value[NAME_LEN * i],
+                  NAME_LEN, "%d", 0600 );
+        rstrcpy( &bulkDataObjRegInp->sqlResult[6].value[NAME_LEN * i],
+                 REGISTER_OPR, NAME_LEN );
+        snprintf( &bulkDataObjRegInp->sqlResult[7].value[NAME_LEN * i],
+                  NAME_LEN, "%d", 0 );
+        rstrcpy( &bulkDataObjRegInp->sqlResult[9].value[MAX_NAME_LEN * i],
+                 rescName, MAX_NAME_LEN );
+    }
+    bulkDataObjRegInp->rowCnt = rowCnt;
+}
+
+static int
+getVaultPath( rcComm_t *conn, const char *rescName, char *vaultPath ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    char condStr[MAX_NAME_LEN];
+    int status;
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    addInxIval( &genQueryInp.selectInp, COL_R_VAULT_PATH, 1 );
+    snprintf( condStr, MAX_NAME_LEN, "='%s'", rescName );
+    addInxVal( &genQueryInp.sqlCondInp, COL_R_RESC_NAME, condStr );
+    genQueryInp.maxRows = 1;
+
+    status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    if ( status >= 0 ) {
+        rstrcpy( vaultPath, genQueryOut->sqlResult[0].value, MAX_NAME_LEN );
+    }
+    freeGenQueryOut( &genQueryOut );
+    clearGenQueryInp( &genQueryInp );
+    return status;
+}
+
+/* count the registered test objects and their owner ACLs */
+static int
+checkRegistered( rcComm_t *conn, const char *collection, int rowCnt ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    std::set<std::string> names, owned;
+    char condStr[MAX_NAME_LEN];
+    int i, status;
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_ACCESS_NAME, 1 );
+    snprintf( condStr, MAX_NAME_LEN, "='%s'", collection );
+    addInxVal( &genQueryInp.sqlCondInp, COL_COLL_NAME, condStr );
+    snprintf( condStr, MAX_NAME_LEN, "like '%s.%%'", BULK_REG_TEST_PREFIX );
+    addInxVal( &genQueryInp.sqlCondInp, COL_DATA_NAME, condStr );
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    while ( status >= 0 ) {
+        for ( i = 0; i < genQueryOut->rowCnt; i++ ) {
+            std::string name = genQueryOut->sqlResult[0].value +
+                               i * genQueryOut->sqlResult[0].len;
+            names.insert( name );
+            if ( strcmp( genQueryOut->sqlResult[1].value +
+                         i * genQueryOut->sqlResult[1].len, "own" ) == 0 ) {
+                owned.insert( name );
+            }
+        }
+        if ( genQueryOut->continueInx <= 0 ) {
+            break;
+        }
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut( &genQueryOut );
+        status = rcGenQuery( conn, &genQueryInp, &genQueryOut );
+    }
+    freeGenQueryOut( &genQueryOut );
+    clearGenQueryInp( &genQueryInp );
+    if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+        rodsLogError( LOG_ERROR, status, "bulkregtest: rcGenQuery error" );
+        return status;
+    }
+
+    printf( "bulkregtest: %d of %d objects registered, %d with an owner ACL\n",
+            ( int ) names.size(), rowCnt, ( int ) owned.size() );
+    if ( ( int ) names.size() != rowCnt || ( int ) owned.size() != rowCnt ) {
+        return -1;
+    }
+    return 0;
+}
+
+/* the data ids returned must all be set and distinct */
+static int
+checkDataIds( genQueryOut_t *bulkDataObjRegOut, int rowCnt ) {
+    std::set<std::string> ids;
+    sqlResult_t *objId;
+    int i;
+
+    if ( bulkDataObjRegOut == NULL || bulkDataObjRegOut->rowCnt != rowCnt ||
+            ( objId = getSqlResultByInx( bulkDataObjRegOut, COL_D_DATA_ID ) ) == NULL ) {
+        printf( "bulkregtest: expected %d data ids\n", rowCnt );
+        return -1;
+    }
+    for ( i = 0; i < rowCnt; i++ ) {
+        const char *id = &objId->value[objId->len * i];
+        if ( strtoll( id, 0, 0 ) <= 0 || !ids.insert( id ).second ) {
+            printf( "bulkregtest: bad data id [%s] in row %d\n", id, i );
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+unregisterObjects( rcComm_t *conn, const char *collection, int rowCnt ) {
+    dataObjInp_t dataObjInp;
+    int i, status;
+
+    for ( i = 0; i < rowCnt; i++ ) {
+        memset( &dataObjInp, 0, sizeof( dataObjInp ) );
+        snprintf( dataObjInp.objPath, MAX_NAME_LEN, "%s/%s.%d",
+                  collection, BULK_REG_TEST_PREFIX, i );
+        dataObjInp.oprType = UNREG_OPR;
+        addKeyVal( &dataObjInp.condInput, FORCE_FLAG_KW, "" );
+        status = rcDataObjUnlink( conn, &dataObjInp );
+        clearKeyVal( &dataObjInp.condInput );
+        if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+            rodsLogError( LOG_ERROR, status,
+                          "bulkregtest: rcDataObjUnlink of %s error",
+                          dataObjInp.objPath );
+        }
+    }
+}
+
+int
+main( int argc, char **argv ) {
+    rcComm_t *conn;
+    rodsEnv myEnv;
+    rErrMsg_t errMsg;
+    collInp_t collCreateInp;
+    genQueryOut_t bulkDataObjRegInp;
+    genQueryOut_t *bulkDataObjRegOut = NULL;
+    char vaultPath[MAX_NAME_LEN];
+    char *collection, *rescName;
+    int rowCnt = DEF_BULK_REG_TEST_ROWS;
+    int c, status;
+    int failed = 0;
+
+    while ( ( c = getopt( argc, argv, "n:h" ) ) != EOF ) {
+        switch ( c ) {
+        case 'n':
+            rowCnt = atoi( optarg );
+            break;
+        default:
+            printf( "usage: bulkregtest [-n rows] collection resource\n" );
+            exit( 1 );
+        }
+    }
+    if ( optind != argc - 2 || rowCnt <= 0 ) {
+        printf( "usage: bulkregtest [-n rows] collection resource\n" );
+        exit( 1 );
+    }
+    collection = argv[optind];
+    rescName = argv[optind + 1];
+
+    status = getRodsEnv( &myEnv );
+    if ( status < 0 ) {
+        fprintf( stderr, "getRodsEnv error, status = %d\n", status );
+        exit( 1 );
+    }
+
+    memset( &errMsg, 0, sizeof( rErrMsg_t ) );
+    conn = rcConnect( myEnv.rodsHost, myEnv.rodsPort, myEnv.rodsUserName,
+                      myEnv.rodsZone, 1, &errMsg );
+    if ( conn == NULL ) {
+        fprintf( stderr, "rcConnect error\n" );
+        exit( 1 );
+    }
+
+    status = clientLogin( conn );
+    if ( status != 0 ) {
+        rcDisconnect( conn );
+        exit( 7 );
+    }
+
+    status = getVaultPath( conn, rescName, vaultPath );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "bulkregtest: no vault path for resource %s", rescName );
+        rcDisconnect( conn );
+        exit( 2 );
+    }
+
+    memset( &collCreateInp, 0, sizeof( collCreateInp ) );
+    rstrcpy( collCreateInp.collName, collection, MAX_NAME_LEN );
+    status = rcCollCreate( conn, &collCreateInp );
+    if ( status < 0 && status != CATALOG_ALREADY_HAS_ITEM_BY_THAT_NAME ) {
+        rodsLogError( LOG_ERROR, status,
+                      "bulkregtest: rcCollCreate of %s error", collection );
+        rcDisconnect( conn );
+        exit( 2 );
+    }
+
+    initBulkRegInp( &bulkDataObjRegInp, collection, rescName, vaultPath, rowCnt );
+    status = rcBulkDataObjReg( conn, &bulkDataObjRegInp, &bulkDataObjRegOut );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "bulkregtest: rcBulkDataObjReg error" );
+        failed = 1;
+    }
+    else if ( checkDataIds( bulkDataObjRegOut, rowCnt ) < 0 ||
+              checkRegistered( conn, collection, rowCnt ) < 0 ) {
+        failed = 1;
+    }
+
+    unregisterObjects( conn, collection, rowCnt );
+    clearGenQueryOut( &bulkDataObjRegInp );
+    freeGenQueryOut( &bulkDataObjRegOut );
+    rcDisconnect( conn );
+
+    if ( !failed ) {
+        printf( "bulkregtest: passed\n" );
+    }
+    exit( failed );
+}
@@ -0,0 +1,154 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* cryptframetest.c - test the encrypted frames of the parallel portal
+ * streams over a socket pair. Frames written in order must decrypt for
+ * every cipher. For the GCM ciphers, whatever the spelling of the name,
+ * a frame read at another offset than the one it was encrypted at, a
+ * replayed frame and a frame with a flipped byte must fail to decrypt.
+ *
+ * usage: cryptframetest
+ */
+
+#include "rodsClient.h"
+#include "irods_buffer_encryption.hpp"
+#include "irods_transfer_pipeline.hpp"
+
+#include <sys/socket.h>
+
+#define FRAME_LEN    1000
+#define MAX_FRAME    ( 2 * FRAME_LEN )
+
+static int Failed = 0;
+
+static void
+fillFrame( irods::transfer_pipeline::frame& frame, rodsLong_t offset ) {
+    int i;
+
+    frame.plain.resize( FRAME_LEN );
+    for ( i = 0; i < FRAME_LEN; i++ ) {
+        frame.plain[i] = ( unsigned char )( ( offset + i ) * 31 );
+    }
+    frame.length = FRAME_LEN;
+    frame.offset = offset;
+}
+
+static int
+encryptFrame( irods::buffer_crypt& crypt, irods::buffer_crypt::array_t& key,
+              irods::transfer_pipeline::frame& frame, rodsLong_t offset ) {
+    fillFrame( frame, offset );
+    return irods::encrypt_frame( crypt, key, frame );
+}
+
+/* send the frames in the given order and read them back expecting the
+ * given offsets, returning the number of frames which decrypted */
+static int
+sendAndRead( irods::buffer_crypt& crypt, irods::buffer_crypt::array_t& key,
+             irods::transfer_pipeline::frame *frames, int cnt,
+             const rodsLong_t *expected ) {
+    irods::transfer_pipeline::frame frame, sent;
+    int sock[2];
+    int i, status;
+    int okCnt = 0;
+
+    if ( socketpair( AF_UNIX, SOCK_STREAM, 0, sock ) < 0 ) {
+        printf( "cryptframetest: socketpair failed, errno = %d\n", errno );
+        exit( 1 );
+    }
+    for ( i = 0; i < cnt; i++ ) {
+        if ( irods::write_encrypted_frame( sock[0], frames[i] ) < 0 ) {
+            printf( "cryptframetest: write_encrypted_frame failed\n" );
+            exit( 1 );
+        }
+    }
+    for ( i = 0; i < cnt; i++ ) {
+        status = irods::read_encrypted_frame( sock[1], MAX_FRAME, crypt, key,
+                                              expected[i], frame );
+        if ( status < 0 ) {
+            continue;
+        }
+        fillFrame( sent, expected[i] );
+        if ( frame.plain != sent.plain || frame.offset != expected[i] ) {
+            printf( "cryptframetest: frame at %lld decrypted to other data\n",
+                    expected[i] );
+            Failed = 1;
+            continue;
+        }
+        okCnt++;
+    }
+    close( sock[0] );
+    close( sock[1] );
+    return okCnt;
+}
+
+static void
+expectCnt( const char *algorithm, const char *what, int okCnt, int expected ) {
+    if ( okCnt != expected ) {
+        printf( "cryptframetest: %s, %s: %d frames decrypted, expected %d\n",
+                algorithm, what, okCnt, expected );
+        Failed = 1;
+    }
+}
+
+static void
+testAlgorithm( const char *algorithm, bool aead ) {
+    irods::buffer_crypt crypt( 32, 8, 16, algorithm );
+    irods::buffer_crypt::array_t key;
+    irods::transfer_pipeline::frame frames[2];
+    const rodsLong_t inOrder[] = { 0, FRAME_LEN };
+    irods::error ret;
+
+    if ( crypt.is_aead() != aead ) {
+        printf( "cryptframetest: %s is_aead is %d, expected %d\n",
+                algorithm, crypt.is_aead(), aead );
+        Failed = 1;
+        return;
+    }
+    if ( crypt.iv_size() != ( aead ? irods::buffer_crypt::AEAD_IV_SIZE : 32 ) ) {
+        printf( "cryptframetest: %s iv_size is %d\n", algorithm, crypt.iv_size() );
+        Failed = 1;
+    }
+
+    ret = irods::buffer_crypt::generate_key( key, 32 );
+    if ( !ret.ok() ||
+            encryptFrame( crypt, key, frames[0], 0 ) < 0 ||
+            encryptFrame( crypt, key, frames[1], FRAME_LEN ) < 0 ) {
+        printf( "cryptframetest: %s, encryption failed\n", algorithm );
+        Failed = 1;
+        return;
+    }
+
+    expectCnt( algorithm, "in order",
+               sendAndRead( crypt, key, frames, 2, inOrder ), 2 );
+    if ( !aead ) {
+        printf( "cryptframetest: %s, %s\n", algorithm, Failed ? "failed" : "ok" );
+        return;
+    }
+
+    /* the frames swapped on the wire */
+    irods::transfer_pipeline::frame swapped[2] = { frames[1], frames[0] };
+    expectCnt( algorithm, "swapped",
+               sendAndRead( crypt, key, swapped, 2, inOrder ), 0 );
+
+    /* the first frame replayed in place of the second */
+    irods::transfer_pipeline::frame replayed[2] = { frames[0], frames[0] };
+    expectCnt( algorithm, "replayed",
+               sendAndRead( crypt, key, replayed, 2, inOrder ), 1 );
+
+    /* a flipped byte in the cipher text */
+    irods::transfer_pipeline::frame tampered[2] = { frames[0], frames[1] };
+    tampered[1].cipher[10] ^= 1;
+    expectCnt( algorithm, "tampered",
+               sendAndRead( crypt, key, tampered, 2, inOrder ), 1 );
+
+    printf( "cryptframetest: %s, %s\n", algorithm, Failed ? "failed" : "ok" );
+}
+
+int
+main( int argc, char **argv ) {
+    testAlgorithm( "aes-256-cbc", false );
+    testAlgorithm( "aes-256-gcm", true );
+    testAlgorithm( "AES-256-GCM", true );
+    testAlgorithm( "id-aes256-GCM", true );
+
+    exit( Failed );
+}
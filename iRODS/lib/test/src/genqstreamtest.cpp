@@ -0,0 +1,214 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* genqstreamtest.c - test the streaming general query against paging with
+ * rcGenQuery. The query is run with small batches and a window of one
+ * batch, so the server has to wait for the client on every batch, and is
+ * then cancelled after the first batch to check that the connection is
+ * still usable afterwards.
+ *
+ * usage: genqstreamtest [-r rowsPerBatch] [-w window] selectConditionString
+ */
+
+#include "rodsClient.h"
+
+#include <string>
+#include <vector>
+
+/* append the rows of genQueryOut to rows, one string per row */
+static void
+appendRows( genQueryOut_t *genQueryOut, std::vector<std::string>& rows ) {
+    int i, j;
+
+    for ( i = 0; i < genQueryOut->rowCnt; i++ ) {
+        std::string row;
+        for ( j = 0; j < genQueryOut->attriCnt; j++ ) {
+            row += genQueryOut->sqlResult[j].value +
+                   i * genQueryOut->sqlResult[j].len;
+            row += "|";
+        }
+        rows.push_back( row );
+    }
+}
+
+static int
+pagedQuery( rcComm_t *conn, genQueryInp_t *genQueryInp,
+            std::vector<std::string>& rows ) {
+    genQueryOut_t *genQueryOut = NULL;
+    int status;
+
+    genQueryInp->continueInx = 0;
+    status = rcGenQuery( conn, genQueryInp, &genQueryOut );
+    while ( status >= 0 ) {
+        appendRows( genQueryOut, rows );
+        if ( genQueryOut->continueInx <= 0 ) {
+            break;
+        }
+        genQueryInp->continueInx = genQueryOut->continueInx;
+        freeGenQueryOut( &genQueryOut );
+        status = rcGenQuery( conn, genQueryInp, &genQueryOut );
+    }
+    freeGenQueryOut( &genQueryOut );
+    genQueryInp->continueInx = 0;
+    return status == CAT_NO_ROWS_FOUND ? 0 : status;
+}
+
+/* read at most maxBatches batches of the stream, all of them if zero */
+static int
+streamQuery( rcComm_t *conn, genQueryInp_t *genQueryInp, int window,
+             int maxBatches, std::vector<std::string>& rows ) {
+    genQueryStreamInp_t genQueryStreamInp;
+    genQueryStream_t stream;
+    genQueryOut_t *genQueryOut = NULL;
+    int batchCnt = 0;
+    int status;
+
+    memset( &genQueryStreamInp, 0, sizeof( genQueryStreamInp ) );
+    genQueryStreamInp.window = window;
+    genQueryStreamInp.genQueryInp = *genQueryInp;
+    status = rcGenQueryStreamOpen( conn, &genQueryStreamInp, &stream );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    while ( ( status = rcGenQueryStreamNext( &stream, &genQueryOut ) ) == 0 ) {
+        if ( genQueryOut->rowCnt > genQueryInp->maxRows ) {
+            printf( "genqstreamtest: batch of %d rows, expected at most %d\n",
+                    genQueryOut->rowCnt, genQueryInp->maxRows );
+            status = SYS_INTERNAL_ERR;
+        }
+        appendRows( genQueryOut, rows );
+        freeGenQueryOut( &genQueryOut );
+        batchCnt++;
+        if ( status < 0 || ( maxBatches > 0 && batchCnt >= maxBatches ) ) {
+            break;
+        }
+    }
+
+    int closeStatus = rcGenQueryStreamClose( &stream );
+    if ( status == CAT_NO_ROWS_FOUND ) {
+        status = 0;
+    }
+    return status < 0 ? status : closeStatus;
+}
+
+static int
+compareRows( const char *what, std::vector<std::string>& expected,
+             std::vector<std::string>& rows ) {
+    if ( rows != expected ) {
+        printf( "genqstreamtest: %s returned %d rows, paging returned %d\n",
+                what, ( int ) rows.size(), ( int ) expected.size() );
+        return -1;
+    }
+    printf( "genqstreamtest: %s returned the same %d rows\n",
+            what, ( int ) rows.size() );
+    return 0;
+}
+
+int
+main( int argc, char **argv ) {
+    rcComm_t *conn;
+    rodsEnv myEnv;
+    rErrMsg_t errMsg;
+    genQueryInp_t genQueryInp;
+    std::vector<std::string> expected, rows;
+    int rowsPerBatch = 2;
+    int window = 1;
+    int c, status;
+    int failed = 0;
+
+    while ( ( c = getopt( argc, argv, "r:w:h" ) ) != EOF ) {
+        switch ( c ) {
+        case 'r':
+            rowsPerBatch = atoi( optarg );
+            break;
+        case 'w':
+            window = atoi( optarg );
+            break;
+        default:
+            printf( "usage: genqstreamtest [-r rowsPerBatch] [-w window] selectConditionString\n" );
+            exit( 1 );
+        }
+    }
+    if ( optind != argc - 1 || rowsPerBatch <= 0 || window <= 0 ) {
+        printf( "usage: genqstreamtest [-r rowsPerBatch] [-w window] selectConditionString\n" );
+        exit( 1 );
+    }
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    status = fillGenQueryInpFromStrCond( argv[optind], &genQueryInp );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "genqstreamtest: bad query" );
+        exit( 1 );
+    }
+    genQueryInp.maxRows = rowsPerBatch;
+
+    status = getRodsEnv( &myEnv );
+    if ( status < 0 ) {
+        fprintf( stderr, "getRodsEnv error, status = %d\n", status );
+        exit( 1 );
+    }
+
+    memset( &errMsg, 0, sizeof( rErrMsg_t ) );
+    conn = rcConnect( myEnv.rodsHost, myEnv.rodsPort, myEnv.rodsUserName,
+                      myEnv.rodsZone, 1, &errMsg );
+    if ( conn == NULL ) {
+        fprintf( stderr, "rcConnect error\n" );
+        exit( 1 );
+    }
+
+    status = clientLogin( conn );
+    if ( status != 0 ) {
+        rcDisconnect( conn );
+        exit( 7 );
+    }
+
+    status = pagedQuery( conn, &genQueryInp, expected );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "genqstreamtest: rcGenQuery error" );
+        rcDisconnect( conn );
+        exit( 2 );
+    }
+    if ( ( int ) expected.size() <= rowsPerBatch * ( window + 1 ) ) {
+        printf( "genqstreamtest: warning, %d rows do not fill the window\n",
+                ( int ) expected.size() );
+    }
+
+    /* the whole result, with the server waiting on the window */
+    status = streamQuery( conn, &genQueryInp, window, 0, rows );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "genqstreamtest: stream error" );
+        failed = 1;
+    }
+    else if ( compareRows( "stream", expected, rows ) < 0 ) {
+        failed = 1;
+    }
+
+    /* cancel after the first batch */
+    rows.clear();
+    status = streamQuery( conn, &genQueryInp, window, 1, rows );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "genqstreamtest: cancelled stream error" );
+        failed = 1;
+    }
+    else if ( ( int ) rows.size() > rowsPerBatch ) {
+        printf( "genqstreamtest: cancelled stream returned %d rows\n",
+                ( int ) rows.size() );
+        failed = 1;
+    }
+
+    /* the connection must be back in step with the server */
+    rows.clear();
+    status = pagedQuery( conn, &genQueryInp, rows );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "genqstreamtest: rcGenQuery error after cancel" );
+        failed = 1;
+    }
+    else if ( compareRows( "paging after cancel", expected, rows ) < 0 ) {
+        failed = 1;
+    }
+
+    clearGenQueryInp( &genQueryInp );
+    rcDisconnect( conn );
+    exit( failed );
+}
@@ -0,0 +1,141 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* kvpbench.c - measure the keyValPair_t operations on the request path:
+ * building the condInput of a put, the getValByKey lookups the server
+ * does while serving it, and the pack/unpack round trip of the request.
+ *
+ * usage: kvpbench [-n iterations] [-k extraKeywords]
+ */
+
+#include "rodsClient.h"
+#include "packStruct.h"
+
+#include <sys/time.h>
+
+static double
+nowSec() {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* keywords an iput typically carries in its condInput */
+static const char *PutKw[] = {
+    DEST_RESC_NAME_KW, RESC_NAME_KW, DATA_TYPE_KW, FORCE_FLAG_KW,
+    REG_CHKSUM_KW, DATA_INCLUDED_KW, OPR_TYPE_KW, RESC_HIER_STR_KW
+};
+
+/* keywords the server looks up while serving a put */
+static const char *LookupKw[] = {
+    FORCE_FLAG_KW, RESC_HIER_STR_KW, NO_PARA_OP_KW, LOCAL_PATH_KW,
+    DEST_RESC_NAME_KW, DEF_RESC_NAME_KW, BACKUP_RESC_NAME_KW, IN_PDMO_KW,
+    VERIFY_CHKSUM_KW, REG_CHKSUM_KW, ALL_KW, REPL_NUM_KW, ADMIN_KW,
+    NO_OPEN_FLAG_KW, PHYOPEN_BY_SIZE_KW, DATA_TYPE_KW, COLLECTION_KW,
+    DATA_SIZE_KW, FILE_PATH_KW, ZONE_KW
+};
+
+#define NUM_PUT_KW      ( int )( sizeof( PutKw ) / sizeof( PutKw[0] ) )
+#define NUM_LOOKUP_KW   ( int )( sizeof( LookupKw ) / sizeof( LookupKw[0] ) )
+
+static void
+buildCondInput( keyValPair_t *condInput, int numExtra ) {
+    char kw[NAME_LEN];
+    int i;
+
+    for ( i = 0; i < NUM_PUT_KW; i++ ) {
+        addKeyVal( condInput, PutKw[i], "demoResc" );
+    }
+    for ( i = 0; i < numExtra; i++ ) {
+        snprintf( kw, NAME_LEN, "extraKw%d", i );
+        addKeyVal( condInput, kw, "1" );
+    }
+}
+
+int
+main( int argc, char **argv ) {
+    dataObjInp_t dataObjInp, *outDataObjInp;
+    bytesBuf_t *packedResult;
+    int iterations = 1000000;
+    int numExtra = 0;
+    int found = 0;
+    int i, j, c, status;
+    double start, elapsed;
+
+    while ( ( c = getopt( argc, argv, "n:k:h" ) ) != EOF ) {
+        switch ( c ) {
+        case 'n':
+            iterations = atoi( optarg );
+            break;
+        case 'k':
+            numExtra = atoi( optarg );
+            break;
+        default:
+            printf( "usage: kvpbench [-n iterations] [-k extraKeywords]\n" );
+            exit( 1 );
+        }
+    }
+    if ( iterations <= 0 || numExtra < 0 ) {
+        printf( "usage: kvpbench [-n iterations] [-k extraKeywords]\n" );
+        exit( 1 );
+    }
+
+    /* build and clear */
+    start = nowSec();
+    for ( i = 0; i < iterations; i++ ) {
+        memset( &dataObjInp, 0, sizeof( dataObjInp ) );
+        buildCondInput( &dataObjInp.condInput, numExtra );
+        clearKeyVal( &dataObjInp.condInput );
+    }
+    elapsed = nowSec() - start;
+    printf( "addKeyVal:   %d keywords, %8.1f ns/keyword\n",
+            NUM_PUT_KW + numExtra,
+            elapsed * 1e9 / ( ( double ) iterations * ( NUM_PUT_KW + numExtra ) ) );
+
+    /* lookups */
+    memset( &dataObjInp, 0, sizeof( dataObjInp ) );
+    rstrcpy( dataObjInp.objPath, "/tempZone/home/rods/kvpbench", MAX_NAME_LEN );
+    buildCondInput( &dataObjInp.condInput, numExtra );
+    start = nowSec();
+    for ( i = 0; i < iterations; i++ ) {
+        for ( j = 0; j < NUM_LOOKUP_KW; j++ ) {
+            if ( getValByKey( &dataObjInp.condInput, LookupKw[j] ) != NULL ) {
+                found++;
+            }
+        }
+    }
+    elapsed = nowSec() - start;
+    printf( "getValByKey: %d lookups, %d hits, %8.1f ns/lookup\n",
+            NUM_LOOKUP_KW, found / iterations,
+            elapsed * 1e9 / ( ( double ) iterations * NUM_LOOKUP_KW ) );
+
+    /* wire round trip */
+    start = nowSec();
+    for ( i = 0; i < iterations / 100 + 1; i++ ) {
+        status = packStruct( &dataObjInp, &packedResult, "DataObjInp_PI",
+                             NULL, 0, NATIVE_PROT );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status, "kvpbench: packStruct error" );
+            exit( 1 );
+        }
+        status = unpackStruct( packedResult->buf, ( void ** ) &outDataObjInp,
+                               "DataObjInp_PI", NULL, NATIVE_PROT );
+        freeBBuf( packedResult );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status, "kvpbench: unpackStruct error" );
+            exit( 1 );
+        }
+        if ( outDataObjInp->condInput.len != dataObjInp.condInput.len ||
+                getValByKey( &outDataObjInp->condInput, RESC_HIER_STR_KW ) == NULL ) {
+            printf( "kvpbench: condInput changed on the wire\n" );
+            exit( 1 );
+        }
+        clearDataObjInp( outDataObjInp );
+        free( outDataObjInp );
+    }
+    elapsed = nowSec() - start;
+    printf( "pack/unpack: DataObjInp_PI, %8.1f ns/round trip\n",
+            elapsed * 1e9 / ( iterations / 100 + 1 ) );
+
+    clearKeyVal( &dataObjInp.condInput );
+    return 0;
+}
@@ -0,0 +1,308 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* kvptest.c - test addKeyVal, getValByKey and rmKeyVal against a plain
+ * list of keyword/value pairs. The keywords share first characters so
+ * the lookup has to fall through to strcmp, the list grows past several
+ * PTR_ARRAY_MALLOC_LEN chunks, and entries are replaced, removed, left
+ * with a NULL keyword or a NULL value, and packed and unpacked in both
+ * protocols.
+ *
+ * usage: kvptest
+ */
+
+#include "rodsClient.h"
+#include "packStruct.h"
+
+#include <string>
+#include <vector>
+
+/* the expected contents of a keyValPair_t, in order */
+typedef struct {
+    std::string keyWord;
+    std::string value;
+    bool nullValue;
+} kvp_t;
+
+typedef std::vector<kvp_t> kvpList_t;
+
+static int Failed = 0;
+
+static void
+fail( const char *what, const char *detail, const char *keyWord ) {
+    printf( "kvptest: %s: %s %s\n", what, detail, keyWord ? keyWord : "(null)" );
+    Failed = 1;
+}
+
+static void
+addExpected( kvpList_t& expected, const char *keyWord, const char *value ) {
+    for ( size_t i = 0; i < expected.size(); i++ ) {
+        if ( expected[i].keyWord == keyWord ) {
+            expected[i].value = value ? value : "";
+            expected[i].nullValue = value == NULL;
+            return;
+        }
+    }
+    kvp_t kvp;
+    kvp.keyWord = keyWord;
+    kvp.value = value ? value : "";
+    kvp.nullValue = value == NULL;
+    expected.push_back( kvp );
+}
+
+static void
+rmExpected( kvpList_t& expected, const char *keyWord ) {
+    for ( size_t i = 0; i < expected.size(); i++ ) {
+        if ( expected[i].keyWord == keyWord ) {
+            expected.erase( expected.begin() + i );
+            return;
+        }
+    }
+}
+
+/* add to both the condInput and the expected list */
+static void
+addBoth( keyValPair_t *condInput, kvpList_t& expected, const char *keyWord,
+         const char *value ) {
+    int status = addKeyVal( condInput, keyWord, value );
+    if ( status < 0 ) {
+        fail( "addKeyVal", "error adding", keyWord );
+    }
+    addExpected( expected, keyWord, value );
+}
+
+static void
+rmBoth( keyValPair_t *condInput, kvpList_t& expected, const char *keyWord ) {
+    rmKeyVal( condInput, ( char * ) keyWord );
+    rmExpected( expected, keyWord );
+}
+
+/* check the entries, their order, and a lookup of each keyword */
+static void
+checkKvp( const char *what, keyValPair_t *condInput, kvpList_t& expected ) {
+    int i;
+
+    if ( condInput->len != ( int ) expected.size() ) {
+        printf( "kvptest: %s: len is %d, expected %d\n", what,
+                condInput->len, ( int ) expected.size() );
+        Failed = 1;
+        return;
+    }
+    if ( condInput->len == 0 ) {
+        if ( condInput->keyWord != NULL || condInput->value != NULL ) {
+            fail( what, "arrays not freed when empty", "" );
+        }
+        return;
+    }
+    for ( i = 0; i < condInput->len; i++ ) {
+        const char *keyWord = expected[i].keyWord.c_str();
+        if ( condInput->keyWord[i] == NULL ||
+                strcmp( condInput->keyWord[i], keyWord ) != 0 ) {
+            fail( what, "out of order at", keyWord );
+            continue;
+        }
+        char *value = getValByKey( condInput, keyWord );
+        if ( expected[i].nullValue ) {
+            if ( value != NULL ) {
+                fail( what, "expected a NULL value for", keyWord );
+            }
+        }
+        else if ( value == NULL || expected[i].value != value ) {
+            fail( what, "wrong value for", keyWord );
+        }
+    }
+}
+
+/* keywords which are not in the list, some with a matching first char */
+static void
+checkMissing( const char *what, keyValPair_t *condInput,
+              const char **keyWords, int cnt ) {
+    int i;
+
+    for ( i = 0; i < cnt; i++ ) {
+        if ( getValByKey( condInput, keyWords[i] ) != NULL ) {
+            fail( what, "found missing keyword", keyWords[i] );
+        }
+    }
+}
+
+static void
+testEmpty() {
+    keyValPair_t condInput;
+
+    memset( &condInput, 0, sizeof( condInput ) );
+    if ( getValByKey( NULL, "a" ) != NULL ||
+            getValByKey( &condInput, "a" ) != NULL ||
+            getValByKey( &condInput, NULL ) != NULL ) {
+        fail( "empty", "lookup did not return NULL", "a" );
+    }
+    if ( rmKeyVal( NULL, ( char * ) "a" ) != 0 ||
+            rmKeyVal( &condInput, ( char * ) "a" ) != 0 ) {
+        fail( "empty", "rmKeyVal failed for", "a" );
+    }
+    if ( addKeyVal( NULL, "a", "1" ) >= 0 ) {
+        fail( "empty", "addKeyVal to NULL did not fail for", "a" );
+    }
+}
+
+/* keywords sharing their first character */
+static void
+testSharedPrefix() {
+    const char *missing[] = { "abcd", "a b", "aa", "bb", "c", "" };
+    keyValPair_t condInput;
+    kvpList_t expected;
+
+    memset( &condInput, 0, sizeof( condInput ) );
+    addBoth( &condInput, expected, "a", "1" );
+    addBoth( &condInput, expected, "ab", "2" );
+    addBoth( &condInput, expected, "abc", "3" );
+    addBoth( &condInput, expected, "b", "4" );
+    addBoth( &condInput, expected, "ba", "5" );
+    checkKvp( "shared prefix", &condInput, expected );
+    checkMissing( "shared prefix", &condInput, missing,
+                  sizeof( missing ) / sizeof( missing[0] ) );
+
+    /* replacing keeps the position */
+    addBoth( &condInput, expected, "ab", "22" );
+    addBoth( &condInput, expected, "ba", NULL );
+    checkKvp( "replace", &condInput, expected );
+
+    /* remove the middle, the first and the last */
+    rmBoth( &condInput, expected, "abc" );
+    checkKvp( "remove middle", &condInput, expected );
+    rmBoth( &condInput, expected, "a" );
+    checkKvp( "remove first", &condInput, expected );
+    rmBoth( &condInput, expected, "ba" );
+    checkKvp( "remove last", &condInput, expected );
+    rmBoth( &condInput, expected, "abc" );
+    checkKvp( "remove missing", &condInput, expected );
+
+    rmBoth( &condInput, expected, "ab" );
+    rmBoth( &condInput, expected, "b" );
+    checkKvp( "remove all", &condInput, expected );
+
+    clearKeyVal( &condInput );
+}
+
+/* an entry with a NULL or empty keyword is skipped by lookups and reused
+ * by the next addKeyVal */
+static void
+testNullKeyWord() {
+    keyValPair_t condInput;
+    kvpList_t expected;
+
+    memset( &condInput, 0, sizeof( condInput ) );
+    addBoth( &condInput, expected, "x", "1" );
+    addBoth( &condInput, expected, "y", "2" );
+    addBoth( &condInput, expected, "z", "3" );
+
+    free( condInput.keyWord[1] );
+    condInput.keyWord[1] = NULL;
+    if ( getValByKey( &condInput, "z" ) == NULL ||
+            strcmp( getValByKey( &condInput, "z" ), "3" ) != 0 ) {
+        fail( "NULL keyword", "lookup past the entry failed for", "z" );
+    }
+    if ( getValByKey( &condInput, "y" ) != NULL ) {
+        fail( "NULL keyword", "found the cleared keyword", "y" );
+    }
+
+    addKeyVal( &condInput, "w", "4" );
+    expected[1].keyWord = "w";
+    expected[1].value = "4";
+    checkKvp( "NULL keyword reused", &condInput, expected );
+
+    condInput.keyWord[2][0] = '\0';
+    addKeyVal( &condInput, "v", "5" );
+    expected[2].keyWord = "v";
+    expected[2].value = "5";
+    checkKvp( "empty keyword reused", &condInput, expected );
+
+    clearKeyVal( &condInput );
+}
+
+/* more keywords than several allocation chunks */
+static void
+testManyKeys() {
+    keyValPair_t condInput;
+    kvpList_t expected;
+    char keyWord[NAME_LEN], value[NAME_LEN];
+    int cnt = 3 * PTR_ARRAY_MALLOC_LEN + 1;
+    int i;
+
+    memset( &condInput, 0, sizeof( condInput ) );
+    for ( i = 0; i < cnt; i++ ) {
+        snprintf( keyWord, NAME_LEN, "keyWord%d", i );
+        snprintf( value, NAME_LEN, "value%d", i );
+        addBoth( &condInput, expected, keyWord, value );
+    }
+    checkKvp( "many keys", &condInput, expected );
+
+    for ( i = 0; i < cnt; i += 2 ) {
+        snprintf( keyWord, NAME_LEN, "keyWord%d", i );
+        rmBoth( &condInput, expected, keyWord );
+    }
+    checkKvp( "many keys, every other removed", &condInput, expected );
+
+    /* grow back over the freed space */
+    for ( i = 0; i < cnt; i++ ) {
+        snprintf( keyWord, NAME_LEN, "keyWord%d", i );
+        snprintf( value, NAME_LEN, "new%d", i );
+        addBoth( &condInput, expected, keyWord, value );
+    }
+    checkKvp( "many keys, added back", &condInput, expected );
+
+    clearKeyVal( &condInput );
+}
+
+/* the condInput of a request has to survive packing */
+static void
+testRoundTrip( irodsProt_t irodsProt ) {
+    const char *what = irodsProt == XML_PROT ? "XML round trip" : "native round trip";
+    dataObjInp_t dataObjInp;
+    dataObjInp_t *outDataObjInp = NULL;
+    bytesBuf_t *packedResult = NULL;
+    kvpList_t expected;
+    int status;
+
+    memset( &dataObjInp, 0, sizeof( dataObjInp ) );
+    rstrcpy( dataObjInp.objPath, "/tempZone/home/rods/kvptest", MAX_NAME_LEN );
+    addBoth( &dataObjInp.condInput, expected, DEST_RESC_NAME_KW, "demoResc" );
+    addBoth( &dataObjInp.condInput, expected, DATA_TYPE_KW, "generic" );
+    addBoth( &dataObjInp.condInput, expected, FORCE_FLAG_KW, "" );
+    addBoth( &dataObjInp.condInput, expected, DATA_INCLUDED_KW, "" );
+
+    status = packStruct( &dataObjInp, &packedResult, "DataObjInp_PI",
+                         NULL, 0, irodsProt );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "kvptest: %s packStruct error", what );
+        Failed = 1;
+    }
+    else {
+        status = unpackStruct( packedResult->buf, ( void ** ) &outDataObjInp,
+                               "DataObjInp_PI", NULL, irodsProt );
+        freeBBuf( packedResult );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status, "kvptest: %s unpackStruct error", what );
+            Failed = 1;
+        }
+        else {
+            checkKvp( what, &outDataObjInp->condInput, expected );
+            clearDataObjInp( outDataObjInp );
+            free( outDataObjInp );
+        }
+    }
+
+    clearKeyVal( &dataObjInp.condInput );
+}
+
+int
+main( int argc, char **argv ) {
+    testEmpty();
+    testSharedPrefix();
+    testNullKeyWord();
+    testManyKeys();
+    testRoundTrip( NATIVE_PROT );
+    testRoundTrip( XML_PROT );
+
+    printf( "kvptest: %s\n", Failed ? "failed" : "ok" );
+    exit( Failed );
+}
@@ -0,0 +1,133 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* packbench.c - measure packStruct/unpackStruct round trips of a request
+ * (DataObjInp_PI) and of a query reply (GenQueryOut_PI) in both the
+ * native and the XML protocol.
+ *
+ * usage: packbench [-n iterations] [-r rows]
+ */
+
+#include "rodsClient.h"
+#include "packStruct.h"
+
+#include <sys/time.h>
+
+static double
+nowSec() {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+fillDataObjInp( dataObjInp_t *dataObjInp ) {
+    memset( dataObjInp, 0, sizeof( dataObjInp_t ) );
+    rstrcpy( dataObjInp->objPath, "/tempZone/home/rods/packbench",
+             MAX_NAME_LEN );
+    dataObjInp->createMode = 0750;
+    dataObjInp->openFlags = O_WRONLY;
+    dataObjInp->dataSize = 1024 * 1024;
+    dataObjInp->oprType = PUT_OPR;
+    addKeyVal( &dataObjInp->condInput, DEST_RESC_NAME_KW, "demoResc" );
+    addKeyVal( &dataObjInp->condInput, DATA_TYPE_KW, "generic" );
+    addKeyVal( &dataObjInp->condInput, FORCE_FLAG_KW, "" );
+}
+
+static void
+fillGenQueryOut( genQueryOut_t *genQueryOut, int rowCnt ) {
+    int i, j;
+
+    memset( genQueryOut, 0, sizeof( genQueryOut_t ) );
+    genQueryOut->rowCnt = rowCnt;
+    genQueryOut->attriCnt = 3;
+    for ( i = 0; i < genQueryOut->attriCnt; i++ ) {
+        genQueryOut->sqlResult[i].attriInx = COL_DATA_NAME + i;
+        genQueryOut->sqlResult[i].len = NAME_LEN;
+        genQueryOut->sqlResult[i].value = ( char * ) malloc( rowCnt * NAME_LEN );
+        for ( j = 0; j < rowCnt; j++ ) {
+            snprintf( genQueryOut->sqlResult[i].value + j * NAME_LEN, NAME_LEN,
+                      "value%d.%d", i, j );
+        }
+    }
+}
+
+static int
+benchPI( void *inStruct, const char *packInstName, irodsProt_t irodsProt,
+         int iterations ) {
+    bytesBuf_t *packedResult;
+    void *outStruct;
+    int i, status;
+    double start, elapsed;
+
+    start = nowSec();
+    for ( i = 0; i < iterations; i++ ) {
+        status = packStruct( inStruct, &packedResult, packInstName,
+                             NULL, 0, irodsProt );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status,
+                          "packbench: packStruct of %s error", packInstName );
+            return status;
+        }
+        status = unpackStruct( packedResult->buf, &outStruct, packInstName,
+                               NULL, irodsProt );
+        freeBBuf( packedResult );
+        if ( status < 0 ) {
+            rodsLogError( LOG_ERROR, status,
+                          "packbench: unpackStruct of %s error", packInstName );
+            return status;
+        }
+        if ( strcmp( packInstName, "GenQueryOut_PI" ) == 0 ) {
+            clearGenQueryOut( ( genQueryOut_t * ) outStruct );
+        }
+        else {
+            clearDataObjInp( ( dataObjInp_t * ) outStruct );
+        }
+        free( outStruct );
+    }
+    elapsed = nowSec() - start;
+    printf( "%-16s %-6s %10.1f us/round trip\n", packInstName,
+            irodsProt == XML_PROT ? "XML" : "native",
+            elapsed * 1e6 / iterations );
+    return 0;
+}
+
+int
+main( int argc, char **argv ) {
+    dataObjInp_t dataObjInp;
+    genQueryOut_t genQueryOut;
+    int iterations = 10000;
+    int rowCnt = 50;
+    int c, status = 0;
+
+    while ( ( c = getopt( argc, argv, "n:r:h" ) ) != EOF ) {
+        switch ( c ) {
+        case 'n':
+            iterations = atoi( optarg );
+            break;
+        case 'r':
+            rowCnt = atoi( optarg );
+            break;
+        default:
+            printf( "usage: packbench [-n iterations] [-r rows]\n" );
+            exit( 1 );
+        }
+    }
+    if ( iterations <= 0 || rowCnt <= 0 ) {
+        printf( "usage: packbench [-n iterations] [-r rows]\n" );
+        exit( 1 );
+    }
+
+    fillDataObjInp( &dataObjInp );
+    fillGenQueryOut( &genQueryOut, rowCnt );
+
+    if ( benchPI( &dataObjInp, "DataObjInp_PI", NATIVE_PROT, iterations ) < 0 ||
+            benchPI( &dataObjInp, "DataObjInp_PI", XML_PROT, iterations ) < 0 ||
+            benchPI( &genQueryOut, "GenQueryOut_PI", NATIVE_PROT, iterations ) < 0 ||
+            benchPI( &genQueryOut, "GenQueryOut_PI", XML_PROT, iterations ) < 0 ) {
+        status = 1;
+    }
+
+    clearKeyVal( &dataObjInp.condInput );
+    clearGenQueryOut( &genQueryOut );
+    return status;
+}
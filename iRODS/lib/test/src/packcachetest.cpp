@@ -0,0 +1,192 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* packcachetest.c - test that the cached pack instructions give the same
+ * result as parsing the instructions on every call. A request
+ * (DataObjInp_PI, with a condInput and a specColl) and a query reply
+ * (GenQueryOut_PI) are packed in the native and the XML protocol with the
+ * cache off and on, and the packed bytes must be identical. Each packed
+ * buffer is then unpacked with the cache off and on, and the result
+ * repacked without the cache must again give the same bytes.
+ *
+ * usage: packcachetest
+ */
+
+#include "rodsClient.h"
+#include "packStruct.h"
+#include "irods_pack_table.hpp"
+
+#include <string>
+
+static void
+fillDataObjInp( dataObjInp_t *dataObjInp ) {
+    memset( dataObjInp, 0, sizeof( dataObjInp_t ) );
+    rstrcpy( dataObjInp->objPath, "/tempZone/home/rods/packcachetest",
+             MAX_NAME_LEN );
+    dataObjInp->createMode = 0750;
+    dataObjInp->openFlags = O_WRONLY;
+    dataObjInp->offset = 1234567890123LL;
+    dataObjInp->dataSize = 1024 * 1024;
+    dataObjInp->numThreads = 4;
+    dataObjInp->oprType = PUT_OPR;
+    dataObjInp->specColl = ( specColl_t * ) malloc( sizeof( specColl_t ) );
+    memset( dataObjInp->specColl, 0, sizeof( specColl_t ) );
+    dataObjInp->specColl->collClass = MOUNTED_COLL;
+    rstrcpy( dataObjInp->specColl->collection, "/tempZone/home/rods/mnt",
+             MAX_NAME_LEN );
+    rstrcpy( dataObjInp->specColl->phyPath, "/var/lib/irods/mnt", MAX_NAME_LEN );
+    addKeyVal( &dataObjInp->condInput, DEST_RESC_NAME_KW, "demoResc" );
+    addKeyVal( &dataObjInp->condInput, DATA_TYPE_KW, "generic" );
+    addKeyVal( &dataObjInp->condInput, FORCE_FLAG_KW, "" );
+    addKeyVal( &dataObjInp->condInput, RESC_HIER_STR_KW, "a;b<c>&d" );
+}
+
+static void
+fillGenQueryOut( genQueryOut_t *genQueryOut, int rowCnt ) {
+    int i, j;
+
+    memset( genQueryOut, 0, sizeof( genQueryOut_t ) );
+    genQueryOut->rowCnt = rowCnt;
+    genQueryOut->attriCnt = 3;
+    genQueryOut->continueInx = 7;
+    genQueryOut->totalRowCount = rowCnt;
+    for ( i = 0; i < genQueryOut->attriCnt; i++ ) {
+        genQueryOut->sqlResult[i].attriInx = COL_DATA_NAME + i;
+        genQueryOut->sqlResult[i].len = NAME_LEN;
+        genQueryOut->sqlResult[i].value = ( char * ) malloc( rowCnt * NAME_LEN );
+        for ( j = 0; j < rowCnt; j++ ) {
+            snprintf( genQueryOut->sqlResult[i].value + j * NAME_LEN, NAME_LEN,
+                      "value%d.%d", i, j );
+        }
+    }
+}
+
+static void
+freeUnpacked( void *outStruct, const char *packInstName ) {
+    if ( strcmp( packInstName, "GenQueryOut_PI" ) == 0 ) {
+        clearGenQueryOut( outStruct );
+    }
+    else {
+        clearDataObjInp( outStruct );
+    }
+    free( outStruct );
+}
+
+/* pack inStruct into packed, with or without the cache */
+static int
+packWith( bool cached, void *inStruct, const char *packInstName,
+          irodsProt_t irodsProt, std::string& packed ) {
+    bytesBuf_t *packedResult = NULL;
+    int status;
+
+    irods::set_pack_instruct_cache( cached );
+    status = packStruct( inStruct, &packedResult, packInstName,
+                         NULL, 0, irodsProt );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "packcachetest: packStruct of %s error",
+                      packInstName );
+        return status;
+    }
+    packed.assign( ( char * ) packedResult->buf, packedResult->len );
+    freeBBuf( packedResult );
+    return 0;
+}
+
+/* unpack packed with or without the cache and repack it without */
+static int
+repackWith( bool cached, const std::string& packed, const char *packInstName,
+            irodsProt_t irodsProt, std::string& repacked ) {
+    std::string buf( packed );
+    void *outStruct = NULL;
+    int status;
+
+    irods::set_pack_instruct_cache( cached );
+    status = unpackStruct( &buf[0], &outStruct, packInstName, NULL, irodsProt );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "packcachetest: unpackStruct of %s error",
+                      packInstName );
+        return status;
+    }
+    status = packWith( false, outStruct, packInstName, irodsProt, repacked );
+    freeUnpacked( outStruct, packInstName );
+    return status;
+}
+
+static int
+compareBytes( const char *what, const char *packInstName, irodsProt_t irodsProt,
+              const std::string& expected, const std::string& packed ) {
+    if ( packed != expected ) {
+        printf( "packcachetest: %s of %s %s differs, %d bytes, expected %d\n",
+                what, packInstName, irodsProt == XML_PROT ? "XML" : "native",
+                ( int ) packed.size(), ( int ) expected.size() );
+        return -1;
+    }
+    return 0;
+}
+
+static int
+testPI( void *inStruct, const char *packInstName, irodsProt_t irodsProt ) {
+    std::string uncached, cached, repacked;
+    int i;
+    int failed = 0;
+
+    if ( packWith( false, inStruct, packInstName, irodsProt, uncached ) < 0 ) {
+        return -1;
+    }
+
+    /* the first cached call parses, the second copies the parsed items */
+    for ( i = 0; i < 2; i++ ) {
+        if ( packWith( true, inStruct, packInstName, irodsProt, cached ) < 0 ) {
+            return -1;
+        }
+        if ( compareBytes( "cached pack", packInstName, irodsProt,
+                           uncached, cached ) < 0 ) {
+            failed = 1;
+        }
+    }
+
+    if ( repackWith( false, uncached, packInstName, irodsProt, repacked ) < 0 ) {
+        return -1;
+    }
+    if ( compareBytes( "uncached unpack", packInstName, irodsProt,
+                       uncached, repacked ) < 0 ) {
+        failed = 1;
+    }
+    if ( repackWith( true, cached, packInstName, irodsProt, repacked ) < 0 ) {
+        return -1;
+    }
+    if ( compareBytes( "cached unpack", packInstName, irodsProt,
+                       uncached, repacked ) < 0 ) {
+        failed = 1;
+    }
+
+    printf( "packcachetest: %s %s, %s\n", packInstName,
+            irodsProt == XML_PROT ? "XML" : "native", failed ? "failed" : "ok" );
+    return failed ? -1 : 0;
+}
+
+int
+main( int argc, char **argv ) {
+    dataObjInp_t dataObjInp;
+    genQueryOut_t genQueryOut;
+    int failed = 0;
+
+    fillDataObjInp( &dataObjInp );
+    fillGenQueryOut( &genQueryOut, 50 );
+
+    if ( testPI( &dataObjInp, "DataObjInp_PI", NATIVE_PROT ) < 0 ) {
+        failed = 1;
+    }
+    if ( testPI( &dataObjInp, "DataObjInp_PI", XML_PROT ) < 0 ) {
+        failed = 1;
+    }
+    if ( testPI( &genQueryOut, "GenQueryOut_PI", NATIVE_PROT ) < 0 ) {
+        failed = 1;
+    }
+    if ( testPI( &genQueryOut, "GenQueryOut_PI", XML_PROT ) < 0 ) {
+        failed = 1;
+    }
+
+    clearDataObjInp( &dataObjInp );
+    clearGenQueryOut( &genQueryOut );
+    exit( failed );
+}
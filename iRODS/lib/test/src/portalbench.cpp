@@ -0,0 +1,220 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* portalbench.c - measure the single thread throughput of the parallel
+ * transfer data path over loopback, comparing the buffered myRead/myWrite
+ * copy with the mySendFile/mySpliceToFile zero-copy path.
+ *
+ * usage: portalbench [-s sizeMB] [-b bufferMB] [-d dir]
+ */
+
+#include "rodsClient.h"
+#include "sockComm.h"
+
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+
+#define BENCH_SRC_FILE	"portalbench.src"
+#define BENCH_DEST_FILE	"portalbench.dest"
+
+static double
+nowSec() {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static int
+connectLoopback( int *sendSock, int *rcvSock ) {
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof( addr );
+    int listenSock = socket( AF_INET, SOCK_STREAM, 0 );
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if ( listenSock < 0 ||
+            bind( listenSock, ( struct sockaddr * ) &addr, sizeof( addr ) ) < 0 ||
+            listen( listenSock, 1 ) < 0 ||
+            getsockname( listenSock, ( struct sockaddr * ) &addr, &addrLen ) < 0 ) {
+        return SYS_SOCK_OPEN_ERR - errno;
+    }
+
+    *sendSock = socket( AF_INET, SOCK_STREAM, 0 );
+    if ( *sendSock < 0 ||
+            connect( *sendSock, ( struct sockaddr * ) &addr, sizeof( addr ) ) < 0 ) {
+        close( listenSock );
+        return USER_SOCK_CONNECT_ERR - errno;
+    }
+    *rcvSock = accept( listenSock, NULL, NULL );
+    close( listenSock );
+    if ( *rcvSock < 0 ) {
+        return SYS_SOCK_ACCEPT_ERR - errno;
+    }
+    return 0;
+}
+
+static int
+sendData( int sock, int fd, rodsLong_t size, char *buf, int bufLen,
+          int zeroCopy ) {
+    rodsLong_t offset = 0;
+    while ( offset < size ) {
+        int toSend = size - offset > bufLen ? bufLen : size - offset;
+        int bytesSent;
+        if ( zeroCopy ) {
+            bytesSent = mySendFile( sock, fd, offset, toSend, NULL );
+        }
+        else {
+            if ( pread( fd, buf, toSend, offset ) != toSend ) {
+                return SYS_COPY_LEN_ERR - errno;
+            }
+            bytesSent = myWrite( sock, buf, toSend, NULL );
+        }
+        if ( bytesSent != toSend ) {
+            return SYS_COPY_LEN_ERR - errno;
+        }
+        offset += bytesSent;
+    }
+    return 0;
+}
+
+static int
+rcvData( int sock, int fd, rodsLong_t size, char *buf, int bufLen,
+         int zeroCopy ) {
+    rodsLong_t offset = 0;
+    while ( offset < size ) {
+        int toRcv = size - offset > bufLen ? bufLen : size - offset;
+        int bytesRcvd;
+        if ( zeroCopy ) {
+            bytesRcvd = mySpliceToFile( sock, fd, offset, toRcv, NULL );
+        }
+        else {
+            bytesRcvd = myRead( sock, buf, toRcv, NULL, NULL );
+            if ( bytesRcvd == toRcv &&
+                    pwrite( fd, buf, toRcv, offset ) != toRcv ) {
+                return SYS_COPY_LEN_ERR - errno;
+            }
+        }
+        if ( bytesRcvd != toRcv ) {
+            return SYS_COPY_LEN_ERR - errno;
+        }
+        offset += bytesRcvd;
+    }
+    return 0;
+}
+
+static int
+runBench( char *srcPath, char *destPath, rodsLong_t size, int bufLen,
+          int zeroCopy, double *gbPerSec ) {
+    int sendSock, rcvSock;
+    int status = connectLoopback( &sendSock, &rcvSock );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    char *buf = ( char * ) malloc( bufLen );
+    double startTime = nowSec();
+
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+        return SYS_FORK_ERROR - errno;
+    }
+    else if ( pid == 0 ) {
+        close( rcvSock );
+        int srcFd = open( srcPath, O_RDONLY );
+        status = sendData( sendSock, srcFd, size, buf, bufLen, zeroCopy );
+        close( srcFd );
+        close( sendSock );
+        _exit( status < 0 ? 1 : 0 );
+    }
+
+    close( sendSock );
+    int destFd = open( destPath, O_WRONLY | O_CREAT | O_TRUNC, 0600 );
+    status = rcvData( rcvSock, destFd, size, buf, bufLen, zeroCopy );
+    close( destFd );
+    close( rcvSock );
+
+    int childStatus = 0;
+    waitpid( pid, &childStatus, 0 );
+    *gbPerSec = size / ( nowSec() - startTime ) / ( 1024.0 * 1024.0 * 1024.0 );
+
+    free( buf );
+    if ( status < 0 ) {
+        return status;
+    }
+    return WIFEXITED( childStatus ) && WEXITSTATUS( childStatus ) == 0 ?
+           0 : SYS_COPY_LEN_ERR;
+}
+
+int
+main( int argc, char **argv ) {
+    int c;
+    rodsLong_t sizeMb = 1024;
+    int bufMb = 4;
+    char *dir = ( char * ) ".";
+    char srcPath[MAX_NAME_LEN], destPath[MAX_NAME_LEN];
+
+    while ( ( c = getopt( argc, argv, "s:b:d:" ) ) != EOF ) {
+        switch ( c ) {
+        case 's':
+            sizeMb = atoll( optarg );
+            break;
+        case 'b':
+            bufMb = atoi( optarg );
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        default:
+            fprintf( stderr,
+                     "usage: portalbench [-s sizeMB] [-b bufferMB] [-d dir]\n" );
+            exit( 1 );
+        }
+    }
+
+    rodsLong_t size = sizeMb * 1024 * 1024;
+    int bufLen = bufMb * 1024 * 1024;
+    snprintf( srcPath, MAX_NAME_LEN, "%s/%s", dir, BENCH_SRC_FILE );
+    snprintf( destPath, MAX_NAME_LEN, "%s/%s", dir, BENCH_DEST_FILE );
+
+    /* fill the source file, this also leaves it in the page cache so
+     * both runs read from memory and only the copy path differs */
+    int srcFd = open( srcPath, O_WRONLY | O_CREAT | O_TRUNC, 0600 );
+    if ( srcFd < 0 ) {
+        fprintf( stderr, "cannot create %s, errno = %d\n", srcPath, errno );
+        exit( 2 );
+    }
+    char *buf = ( char * ) malloc( bufLen );
+    for ( int i = 0; i < bufLen; i++ ) {
+        buf[i] = ( char )( i * 31 );
+    }
+    for ( rodsLong_t written = 0; written < size; written += bufLen ) {
+        int toWrite = size - written > bufLen ? bufLen : size - written;
+        if ( write( srcFd, buf, toWrite ) != toWrite ) {
+            fprintf( stderr, "write to %s failed, errno = %d\n", srcPath, errno );
+            exit( 2 );
+        }
+    }
+    close( srcFd );
+    free( buf );
+
+    printf( "transferring %lld MB over loopback with %d MB buffers\n",
+            sizeMb, bufMb );
+    for ( int zeroCopy = 0; zeroCopy <= 1; zeroCopy++ ) {
+        double gbPerSec = 0;
+        int status = runBench( srcPath, destPath, size, bufLen, zeroCopy,
+                               &gbPerSec );
+        if ( status < 0 ) {
+            fprintf( stderr, "%s run failed, status = %d\n",
+                     zeroCopy ? "zero-copy" : "buffered", status );
+            exit( 3 );
+        }
+        printf( "%-10s %6.2f GB/s per thread\n",
+                zeroCopy ? "zero-copy" : "buffered", gbPerSec );
+    }
+
+    unlink( srcPath );
+    unlink( destPath );
+    exit( 0 );
+}
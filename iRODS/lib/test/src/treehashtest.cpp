@@ -0,0 +1,214 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* treehashtest.c - test that the parallel sha256tree checksum is the same
+ * as hashing the file from start to end with a SHA256TreeStrategy hasher.
+ * Files of sizes which are not multiples of the chunk size are hashed with
+ * 1 to maxThreads threads, with and without some of the chunk digests known
+ * in advance, and once through chksumLocFile from a local file.
+ *
+ * usage: treehashtest [-t maxThreads] [-d tmpDir]
+ */
+
+#include "rodsClient.h"
+#include "checksum.hpp"
+#include "Hasher.hpp"
+#include "irods_log.hpp"
+#include "SHA256TreeStrategy.hpp"
+
+#include <string>
+#include <vector>
+
+/* the byte of the test data at an offset */
+static char
+dataAt( rodsLong_t offset ) {
+    return ( char )( ( offset * 2654435761LL ) >> 13 );
+}
+
+static void
+fillData( rodsLong_t offset, char *buf, int len ) {
+    int i;
+
+    for ( i = 0; i < len; i++ ) {
+        buf[i] = dataAt( offset + i );
+    }
+}
+
+/* the test data, generated as it is read. the handle is the offset */
+class test_tree_hash_file : public irods::tree_hash_file {
+    public:
+        test_tree_hash_file( rodsLong_t _size ) : size_( _size ) {}
+
+        irods::error open( rodsLong_t _offset, boost::any& _handle ) {
+            _handle = _offset;
+            return SUCCESS();
+        }
+
+        irods::error read( boost::any& _handle, char* _buf, int _len ) {
+            rodsLong_t offset = boost::any_cast<rodsLong_t>( _handle );
+            if ( _len > size_ - offset ) {
+                _len = ( int )( size_ - offset );
+            }
+            fillData( offset, _buf, _len );
+            _handle = offset + _len;
+            return CODE( _len );
+        }
+
+        irods::error close( boost::any& ) {
+            return SUCCESS();
+        }
+
+    private:
+        rodsLong_t size_;
+};
+
+/* hash the test data from start to end, in buffers of an odd size so the
+ * updates do not line up with the chunks */
+static std::string
+sequentialDigest( rodsLong_t size ) {
+    irods::SHA256TreeStrategy strategy;
+    irods::Hasher hasher;
+    std::vector<char> buf( 1000003 );
+    std::string digest;
+    rodsLong_t offset;
+
+    hasher.init( &strategy );
+    for ( offset = 0; offset < size; offset += buf.size() ) {
+        int len = ( int ) std::min( ( rodsLong_t ) buf.size(), size - offset );
+        fillData( offset, &buf[0], len );
+        hasher.update( &buf[0], len );
+    }
+    hasher.digest( digest );
+    return digest;
+}
+
+static int
+compareDigest( const char *what, rodsLong_t size, int threads,
+               const std::string& expected, const std::string& digest ) {
+    if ( digest != expected ) {
+        printf( "treehashtest: %s of %lld bytes with %d threads is %s, expected %s\n",
+                what, size, threads, digest.c_str(), expected.c_str() );
+        return -1;
+    }
+    return 0;
+}
+
+static int
+testSize( rodsLong_t size, int maxThreads ) {
+    std::string expected = sequentialDigest( size );
+    int threads;
+    int failed = 0;
+
+    for ( threads = 1; threads <= maxThreads; threads++ ) {
+        test_tree_hash_file file( size );
+        std::string digest;
+        irods::error ret = irods::sha256_tree_hash( file, size, threads, digest );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return -1;
+        }
+        if ( compareDigest( "sha256_tree_hash", size, threads, expected, digest ) < 0 ) {
+            failed = 1;
+        }
+
+        /* every other chunk known in advance, as left by a parallel put */
+        irods::tree_leaves_t leaves;
+        ret = irods::sha256_tree_hash( file, size, threads, leaves, digest );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return -1;
+        }
+        for ( size_t i = 1; i < leaves.size(); i += 2 ) {
+            leaves[i].clear();
+        }
+        ret = irods::sha256_tree_hash( file, size, threads, leaves, digest );
+        if ( !ret.ok() ) {
+            irods::log( PASS( ret ) );
+            return -1;
+        }
+        if ( compareDigest( "sha256_tree_hash with known chunks", size, threads,
+                            expected, digest ) < 0 ) {
+            failed = 1;
+        }
+    }
+
+    printf( "treehashtest: %lld bytes, %s\n", size, failed ? "failed" : "ok" );
+    return failed ? -1 : 0;
+}
+
+/* chksumLocFile hashes a tree checksum with one thread per core */
+static int
+testLocFile( const char *tmpDir, rodsLong_t size ) {
+    char fileName[MAX_NAME_LEN];
+    char chksum[NAME_LEN];
+    std::vector<char> buf( 1024 * 1024 );
+    rodsLong_t offset;
+    FILE *fp;
+    int status;
+
+    snprintf( fileName, MAX_NAME_LEN, "%s/treehashtest.%d", tmpDir, getpid() );
+    fp = fopen( fileName, "w" );
+    if ( fp == NULL ) {
+        printf( "treehashtest: cannot create %s\n", fileName );
+        return -1;
+    }
+    for ( offset = 0; offset < size; offset += buf.size() ) {
+        int len = ( int ) std::min( ( rodsLong_t ) buf.size(), size - offset );
+        fillData( offset, &buf[0], len );
+        fwrite( &buf[0], 1, len, fp );
+    }
+    fclose( fp );
+
+    memset( chksum, 0, sizeof( chksum ) );
+    status = chksumLocFile( fileName, chksum, irods::SHA256_TREE_NAME.c_str() );
+    unlink( fileName );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status, "treehashtest: chksumLocFile error" );
+        return -1;
+    }
+    if ( compareDigest( "chksumLocFile", size, 0, sequentialDigest( size ), chksum ) < 0 ) {
+        return -1;
+    }
+    printf( "treehashtest: chksumLocFile of %lld bytes, ok\n", size );
+    return 0;
+}
+
+int
+main( int argc, char **argv ) {
+    const rodsLong_t chunk = irods::SHA256_TREE_CHUNK_SIZE;
+    const rodsLong_t sizes[] = {
+        0, 1, chunk - 1, chunk, chunk + 1, 3 * chunk + 12345
+    };
+    const char *tmpDir = "/tmp";
+    int maxThreads = 5;
+    int c, i;
+    int failed = 0;
+
+    while ( ( c = getopt( argc, argv, "t:d:h" ) ) != EOF ) {
+        switch ( c ) {
+        case 't':
+            maxThreads = atoi( optarg );
+            break;
+        case 'd':
+            tmpDir = optarg;
+            break;
+        default:
+            printf( "usage: treehashtest [-t maxThreads] [-d tmpDir]\n" );
+            exit( 1 );
+        }
+    }
+    if ( maxThreads <= 0 ) {
+        printf( "usage: treehashtest [-t maxThreads] [-d tmpDir]\n" );
+        exit( 1 );
+    }
+
+    for ( i = 0; i < ( int )( sizeof( sizes ) / sizeof( sizes[0] ) ); i++ ) {
+        if ( testSize( sizes[i], maxThreads ) < 0 ) {
+            failed = 1;
+        }
+    }
+    if ( testLocFile( tmpDir, 2 * chunk + 777 ) < 0 ) {
+        failed = 1;
+    }
+
+    exit( failed );
+}
@@ -0,0 +1,149 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* xxh64test.c - test the xxh64 checksum scheme against the reference
+ * vectors of xxHash64 with a seed of 0, and check that hashing a buffer in
+ * pieces of any size gives the same digest as hashing it in one update.
+ *
+ * usage: xxh64test
+ */
+
+#include "rodsClient.h"
+#include "checksum.hpp"
+#include "Hasher.hpp"
+#include "XXH64Strategy.hpp"
+#include "irods_hasher_factory.hpp"
+#include "irods_log.hpp"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+typedef struct {
+    const char *data;
+    const char *digest;
+} stringVector_t;
+
+/* digests of strings, from the xxHash documentation and bindings */
+static stringVector_t StringVector[] = {
+    {"", "ef46db3751d8e999"},
+    {"a", "d24ec4f1a98c6e5b"},
+    {"abc", "44bc2cf5ad770999"},
+    {"Nobody inspects the spammish repetition", "fbcea83c8a378bf1"},
+    {"The quick brown fox jumps over the lazy dog", "0b242d361fda71bc"}
+};
+
+typedef struct {
+    int len;
+    const char *digest;
+} bufferVector_t;
+
+/* digests of the first len bytes of the xxHash sanity check buffer */
+static bufferVector_t BufferVector[] = {
+    {0, "ef46db3751d8e999"},
+    {1, "e934a84adb052768"},
+    {14, "8282dcc4994e35c8"},
+    {222, "b641ae8cb691c174"}
+};
+
+#define NUM_STRING_VECTOR ( int )( sizeof( StringVector ) / sizeof( StringVector[0] ) )
+#define NUM_BUFFER_VECTOR ( int )( sizeof( BufferVector ) / sizeof( BufferVector[0] ) )
+
+/* the sanity check buffer of the xxHash test suite */
+static void
+fillSanityBuffer( std::vector<char>& buf ) {
+    uint64_t byteGen = 2654435761U;
+    size_t i;
+
+    for ( i = 0; i < buf.size(); i++ ) {
+        buf[i] = ( char )( byteGen >> 56 );
+        byteGen *= 11400714785074694797ULL;
+    }
+}
+
+/* hash len bytes of data, pieceLen bytes per update or all at once if 0 */
+static std::string
+xxh64Digest( const char *data, int len, int pieceLen ) {
+    irods::Hasher hasher;
+    std::string digest;
+    int offset;
+
+    irods::error ret = irods::getHasher( irods::XXH64_NAME, hasher );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return digest;
+    }
+    if ( pieceLen <= 0 ) {
+        hasher.update( data, len );
+    }
+    else {
+        for ( offset = 0; offset < len; offset += pieceLen ) {
+            hasher.update( data + offset, std::min( pieceLen, len - offset ) );
+        }
+    }
+    hasher.digest( digest );
+    return digest;
+}
+
+static int
+checkDigest( const char *what, int len, int pieceLen,
+             const std::string& expected, const std::string& digest ) {
+    if ( digest != expected ) {
+        printf( "xxh64test: %s of %d bytes in pieces of %d is %s, expected %s\n",
+                what, len, pieceLen, digest.c_str(), expected.c_str() );
+        return -1;
+    }
+    return 0;
+}
+
+int
+main( int argc, char **argv ) {
+    /* piece sizes on either side of the 32 byte stripe and odd ones */
+    const int pieceLens[] = { 1, 3, 7, 31, 32, 33, 64, 1000 };
+    std::vector<char> buf( 100003 );
+    int i, j;
+    int failed = 0;
+
+    fillSanityBuffer( buf );
+
+    for ( i = 0; i < NUM_STRING_VECTOR; i++ ) {
+        std::string expected = std::string( XXH64_CHKSUM_PREFIX ) + StringVector[i].digest;
+        int len = strlen( StringVector[i].data );
+        if ( checkDigest( "string", len, 0, expected,
+                          xxh64Digest( StringVector[i].data, len, 0 ) ) < 0 ) {
+            failed = 1;
+        }
+        for ( j = 0; j < ( int )( sizeof( pieceLens ) / sizeof( pieceLens[0] ) ); j++ ) {
+            if ( checkDigest( "string", len, pieceLens[j], expected,
+                              xxh64Digest( StringVector[i].data, len, pieceLens[j] ) ) < 0 ) {
+                failed = 1;
+            }
+        }
+    }
+
+    for ( i = 0; i < NUM_BUFFER_VECTOR; i++ ) {
+        std::string expected = std::string( XXH64_CHKSUM_PREFIX ) + BufferVector[i].digest;
+        int len = BufferVector[i].len;
+        if ( checkDigest( "sanity buffer", len, 0, expected,
+                          xxh64Digest( &buf[0], len, 0 ) ) < 0 ) {
+            failed = 1;
+        }
+        for ( j = 0; j < ( int )( sizeof( pieceLens ) / sizeof( pieceLens[0] ) ); j++ ) {
+            if ( checkDigest( "sanity buffer", len, pieceLens[j], expected,
+                              xxh64Digest( &buf[0], len, pieceLens[j] ) ) < 0 ) {
+                failed = 1;
+            }
+        }
+    }
+
+    /* a buffer with no reference digest, in pieces against one update */
+    std::string oneShot = xxh64Digest( &buf[0], buf.size(), 0 );
+    for ( j = 0; j < ( int )( sizeof( pieceLens ) / sizeof( pieceLens[0] ) ); j++ ) {
+        if ( checkDigest( "sanity buffer", buf.size(), pieceLens[j], oneShot,
+                          xxh64Digest( &buf[0], buf.size(), pieceLens[j] ) ) < 0 ) {
+            failed = 1;
+        }
+    }
+
+    printf( "xxh64test: %s\n", failed ? "failed" : "ok" );
+    exit( failed );
+}
@@ -11,6 +11,8 @@
 #include "irods_stacktrace.hpp"
 #include "irods_file_object.hpp"
 
+#include <vector>
+
 int
 rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
                   genQueryOut_t **bulkDataObjRegOut ) {
@@ -55,7 +57,6 @@ int
 _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
                    genQueryOut_t **bulkDataObjRegOut ) {
 #ifdef RODS_CAT
-    dataObjInfo_t dataObjInfo;
     sqlResult_t *objPath, *dataType, *dataSize, *rescName, *rescHier, *filePath,
                 *dataMode, *oprType, *replNum, *chksum;
     char *tmpObjPath, *tmpDataType, *tmpDataSize, *tmpRescName, *tmpRescHier, *tmpFilePath,
@@ -137,7 +138,20 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
         return UNMATCHED_KEY_OR_INDEX;
     }
 
+    /* the output is sized for one bundle, the input may be larger */
+    if ( bulkDataObjRegInp->rowCnt > MAX_NUM_BULK_OPR_FILES ) {
+        free( objId->value );
+        objId->value = ( char * )malloc( objId->len * bulkDataObjRegInp->rowCnt );
+        bzero( objId->value, objId->len * bulkDataObjRegInp->rowCnt );
+    }
+
     ( *bulkDataObjRegOut )->rowCnt = bulkDataObjRegInp->rowCnt;
+
+    /* fill in every row first so the new objects can be registered in
+     * the catalog together, linked through next */
+    std::vector< dataObjInfo_t > dataObjInfos( bulkDataObjRegInp->rowCnt );
+    dataObjInfo_t *regHead = NULL;
+    dataObjInfo_t *regTail = NULL;
     for ( i = 0; i < bulkDataObjRegInp->rowCnt; i++ ) {
         tmpObjPath = &objPath->value[objPath->len * i];
         tmpDataType = &dataType->value[dataType->len * i];
@@ -148,34 +162,84 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
         tmpDataMode = &dataMode->value[dataMode->len * i];
         tmpOprType = &oprType->value[oprType->len * i];
         tmpReplNum =  &replNum->value[replNum->len * i];
-        tmpObjId = &objId->value[objId->len * i];
 
-        bzero( &dataObjInfo, sizeof( dataObjInfo_t ) );
-        dataObjInfo.flags = NO_COMMIT_FLAG;
-        rstrcpy( dataObjInfo.objPath, tmpObjPath, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.dataType, tmpDataType, NAME_LEN );
-        dataObjInfo.dataSize = strtoll( tmpDataSize, 0, 0 );
-        rstrcpy( dataObjInfo.rescName, tmpRescName, NAME_LEN );
-        rstrcpy( dataObjInfo.rescHier, tmpRescHier, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.filePath, tmpFilePath, MAX_NAME_LEN );
-        rstrcpy( dataObjInfo.dataMode, tmpDataMode, SHORT_STR_LEN );
-        dataObjInfo.replNum = atoi( tmpReplNum );
+        dataObjInfo_t *dataObjInfo = &dataObjInfos[i];
+        bzero( dataObjInfo, sizeof( dataObjInfo_t ) );
+        dataObjInfo->flags = NO_COMMIT_FLAG;
+        rstrcpy( dataObjInfo->objPath, tmpObjPath, MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->dataType, tmpDataType, NAME_LEN );
+        dataObjInfo->dataSize = strtoll( tmpDataSize, 0, 0 );
+        rstrcpy( dataObjInfo->rescName, tmpRescName, NAME_LEN );
+        rstrcpy( dataObjInfo->rescHier, tmpRescHier, MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->filePath, tmpFilePath, MAX_NAME_LEN );
+        rstrcpy( dataObjInfo->dataMode, tmpDataMode, SHORT_STR_LEN );
+        dataObjInfo->replNum = atoi( tmpReplNum );
         if ( chksum != NULL ) {
             tmpChksum = &chksum->value[chksum->len * i];
             if ( strlen( tmpChksum ) > 0 ) {
-                rstrcpy( dataObjInfo.chksum, tmpChksum, NAME_LEN );
+                rstrcpy( dataObjInfo->chksum, tmpChksum, NAME_LEN );
             }
         }
 
-        dataObjInfo.replStatus = NEWLY_CREATED_COPY;
+        dataObjInfo->replStatus = NEWLY_CREATED_COPY;
         if ( strcmp( tmpOprType, REGISTER_OPR ) == 0 ) {
-            status = svrRegDataObj( rsComm, &dataObjInfo );
+            if ( regTail == NULL ) {
+                regHead = dataObjInfo;
+            }
+            else {
+                regTail->next = dataObjInfo;
+            }
+            regTail = dataObjInfo;
+        }
+    }
+
+    if ( regHead != NULL ) {
+        status = chlRegDataObjBulk( rsComm, regHead );
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "rsBulkDataObjReg: chlRegDataObjBulk failed for %s,stat=%d",
+                     regHead->objPath, status );
+            chlRollback( rsComm );
+            freeGenQueryOut( bulkDataObjRegOut );
+            *bulkDataObjRegOut = NULL;
+            return status;
+        }
+    }
+
+    for ( i = 0; i < bulkDataObjRegInp->rowCnt; i++ ) {
+        dataObjInfo_t *dataObjInfo = &dataObjInfos[i];
+        tmpDataSize = &dataSize->value[dataSize->len * i];
+        tmpOprType = &oprType->value[oprType->len * i];
+        tmpObjId = &objId->value[objId->len * i];
+
+        /* the list was only needed for the catalog */
+        dataObjInfo->next = NULL;
+
+        if ( strcmp( tmpOprType, REGISTER_OPR ) == 0 ) {
+            irods::file_object_ptr file_obj(
+                new irods::file_object(
+                    rsComm,
+                    dataObjInfo ) );
+            irods::error ret = fileRegistered( rsComm, file_obj );
+            if ( !ret.ok() ) {
+                std::stringstream msg;
+                msg << __FUNCTION__;
+                msg << " - Failed to signal resource that the data object \"";
+                msg << dataObjInfo->objPath;
+                msg << "\" was registered";
+                ret = PASSMSG( msg.str(), ret );
+                irods::log( ret );
+                status = ret.code();
+            }
+            else {
+                status = 0;
+            }
         }
         else {
-            status = modDataObjSizeMeta( rsComm, &dataObjInfo, tmpDataSize );
+            status = modDataObjSizeMeta( rsComm, dataObjInfo, tmpDataSize );
         }
         if ( status >= 0 ) {
-            snprintf( tmpObjId, NAME_LEN, "%lld", dataObjInfo.dataId );
+            snprintf( tmpObjId, NAME_LEN, "%lld", dataObjInfo->dataId );
 
             // =-=-=-=-=-=-=-
             // added due to lack of notificaiton of new data object
@@ -183,14 +247,14 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
             irods::file_object_ptr file_obj(
                 new irods::file_object(
                     rsComm,
-                    &dataObjInfo ) );
+                    dataObjInfo ) );
 
             irods::error ret = fileModified( rsComm, file_obj );
             if ( !ret.ok() ) {
                 std::stringstream msg;
                 msg << __FUNCTION__;
                 msg << " - Failed to signal resource that the data object \"";
-                msg << dataObjInfo.objPath;
+                msg << dataObjInfo->objPath;
                 msg << "\" was registered";
                 ret = PASSMSG( msg.str(), ret );
                 irods::log( ret );
@@ -201,7 +265,7 @@ _rsBulkDataObjReg( rsComm_t *rsComm, genQueryOut_t *bulkDataObjRegInp,
         else {
             rodsLog( LOG_ERROR,
                      "rsBulkDataObjReg: RegDataObj or ModDataObj failed for %s,stat=%d",
-                     tmpObjPath, status );
+                     dataObjInfo->objPath, status );
             chlRollback( rsComm );
             freeGenQueryOut( bulkDataObjRegOut );
             *bulkDataObjRegOut = NULL;
@@ -49,6 +49,13 @@ rsDataCopy( rsComm_t *rsComm, dataCopyInp_t *dataCopyInp ) {
         else {
             l3descInx = dataOprInp->srcL3descInx;
         }
+        if ( l3descInx < 3 || l3descInx >= ( int ) FileDesc.size() ) {
+            rodsLog( LOG_NOTICE, "rsDataCopy: l3descInx %d out of range", l3descInx );
+            return SYS_FILE_DESC_OUT_OF_RANGE;
+        }
+        if ( FileDesc[l3descInx].inuseFlag != FD_INUSE ) {
+            return SYS_BAD_FILE_DESCRIPTOR;
+        }
         rodsServerHost = FileDesc[l3descInx].rodsServerHost;
         if ( rodsServerHost != NULL && rodsServerHost->localFlag != LOCAL_HOST ) {
             addKeyVal( &dataOprInp->condInput, EXEC_LOCALLY_KW, "" );
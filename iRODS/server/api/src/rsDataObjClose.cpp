@@ -41,6 +41,8 @@
 #include "irods_exception.hpp"
 #include "irods_serialization.hpp"
 #include "irods_server_api_call.hpp"
+#include "irods_inline_checksum.hpp"
+#include "fileChksum.h"
 
 
 int
@@ -61,7 +63,7 @@ irsDataObjClose(
     int l1descInx;
     ruleExecInfo_t rei;
     l1descInx = dataObjCloseInp->l1descInx;
-    if ( l1descInx <= 2 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx <= 2 || l1descInx >= ( int ) L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "rsDataObjClose: l1descInx %d out of range",
                  l1descInx );
@@ -706,6 +708,68 @@ l3Stat( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, rodsStat_t **myStat ) {
     return status;
 }
 
+/* chksumForClose - checksum of the data written through l1descInx. If the
+ * data was hashed as it was written only the part which was not is read
+ * back, otherwise the whole file is checksummed by _dataObjChksum.
+ */
+static int
+chksumForClose(
+    rsComm_t *rsComm,
+    int l1descInx,
+    char **chksumStr ) {
+    dataObjInfo_t *dataObjInfo = L1desc[l1descInx].dataObjInfo;
+    irods::inline_checksum *inlineChksum = L1desc[l1descInx].inlineChksum;
+    rodsLong_t dataSize = L1desc[l1descInx].dataSize;
+    if ( inlineChksum == NULL || !inlineChksum->valid() ||
+            ( inlineChksum->hashes_segments() && dataSize < 0 ) ) {
+        return _dataObjChksum( rsComm, dataObjInfo, chksumStr );
+    }
+
+    /* a tree checksum keeps the chunks hashed by every portal thread, the
+     * others are read back. otherwise the hashed prefix is continued */
+    irods::tree_leaves_t leaves;
+    bool complete;
+    if ( inlineChksum->hashes_segments() ) {
+        complete = inlineChksum->leaves( dataSize, leaves );
+    }
+    else {
+        complete = inlineChksum->size() == dataSize;
+    }
+
+    /* the rest of the file can only be read here if the vault is local */
+    if ( !complete ) {
+        int remoteFlag;
+        rodsServerHost_t *rodsServerHost;
+        irods::error ret = irods::get_host_for_hier_string( dataObjInfo->rescHier, remoteFlag, rodsServerHost );
+        if ( !ret.ok() || remoteFlag != LOCAL_HOST ) {
+            return _dataObjChksum( rsComm, dataObjInfo, chksumStr );
+        }
+    }
+
+    int status = 0;
+    *chksumStr = ( char * ) malloc( NAME_LEN );
+    if ( inlineChksum->hashes_segments() ) {
+        status = fileChksumTreeFrom( rsComm, dataObjInfo->objPath, dataObjInfo->filePath,
+                                     dataObjInfo->rescHier, dataSize, leaves, *chksumStr );
+    }
+    else if ( complete ) {
+        std::string digest;
+        irods::Hasher hasher = inlineChksum->hasher();
+        hasher.digest( digest );
+        rstrcpy( *chksumStr, digest.c_str(), NAME_LEN );
+    }
+    else {
+        irods::Hasher hasher = inlineChksum->hasher();
+        status = fileChksumFrom( rsComm, dataObjInfo->objPath, dataObjInfo->filePath,
+                                 dataObjInfo->rescHier, inlineChksum->size(), hasher, *chksumStr );
+    }
+    if ( status < 0 ) {
+        free( *chksumStr );
+        *chksumStr = NULL;
+    }
+    return status;
+}
+
 /* procChksumForClose - handle checksum issues on close. Returns a non-null
  * chksumStr if it needs to be registered.
  */
@@ -790,7 +854,7 @@ procChksumForClose(
 
             }
 
-            status = _dataObjChksum( rsComm, dataObjInfo, chksumStr );
+            status = chksumForClose( rsComm, l1descInx, chksumStr );
             rmKeyVal( &dataObjInfo->condInput, ORIG_CHKSUM_KW );
             if ( status < 0 ) {
                 return status;
@@ -889,7 +953,7 @@ procChksumForClose(
             addKeyVal( &dataObjInfo->condInput, ORIG_CHKSUM_KW, L1desc[l1descInx].chksum );
         }
 
-        status = _dataObjChksum( rsComm, dataObjInfo, chksumStr );
+        status = chksumForClose( rsComm, l1descInx, chksumStr );
         if ( status < 0 ) {
             return status;
         }
@@ -23,7 +23,7 @@ rsDataObjLseek( rsComm_t *rsComm, openedDataObjInp_t *dataObjLseekInp,
 
     l1descInx = dataObjLseekInp->l1descInx;
 
-    if ( l1descInx <= 2 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx <= 2 || l1descInx >= ( int ) L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "rsDataObjLseek: l1descInx %d out of range",
                  l1descInx );
@@ -34,6 +34,10 @@
 #include "irods_exception.hpp"
 #include "irods_serialization.hpp"
 #include "irods_server_properties.hpp"
+#include "irods_hasher_factory.hpp"
+#include "irods_inline_checksum.hpp"
+#include "MD5Strategy.hpp"
+#include "fileChksum.h"
 
 int
 rsDataObjPut( rsComm_t *rsComm, dataObjInp_t *dataObjInp,
@@ -242,6 +246,37 @@ _rsDataObjPut( rsComm_t *rsComm, dataObjInp_t *dataObjInp,
 
 }
 
+/* initInlineChksum - start hashing the data of a put as it is written if
+ * the checksum will be needed on close. Failing to set it up is not an
+ * error, the checksum is then computed from the file as before.
+ */
+static void
+initInlineChksum( int l1descInx ) {
+    char *origChksum = NULL;
+    if ( L1desc[l1descInx].inlineChksum != NULL ) {
+        return;
+    }
+    if ( strlen( L1desc[l1descInx].chksum ) > 0 ) {
+        origChksum = L1desc[l1descInx].chksum;
+    }
+    if ( L1desc[l1descInx].chksumFlag != REG_CHKSUM &&
+            ( L1desc[l1descInx].chksumFlag != VERIFY_CHKSUM || origChksum == NULL ) ) {
+        return;
+    }
+
+    std::string scheme;
+    if ( fileChksumScheme( origChksum, scheme ) < 0 ) {
+        return;
+    }
+    irods::Hasher hasher;
+    irods::error ret = irods::getHasher( scheme, hasher );
+    if ( !ret.ok() ) {
+        scheme = irods::MD5_NAME;
+        irods::getHasher( scheme, hasher );
+    }
+    L1desc[l1descInx].inlineChksum = new irods::inline_checksum( hasher, scheme );
+}
+
 /* preProcParaPut - preprocessing for parallel put. Basically it calls
  * rsDataPut to setup portalOprOut with the resource server.
  */
@@ -269,6 +304,11 @@ preProcParaPut( rsComm_t *rsComm, int l1descInx,
     if ( status >= 0 ) {
         ( *portalOprOut )->l1descInx = l1descInx;
         L1desc[l1descInx].bytesWritten = dataOprInp.dataSize;
+        /* the portal is served by this agent, hash the data on the way in */
+        if ( L1desc[l1descInx].remoteZoneHost == NULL && rsComm->portalOpr != NULL ) {
+            initInlineChksum( l1descInx );
+            rsComm->portalOpr->l1descInx = l1descInx;
+        }
     }
     clearKeyVal( &dataOprInp.condInput );
     return status;
@@ -328,8 +368,12 @@ _l3DataPutSingleBuf( rsComm_t *rsComm, int l1descInx, dataObjInp_t *dataObjInp,
     int status = 0;
     dataObjInfo_t *myDataObjInfo = L1desc[l1descInx].dataObjInfo;
 
+    initInlineChksum( l1descInx );
     int bytesWritten = l3FilePutSingleBuf( rsComm, l1descInx, dataObjInpBBuf );
     if ( bytesWritten >= 0 ) {
+        if ( L1desc[l1descInx].inlineChksum != NULL ) {
+            L1desc[l1descInx].inlineChksum->update( 0, ( char * ) dataObjInpBBuf->buf, bytesWritten );
+        }
         if ( L1desc[l1descInx].replStatus == NEWLY_CREATED_COPY &&
                 myDataObjInfo->specColl == NULL &&
                 L1desc[l1descInx].remoteZoneHost == NULL ) {
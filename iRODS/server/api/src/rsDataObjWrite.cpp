@@ -69,7 +69,7 @@ int rsDataObjWrite(
     int bytesWritten = 0;
     int l1descInx    = dataObjWriteInp->l1descInx;
 
-    if ( l1descInx < 2 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx < 2 || l1descInx >= ( int ) L1desc.size() ) {
         rodsLog(
             LOG_NOTICE,
             "rsDataObjWrite: l1descInx %d out of range",
@@ -27,6 +27,13 @@ rsDataPut( rsComm_t *rsComm, dataOprInp_t *dataOprInp,
         remoteFlag = LOCAL_HOST;
     }
     else {
+        if ( l3descInx < 3 || l3descInx >= ( int ) FileDesc.size() ) {
+            rodsLog( LOG_NOTICE, "rsDataPut: l3descInx %d out of range", l3descInx );
+            return SYS_FILE_DESC_OUT_OF_RANGE;
+        }
+        if ( FileDesc[l3descInx].inuseFlag != FD_INUSE ) {
+            return SYS_BAD_FILE_DESCRIPTOR;
+        }
         rodsServerHost = FileDesc[l3descInx].rodsServerHost;
         if ( rodsServerHost == NULL ) {
             rodsLog( LOG_NOTICE, "rsDataPut: NULL rodsServerHost" );
@@ -14,9 +14,120 @@
 #include "irods_hasher_factory.hpp"
 #include "readServerConfig.hpp"
 #include "irods_server_properties.hpp"
+#include "irods_configuration_keywords.hpp"
 #include "MD5Strategy.hpp"
+#include "SHA256TreeStrategy.hpp"
 
 #define SVR_MD5_BUF_SZ (1024*1024)
+#define DEF_NUM_CHKSUM_THREADS 4
+
+namespace {
+    // =-=-=-=-=-=-=-
+    // a vault file for the parallel tree hash, each thread opens its
+    // own file object through the resource plugin
+    class vault_tree_hash_file : public irods::tree_hash_file {
+        public:
+            vault_tree_hash_file(
+                rsComm_t* _comm,
+                char*     _obj_path,
+                char*     _file_name,
+                char*     _resc_hier ) :
+                comm_( _comm ),
+                obj_path_( _obj_path ),
+                file_name_( _file_name ),
+                resc_hier_( _resc_hier ) {}
+
+            irods::error open( rodsLong_t _offset, boost::any& _handle ) {
+                irods::file_object_ptr file_obj(
+                    new irods::file_object(
+                        comm_,
+                        obj_path_,
+                        file_name_,
+                        resc_hier_,
+                        -1, 0, O_RDONLY ) );
+                irods::error ret = fileOpen( comm_, file_obj );
+                if ( !ret.ok() ) {
+                    return PASS( ret );
+                }
+                if ( _offset > 0 ) {
+                    ret = fileLseek( comm_, file_obj, _offset, SEEK_SET );
+                    if ( !ret.ok() ) {
+                        fileClose( comm_, file_obj );
+                        return PASS( ret );
+                    }
+                }
+                _handle = file_obj;
+                return SUCCESS();
+            }
+
+            irods::error read( boost::any& _handle, char* _buf, int _len ) {
+                return fileRead( comm_, boost::any_cast<irods::file_object_ptr>( _handle ), _buf, _len );
+            }
+
+            irods::error close( boost::any& _handle ) {
+                return fileClose( comm_, boost::any_cast<irods::file_object_ptr>( _handle ) );
+            }
+
+        private:
+            rsComm_t* comm_;
+            char*     obj_path_;
+            char*     file_name_;
+            char*     resc_hier_;
+    };
+
+    // =-=-=-=-=-=-=-
+    // the number of threads hashing the chunks of a tree checksum
+    int numChksumThreads() {
+        int threads = DEF_NUM_CHKSUM_THREADS;
+        irods::error ret = irods::get_advanced_setting<int>(
+                               irods::CFG_NUMBER_OF_CHECKSUM_THREADS,
+                               threads );
+        if ( !ret.ok() ) {
+            threads = DEF_NUM_CHKSUM_THREADS;
+        }
+        return threads;
+    }
+
+    // =-=-=-=-=-=-=-
+    // hash the chunks of a tree checksum with several threads. returns
+    // 1 if the file should be hashed by a single reader instead
+    int fileChksumTree(
+        rsComm_t* rsComm,
+        char*     objPath,
+        char*     fileName,
+        char*     rescHier,
+        char*     chksumStr ) {
+        int threads = numChksumThreads();
+
+        irods::file_object_ptr file_obj(
+            new irods::file_object(
+                rsComm,
+                objPath,
+                fileName,
+                rescHier,
+                -1, 0, O_RDONLY ) );
+        struct stat stat_buf;
+        irods::error ret = fileStat( rsComm, file_obj, &stat_buf );
+        if ( !ret.ok() || threads <= 1 || stat_buf.st_size <= irods::SHA256_TREE_CHUNK_SIZE ) {
+            return 1;
+        }
+
+        vault_tree_hash_file tree_file( rsComm, objPath, fileName, rescHier );
+        std::string digest;
+        ret = irods::sha256_tree_hash( tree_file, stat_buf.st_size, threads, digest );
+        if ( !ret.ok() ) {
+            std::stringstream msg;
+            msg << "tree checksum failed for [";
+            msg << fileName;
+            msg << "]";
+            irods::error result = PASSMSG( msg.str(), ret );
+            irods::log( result );
+            return result.code();
+        }
+        strncpy( chksumStr, digest.c_str(), NAME_LEN );
+        return 0;
+    }
+}; // namespace
 
 int
 rsFileChksum(
@@ -110,13 +221,11 @@ _rsFileChksum(
     return status;
 }
 
-int fileChksum(
-    rsComm_t* rsComm,
-    char*     objPath,
-    char*     fileName,
-    char*     rescHier,
-    char*     orig_chksum,
-    char*     chksumStr ) {
+/* fileChksumScheme - the hash scheme fileChksum uses for a file, given the
+ * checksum it is compared against, if any. */
+int fileChksumScheme(
+    char*        orig_chksum,
+    std::string& final_scheme ) {
     // =-=-=-=-=-=-=-
     // capture server hashing settings
     std::string svr_hash_scheme;
@@ -160,7 +269,7 @@ int fileChksum(
     // =-=-=-=-=-=-=-
     // check the hash scheme against the policy
     // if necessary
-    std::string final_scheme( hash_scheme );
+    final_scheme = hash_scheme;
     if ( !chkstr_scheme.empty() ) {
         if ( !hash_policy.empty() ) {
             if ( irods::STRICT_HASH_POLICY == hash_policy ) {
@@ -180,6 +289,78 @@ int fileChksum(
         svr_hash_policy.c_str(),
         hash_policy.c_str() );
 
+    return 0;
+}
+
+int fileChksum(
+    rsComm_t* rsComm,
+    char*     objPath,
+    char*     fileName,
+    char*     rescHier,
+    char*     orig_chksum,
+    char*     chksumStr ) {
+    std::string final_scheme;
+    int status = fileChksumScheme( orig_chksum, final_scheme );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    // =-=-=-=-=-=-=-
+    // create a hasher object and init given a scheme
+    // if it is unsupported then default to md5
+    irods::Hasher hasher;
+    irods::error ret = irods::getHasher( final_scheme, hasher );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        irods::getHasher( irods::MD5_NAME, hasher );
+    }
+    else if ( irods::SHA256_TREE_NAME == final_scheme ) {
+        status = fileChksumTree( rsComm, objPath, fileName, rescHier, chksumStr );
+        if ( status <= 0 ) {
+            return status;
+        }
+    }
+
+    return fileChksumFrom( rsComm, objPath, fileName, rescHier, 0, hasher, chksumStr );
+}
+
+/* fileChksumTreeFrom - the tree checksum of the first size bytes of a file,
+ * given the digests of the chunks which are already known. Only the other
+ * chunks are read from the vault. */
+int fileChksumTreeFrom(
+    rsComm_t*                   rsComm,
+    char*                       objPath,
+    char*                       fileName,
+    char*                       rescHier,
+    rodsLong_t                  size,
+    std::vector< std::string >& leaves,
+    char*                       chksumStr ) {
+    vault_tree_hash_file tree_file( rsComm, objPath, fileName, rescHier );
+    std::string digest;
+    irods::error ret = irods::sha256_tree_hash( tree_file, size, numChksumThreads(), leaves, digest );
+    if ( !ret.ok() ) {
+        std::stringstream msg;
+        msg << "tree checksum failed for [";
+        msg << fileName;
+        msg << "]";
+        irods::error result = PASSMSG( msg.str(), ret );
+        irods::log( result );
+        return result.code();
+    }
+    strncpy( chksumStr, digest.c_str(), NAME_LEN );
+    return 0;
+}
+
+/* fileChksumFrom - update the hasher with the file from offset to the end of
+ * the file and return the digest in chksumStr. */
+int fileChksumFrom(
+    rsComm_t*      rsComm,
+    char*          objPath,
+    char*          fileName,
+    char*          rescHier,
+    rodsLong_t     offset,
+    irods::Hasher& hasher,
+    char*          chksumStr ) {
     // =-=-=-=-=-=-=-
     // call resource plugin to open file
     irods::file_object_ptr file_obj(
@@ -189,7 +370,7 @@ int fileChksum(
             fileName,
             rescHier,
             -1, 0, O_RDONLY ) ); // FIXME :: hack until this is better abstracted - JMC
-    ret = fileOpen( rsComm, file_obj );
+    irods::error ret = fileOpen( rsComm, file_obj );
     if ( !ret.ok() ) {
         int status = UNIX_FILE_OPEN_ERR - errno;
         if ( ret.code() != DIRECT_ARCHIVE_ACCESS ) {
@@ -206,13 +387,19 @@ int fileChksum(
     }
 
     // =-=-=-=-=-=-=-
-    // create a hasher object and init given a scheme
-    // if it is unsupported then default to md5
-    irods::Hasher hasher;
-    ret = irods::getHasher( final_scheme, hasher );
-    if ( !ret.ok() ) {
-        irods::log( PASS( ret ) );
-        irods::getHasher( irods::MD5_NAME, hasher );
+    // skip the part of the file which has already been hashed
+    if ( offset > 0 ) {
+        ret = fileLseek( rsComm, file_obj, offset, SEEK_SET );
+        if ( !ret.ok() ) {
+            std::stringstream msg;
+            msg << "fileLseek failed for [";
+            msg << fileName;
+            msg << "]";
+            irods::error result = PASSMSG( msg.str(), ret );
+            irods::log( result );
+            fileClose( rsComm, file_obj );
+            return result.code();
+        }
     }
 
     // =-=-=-=-=-=-=-
@@ -230,7 +417,7 @@ int fileChksum(
     while ( read_err.ok() && bytes_read > 0 ) {
         // =-=-=-=-=-=-=-
         // update hasher
-        hasher.update( std::string( buffer, bytes_read ) );
+        hasher.update( buffer, bytes_read );
 
         // =-=-=-=-=-=-=-
         // read some more
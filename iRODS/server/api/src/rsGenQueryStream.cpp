@@ -0,0 +1,127 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* See genQueryStream.h for a description of this API call.*/
+
+#include "genQueryStream.h"
+#include "genQuery.h"
+#include "rsApiHandler.hpp"
+#include "sockComm.h"
+#include "rcMisc.h"
+#include "rsGlobalExtern.hpp"
+
+/* read the client's answer to a batch, as _svrSendCollOprStat does */
+static int
+_svrReadGenQueryStreamReply( rsComm_t *rsComm ) {
+    int myBuf = 0;
+    int status = myRead( rsComm->sock, &myBuf, sizeof( myBuf ), NULL, NULL );
+    if ( status != sizeof( myBuf ) ) {
+        rodsLogError( LOG_ERROR, status,
+                      "_svrReadGenQueryStreamReply: read handshake failed. status = %d",
+                      status );
+        return status < 0 ? status : SYS_HEADER_READ_LEN_ERR;
+    }
+    return ntohl( myBuf );
+}
+
+static int
+_svrSendGenQueryStreamBatch( rsComm_t *rsComm, genQueryOut_t **genQueryOut ) {
+    int status = sendApiReply( rsComm, rsComm->apiInx,
+                               SYS_SVR_TO_CLI_GEN_QUERY_BATCH, *genQueryOut, NULL );
+    freeGenQueryOut( genQueryOut );
+    freeRErrorContent( &rsComm->rError );
+    if ( status < 0 ) {
+        rodsLogError( LOG_ERROR, status,
+                      "_svrSendGenQueryStreamBatch: sendApiReply failed. status = %d",
+                      status );
+    }
+    return status;
+}
+
+int
+rsGenQueryStream( rsComm_t *rsComm, genQueryStreamInp_t *genQueryStreamInp,
+                  genQueryOut_t **genQueryOut ) {
+    genQueryInp_t *genQueryInp = &genQueryStreamInp->genQueryInp;
+    genQueryOut_t *batch = NULL;
+    int window = genQueryStreamInp->window;
+    int inFlight = 0;
+    int sent = 0;
+    int cancelled = 0;
+    int status;
+
+    *genQueryOut = NULL;
+
+    if ( window <= 0 ) {
+        window = GEN_QUERY_STREAM_DEFAULT_WINDOW;
+    }
+    else if ( window > GEN_QUERY_STREAM_MAX_WINDOW ) {
+        window = GEN_QUERY_STREAM_MAX_WINDOW;
+    }
+    if ( genQueryInp->maxRows <= 0 ) {
+        genQueryInp->maxRows = MAX_SQL_ROWS;
+    }
+    genQueryInp->continueInx = 0;
+
+    status = rsGenQuery( rsComm, genQueryInp, &batch );
+
+    /* every batch but the last is pushed to the client as soon as there
+     * is room in the window; the last one is the normal reply */
+    while ( status >= 0 && batch != NULL && batch->continueInx > 0 ) {
+        if ( inFlight >= window ) {
+            int reply = _svrReadGenQueryStreamReply( rsComm );
+            if ( reply < 0 ) {
+                status = reply;
+                break;
+            }
+            inFlight--;
+            if ( reply != SYS_CLI_TO_SVR_GEN_QUERY_ACK ) {
+                cancelled = 1;
+                break;
+            }
+            continue;
+        }
+
+        genQueryInp->continueInx = batch->continueInx;
+        status = _svrSendGenQueryStreamBatch( rsComm, &batch );
+        if ( status < 0 ) {
+            break;
+        }
+        inFlight++;
+        sent++;
+
+        status = rsGenQuery( rsComm, genQueryInp, &batch );
+    }
+
+    if ( cancelled || status < 0 ) {
+        /* close the statement if the query was stopped early */
+        if ( batch != NULL && batch->continueInx > 0 ) {
+            genQueryInp->continueInx = batch->continueInx;
+            genQueryInp->maxRows = 0;
+            genQueryOut_t *junk = NULL;
+            rsGenQuery( rsComm, genQueryInp, &junk );
+            freeGenQueryOut( &junk );
+        }
+        freeGenQueryOut( &batch );
+    }
+
+    /* the client answers every batch before it reads the final reply */
+    while ( inFlight > 0 ) {
+        int reply = _svrReadGenQueryStreamReply( rsComm );
+        if ( reply < 0 ) {
+            freeGenQueryOut( &batch );
+            return reply;
+        }
+        inFlight--;
+    }
+
+    if ( cancelled ) {
+        return 0;
+    }
+    if ( status == CAT_NO_ROWS_FOUND && sent > 0 ) {
+        freeGenQueryOut( &batch );
+        return 0;
+    }
+
+    *genQueryOut = batch;
+    return status;
+}
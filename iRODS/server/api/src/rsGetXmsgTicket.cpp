@@ -40,8 +40,10 @@ rsGetXmsgTicket( rsComm_t*, getXmsgTicketInp_t *getXmsgTicketInp,
         ( *outXmsgTicketInfo )->rcvTicket = getRandomInt();
         ( *outXmsgTicketInfo )->sendTicket = ( *outXmsgTicketInfo )->rcvTicket;
         hashSlotNum = ticketHashFunc( ( *outXmsgTicketInfo )->rcvTicket );
+        lockTicketHashQue( ( *outXmsgTicketInfo )->rcvTicket );
         status = addTicketToHQue(
                      *outXmsgTicketInfo, &XmsgHashQue[hashSlotNum] );
+        unlockTicketHashQue( ( *outXmsgTicketInfo )->rcvTicket );
         if ( status != SYS_DUPLICATE_XMSG_TICKET ) {
             break;
         }
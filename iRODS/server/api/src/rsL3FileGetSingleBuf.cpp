@@ -20,6 +20,16 @@ rsL3FileGetSingleBuf( rsComm_t *rsComm, int *l1descInx,
                       bytesBuf_t *dataObjOutBBuf ) {
     int bytesRead;
 
+    if ( *l1descInx < 2 || *l1descInx >= ( int ) L1desc.size() ) {
+        rodsLog( LOG_NOTICE,
+                 "rsL3FileGetSingleBuf: l1descInx %d out of range",
+                 *l1descInx );
+        return SYS_FILE_DESC_OUT_OF_RANGE;
+    }
+    if ( L1desc[*l1descInx].inuseFlag != FD_INUSE ) {
+        return BAD_INPUT_DESC_INDEX;
+    }
+
     if ( L1desc[*l1descInx].dataObjInfo->dataSize > 0 ) {
         if ( L1desc[*l1descInx].remoteZoneHost != NULL ) {
             bytesRead = rcL3FileGetSingleBuf(
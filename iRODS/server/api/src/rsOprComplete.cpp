@@ -9,6 +9,16 @@ int rsOprComplete( rsComm_t *rsComm, int *retval ) {
     if ( *retval >= 2 ) {
         int l1descInx = *retval;
 
+        if ( l1descInx >= ( int ) L1desc.size() ) {
+            rodsLog( LOG_NOTICE,
+                     "rsOprComplete: l1descInx %d out of range",
+                     l1descInx );
+            return SYS_FILE_DESC_OUT_OF_RANGE;
+        }
+        if ( L1desc[l1descInx].inuseFlag != FD_INUSE ) {
+            return BAD_INPUT_DESC_INDEX;
+        }
+
         if ( L1desc[l1descInx].remoteZoneHost != NULL ) {
             *retval = rcOprComplete( L1desc[l1descInx].remoteZoneHost->conn,
                                      L1desc[l1descInx].remoteL1descInx );
@@ -214,7 +214,8 @@ _rsQuerySpecColl( rsComm_t *rsComm, int specCollInx,
     dataObjInp_t newDataObjInp;
     int recurFlag;
 
-    if ( SpecCollDesc[specCollInx].inuseFlag != FD_INUSE ) {
+    if ( specCollInx < 0 || specCollInx >= ( int ) SpecCollDesc.size() ||
+            SpecCollDesc[specCollInx].inuseFlag != FD_INUSE ) {
         rodsLog( LOG_ERROR,
                  "_rsQuerySpecColl: Input specCollInx %d not active", specCollInx );
         return BAD_INPUT_DESC_INDEX;
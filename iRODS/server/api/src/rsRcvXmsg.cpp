@@ -7,13 +7,14 @@
 #include "xmsgLib.hpp"
 
 extern ticketHashQue_t XmsgHashQue[];
-extern xmsgQue_t XmsgQue;
 
 int
 rsRcvXmsg( rsComm_t*, rcvXmsgInp_t *rcvXmsgInp,
            rcvXmsgOut_t **rcvXmsgOut ) {
     int status;
     irodsXmsg_t *irodsXmsg = NULL;
+
+    lockTicketHashQue( rcvXmsgInp->rcvTicket );
     /*
     status = getIrodsXmsgByMsgNum (rcvXmsgInp->rcvTicket,
       rcvXmsgInp->msgNumber, &irodsXmsg);
@@ -21,6 +22,7 @@ rsRcvXmsg( rsComm_t*, rcvXmsgInp_t *rcvXmsgInp,
     status = getIrodsXmsg( rcvXmsgInp, &irodsXmsg );
 
     if ( status < 0 ) {
+        unlockTicketHashQue( rcvXmsgInp->rcvTicket );
         return status;
     }
 
@@ -29,6 +31,7 @@ rsRcvXmsg( rsComm_t*, rcvXmsgInp_t *rcvXmsgInp,
     *rcvXmsgOut = ( rcvXmsgOut_t* )calloc( 1, sizeof( rcvXmsgOut_t ) );
 
     status = _rsRcvXmsg( irodsXmsg, *rcvXmsgOut );
+    unlockTicketHashQue( rcvXmsgInp->rcvTicket );
 
     return status;
 }
@@ -8,10 +8,25 @@
 
 
 extern ticketHashQue_t XmsgHashQue[];
-extern xmsgQue_t XmsgQue;
+
+static int
+_rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp );
 
 int
 rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp ) {
+    int status;
+
+    lockTicketHashQue( sendXmsgInp->ticket.rcvTicket );
+    status = _rsSendXmsg( rsComm, sendXmsgInp );
+    unlockTicketHashQue( sendXmsgInp->ticket.rcvTicket );
+
+    return status;
+}
+
+/* the caller holds the lock of the hash slot of the rcvTicket */
+
+static int
+_rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp ) {
     int status, i;
     ticketMsgStruct_t *ticketMsgStruct = NULL;
     irodsXmsg_t *irodsXmsg;
@@ -49,6 +64,10 @@ rsSendXmsg( rsComm_t *rsComm, sendXmsgInp_t *sendXmsgInp ) {
                 }
                 i = rmTicketMsgStructFromHQue( ticketMsgStruct,
                                                ( ticketHashQue_t * ) ticketMsgStruct->ticketHashQue );
+                if ( i >= 0 ) {
+                    /* nobody else can reach it without the lock */
+                    free( ticketMsgStruct );
+                }
                 return i;
             }
         }
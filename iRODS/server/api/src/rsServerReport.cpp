@@ -1155,6 +1155,13 @@ int _rsServerReport(
     }
     json_object_set( resc_svr, "plugins", plugins );
 
+    // =-=-=-=-=-=-=-
+    // the free space and object counts are reported as in the catalog
+    ret = resc_mgr.refresh_resource_counters( _comm );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+    }
+
     json_t* resources = 0;
     ret = get_resource_array( resources );
     if ( !ret.ok() ) {
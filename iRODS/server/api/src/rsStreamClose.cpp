@@ -14,7 +14,7 @@ rsStreamClose( rsComm_t *rsComm, fileCloseInp_t *streamCloseInp ) {
     int fileInx = streamCloseInp->fileInx;
     int status;
 
-    if ( fileInx < 3 || fileInx >= NUM_FILE_DESC ) {
+    if ( fileInx < 3 || fileInx >= ( int ) FileDesc.size() ) {
         rodsLog( LOG_ERROR,
                  "rsStreamClose: fileInx %d out of range", fileInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -13,7 +13,7 @@
 #include "fileDriver.hpp"
 #include "chkNVPathPerm.h"
 
-#define NUM_FILE_DESC   1026    /* number of FileDesc */
+#define MAX_NUM_FILE_DESC       65536   /* limit of the FileDesc table */
 
 /* definition for inuseFlag */
 
@@ -50,6 +50,8 @@ freeFileDesc( int fileInx );
 int
 getServerHostByFileInx( int fileInx, rodsServerHost_t **rodsServerHost );
 int
+getNativeFdByFileInx( int fileInx );
+int
 mkDirForFilePath( rsComm_t *rsComm, size_t startDirLen, const std::string& filePath, const std::string& hier, int mode );
 int
 mkFileDirR( rsComm_t *rsComm, size_t startDirLen, const std::string& destDir, const std::string& hier, int mode );
@@ -23,6 +23,8 @@ int
 initZone( rsComm_t *rsComm );
 int
 initAgent( int processType, rsComm_t *rsComm );
+int
+preInitAgent();
 void cleanup();
 void cleanupAndExit( int status );
 void signalExit( int );
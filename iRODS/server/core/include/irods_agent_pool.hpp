@@ -0,0 +1,100 @@
+#ifndef IRODS_AGENT_POOL_HPP
+#define IRODS_AGENT_POOL_HPP
+
+#include "rodsDef.h"
+#include "irods_error.hpp"
+
+#include <boost/thread/mutex.hpp>
+#include <ctime>
+#include <vector>
+
+namespace irods {
+
+    // advanced_settings keywords controlling the pre-forked agent pool
+    const std::string CFG_AGENT_POOL_MIN_IDLE_AGENTS(
+        "agent_pool_minimum_number_of_idle_agents" );
+    const std::string CFG_AGENT_POOL_MAX_AGENT_AGE(
+        "agent_pool_maximum_agent_age_in_seconds" );
+
+    // default age after which a pooled agent reloads its server info
+    const int DEFAULT_AGENT_POOL_MAX_AGENT_AGE = 300;
+
+    // longest delay before replacing pooled agents which keep exiting
+    const int MAX_AGENT_POOL_SPAWN_BACKOFF = 64;
+
+    /// =-=-=-=-=-=-=-
+    /// @brief manages a set of pre-forked, pre-initialized agents which
+    ///        wait on a unix domain socket for an accepted client socket
+    ///        to be handed off via SCM_RIGHTS, rather than the server
+    ///        paying for a fork + execv + initAgent per connection.  each
+    ///        pooled agent serves a single client and then exits
+    class agent_pool {
+        public:
+            static agent_pool& instance();
+
+            /// @brief read the pool settings from the advanced settings
+            error configure();
+
+            /// @brief true if the server should hand off to pooled agents
+            bool enabled();
+
+            /// @brief true if fewer than the minimum idle agents are waiting
+            ///        and no spawn backoff is in effect
+            bool needs_agent();
+
+            /// @brief track a newly spawned agent waiting on _ctrl_fd
+            void add_idle( int _pid, int _ctrl_fd );
+
+            /// @brief pass the client socket and startup pack to an idle
+            ///        agent, returning the pid of the agent which took it.
+            ///        the agent is no longer tracked by the pool afterwards
+            error hand_off(
+                int                  _sock,
+                const startupPack_t& _pack,
+                int&                 _pid );
+
+            /// @brief forget an agent which has exited.  returns true if the
+            ///        pid belonged to an idle pooled agent, in which case
+            ///        respawning is backed off until agents stay up again
+            bool reap( int _pid );
+
+            /// @brief close all control sockets, letting idle agents exit
+            void shutdown();
+
+            // =-=-=-=-=-=-=-
+            // agent side of the protocol
+
+            /// @brief block until the server hands off a connection
+            static error receive_connection(
+                int            _ctrl_fd,
+                startupPack_t& _pack,
+                int&           _sock );
+
+            /// @brief set the startup pack environment read by
+            ///        initRsCommWithStartupPack in the agent
+            static void set_startup_env(
+                int                  _sock,
+                const startupPack_t& _pack );
+
+        private:
+            struct pooled_agent {
+                int pid;
+                int ctrl_fd;
+            };
+
+            agent_pool();
+            agent_pool( const agent_pool& );
+            agent_pool& operator=( const agent_pool& );
+
+            boost::mutex                 mutex_;
+            bool                         configured_;
+            int                          min_idle_;
+            int                          failures_;
+            time_t                       next_spawn_time_;
+            std::vector< pooled_agent >  idle_;
+
+    }; // class agent_pool
+
+}; // namespace irods
+
+#endif // IRODS_AGENT_POOL_HPP
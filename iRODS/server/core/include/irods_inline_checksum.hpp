@@ -0,0 +1,92 @@
+#ifndef IRODS_INLINE_CHECKSUM_HPP
+#define IRODS_INLINE_CHECKSUM_HPP
+
+#include "rodsType.h"
+#include "Hasher.hpp"
+#include "SHA256TreeStrategy.hpp"
+
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+
+namespace irods {
+
+    /// =-=-=-=-=-=-=-
+    /// @brief checksum of a replica computed from the bytes as they are
+    ///        written to the vault, rather than by reading the replica back
+    ///        when it is closed.  only bytes which extend the hashed prefix
+    ///        of the file are hashed, whatever follows the prefix is read
+    ///        back from the vault when the checksum is finished.
+    ///
+    ///        a sha256tree checksum is kept per chunk instead, so every
+    ///        portal thread of a parallel put hashes the chunks of its own
+    ///        segment. only the chunks no thread wrote from start to end,
+    ///        usually those on the boundaries of the segments, are read back
+    class inline_checksum {
+        public:
+            /// @brief ctor, given a hasher initialized with the scheme to use
+            ///        and the name of that scheme
+            inline_checksum(
+                const Hasher&      _hasher,
+                const std::string& _scheme );
+
+            /// @brief true if the checksum is kept per chunk, in which case
+            ///        every thread of a parallel put may update it
+            bool hashes_segments();
+
+            /// @brief hash bytes written to the vault at an offset of the file.
+            ///        safe to call from several transfer threads at once
+            void update(
+                rodsLong_t  _offset,
+                const char* _buf,
+                int         _len );
+
+            /// @brief false once bytes which were already hashed are written
+            ///        again. a chunk of a tree checksum which is written again
+            ///        is only dropped and read back
+            bool valid();
+
+            /// @brief number of bytes hashed from the start of the file
+            rodsLong_t size();
+
+            /// @brief a copy of the hasher over the hashed prefix, which may be
+            ///        updated with the rest of the file
+            Hasher hasher();
+
+            /// @brief the digests of the chunks of a tree checksum of a file
+            ///        of _size bytes which were hashed from start to end.
+            ///        returns true if no chunk is missing
+            bool leaves(
+                rodsLong_t     _size,
+                tree_leaves_t& _leaves );
+
+        private:
+            /// @brief hash _len bytes written at _pos in a chunk
+            void update_leaf(
+                rodsLong_t  _chunk,
+                rodsLong_t  _pos,
+                const char* _buf,
+                int         _len );
+
+            // =-=-=-=-=-=-=-
+            // the hash of a chunk of a tree checksum, busy while a thread
+            // updates it outside of the lock
+            struct leaf_t {
+                SHA256_CTX ctx;
+                rodsLong_t size;
+                bool       busy;
+                bool       broken;
+            };
+
+            boost::mutex                   mutex_;
+            Hasher                         hasher_;
+            rodsLong_t                     size_;
+            bool                           valid_;
+            bool                           tree_;
+            std::map< rodsLong_t, leaf_t > leaves_;
+
+    }; // class inline_checksum
+
+}; // namespace irods
+
+#endif // IRODS_INLINE_CHECKSUM_HPP
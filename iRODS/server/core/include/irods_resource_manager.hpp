@@ -150,11 +150,49 @@ namespace irods {
             iterator begin() { return resources_.begin(); }
             iterator end()   { return resources_.end();   }
 
+            // =-=-=-=-=-=-=-
+            /// @brief compare the resource generation in the catalog with the one
+            //         the table was loaded at.  _changed is left false if either
+            //         is unknown
+            error resource_generation_changed( rsComm_t*, bool& );
+
+            // =-=-=-=-=-=-=-
+            /// @brief read the free space and object count of the resources
+            //         from the catalog.  these change without a new resource
+            //         generation, so they are not taken from a snapshot
+            error load_resource_counters( rsComm_t* );
+
+            // =-=-=-=-=-=-=-
+            /// @brief mark the free space and object counts as out of date
+            void invalidate_resource_counters( void );
+
+            // =-=-=-=-=-=-=-
+            /// @brief call load_resource_counters if the counters are out of
+            //         date.  callers reading RESOURCE_FREESPACE or
+            //         RESOURCE_OBJCOUNT call this first
+            error refresh_resource_counters( rsComm_t* );
+
         private:
             // =-=-=-=-=-=-=-
             /// @brief take results from genQuery, extract values and create resources
             error process_init_results( genQueryOut_t* );
 
+            // =-=-=-=-=-=-=-
+            /// @brief read the resource generation from the catalog, which
+            //         changes whenever a resource or its children are modified
+            error get_resource_generation( rsComm_t*, std::string& );
+
+            // =-=-=-=-=-=-=-
+            /// @brief process the query results saved by another agent, if
+            //         they were saved at the given resource generation
+            error load_resource_snapshot( const std::string& );
+
+            // =-=-=-=-=-=-=-
+            /// @brief save the packed query results for other agents to use
+            //         until the resource generation changes
+            error save_resource_snapshot( const std::string&,                  // resource generation
+                                          const std::vector< bytesBuf_t* >& ); // packed GenQueryOut_PI pages
+
             // =-=-=-=-=-=-=-
             /// @brief Initialize the child map from the resources lookup table
             error init_child_map( void );
@@ -183,6 +221,8 @@ namespace irods {
             // Attributes
             lookup_table< resource_ptr >            resources_;
             std::vector< std::vector< pdmo_type > > maintenance_operations_;
+            std::string                             generation_;
+            bool                                    counters_stale_;
 
     }; // class resource_manager
 
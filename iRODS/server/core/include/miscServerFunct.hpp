@@ -27,6 +27,10 @@
 
 #define MAX_RECON_ERROR_CNT	10
 
+namespace irods {
+    class inline_checksum;
+};
+
 typedef struct PortalTransferInp {
     rsComm_t *rsComm;
     int destFd;
@@ -47,6 +51,7 @@ typedef struct PortalTransferInp {
     char encryption_algorithm[ NAME_LEN ];
     char shared_secret[ NAME_LEN ]; // JMC - shared secret for each portal thread
 
+    irods::inline_checksum *inlineChksum; // hashes the bytes written, if not NULL
 } portalTransferInp_t;
 
 int
@@ -20,7 +20,12 @@
 
 #include "boost/any.hpp"
 
-#define NUM_L1_DESC     1026    /* number of L1Desc */
+namespace irods {
+    class inline_checksum;
+};
+
+#define MAX_NUM_L1_DESC         65536   /* limit of the L1desc table */
+#define MAX_NUM_SPEC_COLL_DESC  4096    /* limit of the SpecCollDesc table */
 
 #define CHK_ORPHAN_CNT_LIMIT  20  /* number of failed check before stopping */
 /* definition for getNumThreads */
@@ -57,6 +62,7 @@ typedef struct l1desc {
                                      * on close */
     rodsServerHost_t *remoteZoneHost;
     char in_pdmo[MAX_NAME_LEN];
+    irods::inline_checksum *inlineChksum; /* checksum computed while writing, if any */
 } l1desc_t;
 
 extern "C" {
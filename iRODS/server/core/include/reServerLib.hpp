@@ -20,6 +20,8 @@
 #define DEF_NUM_RE_PROCS	1
 #define RESC_UPDATE_TIME        60
 #define RE_EXE	"irodsReServer"
+#define RE_PROC_MAX_JOBS        1000	/* jobs run by an executor before it is restarted */
+#define RE_STATS_TIME           60	/* interval of the queue statistics in the log */
 
 typedef enum {
     RE_PROC_IDLE,
@@ -32,19 +34,38 @@ typedef struct {
     ruleExecSubmitInp_t ruleExecSubmitInp;
     int status;
     int jobType;	/* 0 or RE_FAILED_STATUS */
-    pid_t pid;
+    pid_t pid;		/* executor process, 0 if none */
+    int sock;		/* socket to the executor, -1 if none */
+    int jobCnt;		/* jobs run by the executor */
 } reExecProc_t;
 
+/* job sent to an executor process, which replies with the int status */
+typedef struct {
+    char ruleExecId[NAME_LEN];
+    int jobType;
+} reExecJob_t;
+
 typedef struct {
     int runCnt;
     int maxRunCnt;
     int doFork;
     std::vector< reExecProc_t > reExecProc;
+    /* counted since statTime */
+    time_t statTime;
+    int startCnt;
+    int doneCnt;
+    int failCnt;
+    rodsLong_t latencySum;	/* seconds between exeTime and start */
+    int maxLatency;
 } reExec_t;
 
 int
 getReInfo( rsComm_t *rsComm, genQueryOut_t **genQueryOut );
 int
+getNextReExecTime( rsComm_t *rsComm, time_t *nextTime );
+int
+getReQueueStats( rsComm_t *rsComm, int *dueCnt, time_t *oldestTime );
+int
 getReInfoById( rsComm_t *rsComm, char *ruleExecId, genQueryOut_t **genQueryOut );
 int
 getNextQueuedRuleExec( genQueryOut_t **inGenQueryOut,
@@ -79,6 +100,16 @@ postForkExecProc( rsComm_t *rsComm, reExecProc_t *reExecProc );
 int
 execRuleExec( reExecProc_t *reExecProc );
 int
+startReExecProc( rsComm_t *rsComm, reExec_t *reExec, int thrInx );
+int
+stopReExecProc( reExec_t *reExec, int thrInx );
+int
+restartReExecProcs( rsComm_t *rsComm, reExec_t *reExec );
+int
+runReExecProc( rsComm_t *rsComm, int sock );
+int
+logReExecStats( rsComm_t *rsComm, reExec_t *reExec );
+int
 fillExecSubmitInp( ruleExecSubmitInp_t *ruleExecSubmitInp,  char *exeStatus,
                    char *exeTime, char *ruleExecId, char *reiFilePath, char *ruleName,
                    char *userName, char *exeAddress, char *exeFrequency, char *priority,
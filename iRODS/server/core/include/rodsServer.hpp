@@ -74,6 +74,12 @@ int
 spawnAgent( agentProc_t *connReq, agentProc_t **agentProcHead );
 int
 execAgent( int newSock, startupPack_t *startupPack );
+void
+closeQueuedSockets();
+int
+spawnPooledAgent();
+int
+replenishAgentPool();
 int
 queConnectedAgentProc( int childPid, agentProc_t *connReq,
                        agentProc_t **agentProcHead );
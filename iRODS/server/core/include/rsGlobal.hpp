@@ -34,9 +34,9 @@ int RescGrpInit = 0;    /* whether initRescGrp has been called */
 
 /* global fileDesc */
 
-fileDesc_t FileDesc[NUM_FILE_DESC];
-l1desc_t L1desc[NUM_L1_DESC];
-specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
+std::deque<fileDesc_t> FileDesc;
+std::deque<l1desc_t> L1desc;
+std::deque<specCollDesc_t> SpecCollDesc;
 std::vector<collHandle_t> CollHandle;
 
 /* global Rule Engine File Initialization String */
@@ -19,6 +19,8 @@
 // =-=-=-=-=-=-=-
 #include "irods_resource_manager.hpp"
 
+#include <deque>
+
 // =-=-=-=-=-=-=-
 // externs to singleton plugin managers
 extern irods::resource_manager resc_mgr;
@@ -32,9 +34,12 @@ extern rodsServerHost_t *ServerHostHead;
 extern rodsServerHost_t *HostConfigHead;
 extern zoneInfo_t *ZoneInfoHead;
 extern int RescGrpInit;
-extern fileDesc_t FileDesc[NUM_FILE_DESC];
-extern l1desc_t L1desc[NUM_L1_DESC];
-extern specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
+// =-=-=-=-=-=-=-
+// descriptor tables grow on demand, a deque keeps references to the
+// descriptors valid while it grows
+extern std::deque<fileDesc_t> FileDesc;
+extern std::deque<l1desc_t> L1desc;
+extern std::deque<specCollDesc_t> SpecCollDesc;
 extern std::vector<collHandle_t> CollHandle;;
 
 /* global Rule Engine File Initialization String */
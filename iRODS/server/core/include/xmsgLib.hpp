@@ -21,9 +21,11 @@
 
 #define REQ_MSG_TIMEOUT_TIME	5	/* 5 sec timeout for req msg */
 
-#define NUM_HASH_SLOT		47	/* number of slots for the ticket
-* hash key */
+#define NUM_HASH_SLOT		1021	/* number of slots for the ticket
+* hash key, each with its own lock */
 #define NUM_XMSG_THR		40       /* used to be 10 */
+#define NUM_XMSG_THR_PER_CORE	8	/* a thread serves one connection at a
+* time and mostly waits on it */
 
 int
 initThreadEnv();
@@ -49,6 +51,10 @@ procReqRoutine();
 int
 ticketHashFunc( uint rcvTicket );
 int
+lockTicketHashQue( uint rcvTicket );
+int
+unlockTicketHashQue( uint rcvTicket );
+int
 initXmsgHashQue();
 int
 getTicketMsgStructByTicket( uint rcvTicket,
@@ -19,27 +19,48 @@
 #include "irods_resource_manager.hpp"
 #include "irods_resource_plugin.hpp"
 
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// indices of freed FileDesc, reused before the table is grown
+static std::vector<int> FreeFileDescInx;
+
 int
 initFileDesc() {
-    memset( FileDesc, 0, sizeof( FileDesc ) );
+    FileDesc.clear();
+    FreeFileDescInx.clear();
+    /* 0 - 2 are reserved */
+    FileDesc.resize( 3 );
     return 0;
 }
 
+/* allocFileDesc - take a descriptor off the free list, or append one to
+ * the table if the free list is empty.
+ */
 int
 allocFileDesc() {
     int i;
 
-    for ( i = 3; i < NUM_FILE_DESC; i++ ) {
-        if ( FileDesc[i].inuseFlag == FD_FREE ) {
-            FileDesc[i].inuseFlag = FD_INUSE;
-            return i;
-        };
+    if ( FileDesc.size() < 3 ) {
+        FileDesc.resize( 3 );
     }
 
-    rodsLog( LOG_NOTICE,
-             "allocFileDesc: out of FileDesc" );
+    if ( !FreeFileDescInx.empty() ) {
+        i = FreeFileDescInx.back();
+        FreeFileDescInx.pop_back();
+    }
+    else if ( FileDesc.size() < MAX_NUM_FILE_DESC ) {
+        i = FileDesc.size();
+        FileDesc.push_back( fileDesc_t() );
+    }
+    else {
+        rodsLog( LOG_NOTICE,
+                 "allocFileDesc: out of FileDesc" );
+        return SYS_OUT_OF_FILE_DESC;
+    }
 
-    return SYS_OUT_OF_FILE_DESC;
+    FileDesc[i].inuseFlag = FD_INUSE;
+    return i;
 }
 
 int
@@ -68,7 +89,7 @@ allocAndFillFileDesc( rodsServerHost_t *rodsServerHost,
 
 int
 freeFileDesc( int fileInx ) {
-    if ( fileInx < 3 || fileInx >= NUM_FILE_DESC ) {
+    if ( fileInx < 3 || fileInx >= ( int ) FileDesc.size() ) {
         rodsLog( LOG_NOTICE,
                  "freeFileDesc: fileInx %d out of range", fileInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -88,6 +109,9 @@ freeFileDesc( int fileInx ) {
 
     /* don't free driverDep (dirPtr is not malloced */
 
+    if ( FileDesc[fileInx].inuseFlag == FD_INUSE ) {
+        FreeFileDescInx.push_back( fileInx );
+    }
     memset( &FileDesc[fileInx], 0, sizeof( fileDesc_t ) );
 
     return 0;
@@ -96,7 +120,7 @@ freeFileDesc( int fileInx ) {
 int
 getServerHostByFileInx( int fileInx, rodsServerHost_t **rodsServerHost ) {
     int remoteFlag;
-    if ( fileInx < 3 || fileInx >= NUM_FILE_DESC ) {
+    if ( fileInx < 3 || fileInx >= ( int ) FileDesc.size() ) {
         rodsLog( LOG_DEBUG,
                  "getServerHostByFileInx: Bad fileInx value %d", fileInx );
         return SYS_BAD_FILE_DESCRIPTOR;
@@ -114,6 +138,32 @@ getServerHostByFileInx( int fileInx, rodsServerHost_t **rodsServerHost ) {
     return remoteFlag;
 }
 
+/* getNativeFdByFileInx - return the driver fd of a local file whose leaf
+ * resource advertises RESOURCE_NATIVE_FD, i.e. the fd is a real unix file
+ * descriptor which may be handed to sendfile/splice.  Returns -1 if the
+ * data has to go through the resource plugin read/write operations.
+ */
+int
+getNativeFdByFileInx( int fileInx ) {
+    rodsServerHost_t *rodsServerHost = NULL;
+    if ( getServerHostByFileInx( fileInx, &rodsServerHost ) != LOCAL_HOST ||
+            FileDesc[fileInx].rescHier == NULL ||
+            FileDesc[fileInx].fd < 0 ) {
+        return -1;
+    }
+
+    int native_fd = 0;
+    irods::error ret = irods::get_resc_hier_property< int >(
+                           FileDesc[fileInx].rescHier,
+                           irods::RESOURCE_NATIVE_FD,
+                           native_fd );
+    if ( !ret.ok() || native_fd == 0 ) {
+        return -1;
+    }
+
+    return FileDesc[fileInx].fd;
+}
+
 int
 mkDirForFilePath(
     rsComm_t *          rsComm,
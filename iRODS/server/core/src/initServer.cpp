@@ -39,6 +39,7 @@
 
 static time_t LastBrokenPipeTime = 0;
 static int BrokenPipeCnt = 0;
+static int ServerInfoInitialized = 0;
 namespace {
 
     static std::set<std::vector<std::string> > allowedUsers;
@@ -670,12 +671,14 @@ initAgent( int processType, rsComm_t *rsComm ) {
 
     initProcLog();
 
-    status = initServerInfo( rsComm );
-    if ( status < 0 ) {
-        rodsLog( LOG_ERROR,
-                 "initAgent: initServerInfo error, status = %d",
-                 status );
-        return status;
+    if ( !ServerInfoInitialized ) {
+        status = initServerInfo( rsComm );
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "initAgent: initServerInfo error, status = %d",
+                     status );
+            return status;
+        }
     }
 
     initL1desc();
@@ -763,6 +766,38 @@ initAgent( int processType, rsComm_t *rsComm ) {
     return status;
 }
 
+/* preInitAgent - initialize the server host, zone and resource tables
+ * before a client connection is known, for an agent waiting in the agent
+ * pool. initAgent skips initServerInfo once this has succeeded.
+ */
+int
+preInitAgent() {
+    rsComm_t myComm;
+    int status = initRsComm( &myComm );
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "preInitAgent: initRsComm error, status = %d",
+                 status );
+        return status;
+    }
+
+    status = initServerInfo( &myComm );
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "preInitAgent: initServerInfo error, status = %d",
+                 status );
+        return status;
+    }
+
+    /* server to server connections made here carry the service account
+     * identity. drop them so the client's connections are made as the
+     * client */
+    disconnectAllSvrToSvrConn();
+
+    ServerInfoInitialized = 1;
+    return 0;
+}
+
 void
 cleanup() {
 #ifdef RODS_CAT
@@ -185,6 +185,7 @@ reServerMain( rsComm_t *rsComm, char* logDir ) {
     int runCnt;
     reExec_t reExec;
     int repeatedQueryErrorCount = 0; // JMC - backport 4520
+    uint irbTimeStamp;
 
     initReExec( rsComm, &reExec );
     LastRescUpdateTime = time( NULL );
@@ -198,9 +199,15 @@ reServerMain( rsComm_t *rsComm, char* logDir ) {
 #endif
 #endif
             rodsLog(
-                LOG_NOTICE,
+                LOG_DEBUG,
                 "reServerMain: checking the queue for jobs" );
+            irbTimeStamp = CoreIrbTimeStamp;
             chkAndResetRule();
+            if ( irbTimeStamp != 0 && CoreIrbTimeStamp != irbTimeStamp ) {
+                /* the executors still have the old rules */
+                restartReExecProcs( rsComm, &reExec );
+            }
+            logReExecStats( rsComm, &reExec );
             status = getReInfo( rsComm, &genQueryOut );
             if ( status < 0 ) {
                 if ( status != CAT_NO_ROWS_FOUND ) {
@@ -261,9 +268,15 @@ reServerMain( rsComm_t *rsComm, char* logDir ) {
 
 }
 
+/* reSvrSleep - sleep until the next rule is due, at most
+ * RE_SERVER_SLEEP_TIME seconds so that newly queued rules are seen
+ */
+
 int
 reSvrSleep( rsComm_t *rsComm ) {
     rodsServerHost_t *rodsServerHost = NULL;
+    time_t nextTime = 0;
+    int sleepTime = RE_SERVER_SLEEP_TIME;
     irods::server_properties& props = irods::server_properties::getInstance();
     irods::error ret = props.capture_if_needed();
     if ( !ret.ok() ) {
@@ -282,6 +295,14 @@ reSvrSleep( rsComm_t *rsComm ) {
 
     }
 
+    if ( getNextReExecTime( rsComm, &nextTime ) >= 0 &&
+            nextTime - time( NULL ) < sleepTime ) {
+        sleepTime = nextTime - time( NULL );
+        if ( sleepTime < 1 ) {
+            sleepTime = 1;
+        }
+    }
+
     int status = disconnRcatHost( MASTER_RCAT, zone_name.c_str() );
     if ( status == LOCAL_HOST ) {
 #ifdef RODS_CAT
@@ -292,7 +313,7 @@ reSvrSleep( rsComm_t *rsComm ) {
         }
 #endif
     }
-    rodsSleep( RE_SERVER_SLEEP_TIME, 0 );
+    rodsSleep( sleepTime, 0 );
 
     status = getAndConnRcatHost( rsComm, MASTER_RCAT, zone_name.c_str(), &rodsServerHost );
     if ( status == LOCAL_HOST ) {
@@ -0,0 +1,276 @@
+// =-=-=-=-=-=-=-
+// irods includes
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rcMisc.h"
+#include "irods_agent_pool.hpp"
+#include "irods_server_properties.hpp"
+#include "irods_client_server_negotiation.hpp"
+
+// =-=-=-=-=-=-=-
+// system includes
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+namespace irods {
+
+    agent_pool::agent_pool() :
+        configured_( false ),
+        min_idle_( 0 ),
+        failures_( 0 ),
+        next_spawn_time_( 0 ) {
+    }
+
+    agent_pool& agent_pool::instance() {
+        static agent_pool instance_;
+        return instance_;
+    }
+
+    error agent_pool::configure() {
+        int min_idle = 0;
+        error ret = get_advanced_setting< int >(
+                        CFG_AGENT_POOL_MIN_IDLE_AGENTS,
+                        min_idle );
+        if ( !ret.ok() || min_idle < 0 ) {
+            min_idle = 0;
+        }
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        min_idle_   = min_idle;
+        configured_ = true;
+
+        if ( min_idle_ > 0 ) {
+            rodsLog(
+                LOG_NOTICE,
+                "agent pool enabled with [%d] idle agents",
+                min_idle_ );
+        }
+
+        return SUCCESS();
+
+    } // configure
+
+    bool agent_pool::enabled() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return configured_ && min_idle_ > 0;
+    }
+
+    bool agent_pool::needs_agent() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return configured_ &&
+               static_cast< int >( idle_.size() ) < min_idle_ &&
+               time( 0 ) >= next_spawn_time_;
+    }
+
+    void agent_pool::add_idle(
+        int _pid,
+        int _ctrl_fd ) {
+        pooled_agent agent;
+        agent.pid     = _pid;
+        agent.ctrl_fd = _ctrl_fd;
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        idle_.push_back( agent );
+    }
+
+    error agent_pool::hand_off(
+        int                  _sock,
+        const startupPack_t& _pack,
+        int&                 _pid ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        while ( !idle_.empty() ) {
+            // =-=-=-=-=-=-=-
+            // take the most recently idled agent, its pages are the
+            // most likely to still be warm
+            pooled_agent agent = idle_.back();
+            idle_.pop_back();
+
+            struct iovec iov;
+            iov.iov_base = const_cast< startupPack_t* >( &_pack );
+            iov.iov_len  = sizeof( _pack );
+
+            char ctrl_buf[ CMSG_SPACE( sizeof( int ) ) ];
+            memset( ctrl_buf, 0, sizeof( ctrl_buf ) );
+
+            struct msghdr msg;
+            memset( &msg, 0, sizeof( msg ) );
+            msg.msg_iov        = &iov;
+            msg.msg_iovlen     = 1;
+            msg.msg_control    = ctrl_buf;
+            msg.msg_controllen = sizeof( ctrl_buf );
+
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type  = SCM_RIGHTS;
+            cmsg->cmsg_len   = CMSG_LEN( sizeof( int ) );
+            memcpy( CMSG_DATA( cmsg ), &_sock, sizeof( int ) );
+
+            ssize_t sent = 0;
+            do {
+                sent = sendmsg( agent.ctrl_fd, &msg, MSG_NOSIGNAL );
+            }
+            while ( sent < 0 && EINTR == errno );
+
+            if ( sent != static_cast< ssize_t >( sizeof( _pack ) ) ) {
+                // =-=-=-=-=-=-=-
+                // the agent has most likely died, it will be reaped
+                // by procChildren.  try the next one
+                rodsLog(
+                    LOG_NOTICE,
+                    "agent_pool::hand_off - failed to hand off to agent [%d], errno = %d",
+                    agent.pid,
+                    errno );
+                close( agent.ctrl_fd );
+                continue;
+            }
+
+            // =-=-=-=-=-=-=-
+            // the agent now serves this client like any other agent and
+            // exits when done, an agent which got a client did start up
+            close( agent.ctrl_fd );
+            failures_ = 0;
+            next_spawn_time_ = 0;
+            _pid = agent.pid;
+            return SUCCESS();
+
+        } // while
+
+        return ERROR(
+                   SYS_AGENT_INIT_ERR,
+                   "no idle agent available" );
+
+    } // hand_off
+
+    bool agent_pool::reap( int _pid ) {
+        boost::mutex::scoped_lock lock( mutex_ );
+        for ( size_t i = 0; i < idle_.size(); ++i ) {
+            if ( _pid == idle_[ i ].pid ) {
+                close( idle_[ i ].ctrl_fd );
+                idle_.erase( idle_.begin() + i );
+
+                // =-=-=-=-=-=-=-
+                // an idle agent only exits if it failed, double the delay
+                // before the next spawn so an agent which cannot start does
+                // not turn into a fork loop
+                int backoff = 1 << std::min( failures_, 6 );
+                if ( backoff > MAX_AGENT_POOL_SPAWN_BACKOFF ) {
+                    backoff = MAX_AGENT_POOL_SPAWN_BACKOFF;
+                }
+                failures_++;
+                next_spawn_time_ = time( 0 ) + backoff;
+                if ( failures_ > 1 ) {
+                    rodsLog(
+                        LOG_NOTICE,
+                        "agent_pool::reap - idle agents keep exiting, next spawn in [%d] seconds",
+                        backoff );
+                }
+                return true;
+            }
+        }
+
+        return false;
+
+    } // reap
+
+    void agent_pool::shutdown() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        for ( size_t i = 0; i < idle_.size(); ++i ) {
+            close( idle_[ i ].ctrl_fd );
+        }
+        idle_.clear();
+        min_idle_ = 0;
+
+    } // shutdown
+
+    error agent_pool::receive_connection(
+        int            _ctrl_fd,
+        startupPack_t& _pack,
+        int&           _sock ) {
+        struct iovec iov;
+        iov.iov_base = &_pack;
+        iov.iov_len  = sizeof( _pack );
+
+        char ctrl_buf[ CMSG_SPACE( sizeof( int ) ) ];
+        memset( ctrl_buf, 0, sizeof( ctrl_buf ) );
+
+        struct msghdr msg;
+        memset( &msg, 0, sizeof( msg ) );
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = ctrl_buf;
+        msg.msg_controllen = sizeof( ctrl_buf );
+
+        ssize_t len = 0;
+        do {
+            len = recvmsg( _ctrl_fd, &msg, 0 );
+        }
+        while ( len < 0 && EINTR == errno );
+
+        if ( 0 == len ) {
+            return ERROR(
+                       SYS_SOCK_READ_ERR,
+                       "server closed the agent pool socket" );
+        }
+        else if ( len != static_cast< ssize_t >( sizeof( _pack ) ) ) {
+            std::stringstream msg_str;
+            msg_str << "short read on agent pool socket, errno = " << errno;
+            return ERROR(
+                       SYS_SOCK_READ_ERR,
+                       msg_str.str() );
+        }
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+        if ( !cmsg ||
+                SOL_SOCKET != cmsg->cmsg_level ||
+                SCM_RIGHTS != cmsg->cmsg_type ) {
+            return ERROR(
+                       SYS_SOCK_READ_ERR,
+                       "no socket passed on agent pool socket" );
+        }
+
+        memcpy( &_sock, CMSG_DATA( cmsg ), sizeof( int ) );
+
+        return SUCCESS();
+
+    } // receive_connection
+
+    void agent_pool::set_startup_env(
+        int                  _sock,
+        const startupPack_t& _pack ) {
+        mySetenvInt( SP_NEW_SOCK, _sock );
+        mySetenvInt( SP_PROTOCOL, _pack.irodsProt );
+        mySetenvInt( SP_RECONN_FLAG, _pack.reconnFlag );
+        mySetenvInt( SP_CONNECT_CNT, _pack.connectCnt );
+        mySetenvStr( SP_PROXY_USER, _pack.proxyUser );
+        mySetenvStr( SP_PROXY_RODS_ZONE, _pack.proxyRodsZone );
+        mySetenvStr( SP_CLIENT_USER, _pack.clientUser );
+        mySetenvStr( SP_CLIENT_RODS_ZONE, _pack.clientRodsZone );
+        mySetenvStr( SP_REL_VERSION, _pack.relVersion );
+        mySetenvStr( SP_API_VERSION, _pack.apiVersion );
+
+        // =-=-=-=-=-=-=-
+        // if the client-server negotiation request is in the
+        // option variable, set that env var and strip it out
+        std::string opt_str( _pack.option );
+        size_t pos = opt_str.find( REQ_SVR_NEG );
+        if ( std::string::npos != pos ) {
+            std::string trunc_str = opt_str.substr( 0, pos );
+            mySetenvStr( SP_OPTION,           trunc_str.c_str() );
+            mySetenvStr( irods::RODS_CS_NEG, REQ_SVR_NEG );
+
+        }
+        else {
+            mySetenvStr( SP_OPTION, _pack.option );
+            unsetenv( irods::RODS_CS_NEG );
+
+        }
+
+    } // set_startup_env
+
+}; // namespace irods
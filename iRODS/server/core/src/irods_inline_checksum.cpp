@@ -0,0 +1,156 @@
+// =-=-=-=-=-=-=-
+// irods includes
+#include "irods_inline_checksum.hpp"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <string>
+#include <algorithm>
+
+namespace irods {
+
+    inline_checksum::inline_checksum(
+        const Hasher&      _hasher,
+        const std::string& _scheme ) :
+        hasher_( _hasher ),
+        size_( 0 ),
+        valid_( true ),
+        tree_( SHA256_TREE_NAME == _scheme ) {
+    }
+
+    bool inline_checksum::hashes_segments() {
+        return tree_;
+    }
+
+    void inline_checksum::update(
+        rodsLong_t  _offset,
+        const char* _buf,
+        int         _len ) {
+        if ( _len <= 0 ) {
+            return;
+        }
+
+        // =-=-=-=-=-=-=-
+        // split the bytes of a tree checksum by chunk
+        if ( tree_ ) {
+            while ( _len > 0 ) {
+                rodsLong_t chunk = _offset / SHA256_TREE_CHUNK_SIZE;
+                rodsLong_t pos   = _offset - chunk * SHA256_TREE_CHUNK_SIZE;
+                int len = ( int ) std::min( SHA256_TREE_CHUNK_SIZE - pos, ( rodsLong_t ) _len );
+                update_leaf( chunk, pos, _buf, len );
+                _offset += len;
+                _buf    += len;
+                _len    -= len;
+            }
+            return;
+        }
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        if ( _offset < size_ ) {
+            // =-=-=-=-=-=-=-
+            // hashed bytes were overwritten
+            valid_ = false;
+        }
+        else if ( _offset == size_ && valid_ ) {
+            hasher_.update( _buf, _len );
+            size_ += _len;
+        }
+        // =-=-=-=-=-=-=-
+        // bytes past the prefix are read back when the checksum is finished
+
+    } // update
+
+    bool inline_checksum::valid() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return valid_;
+    }
+
+    rodsLong_t inline_checksum::size() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return size_;
+    }
+
+    Hasher inline_checksum::hasher() {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return hasher_;
+    }
+
+    void inline_checksum::update_leaf(
+        rodsLong_t  _chunk,
+        rodsLong_t  _pos,
+        const char* _buf,
+        int         _len ) {
+        leaf_t* leaf = 0;
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            std::map< rodsLong_t, leaf_t >::iterator itr = leaves_.find( _chunk );
+            if ( itr == leaves_.end() ) {
+                // =-=-=-=-=-=-=-
+                // a chunk is only hashed by the thread which writes its start
+                if ( _pos != 0 ) {
+                    return;
+                }
+                leaf = &leaves_[ _chunk ];
+                SHA256_Init( &leaf->ctx );
+                leaf->size   = 0;
+                leaf->busy   = false;
+                leaf->broken = false;
+            }
+            else {
+                leaf = &itr->second;
+            }
+
+            if ( leaf->broken ) {
+                return;
+            }
+            if ( leaf->busy || _pos != leaf->size ) {
+                // =-=-=-=-=-=-=-
+                // hashed bytes were overwritten or bytes were skipped,
+                // the chunk is read back when the checksum is finished
+                leaf->broken = true;
+                return;
+            }
+            leaf->busy = true;
+        }
+
+        // =-=-=-=-=-=-=-
+        // hash outside of the lock so the threads hash their chunks at once
+        SHA256_Update( &leaf->ctx, _buf, _len );
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        leaf->size += _len;
+        leaf->busy  = false;
+
+    } // update_leaf
+
+    bool inline_checksum::leaves(
+        rodsLong_t     _size,
+        tree_leaves_t& _leaves ) {
+        rodsLong_t chunks = ( _size + SHA256_TREE_CHUNK_SIZE - 1 ) / SHA256_TREE_CHUNK_SIZE;
+        _leaves.assign( chunks, std::string() );
+
+        boost::mutex::scoped_lock lock( mutex_ );
+        rodsLong_t found = 0;
+        std::map< rodsLong_t, leaf_t >::iterator itr;
+        for ( itr = leaves_.begin(); itr != leaves_.end(); ++itr ) {
+            rodsLong_t chunk = itr->first;
+            leaf_t&    leaf  = itr->second;
+            if ( chunk >= chunks || leaf.broken || leaf.busy ||
+                    leaf.size != std::min( SHA256_TREE_CHUNK_SIZE, _size - chunk * SHA256_TREE_CHUNK_SIZE ) ) {
+                continue;
+            }
+
+            // =-=-=-=-=-=-=-
+            // finish a copy, the chunk may still be extended
+            SHA256_CTX ctx = leaf.ctx;
+            unsigned char digest[SHA256_DIGEST_LENGTH];
+            SHA256_Final( digest, &ctx );
+            _leaves[ chunk ].assign( ( char* ) digest, SHA256_DIGEST_LENGTH );
+            ++found;
+        }
+
+        return found == chunks;
+
+    } // leaves
+
+}; // namespace irods
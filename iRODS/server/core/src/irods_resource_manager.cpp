@@ -14,25 +14,77 @@
 #include "phyBundleColl.h"
 #include "miscServerFunct.hpp"
 #include "genQuery.h"
+#include "packStruct.h"
+#include "rsLog.hpp"
 
 // =-=-=-=-=-=-=-
 // stl includes
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <vector>
 
+// =-=-=-=-=-=-=-
+// system includes
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 // =-=-=-=-=-=-=-
 // global singleton
 irods::resource_manager resc_mgr;
 
+namespace {
+// =-=-=-=-=-=-=-
+// the resource snapshot is this header followed by page_count packed
+// GenQueryOut_PI pages, each preceded by a page header and padded to a
+// multiple of 8 bytes so every page header stays aligned in the mapping
+    const char RESOURCE_SNAPSHOT_MAGIC[ 8 ] = { 'i', 'R', 'O', 'D', 'S', 'R', 'S', '1' };
+
+    struct resource_snapshot_header_t {
+        char magic[ 8 ];
+        char generation[ NAME_LEN ];
+        int  page_count;
+        int  pad;
+    };
+
+    struct resource_snapshot_page_t {
+        int len;
+        int pad;
+    };
+
+    size_t snapshot_padded_len( size_t _len ) {
+        return ( _len + 7 ) & ~static_cast< size_t >( 7 );
+    }
+
+    std::string resource_snapshot_path() {
+        std::stringstream path;
+        path << getLogDir() << "/resourceSnapshot";
+        return path.str();
+    }
+
+    double elapsed_ms( const struct timeval& _start ) {
+        struct timeval now;
+        gettimeofday( &now, NULL );
+        return ( now.tv_sec - _start.tv_sec ) * 1000.0 +
+               ( now.tv_usec - _start.tv_usec ) / 1000.0;
+    }
+
+} // namespace
+
 namespace irods {
 // =-=-=-=-=-=-=-
 // public - Constructor
-    resource_manager::resource_manager() {
+    resource_manager::resource_manager() :
+        counters_stale_( false ) {
     } // ctor
 
 // =-=-=-=-=-=-=-
 // public - Copy Constructor
-    resource_manager::resource_manager( const resource_manager& ) {
+    resource_manager::resource_manager( const resource_manager& ) :
+        counters_stale_( false ) {
     } // cctor
 
 // =-=-=-=-=-=-=-
@@ -156,89 +208,168 @@ namespace irods {
         // =-=-=-=-=-=-=-
         // clear existing resource map and initialize
         resources_.clear();
+        counters_stale_ = false;
 
-        // =-=-=-=-=-=-=-
-        // set up data structures for a gen query
-        genQueryInp_t  genQueryInp;
-        genQueryOut_t* genQueryOut = NULL;
-
-        error proc_ret;
+        struct timeval start;
+        gettimeofday( &start, NULL );
 
-        memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+        // =-=-=-=-=-=-=-
+        // another agent may already have queried the resource table at the
+        // current generation, in which case its results are used as is.  the
+        // generation is read before the table so a snapshot is never saved
+        // under a generation newer than its contents.  the free space and
+        // object counts in a snapshot may be out of date, they are read
+        // again by refresh_resource_counters when they are needed
+        std::string generation;
+        error proc_ret = get_resource_generation( _comm, generation );
+        if ( proc_ret.ok() ) {
+            proc_ret = load_resource_snapshot( generation );
+            if ( proc_ret.ok() ) {
+                counters_stale_ = true;
+                rodsLog( LOG_DEBUG, "init_from_catalog - resource table loaded from the snapshot at generation [%s] in %.3f ms",
+                         generation.c_str(), elapsed_ms( start ) );
+            }
+            else {
+                rodsLog( LOG_DEBUG, "init_from_catalog - resource snapshot not used - %s",
+                         proc_ret.result().c_str() );
+                resources_.clear();
+            }
 
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_ID,       1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_NAME,     1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_ZONE_NAME,     1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_TYPE_NAME,     1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_CLASS_NAME,    1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_LOC,           1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_VAULT_PATH,    1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_FREE_SPACE,    1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_INFO,     1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_COMMENT,  1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_CREATE_TIME,   1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_MODIFY_TIME,   1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_STATUS,   1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_CHILDREN, 1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_CONTEXT,  1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_PARENT,   1 );
-        addInxIval( &genQueryInp.selectInp, COL_R_RESC_OBJCOUNT, 1 );
+        }
+        else {
+            rodsLog( LOG_DEBUG, "init_from_catalog - resource generation not available - %s",
+                     proc_ret.result().c_str() );
+            generation.clear();
 
-        genQueryInp.maxRows = MAX_SQL_ROWS;
+        }
+        generation_ = generation;
 
-        // =-=-=-=-=-=-=-
-        // init continueInx to pass for first loop
-        int continueInx = 1;
+        if ( !proc_ret.ok() ) {
+            // =-=-=-=-=-=-=-
+            // set up data structures for a gen query
+            genQueryInp_t  genQueryInp;
+            genQueryOut_t* genQueryOut = NULL;
 
-        // =-=-=-=-=-=-=-
-        // loop until continuation is not requested
-        while ( continueInx > 0 ) {
+            // =-=-=-=-=-=-=-
+            // packed pages of the query for the snapshot
+            std::vector< bytesBuf_t* > pages;
+            bool save_snapshot = !generation.empty();
+
+            memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_ID,       1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_NAME,     1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_ZONE_NAME,     1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_TYPE_NAME,     1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_CLASS_NAME,    1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_LOC,           1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_VAULT_PATH,    1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_FREE_SPACE,    1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_INFO,     1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_COMMENT,  1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_CREATE_TIME,   1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_MODIFY_TIME,   1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_STATUS,   1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_CHILDREN, 1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_CONTEXT,  1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_PARENT,   1 );
+            addInxIval( &genQueryInp.selectInp, COL_R_RESC_OBJCOUNT, 1 );
+
+            genQueryInp.maxRows = MAX_SQL_ROWS;
 
             // =-=-=-=-=-=-=-
-            // perform the general query
-            int status = rsGenQuery( _comm, &genQueryInp, &genQueryOut );
+            // init continueInx to pass for first loop
+            int continueInx = 1;
 
             // =-=-=-=-=-=-=-
-            // perform the general query
-            if ( status < 0 ) {
-                if ( status != CAT_NO_ROWS_FOUND ) {
-                    rodsLog( LOG_NOTICE, "initResc: rsGenQuery error, status = %d",
-                             status );
-                }
+            // loop until continuation is not requested
+            while ( continueInx > 0 ) {
 
-                freeGenQueryOut( &genQueryOut );
-                clearGenQueryInp( &genQueryInp );
-                return ERROR( status, "genQuery failed." );
+                // =-=-=-=-=-=-=-
+                // perform the general query
+                int status = rsGenQuery( _comm, &genQueryInp, &genQueryOut );
 
-            } // if
+                // =-=-=-=-=-=-=-
+                // perform the general query
+                if ( status < 0 ) {
+                    if ( status != CAT_NO_ROWS_FOUND ) {
+                        rodsLog( LOG_NOTICE, "initResc: rsGenQuery error, status = %d",
+                                 status );
+                    }
 
-            // =-=-=-=-=-=-=-
-            // given a series of rows, each being a resource, create a resource and add it to the table
-            proc_ret = process_init_results( genQueryOut );
+                    for ( size_t i = 0; i < pages.size(); ++i ) {
+                        freeBBuf( pages[ i ] );
+                    }
+                    freeGenQueryOut( &genQueryOut );
+                    clearGenQueryInp( &genQueryInp );
+                    return ERROR( status, "genQuery failed." );
 
-            // =-=-=-=-=-=-=-
-            // if error is not valid, clear query and bail
-            if ( !proc_ret.ok() ) {
-                irods::error log_err = PASSMSG( "init_from_catalog - process_init_results failed", proc_ret );
-                irods::log( log_err );
-                freeGenQueryOut( &genQueryOut );
-                break;
-            }
-            else {
-                if ( genQueryOut != NULL ) {
-                    continueInx = genQueryInp.continueInx = genQueryOut->continueInx;
+                } // if
+
+                // =-=-=-=-=-=-=-
+                // given a series of rows, each being a resource, create a resource and add it to the table
+                proc_ret = process_init_results( genQueryOut );
+
+                // =-=-=-=-=-=-=-
+                // if error is not valid, clear query and bail
+                if ( !proc_ret.ok() ) {
+                    irods::error log_err = PASSMSG( "init_from_catalog - process_init_results failed", proc_ret );
+                    irods::log( log_err );
                     freeGenQueryOut( &genQueryOut );
+                    break;
                 }
                 else {
-                    continueInx = 0;
+                    if ( genQueryOut != NULL ) {
+                        // =-=-=-=-=-=-=-
+                        // keep the page for the snapshot
+                        if ( save_snapshot ) {
+                            bytesBuf_t* page = NULL;
+                            status = packStruct( genQueryOut, &page, "GenQueryOut_PI",
+                                                 RodsPackTable, 0, NATIVE_PROT );
+                            if ( status < 0 ) {
+                                rodsLog( LOG_NOTICE, "init_from_catalog - packStruct failed, status = %d",
+                                         status );
+                                save_snapshot = false;
+                            }
+                            else {
+                                pages.push_back( page );
+                            }
+                        }
+
+                        continueInx = genQueryInp.continueInx = genQueryOut->continueInx;
+                        freeGenQueryOut( &genQueryOut );
+                    }
+                    else {
+                        continueInx = 0;
+                    }
+
+                } // else
+
+            } // while
+
+            freeGenQueryOut( &genQueryOut );
+            clearGenQueryInp( &genQueryInp );
+
+            // =-=-=-=-=-=-=-
+            // share the results with the agents started after this one,
+            // a failure only costs them the query
+            if ( proc_ret.ok() && save_snapshot ) {
+                error snap_ret = save_resource_snapshot( generation, pages );
+                if ( !snap_ret.ok() ) {
+                    irods::log( PASSMSG( "init_from_catalog - save_resource_snapshot failed", snap_ret ) );
                 }
+            }
 
-            } // else
+            for ( size_t i = 0; i < pages.size(); ++i ) {
+                freeBBuf( pages[ i ] );
+            }
 
-        } // while
+            if ( proc_ret.ok() ) {
+                rodsLog( LOG_DEBUG, "init_from_catalog - resource table loaded from the catalog in %.3f ms",
+                         elapsed_ms( start ) );
+            }
 
-        freeGenQueryOut( &genQueryOut );
-        clearGenQueryInp( &genQueryInp );
+        } // if !proc_ret
 
         // =-=-=-=-=-=-=-
         // pass along the error if we are in an error state
@@ -281,6 +412,266 @@ namespace irods {
 
     } // init_from_catalog
 
+// =-=-=-=-=-=-=-
+// public - check whether the resource table changed since it was loaded
+    error resource_manager::resource_generation_changed(
+        rsComm_t* _comm,
+        bool&     _changed ) {
+        _changed = false;
+        if ( generation_.empty() ) {
+            return SUCCESS();
+        }
+
+        std::string generation;
+        error ret = get_resource_generation( _comm, generation );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        _changed = ( generation != generation_ );
+        return SUCCESS();
+
+    } // resource_generation_changed
+
+// =-=-=-=-=-=-=-
+// public - mark the free space and object counts as out of date
+    void resource_manager::invalidate_resource_counters( void ) {
+        counters_stale_ = true;
+
+    } // invalidate_resource_counters
+
+// =-=-=-=-=-=-=-
+// public - read the free space and object counts if they are out of date
+    error resource_manager::refresh_resource_counters( rsComm_t* _comm ) {
+        if ( !counters_stale_ ) {
+            return SUCCESS();
+        }
+
+        error ret = load_resource_counters( _comm );
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        counters_stale_ = false;
+        return SUCCESS();
+
+    } // refresh_resource_counters
+
+// =-=-=-=-=-=-=-
+// public - update the free space and object count of the loaded resources
+    error resource_manager::load_resource_counters( rsComm_t* _comm ) {
+        genQueryInp_t  genQueryInp;
+        genQueryOut_t* genQueryOut = NULL;
+
+        memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+        addInxIval( &genQueryInp.selectInp, COL_R_RESC_NAME,     1 );
+        addInxIval( &genQueryInp.selectInp, COL_R_FREE_SPACE,    1 );
+        addInxIval( &genQueryInp.selectInp, COL_R_RESC_OBJCOUNT, 1 );
+        genQueryInp.maxRows = MAX_SQL_ROWS;
+
+        int status = rsGenQuery( _comm, &genQueryInp, &genQueryOut );
+        while ( status >= 0 && genQueryOut != NULL ) {
+            sqlResult_t* rescName     = getSqlResultByInx( genQueryOut, COL_R_RESC_NAME );
+            sqlResult_t* freeSpace    = getSqlResultByInx( genQueryOut, COL_R_FREE_SPACE );
+            sqlResult_t* rescObjCount = getSqlResultByInx( genQueryOut, COL_R_RESC_OBJCOUNT );
+            if ( rescName == NULL || freeSpace == NULL || rescObjCount == NULL ) {
+                status = UNMATCHED_KEY_OR_INDEX;
+                break;
+            }
+
+            for ( int i = 0; i < genQueryOut->rowCnt; ++i ) {
+                std::string name = &rescName->value[ rescName->len * i ];
+                if ( !resources_.has_entry( name ) ) {
+                    continue;
+                }
+                resource_ptr resc = resources_[ name ];
+                resc->set_property<long>( RESOURCE_FREESPACE,
+                                          strtoll( &freeSpace->value[ freeSpace->len * i ], 0, 0 ) );
+                resc->set_property<std::string>( RESOURCE_OBJCOUNT,
+                                                 &rescObjCount->value[ rescObjCount->len * i ] );
+            }
+
+            if ( genQueryOut->continueInx <= 0 ) {
+                break;
+            }
+            genQueryInp.continueInx = genQueryOut->continueInx;
+            freeGenQueryOut( &genQueryOut );
+            status = rsGenQuery( _comm, &genQueryInp, &genQueryOut );
+        }
+
+        freeGenQueryOut( &genQueryOut );
+        clearGenQueryInp( &genQueryInp );
+        if ( status < 0 ) {
+            return ERROR( status, "failed to query the resource counters" );
+        }
+
+        return SUCCESS();
+
+    } // load_resource_counters
+
+// =-=-=-=-=-=-=-
+// private - read the resource generation from the grid configuration
+    error resource_manager::get_resource_generation(
+        rsComm_t*    _comm,
+        std::string& _generation ) {
+        genQueryInp_t  genQueryInp;
+        genQueryOut_t* genQueryOut = NULL;
+
+        memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+        addInxIval( &genQueryInp.selectInp, COL_GRID_CONF_OPTION_VALUE, 1 );
+        addInxVal( &genQueryInp.sqlCondInp, COL_GRID_CONF_NAMESPACE,   "='database'" );
+        addInxVal( &genQueryInp.sqlCondInp, COL_GRID_CONF_OPTION_NAME, "='resource_generation'" );
+        genQueryInp.maxRows = 1;
+
+        int status = rsGenQuery( _comm, &genQueryInp, &genQueryOut );
+        clearGenQueryInp( &genQueryInp );
+        if ( status < 0 ) {
+            freeGenQueryOut( &genQueryOut );
+            return ERROR( status, "rsGenQuery failed for the resource generation" );
+        }
+
+        sqlResult_t* value = getSqlResultByInx( genQueryOut, COL_GRID_CONF_OPTION_VALUE );
+        if ( value == NULL || genQueryOut->rowCnt < 1 ) {
+            freeGenQueryOut( &genQueryOut );
+            return ERROR( UNMATCHED_KEY_OR_INDEX, "getSqlResultByInx for COL_GRID_CONF_OPTION_VALUE failed" );
+        }
+
+        _generation = value->value;
+        freeGenQueryOut( &genQueryOut );
+
+        if ( _generation.empty() || _generation.size() >= NAME_LEN ) {
+            return ERROR( SYS_INVALID_INPUT_PARAM, "invalid resource generation" );
+        }
+
+        return SUCCESS();
+
+    } // get_resource_generation
+
+// =-=-=-=-=-=-=-
+// private - map the snapshot saved by another agent and process its
+//           pages if it was saved at the given generation
+    error resource_manager::load_resource_snapshot(
+        const std::string& _generation ) {
+        std::string path = resource_snapshot_path();
+        int fd = open( path.c_str(), O_RDONLY );
+        if ( fd < 0 ) {
+            return ERROR( UNIX_FILE_OPEN_ERR - errno, path );
+        }
+
+        // =-=-=-=-=-=-=-
+        // only trust a snapshot written by this server's own user
+        struct stat st;
+        if ( fstat( fd, &st ) != 0 ||
+                st.st_uid != geteuid() ||
+                st.st_size < static_cast< off_t >( sizeof( resource_snapshot_header_t ) ) ) {
+            close( fd );
+            return ERROR( SYS_INVALID_INPUT_PARAM, "invalid resource snapshot [" + path + "]" );
+        }
+
+        // =-=-=-=-=-=-=-
+        // map privately so the unpacking may never write through to the file
+        size_t size = static_cast< size_t >( st.st_size );
+        void* map = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        close( fd );
+        if ( map == MAP_FAILED ) {
+            return ERROR( SYS_INVALID_INPUT_PARAM - errno, "mmap failed for [" + path + "]" );
+        }
+
+        char* buf = static_cast< char* >( map );
+        const resource_snapshot_header_t* header = reinterpret_cast< const resource_snapshot_header_t* >( buf );
+        if ( memcmp( header->magic, RESOURCE_SNAPSHOT_MAGIC, sizeof( header->magic ) ) != 0 ||
+                strncmp( header->generation, _generation.c_str(), NAME_LEN ) != 0 ) {
+            munmap( map, size );
+            return ERROR( SYS_INVALID_INPUT_PARAM, "resource snapshot is not at generation [" + _generation + "]" );
+        }
+
+        error result = SUCCESS();
+        size_t offset = sizeof( resource_snapshot_header_t );
+        for ( int i = 0; result.ok() && i < header->page_count; ++i ) {
+            if ( offset + sizeof( resource_snapshot_page_t ) > size ) {
+                result = ERROR( SYS_INVALID_INPUT_PARAM, "truncated resource snapshot" );
+                break;
+            }
+
+            const resource_snapshot_page_t* page = reinterpret_cast< const resource_snapshot_page_t* >( buf + offset );
+            offset += sizeof( resource_snapshot_page_t );
+            if ( page->len <= 0 || offset + page->len > size ) {
+                result = ERROR( SYS_INVALID_INPUT_PARAM, "truncated resource snapshot" );
+                break;
+            }
+
+            genQueryOut_t* genQueryOut = NULL;
+            int status = unpackStruct( buf + offset, ( void ** ) &genQueryOut, "GenQueryOut_PI",
+                                       RodsPackTable, NATIVE_PROT );
+            if ( status < 0 ) {
+                result = ERROR( status, "unpackStruct failed for the resource snapshot" );
+                break;
+            }
+
+            result = process_init_results( genQueryOut );
+            freeGenQueryOut( &genQueryOut );
+            offset += snapshot_padded_len( page->len );
+
+        } // for i
+
+        munmap( map, size );
+
+        if ( !result.ok() ) {
+            return PASS( result );
+        }
+
+        return SUCCESS();
+
+    } // load_resource_snapshot
+
+// =-=-=-=-=-=-=-
+// private - write the snapshot next to its final name and rename it into
+//           place so agents never map a partially written snapshot
+    error resource_manager::save_resource_snapshot(
+        const std::string&                _generation,
+        const std::vector< bytesBuf_t* >& _pages ) {
+        std::string path = resource_snapshot_path();
+        std::stringstream tmp_path;
+        tmp_path << path << "." << getpid();
+
+        resource_snapshot_header_t header;
+        memset( &header, 0, sizeof( header ) );
+        memcpy( header.magic, RESOURCE_SNAPSHOT_MAGIC, sizeof( header.magic ) );
+        rstrcpy( header.generation, _generation.c_str(), NAME_LEN );
+        header.page_count = _pages.size();
+
+        std::ofstream out( tmp_path.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if ( !out.is_open() ) {
+            return ERROR( UNIX_FILE_OPEN_ERR - errno, "failed to open [" + tmp_path.str() + "]" );
+        }
+
+        const char padding[ 8 ] = { 0 };
+        out.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+        for ( size_t i = 0; i < _pages.size(); ++i ) {
+            resource_snapshot_page_t page;
+            page.len = _pages[ i ]->len;
+            page.pad = 0;
+            out.write( reinterpret_cast< const char* >( &page ), sizeof( page ) );
+            out.write( static_cast< const char* >( _pages[ i ]->buf ), page.len );
+            out.write( padding, snapshot_padded_len( page.len ) - page.len );
+        }
+
+        out.close();
+        if ( out.fail() ) {
+            unlink( tmp_path.str().c_str() );
+            return ERROR( UNIX_FILE_WRITE_ERR, "failed to write [" + tmp_path.str() + "]" );
+        }
+
+        if ( rename( tmp_path.str().c_str(), path.c_str() ) != 0 ) {
+            int status = UNIX_FILE_RENAME_ERR - errno;
+            unlink( tmp_path.str().c_str() );
+            return ERROR( status, "failed to rename [" + tmp_path.str() + "]" );
+        }
+
+        return SUCCESS();
+
+    } // save_resource_snapshot
+
 // =-=-=-=-=-=-=-
 /// @brief call shutdown on resources before destruction
     error resource_manager::shut_down_resources( ) {
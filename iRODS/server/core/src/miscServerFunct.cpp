@@ -28,6 +28,7 @@
 #include "reFuncDefs.hpp"
 #include <string>
 #include <vector>
+#include <boost/bind.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/lexical_cast.hpp>
 #include <openssl/md5.h>
@@ -42,12 +43,14 @@ char *__loc1;
 #include "irods_stacktrace.hpp"
 #include "irods_network_factory.hpp"
 #include "irods_buffer_encryption.hpp"
+#include "irods_transfer_pipeline.hpp"
 #include "irods_client_server_negotiation.hpp"
 #include "irods_exception.hpp"
 #include "irods_serialization.hpp"
 #include "irods_hierarchy_parser.hpp"
 #include "irods_home_directory.hpp"
 #include "irods_threads.hpp"
+#include "irods_inline_checksum.hpp"
 #include "sockCommNetworkInterface.hpp"
 
 #include <iomanip>
@@ -169,6 +172,7 @@ setupSrvPortalForParaOpr( rsComm_t *rsComm, dataOprInp_t *dataOprInp,
         rsComm->portalOpr->dataOprInp = *dataOprInp;
         memset( &dataOprInp->condInput, 0, sizeof( dataOprInp->condInput ) );
         rsComm->portalOpr->dataOprInp.numThreads = myDataObjPutOut->numThreads;
+        rsComm->portalOpr->l1descInx = 0;
     }
 
     return 0;
@@ -365,6 +369,7 @@ svrPortalPutGet( rsComm_t *rsComm ) {
     int oprType;
     int flags = 0;
     int retVal = 0;
+    irods::inline_checksum *inlineChksum = NULL;
 
     myPortalOpr = rsComm->portalOpr;
 
@@ -427,6 +432,13 @@ svrPortalPutGet( rsComm_t *rsComm ) {
         fillPortalTransferInp( &myInput[0], rsComm,
                                portalFd, dataOprInp->destL3descInx, 0, dataOprInp->destRescTypeInx,
                                0, size0, offset0, flags );
+        /* the first thread writes the start of the file, which it can hash
+         * as it goes. the rest of the file is read back on close, unless
+         * the checksum is a tree checksum which every thread updates */
+        if ( myPortalOpr->l1descInx > 2 ) {
+            inlineChksum = L1desc[myPortalOpr->l1descInx].inlineChksum;
+            myInput[0].inlineChksum = inlineChksum;
+        }
     }
     else {
         fillPortalTransferInp( &myInput[0], rsComm,
@@ -482,6 +494,9 @@ svrPortalPutGet( rsComm_t *rsComm ) {
                                        portalFd, l3descInx, 0,
                                        dataOprInp->destRescTypeInx,
                                        i, mySize, myOffset, flags );
+                if ( inlineChksum != NULL && inlineChksum->hashes_segments() ) {
+                    myInput[i].inlineChksum = inlineChksum;
+                }
                 tid[i] = new boost::thread( partialDataPut, &myInput[i] );
 
             }
@@ -563,6 +578,110 @@ int fillPortalTransferInp(
 }
 
 
+/* state shared by the stages of an encrypted server portal stream */
+typedef struct SvrCryptStreamInp {
+    portalTransferInp_t *myInput;
+    int l3descInx;
+    rodsLong_t toXfer;
+    rodsLong_t offset; /* file offset of the next frame */
+    int bufSize;
+    int maxFrameSize;
+    irods::buffer_crypt *crypt;
+    irods::buffer_crypt::array_t sharedSecret;
+} svrCryptStreamInp_t;
+
+static int
+l3ReadStage( svrCryptStreamInp_t *stream,
+             irods::transfer_pipeline::frame& frame ) {
+    if ( stream->toXfer <= 0 ) {
+        return 0;
+    }
+
+    int toRead = stream->toXfer > stream->bufSize ?
+                 stream->bufSize : stream->toXfer;
+    frame.plain.resize( toRead );
+    int bytesRead = _l3Read( stream->myInput->rsComm, stream->l3descInx,
+                             &frame.plain[0], toRead );
+    if ( bytesRead != toRead ) {
+        rodsLog( LOG_NOTICE,
+                 "_partialDataGet: toread %d bytes, %d bytes read",
+                 toRead, bytesRead );
+        return bytesRead < 0 ? bytesRead : SYS_COPY_LEN_ERR;
+    }
+
+    frame.length = toRead;
+    frame.offset = stream->offset;
+    stream->offset += toRead;
+    stream->toXfer -= toRead;
+    return 1;
+}
+
+static int
+svrEncryptStage( svrCryptStreamInp_t *stream,
+                 irods::transfer_pipeline::frame& frame ) {
+    int status = irods::encrypt_frame( *stream->crypt, stream->sharedSecret,
+                                       frame );
+    return status < 0 ? status : 1;
+}
+
+static int
+svrSendFrameStage( svrCryptStreamInp_t *stream,
+                   irods::transfer_pipeline::frame& frame ) {
+    int status = irods::write_encrypted_frame( stream->myInput->destFd, frame );
+    if ( status < 0 ) {
+        rodsLog( LOG_NOTICE,
+                 "_partialDataGet: write of %d bytes failed, status = %d",
+                 frame.length, status );
+        return status;
+    }
+    return 1;
+}
+
+static int
+svrRcvFrameStage( svrCryptStreamInp_t *stream,
+                  irods::transfer_pipeline::frame& frame ) {
+    if ( stream->toXfer <= 0 ) {
+        return 0;
+    }
+
+    int status = irods::read_encrypted_frame( stream->myInput->srcFd,
+                 stream->maxFrameSize, *stream->crypt, stream->sharedSecret,
+                 stream->offset, frame );
+    if ( status < 0 ) {
+        rodsLog( LOG_NOTICE,
+                 "_partialDataPut: frame read failed, status = %d",
+                 status );
+        return status;
+    }
+    else if ( frame.length <= 0 || frame.length > stream->toXfer ) {
+        rodsLog( LOG_NOTICE,
+                 "_partialDataPut: toread %lld bytes, bad frame length %d",
+                 stream->toXfer, frame.length );
+        return SYS_COPY_LEN_ERR;
+    }
+
+    stream->offset += frame.length;
+    stream->toXfer -= frame.length;
+    return 1;
+}
+
+static int
+l3WriteStage( svrCryptStreamInp_t *stream,
+              irods::transfer_pipeline::frame& frame ) {
+    int bytesWritten = _l3Write( stream->myInput->rsComm, stream->l3descInx,
+                                 &frame.plain[0], frame.length );
+    if ( bytesWritten != frame.length ) {
+        rodsLog( LOG_NOTICE,
+                 "_partialDataPut:Bytes written %d don't match read %d",
+                 bytesWritten, frame.length );
+        return bytesWritten < 0 ? bytesWritten : SYS_COPY_LEN_ERR;
+    }
+    if ( stream->myInput->inlineChksum != NULL ) {
+        stream->myInput->inlineChksum->update( frame.offset, &frame.plain[0], bytesWritten );
+    }
+    return 1;
+}
+
 void
 partialDataPut( portalTransferInp_t *myInput ) {
     int destL3descInx = 0, srcFd = 0;
@@ -605,29 +724,13 @@ partialDataPut( portalTransferInp_t *myInput ) {
     bytesToGet = myInput->size;
 
     // =-=-=-=-=-=-=-
-    // create an encryption context, initialization vector
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t this_iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t plain;
-    irods::buffer_crypt::array_t shared_secret;
+    // create an encryption context, kept for the life of the stream
     irods::buffer_crypt crypt(
         myInput->key_size,
         myInput->salt_size,
         myInput->num_hash_rounds,
         myInput->encryption_algorithm );
 
-    // =-=-=-=-=-=-=-
-    // compute an iv to determine how large it
-    // is for this implementation
-    if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
-            &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
-    }
-
     int chunk_size = 0;
     irods::error ret = irods::get_advanced_setting<int>(
                            irods::CFG_TRANS_CHUNK_SIZE_PARA_TRANS,
@@ -648,7 +751,33 @@ partialDataPut( portalTransferInp_t *myInput ) {
     }
     trans_buff_size *= 1024 * 1024;
 
-    buf = ( unsigned char* )malloc( ( 2 * trans_buff_size ) + sizeof( unsigned char ) );
+    // =-=-=-=-=-=-=-
+    // encrypted streams overlap the socket read and decryption of
+    // one buffer with the vault write of the previous one
+    svrCryptStreamInp_t cryptStream;
+    irods::transfer_pipeline pipeline;
+    if ( use_encryption_flg ) {
+        cryptStream.myInput = myInput;
+        cryptStream.l3descInx = destL3descInx;
+        cryptStream.bufSize = trans_buff_size;
+        cryptStream.maxFrameSize = 2 * trans_buff_size;
+        cryptStream.crypt = &crypt;
+        cryptStream.sharedSecret.assign(
+            &myInput->shared_secret[0],
+            &myInput->shared_secret[ crypt.key_size() ] );
+        pipeline.add_stage( boost::bind( svrRcvFrameStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( l3WriteStage, &cryptStream, _1 ) );
+    }
+
+    buf = ( unsigned char* )malloc( trans_buff_size );
+
+    // =-=-=-=-=-=-=-
+    // unencrypted data may be spliced from the socket straight into the
+    // vault file if the resource exposes a native file descriptor
+    int nativeFd = -1;
+    if ( !use_encryption_flg && myInput->inlineChksum == NULL ) {
+        nativeFd = getNativeFdByFileInx( destL3descInx );
+    }
 
     while ( bytesToGet > 0 ) {
         int toread0;
@@ -679,6 +808,18 @@ partialDataPut( portalTransferInp_t *myInput ) {
             return;
         }
 
+        if ( use_encryption_flg ) {
+            cryptStream.offset = myOffset;
+            cryptStream.toXfer = toread0;
+            myInput->status = pipeline.run();
+            if ( myInput->status < 0 ) {
+                break;
+            }
+            bytesToGet -= toread0;
+            myOffset   += toread0;
+            continue;
+        }
+
         while ( toread0 > 0 ) {
             int toread1 = 0;
 
@@ -689,65 +830,50 @@ partialDataPut( portalTransferInp_t *myInput ) {
                 toread1 = toread0;
             }
 
-            // =-=-=-=-=-=-=-
-            // read the incoming size as it might differ due to encryption
-            int new_size = toread1;
-            if ( use_encryption_flg ) {
-                bytesRead = myRead(
-                                srcFd,
-                                &new_size,
-                                sizeof( int ),
-                                NULL, NULL );
-                if ( bytesRead != sizeof( int ) ) {
-                    rodsLog( LOG_ERROR, "_partialDataPut:Bytes Read != %d", sizeof( int ) );
+            if ( nativeFd >= 0 ) {
+                bytesWritten = mySpliceToFile( srcFd, nativeFd, myOffset,
+                                               toread1, NULL );
+                if ( bytesWritten < 0 ) {
+                    rodsLog( LOG_NOTICE,
+                             "_partialDataPut: splice of %d bytes failed, status = %d",
+                             toread1, bytesWritten );
+                    myInput->status = bytesWritten;
                     break;
                 }
+                if ( bytesWritten > 0 ) {
+                    FileDesc[destL3descInx].writtenFlag = 1;
+                }
+                bytesToGet -= bytesWritten;
+                toread0    -= bytesWritten;
+                myOffset   += bytesWritten;
+
+                if ( bytesWritten != toread1 ) {
+                    // =-=-=-=-=-=-=-
+                    // fall back to _l3Write for the rest of the transfer.
+                    // splice does not move the file offset
+                    nativeFd = -1;
+                    rodsLong_t status = _l3Lseek( myInput->rsComm, destL3descInx,
+                                                  myOffset, SEEK_SET );
+                    if ( status < 0 ) {
+                        myInput->status = status;
+                        break;
+                    }
+                }
+                continue;
             }
 
-            // =-=-=-=-=-=-=-
-            // now read the provided number of bytes as suggested by the incoming size
             bytesRead = myRead(
                             srcFd,
                             buf,
-                            new_size,
+                            toread1,
                             NULL, NULL );
 
-            if ( bytesRead == new_size ) {
-                // =-=-=-=-=-=-=-
-                // if using encryption, strip off the iv
-                // and decrypt before writing
-                int plain_size = bytesRead;
-                if ( use_encryption_flg ) {
-                    this_iv.assign(
-                        &buf[0],
-                        &buf[ iv_size ] );
-                    cipher.assign(
-                        &buf[ iv_size ],
-                        &buf[ new_size ] );
-                    irods::error ret = crypt.decrypt(
-                                           shared_secret,
-                                           this_iv,
-                                           cipher,
-                                           plain );
-                    if ( !ret.ok() ) {
-                        irods::log( PASS( ret ) );
-                        myInput->status = SYS_COPY_LEN_ERR;
-                        break;
-                    }
-
-                    std::copy(
-                        plain.begin(),
-                        plain.end(),
-                        &buf[0] );
-                    plain_size = plain.size();
-
-                }
-
+            if ( bytesRead == toread1 ) {
                 if ( ( bytesWritten = _l3Write(
                                           myInput->rsComm,
                                           destL3descInx,
                                           buf,
-                                          plain_size ) ) != ( plain_size ) ) {
+                                          bytesRead ) ) != ( bytesRead ) ) {
                     rodsLog( LOG_NOTICE,
                              "_partialDataPut:Bytes written %d don't match read %d",
                              bytesWritten, bytesRead );
@@ -760,6 +886,9 @@ partialDataPut( portalTransferInp_t *myInput ) {
                     }
                     break;
                 }
+                if ( myInput->inlineChksum != NULL ) {
+                    myInput->inlineChksum->update( myOffset, ( char * ) buf, bytesWritten );
+                }
                 bytesToGet -= bytesWritten;
                 toread0    -= bytesWritten;
                 myOffset   += bytesWritten;
@@ -837,27 +966,13 @@ void partialDataGet(
           irods::CS_NEG_USE_SSL );
 
     // =-=-=-=-=-=-=-
-    // create an encryption context
-    int iv_size = 0;
-    irods::buffer_crypt::array_t iv;
-    irods::buffer_crypt::array_t cipher;
-    irods::buffer_crypt::array_t in_buf;
-    irods::buffer_crypt::array_t shared_secret;
+    // create an encryption context, kept for the life of the stream
     irods::buffer_crypt crypt(
         myInput->key_size,
         myInput->salt_size,
         myInput->num_hash_rounds,
         myInput->encryption_algorithm );
 
-    // =-=-=-=-=-=-=-
-    // set iv size
-    if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
-        shared_secret.assign(
-            &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
-    }
-
     int trans_buff_size = 0;
     irods::error ret = irods::get_advanced_setting<int>(
                            irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS,
@@ -868,8 +983,34 @@ void partialDataGet(
     }
     trans_buff_size *= 1024 * 1024;
 
-    size_t buf_size = ( 2 * trans_buff_size ) * sizeof( unsigned char ) ;
-    unsigned char * buf = ( unsigned char* )malloc( buf_size );
+    // =-=-=-=-=-=-=-
+    // encrypted streams overlap the vault read, the encryption and
+    // the socket write of consecutive buffers
+    svrCryptStreamInp_t cryptStream;
+    irods::transfer_pipeline pipeline;
+    if ( use_encryption_flg ) {
+        cryptStream.myInput = myInput;
+        cryptStream.l3descInx = srcL3descInx;
+        cryptStream.bufSize = trans_buff_size;
+        cryptStream.maxFrameSize = 0;
+        cryptStream.crypt = &crypt;
+        cryptStream.sharedSecret.assign(
+            &myInput->shared_secret[0],
+            &myInput->shared_secret[ crypt.key_size() ] );
+        pipeline.add_stage( boost::bind( l3ReadStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( svrEncryptStage, &cryptStream, _1 ) );
+        pipeline.add_stage( boost::bind( svrSendFrameStage, &cryptStream, _1 ) );
+    }
+
+    unsigned char * buf = ( unsigned char* )malloc( trans_buff_size );
+
+    // =-=-=-=-=-=-=-
+    // unencrypted data may be sent from the vault file straight to the
+    // socket if the resource exposes a native file descriptor
+    int nativeFd = -1;
+    if ( !use_encryption_flg ) {
+        nativeFd = getNativeFdByFileInx( srcL3descInx );
+    }
 
     bytesToGet = myInput->size;
 
@@ -913,6 +1054,18 @@ void partialDataGet(
             return;
         }
 
+        if ( use_encryption_flg ) {
+            cryptStream.offset = myOffset;
+            cryptStream.toXfer = toread0;
+            myInput->status = pipeline.run();
+            if ( myInput->status < 0 ) {
+                break;
+            }
+            bytesToGet -= toread0;
+            myOffset   += toread0;
+            continue;
+        }
+
         while ( toread0 > 0 ) {
             int toread1;
 
@@ -923,72 +1076,39 @@ void partialDataGet(
                 toread1 = toread0;
             }
 
-            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf, toread1 );
-
-
-            if ( bytesRead == toread1 ) {
-                // =-=-=-=-=-=-=-
-                // compute an iv for this particular transmission and use
-                // it to encrypt this buffer
-                int new_size = bytesRead;
-                if ( use_encryption_flg ) {
-                    irods::error ret = crypt.initialization_vector( iv );
-                    if ( !ret.ok() ) {
-                        ret = PASS( ret );
-                        printf( "%s", ret.result().c_str() );
-                        break;
-                    }
+            if ( nativeFd >= 0 ) {
+                bytesRead = mySendFile( destFd, nativeFd, myOffset,
+                                        toread1, NULL );
+                bytesToGet -= bytesRead;
+                toread0    -= bytesRead;
+                myOffset   += bytesRead;
 
+                if ( bytesRead != toread1 ) {
                     // =-=-=-=-=-=-=-
-                    // encrypt
-                    in_buf.assign(
-                        &buf[0],
-                        &buf[ bytesRead ] );
-
-                    ret = crypt.encrypt(
-                              shared_secret,
-                              iv,
-                              in_buf,
-                              cipher );
-                    if ( !ret.ok() ) {
-                        ret = PASS( ret );
-                        printf( "%s", ret.result().c_str() );
+                    // fall back to _l3Read for the rest of the transfer.
+                    // sendfile does not move the file offset
+                    nativeFd = -1;
+                    rodsLong_t status = _l3Lseek( myInput->rsComm, srcL3descInx,
+                                                  myOffset, SEEK_SET );
+                    if ( status < 0 ) {
+                        myInput->status = status;
                         break;
                     }
+                }
+                continue;
+            }
 
-                    // =-=-=-=-=-=-=-
-                    // capture the iv with the cipher text
-                    memset( buf, 0,  buf_size );
-                    std::copy(
-                        iv.begin(),
-                        iv.end(),
-                        &buf[0] );
-                    std::copy(
-                        cipher.begin(),
-                        cipher.end(),
-                        &buf[iv_size] );
-
-                    new_size = iv_size + cipher.size();
+            bytesRead = _l3Read( myInput->rsComm, srcL3descInx, buf, toread1 );
 
-                    // =-=-=-=-=-=-=-
-                    // need to send the incoming size as encryption might change
-                    // the size of the data from the written values
-                    bytesWritten = myWrite(
-                                       destFd,
-                                       &new_size,
-                                       sizeof( int ),
-                                       &bytesWritten );
-                }
 
-                // =-=-=-=-=-=-=-
-                // then write the actual buffer
+            if ( bytesRead == toread1 ) {
                 bytesWritten = myWrite(
                                    destFd,
                                    buf,
-                                   new_size,
+                                   bytesRead,
                                    &bytesWritten );
 
-                if ( bytesWritten != new_size ) {
+                if ( bytesWritten != bytesRead ) {
                     rodsLog( LOG_NOTICE,
                              "_partialDataGet:Bytes written %d don't match read %d",
                              bytesWritten, bytesRead );
@@ -1002,9 +1122,6 @@ void partialDataGet(
                     break;
                 }
 
-                // =-=-=-=-=-=-=-
-                // had to change to bytesRead as bytesWritten
-                // may have changed due to encryption
                 bytesToGet -= bytesRead;
                 toread0    -= bytesRead;
                 myOffset   += bytesRead;
@@ -1085,10 +1202,10 @@ remToLocPartialCopy( portalTransferInp_t *myInput ) {
     // compute an iv to determine how large it
     // is for this implementation
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
+        iv_size = crypt.iv_size();
         shared_secret.assign(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
     }
 
     int trans_buff_size = 0;
@@ -1179,9 +1296,12 @@ remToLocPartialCopy( portalTransferInp_t *myInput ) {
                     &buf[ iv_size ],
                     &buf[ new_size ] );
 
+                irods::buffer_crypt::array_t aad;
+                irods::frame_aad( curOffset + myHeader.length - toGet, aad );
                 irods::error ret = crypt.decrypt(
                                        shared_secret,
                                        this_iv,
+                                       aad,
                                        cipher,
                                        plain );
                 if ( !ret.ok() ) {
@@ -1766,10 +1886,10 @@ locToRemPartialCopy( portalTransferInp_t *myInput ) {
     // =-=-=-=-=-=-=-
     // set iv size
     if ( use_encryption_flg ) {
-        iv_size = crypt.key_size();
+        iv_size = crypt.iv_size();
         shared_secret.assign(
             &myInput->shared_secret[0],
-            &myInput->shared_secret[iv_size] );
+            &myInput->shared_secret[ crypt.key_size() ] );
 
     }
 
@@ -1856,9 +1976,12 @@ locToRemPartialCopy( portalTransferInp_t *myInput ) {
                     &buf[0],
                     &buf[ bytesRead ] );
 
+                irods::buffer_crypt::array_t aad;
+                irods::frame_aad( curOffset + myHeader.length - toGet, aad );
                 ret = crypt.encrypt(
                           shared_secret,
                           iv,
+                          aad,
                           in_buf,
                           cipher );
                 if ( !ret.ok() ) {
@@ -3145,6 +3268,11 @@ irods::error update_resource_object_count(
 
     // =-=-=-=-=-=-=-
     // get the resource's objcount in the DB
+    ret = resc_mgr.refresh_resource_counters( _comm );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
     std::string resc_objcount;
     ret = _prop_map.get< std::string >(
               irods::RESOURCE_OBJCOUNT,
@@ -26,46 +26,73 @@
 // =-=-=-=-=-=-=-
 #include "irods_resource_backport.hpp"
 #include "irods_hierarchy_parser.hpp"
+#include "irods_inline_checksum.hpp"
 #include "irods_stacktrace.hpp"
 
+#include <set>
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// indices of freed descriptors, reused before the tables are grown
+static std::vector<int> FreeL1descInx;
+static std::vector<int> FreeSpecCollDescInx;
+
+// =-=-=-=-=-=-=-
+// indices of the L1 descriptors in use, so lookups need not scan the
+// whole grown table
+static std::set<int> InuseL1descInx;
+
 int
 initL1desc() {
-    memset( L1desc, 0, sizeof( L1desc ) );
+    L1desc.clear();
+    FreeL1descInx.clear();
+    InuseL1descInx.clear();
+    /* 0 - 2 are reserved */
+    L1desc.resize( 3 );
     return 0;
 }
 
+/* allocL1desc - take a descriptor off the free list, or append one to
+ * the table if the free list is empty.
+ */
 int
 allocL1desc() {
     int i;
 
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
-        if ( L1desc[i].inuseFlag <= FD_FREE ) {
-            L1desc[i].inuseFlag = FD_INUSE;
-            return i;
-        };
+    if ( L1desc.size() < 3 ) {
+        L1desc.resize( 3 );
     }
 
-    rodsLog( LOG_NOTICE,
-             "allocL1desc: out of L1desc" );
+    if ( !FreeL1descInx.empty() ) {
+        i = FreeL1descInx.back();
+        FreeL1descInx.pop_back();
+    }
+    else if ( L1desc.size() < MAX_NUM_L1_DESC ) {
+        i = L1desc.size();
+        L1desc.push_back( l1desc_t() );
+    }
+    else {
+        rodsLog( LOG_NOTICE,
+                 "allocL1desc: out of L1desc" );
+        return SYS_OUT_OF_FILE_DESC;
+    }
 
-    return SYS_OUT_OF_FILE_DESC;
+    L1desc[i].inuseFlag = FD_INUSE;
+    InuseL1descInx.insert( i );
+    return i;
 }
 
 int
 isL1descInuse() {
-    int i;
-
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
-        if ( L1desc[i].inuseFlag == FD_INUSE ) {
-            return 1;
-        };
-    }
-    return 0;
+    return InuseL1descInx.empty() ? 0 : 1;
 }
 
 int
 initSpecCollDesc() {
-    memset( SpecCollDesc, 0, sizeof( SpecCollDesc ) );
+    SpecCollDesc.clear();
+    FreeSpecCollDescInx.clear();
+    /* 0 is reserved */
+    SpecCollDesc.resize( 1 );
     return 0;
 }
 
@@ -73,22 +100,31 @@ int
 allocSpecCollDesc() {
     int i;
 
-    for ( i = 1; i < NUM_SPEC_COLL_DESC; i++ ) {
-        if ( SpecCollDesc[i].inuseFlag <= FD_FREE ) {
-            SpecCollDesc[i].inuseFlag = FD_INUSE;
-            return i;
-        };
+    if ( SpecCollDesc.empty() ) {
+        SpecCollDesc.resize( 1 );
     }
 
-    rodsLog( LOG_NOTICE,
-             "allocSpecCollDesc: out of SpecCollDesc" );
+    if ( !FreeSpecCollDescInx.empty() ) {
+        i = FreeSpecCollDescInx.back();
+        FreeSpecCollDescInx.pop_back();
+    }
+    else if ( SpecCollDesc.size() < MAX_NUM_SPEC_COLL_DESC ) {
+        i = SpecCollDesc.size();
+        SpecCollDesc.push_back( specCollDesc_t() );
+    }
+    else {
+        rodsLog( LOG_NOTICE,
+                 "allocSpecCollDesc: out of SpecCollDesc" );
+        return SYS_OUT_OF_FILE_DESC;
+    }
 
-    return SYS_OUT_OF_FILE_DESC;
+    SpecCollDesc[i].inuseFlag = FD_INUSE;
+    return i;
 }
 
 int
 freeSpecCollDesc( int specCollInx ) {
-    if ( specCollInx < 1 || specCollInx >= NUM_SPEC_COLL_DESC ) {
+    if ( specCollInx < 1 || specCollInx >= ( int ) SpecCollDesc.size() ) {
         rodsLog( LOG_NOTICE,
                  "freeSpecCollDesc: specCollInx %d out of range", specCollInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -98,6 +134,11 @@ freeSpecCollDesc( int specCollInx ) {
         freeDataObjInfo( SpecCollDesc[specCollInx].dataObjInfo );
     }
 
+    /* only an in use descriptor goes back on the free list, so freeing
+     * twice cannot hand the same index out to two callers */
+    if ( SpecCollDesc[specCollInx].inuseFlag == FD_INUSE ) {
+        FreeSpecCollDescInx.push_back( specCollInx );
+    }
     memset( &SpecCollDesc[specCollInx], 0, sizeof( specCollDesc_t ) );
 
     return 0;
@@ -110,7 +151,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
     if ( rsComm == NULL ) {
         return 0;
     }
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
+    for ( i = 3; i < ( int ) L1desc.size(); i++ ) {
         if ( L1desc[i].inuseFlag == FD_INUSE &&
                 L1desc[i].l3descInx > 2 ) {
             l3Close( rsComm, i );
@@ -121,7 +162,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
 
 int
 freeL1desc( int l1descInx ) {
-    if ( l1descInx < 3 || l1descInx >= NUM_L1_DESC ) {
+    if ( l1descInx < 3 || l1descInx >= ( int ) L1desc.size() ) {
         rodsLog( LOG_NOTICE,
                  "freeL1desc: l1descInx %d out of range", l1descInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -144,6 +185,11 @@ freeL1desc( int l1descInx ) {
         clearDataObjInp( L1desc[l1descInx].dataObjInp );
         free( L1desc[l1descInx].dataObjInp );
     }
+    delete L1desc[l1descInx].inlineChksum;
+    if ( L1desc[l1descInx].inuseFlag == FD_INUSE ) {
+        FreeL1descInx.push_back( l1descInx );
+        InuseL1descInx.erase( l1descInx );
+    }
     memset( &L1desc[l1descInx], 0, sizeof( l1desc_t ) );
 
     return 0;
@@ -245,10 +291,10 @@ initDataObjInfoWithInp( dataObjInfo_t *dataObjInfo, dataObjInp_t *dataObjInp ) {
 
 int
 getL1descIndexByDataObjInfo( const dataObjInfo_t * dataObjInfo ) {
-    int index;
-    for ( index = 3; index < NUM_L1_DESC; index++ ) {
-        if ( L1desc[index].dataObjInfo == dataObjInfo ) {
-            return index;
+    std::set<int>::const_iterator it;
+    for ( it = InuseL1descInx.begin(); it != InuseL1descInx.end(); ++it ) {
+        if ( L1desc[*it].dataObjInfo == dataObjInfo ) {
+            return *it;
         }
     }
     return -1;
@@ -6,6 +6,8 @@
 // JMC #include <pthread.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/select.h>
 #endif
 #include "reServerLib.hpp"
 #include "rodsConnect.h"
@@ -27,18 +29,25 @@
 #include <boost/filesystem/convenience.hpp>
 using namespace boost::filesystem;
 
+/* getReInfo - get the next batch of up to MAX_SQL_ROWS rules which are
+ * due, the longest overdue first. The catalog stores exeTime as seconds
+ * since the epoch zero padded to 11 digits, like getNowStr, so it
+ * compares and sorts as a string against a time formatted the same way.
+ */
+
 int
 getReInfo( rsComm_t *rsComm, genQueryOut_t **genQueryOut ) {
+    char tmpStr[NAME_LEN];
 
     genQueryInp_t genQueryInp;
     memset( &genQueryInp, 0, sizeof( genQueryInp_t ) );
 
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_TIME, ORDER_BY );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_ID, ORDER_BY );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_NAME, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_REI_FILE_PATH, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_USER_NAME, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_ADDRESS, 1 );
-    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_TIME, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_FREQUENCY, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_PRIORITY, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_ESTIMATED_EXE_TIME, 1 );
@@ -46,6 +55,9 @@ getReInfo( rsComm_t *rsComm, genQueryOut_t **genQueryOut ) {
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_LAST_EXE_TIME, 1 );
     addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_STATUS, 1 );
 
+    snprintf( tmpStr, NAME_LEN, "<='%011u'", ( uint ) time( NULL ) );
+    addInxVal( &genQueryInp.sqlCondInp, COL_RULE_EXEC_TIME, tmpStr );
+
     genQueryInp.maxRows = MAX_SQL_ROWS;
 
     *genQueryOut = NULL;
@@ -62,6 +74,88 @@ getReInfo( rsComm_t *rsComm, genQueryOut_t **genQueryOut ) {
     return status;
 }
 
+/* getNextReExecTime - get the exeTime of the next rule which is not due yet
+ */
+
+int
+getNextReExecTime( rsComm_t *rsComm, time_t *nextTime ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *exeTime;
+    char tmpStr[NAME_LEN];
+    int status;
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp_t ) );
+
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_TIME, SELECT_MIN );
+
+    snprintf( tmpStr, NAME_LEN, ">'%011u'", ( uint ) time( NULL ) );
+    addInxVal( &genQueryInp.sqlCondInp, COL_RULE_EXEC_TIME, tmpStr );
+
+    genQueryInp.maxRows = 1;
+
+    status = rsGenQuery( rsComm, &genQueryInp, &genQueryOut );
+    clearGenQueryInp( &genQueryInp );
+
+    if ( status >= 0 ) {
+        if ( ( exeTime = getSqlResultByInx( genQueryOut,
+                                            COL_RULE_EXEC_TIME ) ) == NULL ||
+                genQueryOut->rowCnt < 1 || strlen( exeTime->value ) == 0 ) {
+            status = CAT_NO_ROWS_FOUND;
+        }
+        else {
+            *nextTime = atoi( exeTime->value );
+        }
+    }
+    freeGenQueryOut( &genQueryOut );
+    return status;
+}
+
+/* getReQueueStats - get the number of rules which are due and the exeTime
+ * of the longest overdue one
+ */
+
+int
+getReQueueStats( rsComm_t *rsComm, int *dueCnt, time_t *oldestTime ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *ruleExecId, *exeTime;
+    char tmpStr[NAME_LEN];
+    int status;
+
+    *dueCnt = 0;
+    *oldestTime = 0;
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp_t ) );
+
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_ID, SELECT_COUNT );
+    addInxIval( &genQueryInp.selectInp, COL_RULE_EXEC_TIME, SELECT_MIN );
+
+    snprintf( tmpStr, NAME_LEN, "<='%011u'", ( uint ) time( NULL ) );
+    addInxVal( &genQueryInp.sqlCondInp, COL_RULE_EXEC_TIME, tmpStr );
+
+    genQueryInp.maxRows = 1;
+
+    status = rsGenQuery( rsComm, &genQueryInp, &genQueryOut );
+    clearGenQueryInp( &genQueryInp );
+
+    if ( status >= 0 && genQueryOut->rowCnt > 0 ) {
+        if ( ( ruleExecId = getSqlResultByInx( genQueryOut,
+                                               COL_RULE_EXEC_ID ) ) != NULL ) {
+            *dueCnt = atoi( ruleExecId->value );
+        }
+        if ( ( exeTime = getSqlResultByInx( genQueryOut,
+                                            COL_RULE_EXEC_TIME ) ) != NULL ) {
+            *oldestTime = atoi( exeTime->value );
+        }
+    }
+    else if ( status == CAT_NO_ROWS_FOUND ) {
+        status = 0;
+    }
+    freeGenQueryOut( &genQueryOut );
+    return status;
+}
+
 int
 getReInfoById( rsComm_t *rsComm, char *ruleExecId, genQueryOut_t **genQueryOut ) {
     genQueryInp_t genQueryInp;
@@ -360,6 +454,8 @@ regExeStatus( rsComm_t *rsComm, char *ruleExecId, char *exeStatus ) {
  * a getReInfo call), run the jobs with the input jobType.
  * Valid jobType = 0 ==> normal job.
  * jobType = RE_FAILED_STATUS ==> job have failed as least once
+ * With doFork, the jobs are handed to the executor processes, waiting for
+ * one to become free whenever all are busy.
  */
 
 int
@@ -369,9 +465,18 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
     ruleExecSubmitInp_t *myRuleExecInp;
     int runCnt = 0;
     int thrInx;
+    int latency;
+    reExecJob_t reExecJob;
 
     inx = -1;
-    while ( time( NULL ) <= endTime && ( thrInx = allocReThr( reExec ) ) >= 0 ) { // JMC - backport 4695
+    while ( time( NULL ) <= endTime ) {
+        if ( ( thrInx = allocReThr( reExec ) ) < 0 ) { // JMC - backport 4695
+            if ( reExec->doFork == 1 &&
+                    waitAndFreeReThr( rsComm, reExec ) >= 0 ) {
+                continue;
+            }
+            break;
+        }
         myRuleExecInp = &reExec->reExecProc[thrInx].ruleExecSubmitInp;
         chkAndUpdateResc( rsComm );
         if ( ( inx = getNextQueuedRuleExec( genQueryOut, inx + 1,
@@ -396,66 +501,51 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
         }
 
         runCnt ++;
+        reExec->startCnt++;
+        latency = time( NULL ) - atoi( myRuleExecInp->exeTime );
+        if ( latency > 0 ) {
+            reExec->latencySum += latency;
+            if ( latency > reExec->maxLatency ) {
+                reExec->maxLatency = latency;
+            }
+        }
+
         if ( reExec->doFork == 0 ) {
             /* single thread. Just call runRuleExec */
-            status = execRuleExec( &reExec->reExecProc[thrInx] );
+            status = runRuleExec( &reExec->reExecProc[thrInx] );
             if ( status < 0 ) {
-                rodsLog( LOG_ERROR, "execRuleExec failed in runQueuedRuleExec with status %d", status );
+                rodsLog( LOG_ERROR, "runRuleExec failed in runQueuedRuleExec with status %d", status );
+                reExec->failCnt++;
             }
             postProcRunRuleExec( rsComm, &reExec->reExecProc[thrInx] );
+            reExec->doneCnt++;
             freeReThr( reExec, thrInx );
             continue;
         }
-        else {
-#ifdef RE_EXEC_PROC
-            if ( ( reExec->reExecProc[thrInx].pid = fork() ) == 0 ) {
-                /* child. need to disconnect Rcat */
-                irods::server_properties& props = irods::server_properties::getInstance();
-                irods::error ret = props.capture_if_needed();
-                if ( !ret.ok() ) {
-                    irods::log( PASS( ret ) );
-                    return ret.code();
-                }
-
-                std::string zone_name;
-                ret = props.get_property <
-                      std::string > (
-                          irods::CFG_ZONE_NAME,
-                          zone_name );
-                if ( !ret.ok() ) {
-                    irods::log( PASS( ret ) );
-                    return ret.code();
 
-                }
-                status = resetRcatHost(
-                             rsComm,
-                             MASTER_RCAT,
-                             zone_name.c_str() );
-                if ( LOCAL_HOST == status ) {
-#ifdef RODS_CAT
-                    resetRcat();
-#endif
-                }
-                /* this call doesn't come back */
-                execRuleExec( &reExec->reExecProc[thrInx] );
-#else
-            if ( ( reExec->reExecProc[thrInx].pid = fork() ) == 0 ) {
-                status = postForkExecProc( rsComm,
-                                           &reExec->reExecProc[thrInx] );
-                cleanupAndExit( status );
-#endif
-            }
-            else {
+        /* hand the job to the executor of the slot */
+        memset( &reExecJob, 0, sizeof( reExecJob ) );
+        rstrcpy( reExecJob.ruleExecId, myRuleExecInp->ruleExecId, NAME_LEN );
+        reExecJob.jobType = jobType;
+        if ( reExec->reExecProc[thrInx].sock < 0 ||
+                myWrite( reExec->reExecProc[thrInx].sock, &reExecJob,
+                         sizeof( reExecJob ), NULL ) != sizeof( reExecJob ) ) {
+            /* the job stays RE_RUNNING and is picked up again by a later pass */
+            rodsLog( LOG_ERROR,
+                     "runQueuedRuleExec: cannot send id %s to executor %d, pid %d",
+                     myRuleExecInp->ruleExecId, thrInx,
+                     reExec->reExecProc[thrInx].pid );
+            stopReExecProc( reExec, thrInx );
+            startReExecProc( rsComm, reExec, thrInx );
+            freeReThr( reExec, thrInx );
+            continue;
+        }
+        reExec->reExecProc[thrInx].jobCnt++;
 #ifdef RE_SERVER_DEBUG
-                rodsLog( LOG_NOTICE,
-                         "runQueuedRuleExec: started proc %d, thrInx %d",
-                         reExec->reExecProc[thrInx].pid, thrInx );
+        rodsLog( LOG_NOTICE,
+                 "runQueuedRuleExec: sent id %s to proc %d, thrInx %d",
+                 myRuleExecInp->ruleExecId, reExec->reExecProc[thrInx].pid, thrInx );
 #endif
-                /* parent fall through here */
-                // r5676 - reExec->runCnt++;
-                continue;
-            }
-        }
     }
     if ( reExec->doFork == 1 ) {
         /* wait for all jobs to finish */
@@ -468,8 +558,12 @@ runQueuedRuleExec( rsComm_t *rsComm, reExec_t *reExec,
     return runCnt;
 }
 
-int
-postForkExecProc( rsComm_t * rsComm, reExecProc_t * reExecProc ) {
+/* reconnRcatInChild - connect a forked process to the catalog on its own,
+ * the connection of the parent is left alone
+ */
+
+static int
+reconnRcatInChild( rsComm_t * rsComm ) {
     int status;
 
     /* child. need to disconnect Rcat */
@@ -509,6 +603,14 @@ postForkExecProc( rsComm_t * rsComm, reExecProc_t * reExecProc ) {
         }
 #endif
     }
+    return status;
+}
+
+int
+postForkExecProc( rsComm_t * rsComm, reExecProc_t * reExecProc ) {
+    int status;
+
+    reconnRcatInChild( rsComm );
     seedRandom();
     status = runRuleExec( reExecProc );
     postProcRunRuleExec( rsComm, reExecProc );
@@ -564,6 +666,12 @@ initReExec( rsComm_t * rsComm, reExec_t * reExec ) {
     reExec->runCnt = 0;
     reExec->maxRunCnt = 0;
     reExec->doFork = 0;
+    reExec->statTime = time( NULL );
+    reExec->startCnt = 0;
+    reExec->doneCnt = 0;
+    reExec->failCnt = 0;
+    reExec->latencySum = 0;
+    reExec->maxLatency = 0;
 
     bzero( &rei, sizeof( ruleExecInfo_t ) ); /*  June 17. 2009 */
 
@@ -613,6 +721,13 @@ initReExec( rsComm_t * rsComm, reExec_t * reExec ) {
         /* init reComm */
         reExec->reExecProc[i].reComm.proxyUser = rsComm->proxyUser;
         reExec->reExecProc[i].reComm.myEnv = rsComm->myEnv;
+
+        reExec->reExecProc[i].pid = 0;
+        reExec->reExecProc[i].sock = -1;
+        reExec->reExecProc[i].jobCnt = 0;
+        if ( reExec->doFork == 1 ) {
+            startReExecProc( rsComm, reExec, i );
+        }
     }
     return 0;
 }
@@ -658,18 +773,89 @@ allocReThr( reExec_t * reExec ) { // JMC - backport 4695
     return thrInx;
 }
 
+/* chkReExecAfterCrash - the executor of thrInx went away without replying,
+ * so the rule may not have been post processed
+ */
+
+static void
+chkReExecAfterCrash( rsComm_t * rsComm, reExec_t * reExec, int thrInx ) {
+    genQueryOut_t *genQueryOut = NULL;
+    int status1;
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+    char *ruleExecId = reExecProc->ruleExecSubmitInp.ruleExecId;
+
+    status1 = getReInfoById( rsComm, ruleExecId, &genQueryOut );
+    if ( status1 >= 0 ) {
+        sqlResult_t *exeFrequency, *exeStatus;
+        if ( ( exeFrequency = getSqlResultByInx( genQueryOut,
+                              COL_RULE_EXEC_FREQUENCY ) ) == NULL ) {
+            rodsLog( LOG_NOTICE,
+                     "waitAndFreeReThr:getResultByInx for RULE_EXEC_FREQUENCY failed" );
+        }
+        if ( ( exeStatus = getSqlResultByInx( genQueryOut,
+                                              COL_RULE_EXEC_STATUS ) ) == NULL ) {
+            rodsLog( LOG_NOTICE,
+                     "waitAndFreeReThr:getResultByInx for RULE_EXEC_STATUS failed" );
+        }
+
+        if ( exeFrequency == NULL || exeStatus == NULL || strlen( exeFrequency->value ) == 0 || strcmp( exeStatus->value, RE_RUNNING ) == 0 ) {
+            // r5676
+            int i;
+            int overlap = 0;
+            for ( i = 0; i < reExec->maxRunCnt; i++ ) {
+                if ( i != thrInx && strcmp( reExec->reExecProc[i].ruleExecSubmitInp.ruleExecId, ruleExecId ) == 0 ) {
+                    overlap++;
+                }
+            }
+
+            if ( overlap == 0 ) { // r5676
+                /* something wrong since the entry is not deleted. could
+                 * be core dump */
+                if ( ( reExecProc->jobType & RE_FAILED_STATUS ) == 0 ) {
+                    /* first time. just mark it RE_FAILED */
+                    regExeStatus( rsComm, ruleExecId, RE_FAILED );
+                }
+                else {
+                    ruleExecDelInp_t ruleExecDelInp;
+                    rodsLog( LOG_ERROR,
+                             "waitAndFreeReThr: %s executed but still in iCat. Job deleted",
+                             ruleExecId );
+                    rstrcpy( ruleExecDelInp.ruleExecId, ruleExecId, NAME_LEN );
+                    rsRuleExecDel( rsComm, &ruleExecDelInp );
+                }
+            } // r5676
+        }
+        freeGenQueryOut( &genQueryOut );
+    }
+}
+
+/* waitAndFreeReThr - wait for an executor to finish its job and free the
+ * slot. Returns the freed thrInx, or SYS_NO_FREE_RE_THREAD if no job is
+ * running.
+ */
+
 int
 waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec ) { // JMC - backport 4695
-    pid_t childPid;
-    int status = 0;
+    fd_set set;
+    int maxFd = -1;
+    int i, status;
     int thrInx = SYS_NO_FREE_RE_THREAD;
+    int jobStatus = 0;
 
-    childPid = waitpid( -1, &status, WUNTRACED );
-    if ( childPid < 0 ) {
+    FD_ZERO( &set );
+    for ( i = 0; i < reExec->maxRunCnt; i++ ) {
+        if ( reExec->reExecProc[i].procExecState == RE_PROC_RUNNING &&
+                reExec->reExecProc[i].sock >= 0 ) {
+            FD_SET( reExec->reExecProc[i].sock, &set );
+            if ( reExec->reExecProc[i].sock > maxFd ) {
+                maxFd = reExec->reExecProc[i].sock;
+            }
+        }
+    }
+    if ( maxFd < 0 ) {
         if ( reExec->runCnt > 0 ) {
-            int i;
             rodsLog( LOG_NOTICE,
-                     "waitAndFreeReThr: no outstanding child. but runCnt=%d",
+                     "waitAndFreeReThr: no outstanding executor. but runCnt=%d",
                      reExec->runCnt );
             for ( i = 0; i < reExec->maxRunCnt; i++ ) {
                 if ( reExec->reExecProc[i].procExecState != RE_PROC_IDLE ) {
@@ -679,65 +865,178 @@ waitAndFreeReThr( rsComm_t * rsComm, reExec_t * reExec ) { // JMC - backport 469
             reExec->runCnt = 0;
             thrInx = 0;
         }
+        return thrInx;
+    }
+
+    while ( ( status = select( maxFd + 1, &set, NULL, NULL, NULL ) ) < 0 ) {
+        if ( errno != EINTR ) {
+            rodsLog( LOG_ERROR,
+                     "waitAndFreeReThr: select error, errno = %d", errno );
+            return SYS_SOCK_READ_ERR - errno;
+        }
+    }
+
+    for ( i = 0; i < reExec->maxRunCnt; i++ ) {
+        if ( reExec->reExecProc[i].procExecState == RE_PROC_RUNNING &&
+                reExec->reExecProc[i].sock >= 0 &&
+                FD_ISSET( reExec->reExecProc[i].sock, &set ) ) {
+            thrInx = i;
+            break;
+        }
+    }
+    if ( thrInx < 0 ) {
+        return thrInx;
+    }
+
+    reExec->doneCnt++;
+    if ( myRead( reExec->reExecProc[thrInx].sock, &jobStatus,
+                 sizeof( jobStatus ), NULL, NULL ) != sizeof( jobStatus ) ) {
+        rodsLog( LOG_ERROR,
+                 "waitAndFreeReThr: executor %d, pid %d exited while running id %s",
+                 thrInx, reExec->reExecProc[thrInx].pid,
+                 reExec->reExecProc[thrInx].ruleExecSubmitInp.ruleExecId );
+        reExec->failCnt++;
+        chkReExecAfterCrash( rsComm, reExec, thrInx );
+        stopReExecProc( reExec, thrInx );
+        startReExecProc( rsComm, reExec, thrInx );
     }
     else {
-        thrInx = matchPidInReExec( reExec, childPid );
-        // =-=-=-=-=-=-=-
-        // JMC - backport 4695
-        if ( thrInx >= 0 ) {
-            genQueryOut_t *genQueryOut = NULL;
-            int status1;
-            reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
-            char *ruleExecId = reExecProc->ruleExecSubmitInp.ruleExecId;
-
-            status1 = getReInfoById( rsComm, ruleExecId, &genQueryOut );
-            if ( status1 >= 0 ) {
-                sqlResult_t *exeFrequency, *exeStatus;
-                if ( ( exeFrequency = getSqlResultByInx( genQueryOut,
-                                      COL_RULE_EXEC_FREQUENCY ) ) == NULL ) {
-                    rodsLog( LOG_NOTICE,
-                             "waitAndFreeReThr:getResultByInx for RULE_EXEC_FREQUENCY failed" );
-                }
-                if ( ( exeStatus = getSqlResultByInx( genQueryOut,
-                                                      COL_RULE_EXEC_STATUS ) ) == NULL ) {
-                    rodsLog( LOG_NOTICE,
-                             "waitAndFreeReThr:getResultByInx for RULE_EXEC_STATUS failed" );
-                }
+        if ( jobStatus < 0 ) {
+            reExec->failCnt++;
+        }
+        if ( reExec->reExecProc[thrInx].jobCnt >= RE_PROC_MAX_JOBS ) {
+            /* bound what a long lived executor can leak */
+            stopReExecProc( reExec, thrInx );
+            startReExecProc( rsComm, reExec, thrInx );
+        }
+    }
+    freeReThr( reExec, thrInx );
 
-                if ( exeFrequency == NULL || exeStatus == NULL || strlen( exeFrequency->value ) == 0 || strcmp( exeStatus->value, RE_RUNNING ) == 0 ) {
-                    // r5676
-                    int i;
-                    int overlap = 0;
-                    for ( i = 0; i < reExec->maxRunCnt; i++ ) {
-                        if ( i != thrInx && strcmp( reExec->reExecProc[i].ruleExecSubmitInp.ruleExecId, ruleExecId ) == 0 ) {
-                            overlap++;
-                        }
-                    }
-
-                    if ( overlap == 0 ) { // r5676
-                        /* something wrong since the entry is not deleted. could
-                         * be core dump */
-                        if ( ( reExecProc->jobType & RE_FAILED_STATUS ) == 0 ) {
-                            /* first time. just mark it RE_FAILED */
-                            regExeStatus( rsComm, ruleExecId, RE_FAILED );
-                        }
-                        else {
-                            ruleExecDelInp_t ruleExecDelInp;
-                            rodsLog( LOG_ERROR,
-                                     "waitAndFreeReThr: %s executed but still in iCat. Job deleted",
-                                     ruleExecId );
-                            rstrcpy( ruleExecDelInp.ruleExecId, ruleExecId, NAME_LEN );
-                            status = rsRuleExecDel( rsComm, &ruleExecDelInp );
-                        }
-                    } // r5676
-                }
-                freeGenQueryOut( &genQueryOut );
+    return thrInx;
+}
+
+/* startReExecProc - fork the executor process of thrInx. The executor
+ * connects to the catalog once and then runs the jobs sent over its socket
+ * with the rules loaded in the server at the time of the fork.
+ */
+
+int
+startReExecProc( rsComm_t * rsComm, reExec_t * reExec, int thrInx ) {
+    int sv[2];
+    int i, status;
+    pid_t pid;
+
+    if ( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) < 0 ) {
+        status = SYS_SOCK_OPEN_ERR - errno;
+        rodsLog( LOG_ERROR,
+                 "startReExecProc: socketpair error, status = %d", status );
+        return status;
+    }
+
+    if ( ( pid = fork() ) < 0 ) {
+        status = SYS_FORK_ERROR - errno;
+        rodsLog( LOG_ERROR,
+                 "startReExecProc: fork error, status = %d", status );
+        close( sv[0] );
+        close( sv[1] );
+        return status;
+    }
+    else if ( pid == 0 ) {
+        /* child. the sockets to the other executors belong to the parent */
+        close( sv[0] );
+        for ( i = 0; i < reExec->maxRunCnt; i++ ) {
+            if ( reExec->reExecProc[i].sock >= 0 ) {
+                close( reExec->reExecProc[i].sock );
             }
-            freeReThr( reExec, thrInx );
         }
-        // =-=-=-=-=-=-=-
+        status = runReExecProc( rsComm, sv[1] );
+        cleanupAndExit( status );
     }
-    return thrInx;
+
+    close( sv[1] );
+    reExec->reExecProc[thrInx].pid = pid;
+    reExec->reExecProc[thrInx].sock = sv[0];
+    reExec->reExecProc[thrInx].jobCnt = 0;
+#ifdef RE_SERVER_DEBUG
+    rodsLog( LOG_NOTICE,
+             "startReExecProc: started proc %d, thrInx %d", pid, thrInx );
+#endif
+    return 0;
+}
+
+/* stopReExecProc - close the socket of the executor of thrInx, which makes
+ * it exit once it is done with its job, and reap it
+ */
+
+int
+stopReExecProc( reExec_t * reExec, int thrInx ) {
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+
+    if ( reExecProc->sock >= 0 ) {
+        close( reExecProc->sock );
+        reExecProc->sock = -1;
+    }
+    if ( reExecProc->pid > 0 ) {
+        waitpid( reExecProc->pid, NULL, 0 );
+        reExecProc->pid = 0;
+    }
+    reExecProc->jobCnt = 0;
+    return 0;
+}
+
+/* restartReExecProcs - replace all executors once their jobs are done, so
+ * that they pick up the rules reloaded by the server
+ */
+
+int
+restartReExecProcs( rsComm_t * rsComm, reExec_t * reExec ) {
+    int i;
+
+    if ( reExec->doFork == 0 ) {
+        return 0;
+    }
+
+    while ( reExec->runCnt > 0 &&
+            waitAndFreeReThr( rsComm, reExec ) >= 0 ) {
+        ;
+    }
+
+    for ( i = 0; i < reExec->maxRunCnt; i++ ) {
+        stopReExecProc( reExec, i );
+        startReExecProc( rsComm, reExec, i );
+    }
+    return 0;
+}
+
+/* runReExecProc - main loop of an executor process. Runs the jobs read
+ * from sock and replies with their status until the server closes sock.
+ */
+
+int
+runReExecProc( rsComm_t * rsComm, int sock ) {
+    int status;
+    reExecJob_t reExecJob;
+
+    reconnRcatInChild( rsComm );
+    seedRandom();
+
+    while ( myRead( sock, &reExecJob, sizeof( reExecJob ), NULL, NULL ) ==
+            sizeof( reExecJob ) ) {
+        reExecJob.ruleExecId[NAME_LEN - 1] = '\0';
+        chkAndUpdateResc( rsComm );
+        status = reServerSingleExec( rsComm, reExecJob.ruleExecId,
+                                     reExecJob.jobType );
+        if ( myWrite( sock, &status, sizeof( status ), NULL ) !=
+                sizeof( status ) ) {
+            break;
+        }
+    }
+#ifdef RE_SERVER_DEBUG
+    rodsLog( LOG_NOTICE,
+             "runReExecProc: process %d exiting", getpid() );
+#endif
+    close( sock );
+    return 0;
 }
 #endif
 
@@ -777,7 +1076,7 @@ freeReThr( reExec_t * reExec, int thrInx ) {
     reExec->reExecProc[thrInx].procExecState = RE_PROC_IDLE;
     reExec->reExecProc[thrInx].status = 0;
     reExec->reExecProc[thrInx].jobType = 0;
-    reExec->reExecProc[thrInx].pid = 0;
+    /* pid and sock belong to the executor, which outlives the job */
     /* save the packedReiAndArgBBuf */
     packedReiAndArgBBuf =
         reExec->reExecProc[thrInx].ruleExecSubmitInp.packedReiAndArgBBuf;
@@ -934,6 +1233,48 @@ chkAndUpdateResc( rsComm_t * rsComm ) {
     }
 }
 
+/* logReExecStats - log the depth of the queue and the start latency of the
+ * rules every RE_STATS_TIME seconds
+ */
+
+int
+logReExecStats( rsComm_t * rsComm, reExec_t * reExec ) {
+    time_t curTime = time( NULL );
+    time_t oldestTime = 0;
+    int dueCnt = 0;
+    int status;
+
+    if ( curTime < reExec->statTime + RE_STATS_TIME ) {
+        return 0;
+    }
+
+    status = getReQueueStats( rsComm, &dueCnt, &oldestTime );
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR,
+                 "logReExecStats: getReQueueStats error, status = %d", status );
+    }
+
+    rodsLog( LOG_NOTICE,
+             "logReExecStats: %d rules due, oldest due for %d sec, %d of %d executors busy",
+             dueCnt, oldestTime > 0 ? ( int )( curTime - oldestTime ) : 0,
+             reExec->runCnt, reExec->maxRunCnt );
+    rodsLog( LOG_NOTICE,
+             "logReExecStats: in %d sec started %d, done %d, failed %d, start latency avg %d sec, max %d sec",
+             ( int )( curTime - reExec->statTime ), reExec->startCnt,
+             reExec->doneCnt, reExec->failCnt,
+             reExec->startCnt > 0 ? ( int )( reExec->latencySum / reExec->startCnt ) : 0,
+             reExec->maxLatency );
+
+    reExec->statTime = curTime;
+    reExec->startCnt = 0;
+    reExec->doneCnt = 0;
+    reExec->failCnt = 0;
+    reExec->latencySum = 0;
+    reExec->maxLatency = 0;
+
+    return status;
+}
+
 int
 fillExecSubmitInp( ruleExecSubmitInp_t * ruleExecSubmitInp,  char * exeStatus,
                    char * exeTime, char * ruleExecId, char * reiFilePath, char * ruleName,
@@ -1019,15 +1360,6 @@ reServerSingleExec( rsComm_t * rsComm, char * ruleExecId, int jobType ) {
                 *estimateExeTime, *notificationAddr;
     genQueryOut_t *genQueryOut = NULL;
 
-    bzero( &reExecProc, sizeof( reExecProc ) );
-    /* init reComm */
-    reExecProc.reComm.proxyUser = rsComm->proxyUser;
-    reExecProc.reComm.myEnv = rsComm->myEnv;
-    reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf =
-        ( bytesBuf_t * ) calloc( 1, sizeof( bytesBuf_t ) );
-    reExecProc.procExecState = RE_PROC_RUNNING;
-    reExecProc.jobType = jobType;
-
     status = getReInfoById( rsComm, ruleExecId, &genQueryOut );
     if ( status < 0 ) {
         rodsLog( LOG_ERROR,
@@ -1117,15 +1449,18 @@ reServerSingleExec( rsComm_t * rsComm, char * ruleExecId, int jobType ) {
                                 ruleName->value, userName->value, exeAddress->value, exeFrequency->value,
                                 priority->value, estimateExeTime->value, notificationAddr->value );
 
-    if ( status < 0 ) {
-        return status;
+    if ( status >= 0 ) {
+        seedRandom();
+        status = runRuleExec( &reExecProc );
+        postProcRunRuleExec( rsComm, &reExecProc );
+        status = reExecProc.status;
     }
-    seedRandom();
-    status = runRuleExec( &reExecProc );
-    postProcRunRuleExec( rsComm, &reExecProc );
 
+    /* executor processes run many jobs */
+    free( reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf->buf );
+    free( reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf );
     freeGenQueryOut( &genQueryOut ); // JMC - backport 4695
 
-    return reExecProc.status;
+    return status;
 }
 
@@ -10,6 +10,7 @@
 #include "rsApiHandler.hpp"
 #include "icatHighLevelRoutines.hpp"
 #include "miscServerFunct.hpp"
+#include "rsIcatOpr.hpp"
 #include "rsGlobal.hpp"   /* server global */
 #ifdef windows_platform
 #include "rsLog.hpp"
@@ -33,6 +34,8 @@ static void NtAgentSetEnvsFromArgs( int ac, char **av );
 #include "irods_threads.hpp"
 #include "procLog.h"
 #include "initServer.hpp"
+#include "irods_agent_pool.hpp"
+#include "rodsServer.hpp"
 
 #include "readServerConfig.hpp"
 #include "sockCommNetworkInterface.hpp"
@@ -50,11 +53,13 @@ int getAgentProcPIDs(
 
 
 /* #define SERVER_DEBUG 1   */
+
+static int serveConnection();
+static int runPooledAgent( int _ctrl_fd );
+
 int
 main( int, char ** ) {
 
-    int status;
-    rsComm_t rsComm;
     char *tmpStr;
 
     ProcessType = AGENT_PT;
@@ -92,24 +97,6 @@ main( int, char ** ) {
 #endif
 #endif
 
-    memset( &rsComm, 0, sizeof( rsComm ) );
-    rsComm.thread_ctx = ( thread_context* )malloc( sizeof( thread_context ) );
-
-    status = initRsCommWithStartupPack( &rsComm, NULL );
-
-    // =-=-=-=-=-=-=-
-    // manufacture a network object for comms
-    irods::network_object_ptr net_obj;
-    irods::error ret = irods::network_factory( &rsComm, net_obj );
-    if ( !ret.ok() ) {
-        irods::log( PASS( ret ) );
-    }
-
-    if ( status < 0 ) {
-        sendVersion( net_obj, status, 0, NULL, 0 );
-        cleanupAndExit( status );
-    }
-
     /* Handle option to log sql commands */
     tmpStr = getenv( SP_LOG_SQL );
     if ( tmpStr != NULL ) {
@@ -136,15 +123,8 @@ main( int, char ** ) {
     /* Open a connection to syslog */
     openlog( "rodsAgent", LOG_ODELAY | LOG_PID, LOG_DAEMON );
 #endif
-    status = getRodsEnv( &rsComm.myEnv );
-
-    if ( status < 0 ) {
-        rodsLog( LOG_ERROR, "agentMain :: getRodsEnv failed" );
-        sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
-        cleanupAndExit( status );
-    }
 
-    ret = setRECacheSaltFromEnv();
+    irods::error ret = setRECacheSaltFromEnv();
     if ( !ret.ok() ) {
         rodsLog( LOG_ERROR, "rodsAgent::main: Failed to set RE cache mutex name\n%s", ret.result().c_str() );
         exit( 1 );
@@ -175,8 +155,53 @@ main( int, char ** ) {
         return 1;
     }
 
+    // =-=-=-=-=-=-=-
+    // an agent started for the agent pool waits for the server to
+    // hand it a client connection rather than having one up front
+    tmpStr = getenv( SP_AGENT_POOL_SOCK );
+    if ( tmpStr != NULL ) {
+        return runPooledAgent( atoi( tmpStr ) );
+    }
 
+    int status = serveConnection();
+    rodsLog( LOG_NOTICE, "Agent exiting with status = %d", status );
+    return status;
+}
 
+/* serveConnection - set up the client connection described by the startup
+ * pack environment and run the agent until the client disconnects.
+ */
+static int
+serveConnection() {
+
+    int status;
+    rsComm_t rsComm;
+
+    memset( &rsComm, 0, sizeof( rsComm ) );
+    rsComm.thread_ctx = ( thread_context* )malloc( sizeof( thread_context ) );
+
+    status = initRsCommWithStartupPack( &rsComm, NULL );
+
+    // =-=-=-=-=-=-=-
+    // manufacture a network object for comms
+    irods::network_object_ptr net_obj;
+    irods::error ret = irods::network_factory( &rsComm, net_obj );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+    }
+
+    if ( status < 0 ) {
+        sendVersion( net_obj, status, 0, NULL, 0 );
+        cleanupAndExit( status );
+    }
+
+    status = getRodsEnv( &rsComm.myEnv );
+
+    if ( status < 0 ) {
+        rodsLog( LOG_ERROR, "agentMain :: getRodsEnv failed" );
+        sendVersion( net_obj, SYS_AGENT_INIT_ERR, 0, NULL, 0 );
+        cleanupAndExit( status );
+    }
 
 #if RODS_CAT
     if ( strstr( rsComm.myEnv.rodsDebug, "CAT" ) != NULL ) {
@@ -267,9 +292,111 @@ main( int, char ** ) {
     }
 
     new_net_obj->to_server( &rsComm );
+
     cleanup();
     free( rsComm.thread_ctx );
     free( rsComm.auth_scheme );
+    return status;
+}
+
+/* pooledAgentIsStale - true if the server info loaded by preInitAgent
+ * may no longer match the catalog. It is reloaded after
+ * agent_pool_maximum_agent_age_in_seconds, and at once on the catalog
+ * server when the resource generation has moved on. The resource free
+ * space and object counts are marked out of date either way, and are only
+ * read again by the requests which use them.
+ */
+static bool
+pooledAgentIsStale( time_t _init_time ) {
+    int max_age = irods::DEFAULT_AGENT_POOL_MAX_AGENT_AGE;
+    irods::error ret = irods::get_advanced_setting<int>(
+                           irods::CFG_AGENT_POOL_MAX_AGENT_AGE,
+                           max_age );
+    if ( !ret.ok() || max_age < 0 ) {
+        max_age = irods::DEFAULT_AGENT_POOL_MAX_AGENT_AGE;
+    }
+    if ( time( 0 ) - _init_time > max_age ) {
+        return true;
+    }
+
+    /* free space and object counts change without a new generation */
+    resc_mgr.invalidate_resource_counters();
+
+#ifdef RODS_CAT
+    rsComm_t myComm;
+    if ( initRsComm( &myComm ) < 0 ) {
+        return true;
+    }
+    bool changed = false;
+    ret = resc_mgr.resource_generation_changed( &myComm, changed );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return true;
+    }
+    return changed;
+#else
+    return false;
+#endif
+}
+
+/* runPooledAgent - initialize what does not depend on the client, then
+ * wait for the server to hand off a connection over _ctrl_fd and serve
+ * it. A pooled agent serves a single client, so no per-client state is
+ * carried over between clients.
+ */
+static int
+runPooledAgent( int _ctrl_fd ) {
+#ifndef windows_platform
+    /* keep the control socket out of processes forked by this agent */
+    fcntl( _ctrl_fd, F_SETFD, FD_CLOEXEC );
+#endif
+
+    /* on failure initAgent does the full initialization */
+    time_t init_time = time( 0 );
+    int status = preInitAgent();
+    if ( status < 0 ) {
+        rodsLog( LOG_NOTICE,
+                 "runPooledAgent: preInitAgent failed, status = %d", status );
+    }
+
+    startupPack_t startupPack;
+    int sock = -1;
+    irods::error ret = irods::agent_pool::receive_connection( _ctrl_fd, startupPack, sock );
+    if ( !ret.ok() ) {
+        /* the server closed the pool socket, retire this agent */
+        rodsLog( LOG_DEBUG, "runPooledAgent: %s", ret.result().c_str() );
+#ifdef RODS_CAT
+        disconnectRcat();
+#endif
+        close( _ctrl_fd );
+        return 0;
+    }
+    close( _ctrl_fd );
+
+    irods::agent_pool::set_startup_env( sock, startupPack );
+
+#ifndef windows_platform
+    /* start over as a regular agent rather than serve the client with
+     * server info which may be out of date */
+    if ( status >= 0 && pooledAgentIsStale( init_time ) ) {
+        char *myArgv[2];
+        char buf[NAME_LEN];
+
+#ifdef RODS_CAT
+        disconnectRcat();
+#endif
+        unsetenv( SP_AGENT_POOL_SOCK );
+        rstrcpy( buf, AGENT_EXE, NAME_LEN );
+        myArgv[0] = buf;
+        myArgv[1] = NULL;
+        execv( myArgv[0], myArgv );
+        rodsLog( LOG_ERROR, "runPooledAgent: execv error errno=%d", errno );
+        close( sock );
+        return SYS_AGENT_INIT_ERR;
+    }
+#endif
+
+    status = serveConnection();
     rodsLog( LOG_NOTICE, "Agent exiting with status = %d", status );
     return status;
 }
@@ -30,6 +30,7 @@
 #include "irods_network_factory.hpp"
 #include "irods_server_properties.hpp"
 #include "irods_server_control_plane.hpp"
+#include "irods_agent_pool.hpp"
 #include "readServerConfig.hpp"
 #include "initServer.hpp"
 #include "procLog.h"
@@ -314,6 +315,13 @@ serverMain( char *logDir ) {
         irods::server_control_plane ctrl_plane(
             irods::CFG_SERVER_CONTROL_PLANE_PORT );
 
+        SvrSock = svrComm.sock;
+
+#ifndef windows_platform
+        irods::agent_pool::instance().configure();
+        replenishAgentPool();
+#endif
+
         startProcConnReqThreads();
 #if RODS_CAT // JMC - backport 4612
         try {
@@ -327,7 +335,6 @@ serverMain( char *logDir ) {
 
         fd_set sockMask;
         FD_ZERO( &sockMask );
-        SvrSock = svrComm.sock;
 
         irods::server_state& state = irods::server_state::instance();
         while ( true ) {
@@ -456,6 +463,9 @@ serverMain( char *logDir ) {
 
         procChildren( &ConnectedAgentHead );
         stopProcConnReqThreads();
+#ifndef windows_platform
+        irods::agent_pool::instance().shutdown();
+#endif
 
     }
     catch ( const irods::exception& e_ ) {
@@ -508,12 +518,21 @@ procChildren( agentProc_t **agentProcHead ) {
 
 #ifndef _WIN32
     while ( ( childPid = waitpid( -1, &status, WNOHANG ) ) > 0 ) {
+        bool idlePooledAgent = irods::agent_pool::instance().reap( childPid );
         tmpAgentProc = getAgentProcByPid( childPid, agentProcHead );
         if ( tmpAgentProc != NULL ) {
             rodsLog( LOG_NOTICE, "Agent process %d exited with status %d",
                      childPid, status );
             free( tmpAgentProc );
         }
+        else if ( idlePooledAgent ) {
+            rodsLog( LOG_NOTICE,
+                     "Pooled agent process %d exited with status %d",
+                     childPid, status );
+            /* wake the spawn manager to replace it */
+            boost::unique_lock< boost::mutex > spwn_req_lock( SpawnReqCondMutex );
+            SpawnReqCond.notify_all();
+        }
         else {
             rodsLog( LOG_NOTICE,
                      "Agent process %d exited with status %d but not in queue",
@@ -571,6 +590,18 @@ spawnAgent( agentProc_t *connReq, agentProc_t **agentProcHead ) {
     startupPack = &connReq->startupPack;
 
 #ifndef windows_platform
+    /* hand the connection to a pre-initialized agent if one is waiting */
+    irods::agent_pool& pool = irods::agent_pool::instance();
+    if ( pool.enabled() ) {
+        irods::error ret = pool.hand_off( newSock, *startupPack, childPid );
+        if ( ret.ok() ) {
+            queConnectedAgentProc( childPid, connReq, agentProcHead );
+            return childPid;
+        }
+        rodsLog( LOG_DEBUG,
+                 "spawnAgent: no pooled agent available, forking a new agent" );
+    }
+
     childPid = fork();  /* use fork instead of vfork because of multi-thread
                          * env */
 
@@ -578,31 +609,7 @@ spawnAgent( agentProc_t *connReq, agentProc_t **agentProcHead ) {
         return SYS_FORK_ERROR - errno;
     }
     else if ( childPid == 0 ) { /* child */
-        agentProc_t *tmpAgentProc;
-        close( SvrSock );
-
-        /* close any socket still in the queue */
-
-        /* These queues may be inconsistent because of the multi-threading
-             * of the parent. set sock to -1 if it has been closed */
-        tmpAgentProc = ConnReqHead;
-        while ( tmpAgentProc != NULL ) {
-            if ( tmpAgentProc->sock == -1 ) {
-                break;
-            }
-            close( tmpAgentProc->sock );
-            tmpAgentProc->sock = -1;
-            tmpAgentProc = tmpAgentProc->next;
-        }
-        tmpAgentProc = SpawnReqHead;
-        while ( tmpAgentProc != NULL ) {
-            if ( tmpAgentProc->sock == -1 ) {
-                break;
-            }
-            close( tmpAgentProc->sock );
-            tmpAgentProc->sock = -1;
-            tmpAgentProc = tmpAgentProc->next;
-        }
+        closeQueuedSockets();
 
         execAgent( newSock, startupPack );
     }
@@ -617,6 +624,34 @@ spawnAgent( agentProc_t *connReq, agentProc_t **agentProcHead ) {
     return childPid;
 }
 
+/* close the listening socket and any socket still in the queue in a
+ * newly forked child.  These queues may be inconsistent because of the
+ * multi-threading of the parent. set sock to -1 if it has been closed */
+void
+closeQueuedSockets() {
+    agentProc_t *tmpAgentProc;
+    close( SvrSock );
+
+    tmpAgentProc = ConnReqHead;
+    while ( tmpAgentProc != NULL ) {
+        if ( tmpAgentProc->sock == -1 ) {
+            break;
+        }
+        close( tmpAgentProc->sock );
+        tmpAgentProc->sock = -1;
+        tmpAgentProc = tmpAgentProc->next;
+    }
+    tmpAgentProc = SpawnReqHead;
+    while ( tmpAgentProc != NULL ) {
+        if ( tmpAgentProc->sock == -1 ) {
+            break;
+        }
+        close( tmpAgentProc->sock );
+        tmpAgentProc->sock = -1;
+        tmpAgentProc = tmpAgentProc->next;
+    }
+}
+
 int
 execAgent( int newSock, startupPack_t *startupPack ) {
 #if windows_platform
@@ -628,32 +663,7 @@ execAgent( int newSock, startupPack_t *startupPack ) {
     int status;
     char buf[NAME_LEN];
 
-    mySetenvInt( SP_NEW_SOCK, newSock );
-    mySetenvInt( SP_PROTOCOL, startupPack->irodsProt );
-    mySetenvInt( SP_RECONN_FLAG, startupPack->reconnFlag );
-    mySetenvInt( SP_CONNECT_CNT, startupPack->connectCnt );
-    mySetenvStr( SP_PROXY_USER, startupPack->proxyUser );
-    mySetenvStr( SP_PROXY_RODS_ZONE, startupPack->proxyRodsZone );
-    mySetenvStr( SP_CLIENT_USER, startupPack->clientUser );
-    mySetenvStr( SP_CLIENT_RODS_ZONE, startupPack->clientRodsZone );
-    mySetenvStr( SP_REL_VERSION, startupPack->relVersion );
-    mySetenvStr( SP_API_VERSION, startupPack->apiVersion );
-
-    // =-=-=-=-=-=-=-
-    // if the client-server negotiation request is in the
-    // option variable, set that env var and strip it out
-    std::string opt_str( startupPack->option );
-    size_t pos = opt_str.find( REQ_SVR_NEG );
-    if ( std::string::npos != pos ) {
-        std::string trunc_str = opt_str.substr( 0, pos );
-        mySetenvStr( SP_OPTION,           trunc_str.c_str() );
-        mySetenvStr( irods::RODS_CS_NEG, REQ_SVR_NEG );
-
-    }
-    else {
-        mySetenvStr( SP_OPTION, startupPack->option );
-
-    }
+    irods::agent_pool::set_startup_env( newSock, *startupPack );
 
     mySetenvInt( SERVER_BOOT_TIME, ServerBootTime );
 
@@ -688,6 +698,73 @@ execAgent( int newSock, startupPack_t *startupPack ) {
 #endif
 }
 
+/* fork and exec an agent which initializes itself and then waits on a
+ * unix domain socket for the server to hand it a client connection */
+int
+spawnPooledAgent() {
+#ifndef windows_platform
+    int fds[2];
+    if ( socketpair( AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds ) < 0 ) {
+        return SYS_SOCK_OPEN_ERR - errno;
+    }
+
+    int childPid = fork();
+    if ( childPid < 0 ) {
+        close( fds[0] );
+        close( fds[1] );
+        return SYS_FORK_ERROR - errno;
+    }
+    else if ( childPid == 0 ) { /* child */
+        char *myArgv[2];
+        char buf[NAME_LEN];
+
+        closeQueuedSockets();
+        close( fds[0] );
+
+        /* the agent end must survive the execv */
+        fcntl( fds[1], F_SETFD, 0 );
+        mySetenvInt( SP_AGENT_POOL_SOCK, fds[1] );
+        mySetenvInt( SERVER_BOOT_TIME, ServerBootTime );
+
+        rstrcpy( buf, AGENT_EXE, NAME_LEN );
+        myArgv[0] = buf;
+        myArgv[1] = NULL;
+        execv( myArgv[0], myArgv );
+        rodsLog( LOG_ERROR, "spawnPooledAgent: execv error errno=%d", errno );
+        exit( 1 );
+    }
+
+    close( fds[1] );
+    irods::agent_pool::instance().add_idle( childPid, fds[0] );
+    rodsLog( LOG_DEBUG, "Pooled agent process %d started", childPid );
+
+    return childPid;
+#else
+    return SYS_NOT_SUPPORTED;
+#endif
+}
+
+/* top the pool back up to its minimum number of idle agents */
+int
+replenishAgentPool() {
+    irods::agent_pool& pool = irods::agent_pool::instance();
+    if ( !pool.enabled() ) {
+        return 0;
+    }
+
+    while ( pool.needs_agent() ) {
+        int status = spawnPooledAgent();
+        if ( status < 0 ) {
+            rodsLog( LOG_ERROR,
+                     "replenishAgentPool: spawnPooledAgent failed, status = %d",
+                     status );
+            return status;
+        }
+    }
+
+    return 0;
+}
+
 int
 queConnectedAgentProc( int childPid, agentProc_t *connReq,
                        agentProc_t **agentProcHead ) {
@@ -995,7 +1072,7 @@ initServerMain( rsComm_t *svrComm ) {
         }
     }
     else if ( unsigned char *shared = prepareServerSharedMemory() ) {
-        copyCache( &shared, SHMMAX, &ruleEngineConfig );
+        updateCache( shared, SHMMAX, &ruleEngineConfig, RULE_ENGINE_INIT_CACHE );
         detachSharedMemory();
     }
     else {
@@ -1218,7 +1295,13 @@ spawnManagerTask() {
     while ( irods::server_state::STOPPED != state() ) {
 
         boost::unique_lock<boost::mutex> spwn_req_lock( SpawnReqCondMutex );
-        SpawnReqCond.wait( spwn_req_lock );
+        if ( irods::agent_pool::instance().enabled() ) {
+            /* wake up to refill the pool once a spawn backoff expires */
+            SpawnReqCond.timed_wait( spwn_req_lock, boost::posix_time::seconds( 1 ) );
+        }
+        else {
+            SpawnReqCond.wait( spwn_req_lock );
+        }
 
         while ( SpawnReqHead != NULL ) {
             mySpawnReq = SpawnReqHead;
@@ -1251,6 +1334,8 @@ spawnManagerTask() {
 
         spwn_req_lock.unlock();
 
+        replenishAgentPool();
+
         curTime = time( 0 );
         if ( curTime > agentQueChkTime + AGENT_QUE_CHK_INT ) {
             agentQueChkTime = curTime;
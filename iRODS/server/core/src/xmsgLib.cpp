@@ -23,11 +23,18 @@
 #include "sockCommNetworkInterface.hpp"
 
 static boost::mutex			     ReqQueCondMutex;
-static boost::mutex			     MessQueCondMutex;
-static boost::thread*			 ProcReqThread[ NUM_XMSG_THR ];
 static boost::condition_variable ReqQueCond;
+static std::vector< boost::thread* > ProcReqThread;
+
+// =-=-=-=-=-=-=-
+// the tickets of a hash slot and their messages are guarded by the lock of
+// the slot, so requests on different tickets do not wait for each other
+static boost::mutex			     TicketHashQueMutex[ NUM_HASH_SLOT ];
+
+// =-=-=-=-=-=-=-
+// XMsgMsParamArray and the rule engine evaluating a msgCondition are shared
+static boost::mutex			     MsgCondMutex;
 
-static xmsgQue_t      XmsgQue;
 static xmsgReq_t*     XmsgReqHead = NULL;
 static xmsgReq_t*     XmsgReqTail = NULL; /* points to last item in queue */
 static msParamArray_t XMsgMsParamArray;
@@ -44,18 +51,12 @@ initThreadEnv() {
 }
 
 
+/* the caller holds the lock of the hash slot of ticketMsgStruct */
+
 int
 addXmsgToQues( irodsXmsg_t *irodsXmsg,  ticketMsgStruct_t *ticketMsgStruct ) {
 
-
-    MessQueCondMutex.lock();
-
-    addXmsgToXmsgQue( irodsXmsg, &XmsgQue );
-    int status = addXmsgToTicketMsgStruct( irodsXmsg, ticketMsgStruct );
-
-    MessQueCondMutex.unlock();
-
-    return status;
+    return addXmsgToTicketMsgStruct( irodsXmsg, ticketMsgStruct );
 
 }
 
@@ -182,6 +183,12 @@ int checkMsgCondition( irodsXmsg_t *irodsXmsg, char *msgCond ) {
 
     strcpy( condStr, msgCond );
 
+    if ( strcmp( condStr, "" ) == 0 ) {
+        return 0;
+    }
+
+    boost::lock_guard<boost::mutex> cond_lock( MsgCondMutex );
+
     XMsgMsParamArray.msParam[0]->inOutStruct = ( char * ) irodsXmsg->sendXmsgInfo->msgType; /* *XHDR*/
     XMsgMsParamArray.msParam[1]->inOutStruct = ( char * ) irodsXmsg->sendUserName;        /* *XUSER*/
     XMsgMsParamArray.msParam[2]->inOutStruct = ( char * ) irodsXmsg->sendAddr;            /* *XADDR*/
@@ -190,9 +197,6 @@ int checkMsgCondition( irodsXmsg_t *irodsXmsg, char *msgCond ) {
     * ( int * ) XMsgMsParamArray.msParam[5]->inOutStruct = ( int ) irodsXmsg->seqNumber;    /* *XSEQNUM*/
     * ( int * ) XMsgMsParamArray.msParam[6]->inOutStruct = ( int ) irodsXmsg->sendTime;     /* *XTIME*/
 
-    if ( strcmp( condStr, "" ) == 0 ) {
-        return 0;
-    }
     int ret;
     int grdf[2];
     disableReDebugger( grdf );
@@ -206,6 +210,8 @@ int checkMsgCondition( irodsXmsg_t *irodsXmsg, char *msgCond ) {
 
 
 
+/* the caller holds the lock of the hash slot of rcvXmsgInp->rcvTicket */
+
 int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
     int rcvTicket = rcvXmsgInp->rcvTicket;
     char *msgCond = rcvXmsgInp->msgCondition;
@@ -227,7 +233,6 @@ int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
 
     /* now locate the irodsXmsg_t */
 
-    MessQueCondMutex.lock();
     irodsXmsg_t *tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
 
     while ( tmpIrodsXmsg != NULL && checkMsgCondition( tmpIrodsXmsg, msgCond ) != 0 ) {
@@ -235,7 +240,6 @@ int getIrodsXmsg( rcvXmsgInp_t *rcvXmsgInp, irodsXmsg_t **outIrodsXmsg ) {
     }
 
     *outIrodsXmsg = tmpIrodsXmsg;
-    MessQueCondMutex.unlock();
     if ( tmpIrodsXmsg == NULL ) {
         return SYS_NO_XMSG_FOR_MSG_NUMBER;
     }
@@ -363,7 +367,7 @@ addTicketMsgStructToHQue( ticketMsgStruct_t *ticketMsgStruct,
         ticketMsgStruct->hprev = tmpTicketMsgStruct->hprev;
         ticketMsgStruct->hnext = tmpTicketMsgStruct;
         tmpTicketMsgStruct->hprev->hnext = ticketMsgStruct;
-        tmpTicketMsgStruct->hprev = tmpTicketMsgStruct;
+        tmpTicketMsgStruct->hprev = ticketMsgStruct;
     }
 
     return 0;
@@ -422,7 +426,9 @@ addReqToQue( int sock ) {
 
     ReqQueCondMutex.unlock();
 
-    ReqQueCond.notify_all();
+    // =-=-=-=-=-=-=-
+    // a single request needs a single thread
+    ReqQueCond.notify_one();
 
     return 0;
 }
@@ -431,50 +437,43 @@ xmsgReq_t *
 getReqFromQue() {
     xmsgReq_t *myXmsgReq = NULL;
 
-    while ( myXmsgReq == NULL ) {
-
-        ReqQueCondMutex.lock();
-
-        if ( XmsgReqHead != NULL ) {
-            myXmsgReq = XmsgReqHead;
-            XmsgReqHead = XmsgReqHead->next;
-            ReqQueCondMutex.unlock();
-
-            break;
-        }
-
-        ReqQueCondMutex.unlock();
-
-        boost::unique_lock<boost::mutex> boost_lock( ReqQueCondMutex );
+    boost::unique_lock<boost::mutex> boost_lock( ReqQueCondMutex );
+    while ( XmsgReqHead == NULL ) {
         ReqQueCond.wait( boost_lock );
-        if ( XmsgReqHead == NULL ) {
-            boost_lock.unlock();
-
-            continue;
-        }
-        else {
-            myXmsgReq = XmsgReqHead;
-            XmsgReqHead = XmsgReqHead->next;
-            boost_lock.unlock();
+    }
 
-            break;
-        }
+    myXmsgReq = XmsgReqHead;
+    XmsgReqHead = XmsgReqHead->next;
+    if ( XmsgReqHead == NULL ) {
+        XmsgReqTail = NULL;
     }
 
     return myXmsgReq;
 }
 
+/* start the threads serving the connections. A thread serves one
+ * connection until it is idle for REQ_MSG_TIMEOUT_TIME, so there are
+ * NUM_XMSG_THR_PER_CORE per core, and at least NUM_XMSG_THR
+ */
+
 int
 startXmsgThreads() {
-    for ( int i = 0; i < NUM_XMSG_THR; i++ ) {
+    int numThr = NUM_XMSG_THR_PER_CORE * boost::thread::hardware_concurrency();
+    if ( numThr < NUM_XMSG_THR ) {
+        numThr = NUM_XMSG_THR;
+    }
+
+    for ( int i = 0; i < numThr; i++ ) {
         try {
-            ProcReqThread[i] = new boost::thread( procReqRoutine );
+            ProcReqThread.push_back( new boost::thread( procReqRoutine ) );
         }
         catch ( const boost::thread_resource_error& ) {
             return SYS_THREAD_RESOURCE_ERR;
         }
     }
 
+    rodsLog( LOG_NOTICE, "startXmsgThreads: started %d threads", numThr );
+
     return 0;
 }
 
@@ -560,6 +559,18 @@ ticketHashFunc( uint rcvTicket ) {
     return mySlot;
 }
 
+int
+lockTicketHashQue( uint rcvTicket ) {
+    TicketHashQueMutex[ ticketHashFunc( rcvTicket ) ].lock();
+    return 0;
+}
+
+int
+unlockTicketHashQue( uint rcvTicket ) {
+    TicketHashQueMutex[ ticketHashFunc( rcvTicket ) ].unlock();
+    return 0;
+}
+
 int
 initXmsgHashQue() {
 
@@ -568,7 +579,6 @@ initXmsgHashQue() {
     int hashSlotNum;
 
     memset( XmsgHashQue, 0, NUM_HASH_SLOT * sizeof( ticketHashQue_t ) );
-    memset( &XmsgQue, 0, sizeof( XmsgQue ) );
 
     /***  have a permanent message queue with ticket-id =1,2,3,4,5***/
 
@@ -631,6 +641,8 @@ initXmsgHashQue() {
     return 0;
 }
 
+/* the caller holds the lock of the hash slot of rcvTicket */
+
 int
 getTicketMsgStructByTicket( uint rcvTicket,
                             ticketMsgStruct_t **outTicketMsgStruct ) {
@@ -668,7 +680,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
     if ( irodsXmsg == NULL || rcvXmsgOut == NULL ) {
         rodsLog( LOG_ERROR,
                  "_rsRcvXmsg: input irodsXmsg or rcvXmsgOut is NULL" );
-        MessQueCondMutex.unlock();
         return SYS_INTERNAL_NULL_INPUT_ERR;
     }
 
@@ -693,7 +704,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
                  NAME_LEN );
         rstrcpy( rcvXmsgOut->sendAddr, irodsXmsg->sendAddr,
                  NAME_LEN );
-        rmXmsgFromXmsgQue( irodsXmsg, &XmsgQue );
         rmXmsgFromXmsgTcketQue( irodsXmsg, &ticketMsgStruct->xmsgQue );
         clearSendXmsgInfo( sendXmsgInfo );
         free( sendXmsgInfo );
@@ -709,7 +719,6 @@ _rsRcvXmsg( irodsXmsg_t *irodsXmsg, rcvXmsgOut_t *rcvXmsgOut ) {
         rstrcpy( rcvXmsgOut->sendAddr, irodsXmsg->sendAddr,
                  NAME_LEN );
     }
-    MessQueCondMutex.unlock();
     return 0;
 }
 
@@ -722,7 +731,6 @@ clearOneXMessage( ticketMsgStruct_t *ticketMsgStruct, int seqNum ) {
     tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
     while ( tmpIrodsXmsg != NULL ) {
         if ( ( int ) tmpIrodsXmsg->seqNumber == seqNum ) {
-            rmXmsgFromXmsgQue( tmpIrodsXmsg, &XmsgQue );
             rmXmsgFromXmsgTcketQue( tmpIrodsXmsg, &ticketMsgStruct->xmsgQue );
             clearSendXmsgInfo( tmpIrodsXmsg->sendXmsgInfo );
             free( tmpIrodsXmsg->sendXmsgInfo );
@@ -744,7 +752,6 @@ clearAllXMessages( ticketMsgStruct_t *ticketMsgStruct ) {
     tmpIrodsXmsg = ticketMsgStruct->xmsgQue.head;
     while ( tmpIrodsXmsg != NULL ) {
         tmpIrodsXmsg2 = tmpIrodsXmsg->tnext;
-        rmXmsgFromXmsgQue( tmpIrodsXmsg, &XmsgQue );
         clearSendXmsgInfo( tmpIrodsXmsg->sendXmsgInfo );
         free( tmpIrodsXmsg->sendXmsgInfo );
         free( tmpIrodsXmsg );
@@ -35,6 +35,7 @@ int chlModDataObjMeta( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
                        keyValPair_t *regParam );
 int chlUpdateRescObjCount( const std::string& _resc, int _delta );
 int chlRegDataObj( rsComm_t *rsComm, dataObjInfo_t *dataObjInfo );
+int chlRegDataObjBulk( rsComm_t *rsComm, dataObjInfo_t *dataObjInfoHead );
 int chlRegRuleExecObj( rsComm_t *rsComm,
                        ruleExecSubmitInp_t *ruleExecSubmitInp );
 int chlRegReplica( rsComm_t *rsComm, dataObjInfo_t *srcDataObjInfo,
@@ -193,16 +194,18 @@ int chlSubstituteResourceHierarchies( rsComm_t *rsComm, const char *old_hier, co
 
 /// =-=-=-=-=-=-=-
 /// @brief typedefs and prototype for query used for rebalancing operation
-typedef std::vector< int > dist_child_result_t;
+typedef std::vector< rodsLong_t > dist_child_result_t;
 
 /// =-=-=-=-=-=-=-
 /// @brief query which distinct data objects do not existin on a
-///        given child resource which do exist on the parent
+///        given child resource which do exist on the parent, in
+///        order of data id starting after _min_data_id
 int chlGetDistinctDataObjsMissingFromChildGivenParent(
     const std::string&   _parent,
     const std::string&   _child,
     int                  _limit,
-    dist_child_result_t& _results );
+    dist_child_result_t& _results,
+    rodsLong_t           _min_data_id = 0 );
 
 /// =-=-=-=-=-=-=-
 /// @brief the the distinct data object count for a resource
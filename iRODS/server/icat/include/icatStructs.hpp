@@ -19,6 +19,9 @@ typedef struct {
     int     selectColIds[MAX_NUM_OF_SELECT_ITEMS];  /* rods-id to column in the
                                                      result (unused, so far) */
     char    *resultValue[MAX_NUM_OF_SELECT_ITEMS];  /* pointer to data area */
+    void*   cacheEntry;                         /* prepared statement cache
+                                                   entry owning the handle
+                                                   and buffers, if any */
 } icatStmtStrct;
 
 
@@ -32,6 +35,8 @@ typedef struct {
     char databasePassword[DB_PASSWORD_LEN];  /* password for accessing the db */
     int         databaseType;     /* DB type, DB_TYPE_POSTGRES, etc */
     char        database_plugin_type[ DB_TYPENAME_LEN ];
+    void*       stmtCache;        /* prepared statements kept by the low
+                                     level routines for this connection */
 } icatSessionStruct;
 
 
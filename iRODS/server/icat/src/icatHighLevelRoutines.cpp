@@ -537,6 +537,61 @@ int chlRegDataObj(
 
 } // chlRegDataObj
 
+// =-=-=-=-=-=-=-
+// chlRegDataObjBulk - Register a list of new iRODS data objects, linked
+// through dataObjInfo->next, with as few statements as possible.
+// Input - rsComm_t *rsComm  - the server handle
+//         dataObjInfo_t *dataObjInfoHead - the first object to register.
+//            The dataId of every object is set on success.
+// The objects are not committed, the caller calls chlCommit.
+int chlRegDataObjBulk(
+    rsComm_t*      _comm,
+    dataObjInfo_t* _data_obj_info ) {
+    // =-=-=-=-=-=-=-
+    // call factory for database object
+    irods::database_object_ptr db_obj_ptr;
+    irods::error ret = irods::database_factory(
+                           database_plugin_type,
+                           db_obj_ptr );
+    if ( !ret.ok() ) {
+        irods::log( PASS( ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // resolve a plugin for that object
+    irods::plugin_ptr db_plug_ptr;
+    ret = db_obj_ptr->resolve(
+              irods::DATABASE_INTERFACE,
+              db_plug_ptr );
+    if ( !ret.ok() ) {
+        irods::log(
+            PASSMSG(
+                "failed to resolve database interface",
+                ret ) );
+        return ret.code();
+    }
+
+    // =-=-=-=-=-=-=-
+    // cast plugin and object to db and fco for call
+    irods::first_class_object_ptr ptr = boost::dynamic_pointer_cast <
+                                        irods::first_class_object > ( db_obj_ptr );
+    irods::database_ptr           db = boost::dynamic_pointer_cast <
+                                       irods::database > ( db_plug_ptr );
+
+    // =-=-=-=-=-=-=-
+    // call the operation on the plugin
+    ret = db->call <
+          dataObjInfo_t* > (
+              _comm,
+              irods::DATABASE_OP_REG_DATA_OBJ_BULK,
+              ptr,
+              _data_obj_info );
+
+    return ret.code();
+
+} // chlRegDataObjBulk
+
 // =-=-=-=-=-=-=-
 // chlRegReplica - Register a new iRODS replica file (data object)
 // Input - rsComm_t *rsComm  - the server handle
@@ -4360,7 +4415,8 @@ int chlGetDistinctDataObjsMissingFromChildGivenParent(
     const std::string&   _parent,
     const std::string&   _child,
     int                  _limit,
-    dist_child_result_t& _results ) {
+    dist_child_result_t& _results,
+    rodsLong_t           _min_data_id ) {
     // =-=-=-=-=-=-=-
     // call factory for database object
     irods::database_object_ptr db_obj_ptr;
@@ -4399,13 +4455,15 @@ int chlGetDistinctDataObjsMissingFromChildGivenParent(
           const std::string*,
           const std::string*,
           int,
-          dist_child_result_t* > ( 0,
-                                   irods::DATABASE_OP_GET_DISTINCT_DATA_OBJS_MISSING_FROM_CHILD_GIVEN_PARENT,
-                                   ptr,
-                                   &_parent,
-                                   &_child,
-                                   _limit,
-                                   &_results );
+          dist_child_result_t*,
+          rodsLong_t > ( 0,
+                  irods::DATABASE_OP_GET_DISTINCT_DATA_OBJS_MISSING_FROM_CHILD_GIVEN_PARENT,
+                  ptr,
+                  &_parent,
+                  &_child,
+                  _limit,
+                  &_results,
+                  _min_data_id );
 
     return ret.code();
 
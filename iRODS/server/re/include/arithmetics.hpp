@@ -23,7 +23,14 @@
 
 #define RETURN {goto ret;}
 
+namespace irods {
+    class ms_table_entry;
+}
+typedef struct callTarget CallTarget;
+
 /** AST evaluators */
+void logRuleActionError( Node *action, int recovery, int status );
+void logRuleRollingBack( ruleExecInfo_t *rei );
 Res* evaluateActions( Node *ruleAction, Node *ruleRecovery,
                       int applyAll, ruleExecInfo_t *rei, int reiSaveFlag , Env *env,
                       rError_t *errmsg, Region *r );
@@ -33,8 +40,10 @@ Res* evaluateVar3( char* vn, Node *node, ruleExecInfo_t *rei, Env *env, rError_t
 Res *setVariableValue( char *varName, Res *val, Node *node, ruleExecInfo_t *rei, Env *env, rError_t *errmsg, Region *r );
 Res *evaluateFunctionApplication( Node *func, Node *arg, int applyAll, Node *node, ruleExecInfo_t* rei, int reiSaveFlag, Env *env, rError_t *errmsg, Region *r );
 Res* evaluateFunction3( Node* appNode, int applyAll, Node *astNode, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r );
+Res* evaluateResolvedFunction3( Node* appNode, int applyAll, Node *astNode, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r, CallTarget *target );
 Res* execAction3( char *fn, Res** args, unsigned int nargs, int applyAll, Node *node, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r );
 Res* execMicroService3( char *inAction, Res** largs, unsigned int nargs, Node *node, Env *env, ruleExecInfo_t *rei, rError_t *errmsg, Region *r );
+Res* execMicroServiceEntry3( char *inAction, irods::ms_table_entry *msEntry, Res** largs, unsigned int nargs, Node *node, Env *env, ruleExecInfo_t *rei, rError_t *errmsg, Region *r );
 Res* execRule( char *ruleName, Res** args, unsigned int narg, int applyAll, Env *outEnv, ruleExecInfo_t *rei, int reiSaveFlag, rError_t *errmsg, Region *r );
 Res* execRuleNodeRes( Node *rule, Res** args, unsigned int narg, int applyAll, Env *outEnv, ruleExecInfo_t *rei, int reiSaveFlag, rError_t *errmsg, Region *r );
 Res* matchPattern( Node *pattern, Node *val, Env *env, ruleExecInfo_t *rei, int reiSaveFlag, rError_t *errmsg, Region *r );
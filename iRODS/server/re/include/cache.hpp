@@ -14,6 +14,7 @@
 
 Cache *copyCache( unsigned char **buf, size_t size, Cache *c );
 Cache *restoreCache( unsigned char *buf );
+void freeCache( Cache *cache );
 void applyDiff( unsigned char *pointers, long pointersSize, long diff, long pointerDiff );
 void applyDiffToPointers( unsigned char *pointers, long pointersSize, long pointerDiff );
 int updateCache( unsigned char *shared, size_t size, Cache *cache, int processType );
@@ -0,0 +1,60 @@
+/* For copyright information please refer to files in the COPYRIGHT directory
+ */
+
+#ifndef FLAT_RULES_HPP
+#define FLAT_RULES_HPP
+#include "restructs.hpp"
+#include "irods_ms_plugin.hpp"
+
+/* flattened rule bodies
+ *
+ * The action and recovery lists of a rule are flattened into arrays of actions the first time the
+ * rule is executed, with cuts marked and calls to named functions resolved once to the function
+ * descriptor or microservice table entry they end up at, instead of on every call.
+ * This is not an expression compiler: the arguments of a call and every other action are still
+ * evaluated by the tree walker (evaluateExpression3).
+ *
+ * Flattened rules are dropped whenever rules or function descriptors are added or removed.
+ */
+
+typedef enum flatActionOp {
+    FA_EVAL, /* evaluate the action with evaluateExpression3 */
+    FA_CUT, /* a cut in the action list */
+    FA_CALL /* apply a function given by name to a tuple of arguments */
+} FlatActionOp;
+
+typedef enum callTargetType {
+    CALL_UNRESOLVED,
+    CALL_TREE_WALK, /* the function symbol does not take a single tuple, evaluate with the tree walker */
+    CALL_FUNCTION, /* a function descriptor, or a rule or action left to execAction3 */
+    CALL_MICROSERVICE /* a microservice which is not shadowed by a rule */
+} CallTargetType;
+
+typedef struct callTarget {
+    CallTargetType type;
+    FunctionDesc *fd; /* the function descriptor, NULL if there is none */
+    irods::ms_table_entry *msEntry;
+    char action[MAX_NAME_LEN]; /* the microservice name after function name mapping */
+} CallTarget;
+
+typedef struct flatAction {
+    FlatActionOp op;
+    Node *node; /* the action in the rule body */
+    CallTarget target;
+} FlatAction;
+
+typedef struct flatRule {
+    Node *rule;
+    unsigned int generation;
+    int actionsLen;
+    FlatAction *actions;
+    int recoveryLen;
+    FlatAction *recovery;
+} FlatRule;
+
+int useFlatRules();
+FlatRule *getFlatRule( Node *rule );
+void invalidateFlatRules();
+Res *execFlatRule( FlatRule *prog, int applyAll, ruleExecInfo_t *rei, int reiSaveFlag, Env *env, rError_t *errmsg, Region *r );
+
+#endif
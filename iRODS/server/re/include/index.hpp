@@ -13,6 +13,11 @@
 
 #define COND_INDEX_THRESHOLD 2
 
+/* states in the pep index */
+#define PEP_NO_RULE 0
+#define PEP_EMPTY_RULES 1
+#define PEP_HAS_RULES 2
+
 char *convertRuleNameArityToKey( char *ruleName, int arity );
 RuleIndexList *newRuleIndexList( char *ruleName, int ruleIndex, Region *r );
 RuleIndexListNode *newRuleIndexListNode( int ruleIndex, RuleIndexListNode *prev, RuleIndexListNode *next, Region *r );
@@ -53,4 +58,10 @@ void removeNodeFromRuleIndexList( RuleIndexList *rd, RuleIndexListNode *node );
 void appendRuleNodeToRuleIndexList( RuleIndexList *rd, int i, Region *r );
 void prependRuleNodeToRuleIndexList( RuleIndexList *rd, int i, Region *r );
 
+/* which policy enforcement points have rules, and how many were fired or skipped */
+void clearPepIndex();
+int lookupPepIndex( const char *ruleName );
+void recordPep( int fired );
+void getPepCounts( rodsLong_t *fired, rodsLong_t *skipped );
+
 #endif
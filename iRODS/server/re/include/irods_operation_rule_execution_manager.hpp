@@ -48,12 +48,21 @@ namespace irods {
                 keyValPair_t&,  // vars from fco
                 std::string& ); // results of call to rule
 
+            /// =-=-=-=-=-=-=-
+            /// @brief true if the pep index has a pre or post operation rule
+            virtual bool has_rules();
+
         protected:
 
             /// =-=-=-=-=-=-=-
             /// @brief name of the rule minus the _pre or _post
             std::string rule_name_;
 
+            /// =-=-=-=-=-=-=-
+            /// @brief names of the pre and post operation rules
+            std::string pre_name_;
+            std::string post_name_;
+
             /// =-=-=-=-=-=-=-
             /// @brief execute rule for post operation
             virtual error exec_op(
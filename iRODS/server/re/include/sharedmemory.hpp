@@ -12,10 +12,16 @@
 #include "irods_error.hpp"
 
 #define SHMMAX 30000000
+/* the address snapshots of the rule cache are relocated to, agents which can map them there use them in place */
 #define SHM_BASE_ADDR ((void *)0x80000000)
 unsigned char *prepareServerSharedMemory();
 void detachSharedMemory();
 int removeSharedMemory();
 unsigned char *prepareNonServerSharedMemory();
+int writeSharedMemorySnapshot( unsigned int version, unsigned char *data, size_t dataSize, unsigned char *pointers, size_t pointersSize );
+unsigned char *mapSharedMemorySnapshot( unsigned int version, void *address );
+int unmapSharedMemorySnapshot( unsigned char *buf );
+void removeSharedMemorySnapshot( unsigned int version );
 irods::error getSharedMemoryName( std::string &shared_memory_name );
+irods::error getSharedMemorySnapshotName( unsigned int version, std::string &snapshot_name );
 #endif /* SHAREDMEMORY_H */
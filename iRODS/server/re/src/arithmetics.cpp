@@ -14,6 +14,7 @@
 #include "reVariableMap.gen.hpp"
 #include "reVariableMap.hpp"
 #include "debug.hpp"
+#include "flatRules.hpp"
 
 //    #include "irods_ms_plugin.hpp"
 //    extern irods::ms_table MicrosTable;
@@ -357,6 +358,37 @@ Res* processCoercion( Node *node, Res *res, ExprType *type, Hashtable *tvarEnv,
     return newErrorRes( r, RE_TYPE_ERROR );
 }
 
+/* log an action of a rule body, or of its recovery chain, which failed */
+void logRuleActionError( Node *action, int recovery, int status ) {
+#ifndef DEBUG
+    char tmpStr[1024];
+    char *errAction = getNodeType( action ) == N_APPLICATION ? N_APP_FUNC( action )->text : action->text;
+    snprintf( tmpStr, sizeof( tmpStr ), "%s Failed for %s",
+              recovery ? "executeRuleRecovery" : "executeRuleAction", errAction );
+    rodsLogError( LOG_ERROR, status, tmpStr );
+    if ( !recovery ) {
+        rodsLog( LOG_NOTICE, "executeRuleBody: Microservice or Action %s Failed with status %i", errAction, status );
+    }
+#endif
+}
+
+/* trace each step of a recovery chain when rules are being tested */
+void logRuleRollingBack( ruleExecInfo_t *rei ) {
+#ifndef DEBUG
+    if ( reTestFlag > 0 ) {
+        if ( reTestFlag == COMMAND_TEST_1 || reTestFlag == COMMAND_TEST_MSI ) {
+            fprintf( stdout, "***RollingBack\n" );
+        }
+        else if ( reTestFlag == HTML_TEST_1 ) {
+            fprintf( stdout, "<FONT COLOR=#FF0000>***RollingBack</FONT><BR>\n" );
+        }
+        else if ( reTestFlag == LOG_TEST_1 && rei != NULL && rei->rsComm != NULL ) {
+            rodsLog( LOG_NOTICE, "***RollingBack\n" );
+        }
+    }
+#endif
+}
+
 Res* evaluateActions( Node *expr, Node *reco, int applyAll, ruleExecInfo_t *rei, int reiSaveFlag, Env *env, rError_t* errmsg, Region *r ) {
     /*
         printTree(expr, 0);
@@ -364,9 +396,6 @@ Res* evaluateActions( Node *expr, Node *reco, int applyAll, ruleExecInfo_t *rei,
     int i;
     int cutFlag = 0;
     Res* res = NULL;
-#ifndef DEBUG
-    char tmpStr[1024];
-#endif
     switch ( getNodeType( expr ) ) {
     case N_ACTIONS:
         for ( i = 0; i < expr->degree; i++ ) {
@@ -377,38 +406,16 @@ Res* evaluateActions( Node *expr, Node *reco, int applyAll, ruleExecInfo_t *rei,
             }
             res = evaluateExpression3( nodei, applyAll, 0, rei, reiSaveFlag, env, errmsg, r );
             if ( getNodeType( res ) == N_ERROR ) {
-#ifndef DEBUG
-                char *errAction = getNodeType( nodei ) == N_APPLICATION ? N_APP_FUNC( nodei )->text : nodei->text;
-                sprintf( tmpStr, "executeRuleAction Failed for %s", errAction );
-                rodsLogError( LOG_ERROR, RES_ERR_CODE( res ), tmpStr );
-                rodsLog( LOG_NOTICE, "executeRuleBody: Microservice or Action %s Failed with status %i", errAction, RES_ERR_CODE( res ) );
-#endif
+                logRuleActionError( nodei, 0, RES_ERR_CODE( res ) );
                 /* run recovery chain */
                 if ( RES_ERR_CODE( res ) != RETRY_WITHOUT_RECOVERY_ERR && reco != NULL ) {
                     int i2;
                     for ( i2 = reco->degree - 1 < i ? reco->degree - 1 : i; i2 >= 0; i2-- ) {
-#ifndef DEBUG
-                        if ( reTestFlag > 0 ) {
-                            if ( reTestFlag == COMMAND_TEST_1 || reTestFlag == COMMAND_TEST_MSI ) {
-                                fprintf( stdout, "***RollingBack\n" );
-                            }
-                            else if ( reTestFlag == HTML_TEST_1 ) {
-                                fprintf( stdout, "<FONT COLOR=#FF0000>***RollingBack</FONT><BR>\n" );
-                            }
-                            else  if ( reTestFlag == LOG_TEST_1 )
-                                if ( rei != NULL && rei->rsComm != NULL && &( rei->rsComm->rError ) != NULL ) {
-                                    rodsLog( LOG_NOTICE, "***RollingBack\n" );
-                                }
-                        }
-#endif
+                        logRuleRollingBack( rei );
 
                         Res *res2 = evaluateExpression3( reco->subtrees[i2], 0, 0, rei, reiSaveFlag, env, errmsg, r );
                         if ( getNodeType( res2 ) == N_ERROR ) {
-#ifndef DEBUG
-                            char *errAction = getNodeType( reco->subtrees[i2] ) == N_APPLICATION ? N_APP_FUNC( reco->subtrees[i2] )->text : reco->subtrees[i2]->text;
-                            sprintf( tmpStr, "executeRuleRecovery Failed for %s", errAction );
-                            rodsLogError( LOG_ERROR, RES_ERR_CODE( res2 ), tmpStr );
-#endif
+                            logRuleActionError( reco->subtrees[i2], 1, RES_ERR_CODE( res2 ) );
                         }
                     }
                 }
@@ -461,6 +468,27 @@ Res *evaluateFunctionApplication( Node *func, Node *arg, int applyAll, Node *nod
  * precond n <= MAX_PARAMS_LEN
  */
 Res* evaluateFunction3( Node *appRes, int applyAll, Node *node, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r ) {
+    return evaluateResolvedFunction3( appRes, applyAll, node, env, rei, reiSaveFlag, errmsg, r, NULL );
+}
+
+/*
+ * execute an external microservice or a rule,
+ * calling the microservice directly if it was already resolved for a flattened rule
+ */
+static Res* execResolvedAction3( char *fn, CallTarget *target, Res** args, unsigned int nargs, int applyAll, Node *node, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r ) {
+    /* execRule succeeds without calling the microservice when applying all rules */
+    if ( target != NULL && target->type == CALL_MICROSERVICE && applyAll == 0 ) {
+        return execMicroServiceEntry3( target->action, target->msEntry, args, nargs, node, env, rei, errmsg, r );
+    }
+    return execAction3( fn, args, nargs, applyAll, node, env, rei, reiSaveFlag, errmsg, r );
+}
+
+/**
+ * evaluate function
+ * the function descriptor and microservice are taken from target if it is not NULL,
+ * otherwise they are looked up by name
+ */
+Res* evaluateResolvedFunction3( Node *appRes, int applyAll, Node *node, Env *env, ruleExecInfo_t* rei, int reiSaveFlag, rError_t *errmsg, Region *r, CallTarget *target ) {
     unsigned int i;
     unsigned int n;
     Node* args[MAX_FUNC_PARAMS];
@@ -502,7 +530,12 @@ Res* evaluateFunction3( Node *appRes, int applyAll, Node *node, Env *env, ruleEx
     List *localTypingConstraints = NULL;
     FunctionDesc *fd = NULL;
     /* look up function descriptor */
-    fd = ( FunctionDesc * )lookupFromEnv( ruleEngineConfig.extFuncDescIndex, fn );
+    if ( target != NULL ) {
+        fd = target->fd;
+    }
+    else {
+        fd = ( FunctionDesc * )lookupFromEnv( ruleEngineConfig.extFuncDescIndex, fn );
+    }
 
     localTypingConstraints = newList( r );
     int ioParam[MAX_FUNC_PARAMS];
@@ -636,7 +669,7 @@ Res* evaluateFunction3( Node *appRes, int applyAll, Node *node, Env *env, ruleEx
             res = ( Res * ) FD_SMSI_FUNC_PTR( fd )( argsProcessed, n, node, rei, reiSaveFlag,  env, errmsg, newRegion );
             break;
         case N_FD_EXTERNAL:
-            res = execAction3( fn, argsProcessed, n, applyAll, node, nEnv, rei, reiSaveFlag, errmsg, newRegion );
+            res = execResolvedAction3( fn, target, argsProcessed, n, applyAll, node, nEnv, rei, reiSaveFlag, errmsg, newRegion );
             break;
         case N_FD_RULE_INDEX_LIST:
             res = execAction3( fn, argsProcessed, n, applyAll, node, nEnv, rei, reiSaveFlag, errmsg, newRegion );
@@ -648,7 +681,7 @@ Res* evaluateFunction3( Node *appRes, int applyAll, Node *node, Env *env, ruleEx
         }
     }
     else {
-        res = execAction3( fn, argsProcessed, n, applyAll, node, nEnv, rei, reiSaveFlag, errmsg, newRegion );
+        res = execResolvedAction3( fn, target, argsProcessed, n, applyAll, node, nEnv, rei, reiSaveFlag, errmsg, newRegion );
     }
 
     if ( GlobalREAuditFlag > 0 ) {
@@ -834,21 +867,12 @@ Res* execAction3( char *actionName, Res** args, unsigned int nargs, int applyAll
  * execute micro service msiName
  */
 Res* execMicroService3( char *msName, Res **args, unsigned int nargs, Node *node, Env *env, ruleExecInfo_t *rei, rError_t *errmsg, Region *r ) {
-    msParamArray_t *origMsParamArray = rei->msParamArray;
-    funcPtr myFunc = NULL;
-    int actionInx;
-    unsigned int numOfStrArgs;
-    unsigned int i;
-    int ii = 0;
-    msParam_t *myArgv[MAX_PARAMS_LEN];
-    Res *res;
-
     /* look up the micro service */
     irods::ms_table_entry ms_entry;
-    actionInx = actionTableLookUp( ms_entry, msName );
+    int actionInx = actionTableLookUp( ms_entry, msName );
 
-    char errbuf[ERR_MSG_LEN];
     if ( actionInx < 0 ) {
+        char errbuf[ERR_MSG_LEN];
         int ret = NO_MICROSERVICE_FOUND_ERR;
         generateErrMsg( "execMicroService3: no micro service found", NODE_EXPR_POS( node ), node->base, errbuf );
         addRErrorMsg( errmsg, ret, errbuf );
@@ -856,8 +880,24 @@ Res* execMicroService3( char *msName, Res **args, unsigned int nargs, Node *node
 
     }
 
-    myFunc       = ms_entry.call_action_;
-    numOfStrArgs = ms_entry.num_args_;
+    return execMicroServiceEntry3( msName, &ms_entry, args, nargs, node, env, rei, errmsg, r );
+}
+
+/**
+ * execute micro service msName from its table entry
+ */
+Res* execMicroServiceEntry3( char *msName, irods::ms_table_entry *ms_entry, Res **args, unsigned int nargs, Node *node, Env *env, ruleExecInfo_t *rei, rError_t *errmsg, Region *r ) {
+    msParamArray_t *origMsParamArray = rei->msParamArray;
+    funcPtr myFunc = NULL;
+    unsigned int numOfStrArgs;
+    unsigned int i;
+    int ii = 0;
+    msParam_t *myArgv[MAX_PARAMS_LEN];
+    Res *res;
+
+    char errbuf[ERR_MSG_LEN];
+    myFunc       = ms_entry->call_action_;
+    numOfStrArgs = ms_entry->num_args_;
     if ( nargs != numOfStrArgs ) {
         int ret = ACTION_ARG_COUNT_MISMATCH;
         generateErrMsg( "execMicroService3: wrong number of arguments", NODE_EXPR_POS( node ), node->base, errbuf );
@@ -1328,7 +1368,14 @@ Res* execRuleNodeRes( Node *rule, Res** args, unsigned int argc, int applyAll, E
     Res *res = evaluateExpression3( ruleCondition, 0, 0, rei, reiSaveFlag,  envNew, errmsg, rNew );
     /* todo consolidate every error into T_ERROR except OOM */
     if ( getNodeType( res ) != N_ERROR && TYPE( res ) == T_BOOL && RES_BOOL_VAL( res ) != 0 ) {
-        if ( getNodeType( ruleAction ) == N_ACTIONS ) {
+        FlatRule *prog = NULL;
+        if ( getNodeType( ruleAction ) == N_ACTIONS && useFlatRules() ) {
+            prog = getFlatRule( rule );
+        }
+        if ( prog != NULL ) {
+            statusRes = execFlatRule( prog, applyAll, rei, reiSaveFlag, envNew, errmsg, rNew );
+        }
+        else if ( getNodeType( ruleAction ) == N_ACTIONS ) {
             statusRes = evaluateActions( ruleAction, ruleRecovery, applyAll, rei, reiSaveFlag,  envNew, errmsg, rNew );
         }
         else {
@@ -74,83 +74,62 @@ Cache *copyCache( unsigned char **p, size_t size, Cache *ptr ) {
 }
 
 /*
- * Restore a Cache struct from buf into a malloc'd buffer.
+ * Restore the Cache struct published in buf.
+ * buf holds a copy of the Cache struct of the current snapshot, the snapshot itself is in a separate shared memory.
+ * The snapshot is relocated to SHM_BASE_ADDR when it is written. If it can be mapped at that address, it is used in place
+ * without copying or applying the pointer table. Otherwise it is copied into a malloc'd buffer and the pointers are offset.
+ * A snapshot is never modified once published, a new version is written to a new shared memory.
  * This function returns NULL if failed to acquire or release the mutex.
- * It first create a local copy of buf's data section and pointer pointers section. This part needs synchronization.
- * Then it works on its local copy, which does not need synchronization.
  */
 Cache *restoreCache( unsigned char *buf ) {
     mutex_type *mutex;
-    Cache *cache = ( Cache * ) buf;
-    unsigned char *bufCopy;
-    unsigned char *pointers;
-    size_t pointersSize;
-    unsigned char *bufMapped;
-
-    unsigned char *pointersCopy;
-    unsigned char *pointersMapped;
-    size_t dataSize;
-    unsigned int version, version2;
+    Cache header;
+    unsigned char *snapshot;
     while ( true ) {
         if ( lockMutex( &mutex ) != 0 ) {
             return NULL;
         }
-        version = cache->version;
+        memcpy( &header, buf, sizeof( Cache ) );
         unlockMutex( &mutex );
-        dataSize = cache->dataSize;
-        pointersMapped = cache->pointers;
-        bufMapped = cache->address;
-        if ( pointersMapped < bufMapped || pointersMapped - bufMapped > SHMMAX || dataSize > SHMMAX ) {
+        if ( header.address == NULL || header.pointers < header.address || header.pointers - header.address > SHMMAX || header.dataSize > SHMMAX ) {
             sleep( 1 );
             continue;
         }
-        bufCopy = ( unsigned char * )malloc( dataSize );
-        if ( bufCopy == NULL ) {
-            return NULL;
-        }
-        memcpy( bufCopy, buf, cache->dataSize );
-        pointersSize = bufMapped + SHMMAX - pointersMapped;
-        pointersCopy = ( unsigned char * )malloc( pointersSize );
-        if ( pointersCopy == NULL ) {
-            free( bufCopy );
-            return NULL;
-        }
-        memcpy( pointersCopy, pointersMapped + ( buf - bufMapped ), pointersSize );
-        if ( lockMutex( &mutex ) != 0 ) {
-            free( pointersCopy );
-            free( bufCopy );
-            return NULL;
+        /* use the snapshot in place */
+        snapshot = mapSharedMemorySnapshot( header.version, header.address );
+        if ( snapshot != NULL ) {
+            return ( Cache * ) snapshot;
         }
-        version2 = cache->version;
-        unlockMutex( &mutex );
-        if ( version2 != version ) {
-            free( bufCopy );
-            free( pointersCopy );
+        snapshot = mapSharedMemorySnapshot( header.version, NULL );
+        if ( snapshot == NULL ) {
+            /* a newer version has been published since the header was read */
             sleep( 1 );
             continue;
         }
-        else {
-            break;
-        }
+        break;
     }
-    pointers = pointersCopy;
-    /*    bufCopy = (unsigned char *)malloc(cache->dataSize);
-
-        if(bufCopy == NULL) {
-            return NULL;
-        }
-        memcpy(bufCopy, buf, cache->dataSize);
 
-        bufMapped = cache->address;
+    unsigned char *bufCopy = ( unsigned char * )malloc( header.dataSize );
+    if ( bufCopy == NULL ) {
+        unmapSharedMemorySnapshot( snapshot );
+        return NULL;
+    }
+    memcpy( bufCopy, snapshot, header.dataSize );
+    size_t pointersSize = header.address + SHMMAX - header.pointers;
+    unsigned char *pointersCopy = ( unsigned char * )malloc( pointersSize );
+    if ( pointersCopy == NULL ) {
+        unmapSharedMemorySnapshot( snapshot );
+        free( bufCopy );
+        return NULL;
+    }
+    memcpy( pointersCopy, snapshot + ( header.pointers - header.address ), pointersSize );
+    unmapSharedMemorySnapshot( snapshot );
 
-        long diffBuf = buf - bufMapped;
-        pointers = cache->pointers + diffBuf;
-        pointersSize = pointers - buf; */
-    long diff = bufCopy - bufMapped;
+    long diff = bufCopy - header.address;
     long pointerDiff = diff;
-    applyDiff( pointers, pointersSize, diff, pointerDiff );
+    applyDiff( pointersCopy, pointersSize, diff, pointerDiff );
     free( pointersCopy );
-    cache = ( Cache * ) bufCopy;
+    Cache *cache = ( Cache * ) bufCopy;
 
 #ifdef RE_CACHE_CHECK
     Hashtable *objectMap = newHashTable( 100 );
@@ -159,6 +138,14 @@ Cache *restoreCache( unsigned char *buf ) {
 #endif
     return cache;
 }
+
+/* Free a Cache struct returned by restoreCache */
+void freeCache( Cache *cache ) {
+    if ( unmapSharedMemorySnapshot( cache->address ) != 0 ) {
+        free( cache->address );
+    }
+}
+
 void applyDiff( unsigned char *pointers, long pointersSize, long diff, long pointerDiff ) {
     unsigned char *p;
 #ifdef DEBUG_VERBOSE
@@ -227,7 +214,7 @@ int updateCache( unsigned char *shared, size_t size, Cache *cache, int processTy
                 printf( "Buffer usage: %fM\n", ( ( double )( cacheCopy->dataSize ) ) / ( 1024 * 1024 ) );
 #endif
                 size_t pointersSize = ( cacheCopy->address + cacheCopy->cacheSize ) - cacheCopy->pointers;
-                long diff = shared - cacheCopy->address;
+                long diff = ( unsigned char * ) SHM_BASE_ADDR - cacheCopy->address;
                 unsigned char *pointers = cacheCopy->pointers;
 
                 applyDiff( pointers, pointersSize, diff, 0 );
@@ -238,8 +225,11 @@ int updateCache( unsigned char *shared, size_t size, Cache *cache, int processTy
                     free( buf );
                     return -1;
                 }
+                ret = 0;
                 if ( processType == RULE_ENGINE_INIT_CACHE || processType == RULE_ENGINE_REFRESH_CACHE || !time_type_gt( ( ( Cache * )shared )->updateTS, timestamp ) ) {
 
+                    unsigned int oldVersion = ( ( Cache * )shared )->version;
+                    int published = processType != RULE_ENGINE_INIT_CACHE && ( ( Cache * )shared )->address != NULL;
                     switch ( processType ) {
                     case RULE_ENGINE_INIT_CACHE:
                         cacheCopy->version = 0;
@@ -248,13 +238,20 @@ int updateCache( unsigned char *shared, size_t size, Cache *cache, int processTy
                         cacheCopy->version = ( ( Cache * )shared )->version;
                         INC_MOD( cacheCopy->version, UINT_MAX );
                     }
-                    /* copy data */
-                    memcpy( shared, buf, cacheCopy->dataSize );
-                    /* copy pointers */
-                    memcpy( cacheCopy->pointers, pointers, pointersSize );
+                    /* write the snapshot, then publish it */
+                    if ( writeSharedMemorySnapshot( cacheCopy->version, buf, cacheCopy->dataSize, pointers, pointersSize ) == 0 ) {
+                        memcpy( shared, buf, sizeof( Cache ) );
+                        /* agents using the previous snapshot keep it mapped */
+                        if ( published ) {
+                            removeSharedMemorySnapshot( oldVersion );
+                        }
+                    }
+                    else {
+                        rodsLog( LOG_ERROR, "Failed to write cache snapshot." );
+                        ret = -1;
+                    }
                 }
                 unlockMutex( &mutex );
-                ret = 0;
             }
             else {
                 rodsLog( LOG_ERROR, "Error updating cache." );
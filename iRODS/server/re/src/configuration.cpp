@@ -11,6 +11,7 @@
 #include "functions.hpp"
 #include "filesystem.hpp"
 #include "sharedmemory.hpp"
+#include "flatRules.hpp"
 #include "icatHighLevelRoutines.hpp"
 #include "rcMisc.h"
 #include "modAVUMetadata.h"
@@ -65,6 +66,12 @@ Cache ruleEngineConfig = {
     "", /* char ruleBase[RULE_SET_DEF_LENGTH] */
 };
 
+/* drop everything derived from the rule index, called whenever a rule or a function descriptor is added or removed */
+static void clearDerivedIndices() {
+    invalidateFlatRules();
+    clearPepIndex();
+}
+
 void removeRuleFromExtIndex( char *ruleName, int i ) {
     if ( isComponentInitialized( ruleEngineConfig.extFuncDescIndexStatus ) ) {
         FunctionDesc *fd = ( FunctionDesc * )lookupFromHashTable( ruleEngineConfig.extFuncDescIndex->current, ruleName );
@@ -79,6 +86,7 @@ void removeRuleFromExtIndex( char *ruleName, int i ) {
 
 }
 void appendRuleIntoExtIndex( RuleDesc *rule, int i, Region *r ) {
+    clearDerivedIndices();
     FunctionDesc *fd = ( FunctionDesc * )lookupFromHashTable( ruleEngineConfig.extFuncDescIndex->current, RULE_NAME( rule->node ) );
     RuleIndexList *rd;
     if ( fd == NULL ) {
@@ -116,6 +124,7 @@ void prependRuleIntoAppIndex( RuleDesc *rule, int i, Region *r ) {
     }
 }
 int checkPointExtRuleSet( Region *r ) {
+    clearDerivedIndices();
     ruleEngineConfig.extFuncDescIndex = newEnv( newHashTable2( 100, r ), ruleEngineConfig.extFuncDescIndex, NULL, r );
     return ruleEngineConfig.extRuleSet->len;
 }
@@ -125,11 +134,13 @@ int checkPointExtRuleSet( Region *r ) {
 	appendRuleIntoIndex(rd, i, r);
 }*/
 void prependAppRule( RuleDesc *rd, Region *r ) {
+    clearDerivedIndices();
     int i = ruleEngineConfig.appRuleSet->len++;
     ruleEngineConfig.appRuleSet->rules[i] = rd;
     prependRuleIntoAppIndex( rd, i, r );
 }
 void popExtRuleSet( int checkPoint ) {
+    clearDerivedIndices();
     /*int i;
     for(i = checkPoint; i < ruleEngineConfig.extRuleSet->len; i++) {
     	removeRuleFromExtIndex(RULE_NAME(ruleEngineConfig.extRuleSet->rules[i]->node), i);
@@ -155,6 +166,7 @@ void setRuleEngineMemStatus(RuleEngineStatus s) {
 	_ruleEngineMemStatus = s;
 } */
 int clearResources( int resources ) {
+    clearDerivedIndices();
     clearFuncDescIndex( APP, app );
     clearFuncDescIndex( SYS, sys );
     clearFuncDescIndex( CORE, core );
@@ -180,6 +192,7 @@ List regionsToClear = {0, NULL, NULL};
 List memoryToFree = {0, NULL, NULL};
 
 void delayClearResources( int resources ) {
+    clearDerivedIndices();
     /*if((resources & RESC_RULE_INDEX) && ruleEngineConfig.ruleIndexStatus == INITIALIZED) {
     	listAppendNoRegion(hashtablesToClear, ruleEngineConfig.ruleIndex);
     	ruleEngineConfig.ruleIndexStatus = UNINITIALIZED;
@@ -341,6 +354,9 @@ int loadRuleFromCacheOrFile( int processType, char *irbSet, ruleStruct_t *inRule
     }
     snprintf( r2, sizeof( r2 ), "%s", irbSet );
 
+    /* flattened rules and the pep index refer to the rule set being replaced */
+    clearDerivedIndices();
+
 #ifdef CACHE_ENABLE
 
     int update = 0;
@@ -363,7 +379,7 @@ int loadRuleFromCacheOrFile( int processType, char *irbSet, ruleStruct_t *inRule
 
                 if ( diffIrbSet || time_type_gt( timestamp, cache->timestamp ) ) {
                     update = 1;
-                    free( cache->address );
+                    freeCache( cache );
                     rodsLog( LOG_DEBUG, "Rule base set or rule files modified, force refresh." );
                 }
                 else {
@@ -0,0 +1,237 @@
+/* For copyright information please refer to files in the COPYRIGHT directory
+ */
+#include "reFuncDefs.hpp"
+#include "restructs.hpp"
+#include "arithmetics.hpp"
+#include "index.hpp"
+#include "rules.hpp"
+#include "configuration.hpp"
+#include "flatRules.hpp"
+#include "irods_server_properties.hpp"
+#include "irods_configuration_keywords.hpp"
+
+#include <map>
+#include <vector>
+
+/* flattened rules of the current generation, by rule node */
+static std::map<Node *, FlatRule *> flatRuleIndex;
+static Region *flatRuleRegion = NULL;
+/* regions of invalidated flattened rules which may still be running */
+static std::vector<Region *> retiredRegions;
+static unsigned int flatRuleGeneration = 0;
+static int flatRuleDepth = 0;
+static int flatRulesEnabled = -1;
+
+int useFlatRules() {
+    if ( flatRulesEnabled < 0 ) {
+        int flatten = 0;
+        irods::error ret = irods::get_advanced_setting<int>(
+                               irods::CFG_RE_FLATTEN_RULES,
+                               flatten );
+        flatRulesEnabled = ret.ok() && flatten != 0 ? 1 : 0;
+        if ( flatRulesEnabled ) {
+            rodsLog( LOG_DEBUG, "useFlatRules: rule bodies are flattened before execution" );
+        }
+    }
+    return flatRulesEnabled;
+}
+
+static void freeRetiredRegions() {
+    if ( flatRuleDepth > 0 ) {
+        return;
+    }
+    for ( size_t i = 0; i < retiredRegions.size(); i++ ) {
+        region_free( retiredRegions[i] );
+    }
+    retiredRegions.clear();
+}
+
+/*
+ * drop all flattened rules, called whenever a rule or a function descriptor is added or removed
+ * rules which are running fall back to the tree walker for the rest of their actions
+ */
+void invalidateFlatRules() {
+    flatRuleIndex.clear();
+    if ( flatRuleRegion != NULL ) {
+        retiredRegions.push_back( flatRuleRegion );
+        flatRuleRegion = NULL;
+    }
+    flatRuleGeneration++;
+    freeRetiredRegions();
+}
+
+static FlatAction *flattenActions( Node *actions, int allowCut, Region *r ) {
+    int n = actions->degree;
+    FlatAction *code = ( FlatAction * ) region_alloc( r, sizeof( FlatAction ) * ( n > 0 ? n : 1 ) );
+    memset( code, 0, sizeof( FlatAction ) * ( n > 0 ? n : 1 ) );
+    int i;
+    for ( i = 0; i < n; i++ ) {
+        Node *nodei = actions->subtrees[i];
+        code[i].node = nodei;
+        code[i].op = FA_EVAL;
+        code[i].target.type = CALL_UNRESOLVED;
+        if ( getNodeType( nodei ) != N_APPLICATION || getNodeType( N_APP_FUNC( nodei ) ) != TK_TEXT ) {
+            continue;
+        }
+        if ( allowCut && strcmp( N_APP_FUNC( nodei )->text, "cut" ) == 0 ) {
+            code[i].op = FA_CUT;
+        }
+        else if ( getIOType( nodei ) == IO_TYPE_INPUT && getIOType( N_APP_FUNC( nodei ) ) == IO_TYPE_INPUT &&
+                  getNodeType( nodei->subtrees[1] ) == N_TUPLE ) {
+            code[i].op = FA_CALL;
+        }
+    }
+    return code;
+}
+
+/*
+ * flatten the action and recovery lists of a rule
+ * returns NULL if the rule body is not an action list
+ */
+static FlatRule *flattenRule( Node *rule, Region *r ) {
+    Node *ruleAction = rule->subtrees[2];
+    Node *ruleRecovery = rule->subtrees[3];
+    if ( getNodeType( ruleAction ) != N_ACTIONS ) {
+        return NULL;
+    }
+    FlatRule *prog = ( FlatRule * ) region_alloc( r, sizeof( FlatRule ) );
+    prog->rule = rule;
+    prog->generation = flatRuleGeneration;
+    prog->actionsLen = ruleAction->degree;
+    prog->actions = flattenActions( ruleAction, 1, r );
+    if ( ruleRecovery != NULL ) {
+        prog->recoveryLen = ruleRecovery->degree;
+        prog->recovery = flattenActions( ruleRecovery, 0, r );
+    }
+    else {
+        prog->recoveryLen = 0;
+        prog->recovery = NULL;
+    }
+    return prog;
+}
+
+FlatRule *getFlatRule( Node *rule ) {
+    std::map<Node *, FlatRule *>::iterator it = flatRuleIndex.find( rule );
+    if ( it != flatRuleIndex.end() ) {
+        return it->second;
+    }
+    if ( flatRuleRegion == NULL ) {
+        flatRuleRegion = make_region( 0, NULL );
+    }
+    FlatRule *prog = flattenRule( rule, flatRuleRegion );
+    flatRuleIndex[rule] = prog;
+    return prog;
+}
+
+/*
+ * resolve the function called by a FA_CALL action the way evaluateFunction3 and execAction3 would
+ */
+static void resolveCallTarget( FlatAction *instr ) {
+    CallTarget *target = &instr->target;
+    char *fn = N_APP_FUNC( instr->node )->text;
+    FunctionDesc *fd = ( FunctionDesc * )lookupFromEnv( ruleEngineConfig.extFuncDescIndex, fn );
+
+    /* the tree walker applies a function symbol to the argument tuple only if it takes one argument */
+    if ( fd != NULL && fd->exprType != NULL ) {
+        int nArgs = 0;
+        ExprType *type = fd->exprType;
+        while ( getNodeType( type ) == T_CONS && strcmp( type->text, FUNC ) == 0 ) {
+            type = type->subtrees[1];
+            nArgs ++;
+        }
+        if ( nArgs != 1 ) {
+            target->type = CALL_TREE_WALK;
+            return;
+        }
+    }
+
+    target->type = CALL_FUNCTION;
+    target->fd = fd;
+    if ( ( fd != NULL && getNodeType( fd ) != N_FD_EXTERNAL ) || strlen( fn ) >= sizeof( target->action ) ) {
+        return;
+    }
+
+    /* execAction3 only calls the microservice if there is no rule by the same name */
+    snprintf( target->action, sizeof( target->action ), "%s", fn );
+    mapExternalFuncToInternalProc2( target->action );
+    RuleIndexListNode *ruleIndexListNode;
+    if ( findNextRule2( target->action, 0, &ruleIndexListNode ) == 0 ||
+            findNextRuleFromIndex( ruleEngineConfig.coreFuncDescIndex, target->action, 0, &ruleIndexListNode ) == 0 ) {
+        return;
+    }
+    irods::ms_table_entry ms_entry;
+    if ( actionTableLookUp( ms_entry, target->action ) < 0 ) {
+        return;
+    }
+    target->msEntry = MicrosTable[target->action];
+    target->type = CALL_MICROSERVICE;
+}
+
+static Res *execInstr( FlatRule *prog, FlatAction *instr, int applyAll, ruleExecInfo_t *rei, int reiSaveFlag, Env *env, rError_t *errmsg, Region *r ) {
+    Node *node = instr->node;
+    /* rules or function descriptors may have changed since the rule was flattened */
+    if ( instr->op != FA_CALL || prog->generation != flatRuleGeneration ) {
+        return evaluateExpression3( node, applyAll, 0, rei, reiSaveFlag, env, errmsg, r );
+    }
+    if ( instr->target.type == CALL_UNRESOLVED ) {
+        resolveCallTarget( instr );
+    }
+    if ( instr->target.type == CALL_TREE_WALK ) {
+        return evaluateExpression3( node, applyAll, 0, rei, reiSaveFlag, env, errmsg, r );
+    }
+
+    /* same as evaluateExpression3 on N_APPLICATION, without looking up the function symbol */
+    Res *argRes = evaluateExpression3( node->subtrees[1], applyAll > 1 ? applyAll : 0, 0, rei, reiSaveFlag, env, errmsg, r );
+    if ( getNodeType( argRes ) == N_ERROR ) {
+        return argRes;
+    }
+    Node *appRes = newPartialApplication( newFuncSymLink( N_APP_FUNC( node )->text, 1, r ), argRes, 0, r );
+    return evaluateResolvedFunction3( appRes, applyAll, node, env, rei, reiSaveFlag, errmsg, r, &instr->target );
+}
+
+/*
+ * execute a flattened rule body
+ * this follows evaluateActions, including the recovery chain
+ */
+Res *execFlatRule( FlatRule *prog, int applyAll, ruleExecInfo_t *rei, int reiSaveFlag, Env *env, rError_t *errmsg, Region *r ) {
+    int i;
+    int cutFlag = 0;
+    Res* res = NULL;
+    flatRuleDepth++;
+    for ( i = 0; i < prog->actionsLen; i++ ) {
+        FlatAction *instr = &prog->actions[i];
+        if ( instr->op == FA_CUT ) {
+            cutFlag = 1;
+            continue;
+        }
+        res = execInstr( prog, instr, applyAll, rei, reiSaveFlag, env, errmsg, r );
+        if ( getNodeType( res ) == N_ERROR ) {
+            logRuleActionError( instr->node, 0, RES_ERR_CODE( res ) );
+            /* run recovery chain */
+            if ( RES_ERR_CODE( res ) != RETRY_WITHOUT_RECOVERY_ERR && prog->recovery != NULL ) {
+                int i2;
+                for ( i2 = prog->recoveryLen - 1 < i ? prog->recoveryLen - 1 : i; i2 >= 0; i2-- ) {
+                    logRuleRollingBack( rei );
+                    FlatAction *reco = &prog->recovery[i2];
+                    Res *res2 = execInstr( prog, reco, 0, rei, reiSaveFlag, env, errmsg, r );
+                    if ( getNodeType( res2 ) == N_ERROR ) {
+                        logRuleActionError( reco->node, 1, RES_ERR_CODE( res2 ) );
+                    }
+                }
+            }
+            if ( cutFlag ) {
+                res = newErrorRes( r, CUT_ACTION_PROCESSED_ERR );
+            }
+            break;
+        }
+        else if ( TYPE( res ) == T_BREAK ) {
+            break;
+        }
+        else if ( TYPE( res ) == T_SUCCESS ) {
+            break;
+        }
+    }
+    flatRuleDepth--;
+    freeRetiredRegions();
+    return res == NULL ? newIntRes( r, 0 ) : res;
+}
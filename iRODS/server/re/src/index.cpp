@@ -12,6 +12,12 @@ Hashtable *coreRuleFuncMapDefIndex = NULL;
 Hashtable *appRuleFuncMapDefIndex = NULL;
 Hashtable *microsTableIndex = NULL;
 
+/* rule name -> PEP_EMPTY_RULES or PEP_HAS_RULES, built from the rule index when first needed */
+static Hashtable *pepIndex = NULL;
+static Region *pepIndexRegion = NULL;
+static rodsLong_t pepFired = 0;
+static rodsLong_t pepSkipped = 0;
+
 void clearIndex( Hashtable **ruleIndex ) {
     if ( *ruleIndex != NULL ) {
         deleteHashTable( *ruleIndex, free_const );
@@ -220,6 +226,9 @@ void prependRuleNodeToRuleIndexList( RuleIndexList *list, int i, Region *r ) {
  * returns 0 if out of memory
  */
 int createRuleNodeIndex( RuleSet *inRuleSet, Hashtable *ruleIndex, int offset, Region *r ) {
+    /* the pep index is rebuilt from the new rule index */
+    clearPepIndex();
+
     /* generate main index */
     int i;
     for ( i = 0; i < inRuleSet->len; i++ ) {
@@ -406,3 +415,96 @@ CondIndexVal *newCondIndexVal( Node *condExp, Node *params, Hashtable *groupHash
     civ->valIndex = groupHashtable;
     return civ;
 }
+
+void clearPepIndex() {
+    if ( pepIndexRegion != NULL ) {
+        region_free( pepIndexRegion );
+    }
+    pepIndexRegion = NULL;
+    pepIndex = NULL;
+}
+
+/* a rule which always succeeds without doing anything: no parameters, no condition and no actions */
+static int isEmptyRule( RuleDesc *rd ) {
+    Node *rule = rd->node;
+    Node *ruleCondition = rule->subtrees[1];
+    Node *ruleAction = rule->subtrees[2];
+    return RULE_NODE_NUM_PARAMS( rule ) == 0 &&
+           getNodeType( ruleCondition ) == TK_BOOL && strcmp( ruleCondition->text, "true" ) == 0 &&
+           getNodeType( ruleAction ) == N_ACTIONS && ruleAction->degree == 0;
+}
+
+static int getPepState( char *ruleName ) {
+    FunctionDesc *fd = ( FunctionDesc * )lookupFromEnv( ruleEngineConfig.extFuncDescIndex, ruleName );
+    if ( fd == NULL || getNodeType( fd ) != N_FD_RULE_INDEX_LIST ) {
+        return PEP_HAS_RULES;
+    }
+    RuleIndexListNode *node;
+    int i;
+    for ( i = 0; findNextRule2( ruleName, i, &node ) == 0; i++ ) {
+        if ( node->secondaryIndex || !isEmptyRule( getRuleDesc( node->ruleIndex ) ) ) {
+            return PEP_HAS_RULES;
+        }
+    }
+    return PEP_EMPTY_RULES;
+}
+
+static void addRuleSetToPepIndex( RuleSet *ruleSet ) {
+    int i;
+    for ( i = 0; i < ruleSet->len; i++ ) {
+        RuleDesc *rd = ruleSet->rules[i];
+        if ( rd->node == NULL || ( rd->ruleType != RK_REL && rd->ruleType != RK_FUNC ) ) {
+            continue;
+        }
+        char *ruleName = RULE_NAME( rd->node );
+        if ( lookupFromHashTable( pepIndex, ruleName ) != NULL ) {
+            continue;
+        }
+        int *state = ( int * ) region_alloc( pepIndexRegion, sizeof( int ) );
+        *state = getPepState( ruleName );
+        insertIntoHashTable( pepIndex, ruleName, state );
+    }
+}
+
+static void createPepIndex() {
+    pepIndexRegion = make_region( 0, NULL );
+    pepIndex = newHashTable2( 1000, pepIndexRegion );
+    if ( isComponentInitialized( ruleEngineConfig.coreRuleSetStatus ) ) {
+        addRuleSetToPepIndex( ruleEngineConfig.coreRuleSet );
+    }
+    if ( isComponentInitialized( ruleEngineConfig.appRuleSetStatus ) ) {
+        addRuleSetToPepIndex( ruleEngineConfig.appRuleSet );
+    }
+    if ( isComponentInitialized( ruleEngineConfig.extRuleSetStatus ) ) {
+        addRuleSetToPepIndex( ruleEngineConfig.extRuleSet );
+    }
+}
+
+/*
+ * look up whether a policy enforcement point has rules
+ * returns PEP_NO_RULE, PEP_EMPTY_RULES if every rule by that name has an empty body, or PEP_HAS_RULES
+ */
+int lookupPepIndex( const char *ruleName ) {
+    if ( !isComponentInitialized( ruleEngineConfig.extFuncDescIndexStatus ) ) {
+        return PEP_NO_RULE;
+    }
+    if ( pepIndex == NULL ) {
+        createPepIndex();
+    }
+    int *state = ( int * )lookupFromHashTable( pepIndex, ruleName );
+    return state == NULL ? PEP_NO_RULE : *state;
+}
+
+void recordPep( int fired ) {
+    if ( fired ) {
+        pepFired++;
+    }
+    else {
+        pepSkipped++;
+    }
+}
+
+void getPepCounts( rodsLong_t *fired, rodsLong_t *skipped ) {
+    *fired = pepFired;
+    *skipped = pepSkipped;
+}
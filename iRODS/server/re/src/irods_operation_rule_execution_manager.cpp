@@ -17,6 +17,8 @@ namespace irods {
             _instance,
             _op_name ) {
         rule_name_ = "pep_" + op_name_;
+        pre_name_  = rule_name_ + "_pre";
+        post_name_ = rule_name_ + "_post";
 
     } // ctor
 
@@ -26,13 +28,9 @@ namespace irods {
         rsComm_t*     _comm,
         keyValPair_t& _kvp,
         std::string&  _res ) {
-        // =-=-=-=-=-=-=-
-        // manufacture pre rule name
-        std::string pre_name = rule_name_ + "_pre";
-
         // =-=-=-=-=-=-=-
         // execute the rule
-        return exec_op( _comm, _kvp, pre_name, _res );
+        return exec_op( _comm, _kvp, pre_name_, _res );
 
     } // exec_pre_op
 
@@ -42,16 +40,28 @@ namespace irods {
         rsComm_t*     _comm,
         keyValPair_t& _kvp,
         std::string&  _res ) {
-        // =-=-=-=-=-=-=-
-        // manufacture pre rule name
-        std::string post_name = rule_name_ + "_post";
-
         // =-=-=-=-=-=-=-
         // execute the rule
-        return exec_op( _comm, _kvp, post_name, _res );
+        return exec_op( _comm, _kvp, post_name_, _res );
 
     } // exec_post_op
 
+// =-=-=-=-=-=-=-
+// public - determine if either rule exists
+    bool operation_rule_execution_manager::has_rules() {
+        if ( lookupPepIndex( pre_name_.c_str() ) != PEP_NO_RULE ||
+                lookupPepIndex( post_name_.c_str() ) != PEP_NO_RULE ) {
+            return true;
+        }
+
+        // =-=-=-=-=-=-=-
+        // the pre and post operation rules are both skipped
+        recordPep( 0 );
+        recordPep( 0 );
+        return false;
+
+    } // has_rules
+
 // =-=-=-=-=-=-=-
 // private - execute rule for pre operation
     error operation_rule_execution_manager::exec_op(
@@ -61,10 +71,11 @@ namespace irods {
         std::string&       _res ) {
         // =-=-=-=-=-=-=-
         // determine if rule exists
-        RuleIndexListNode* re_node = 0;
-        if ( findNextRule2( const_cast<char*>( _name.c_str() ), 0, &re_node ) < 0 ) {
+        if ( lookupPepIndex( _name.c_str() ) == PEP_NO_RULE ) {
+            recordPep( 0 );
             return ERROR( SYS_RULE_NOT_FOUND, "no rule found" );
         }
+        recordPep( 1 );
 
         // =-=-=-=-=-=-=-
         // debug message for creating dynPEP rules
@@ -142,6 +142,21 @@ applyRuleUpdateParams( char *inAction, msParamArray_t *inMsParamArray, ruleExecI
 
 }
 
+/* returns the pep index state of an action which is a bare rule name, -1 for any other action */
+static int
+getActionPepState( char *inAction ) {
+    if ( GlobalREAuditFlag > 0 || reTestFlag > 0 || ruleEngineConfig.clearDelayed ) {
+        return -1;
+    }
+    char *p;
+    for ( p = inAction; *p != '\0'; p++ ) {
+        if ( !isalnum( ( unsigned char ) *p ) && *p != '_' ) {
+            return -1;
+        }
+    }
+    return p == inAction ? -1 : lookupPepIndex( inAction );
+}
+
 int
 applyRuleBase( char *inAction, msParamArray_t *inMsParamArray, int updateInMsParam, ruleExecInfo_t *rei, int reiSaveFlag ) {
 #if defined(DEBUG) || defined(RE_LOG_RULES_TMP)
@@ -149,6 +164,19 @@ applyRuleBase( char *inAction, msParamArray_t *inMsParamArray, int updateInMsPar
     writeToTmp( "entry.log", inAction );
     writeToTmp( "entry.log", "\n" );
 #endif
+    /* skip static policy enforcement points which do nothing, the result would be 0 anyway */
+    int pepState = getActionPepState( inAction );
+    if ( pepState == PEP_EMPTY_RULES ) {
+        if ( rei != NULL ) {
+            rei->status = 0;
+        }
+        recordPep( 0 );
+        return 0;
+    }
+    else if ( pepState == PEP_HAS_RULES ) {
+        recordPep( 1 );
+    }
+
     if ( GlobalREAuditFlag > 0 ) {
         RuleEngineEventParam param;
         param.actionName = inAction;
@@ -1566,6 +1594,9 @@ writeMSrvcsIntoFile( char * inFileName, msrvcStruct_t *myMsrvcStruct,
 
 int
 finalizeRuleEngine() {
+    rodsLong_t fired, skipped;
+    getPepCounts( &fired, &skipped );
+    rodsLog( LOG_DEBUG, "finalizeRuleEngine: %lld policy enforcement points fired, %lld skipped", fired, skipped );
     if ( GlobalREDebugFlag > 5 ) {
         _writeXMsg( GlobalREDebugFlag, "idbug", "PROCESS END" );
     }
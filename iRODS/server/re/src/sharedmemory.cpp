@@ -7,9 +7,15 @@
 #include "utils.hpp"
 #include "filesystem.hpp"
 #include "irods_server_properties.hpp"
+#include "configuration.hpp"
+
+#include <map>
+#include <sstream>
 
 static boost::interprocess::shared_memory_object *shm_obj = NULL;
 static boost::interprocess::mapped_region *mapped = NULL;
+/* snapshots mapped by this process, by address */
+static std::map<unsigned char *, boost::interprocess::mapped_region *> snapshots;
 
 unsigned char *prepareServerSharedMemory() {
     std::string shared_memory_name;
@@ -48,6 +54,19 @@ int removeSharedMemory() {
         return RE_SHM_UNLINK_ERROR;
     }
 
+    /* remove the snapshot published in the shared memory */
+    try {
+        boost::interprocess::shared_memory_object shm( boost::interprocess::open_only, shared_memory_name.c_str(), boost::interprocess::read_only );
+        boost::interprocess::mapped_region region( shm, boost::interprocess::read_only );
+        Cache *cache = ( Cache * ) region.get_address();
+        if ( region.get_size() >= sizeof( Cache ) && cache->address != NULL ) {
+            removeSharedMemorySnapshot( cache->version );
+        }
+    }
+    catch ( const boost::interprocess::interprocess_exception & ) {
+        /* nothing has been published */
+    }
+
     if ( !boost::interprocess::shared_memory_object::remove( shared_memory_name.c_str() ) ) {
         rodsLog( LOG_ERROR, "removeSharedMemory: failed to remove shared memory" );
         return RE_SHM_UNLINK_ERROR;
@@ -75,6 +94,96 @@ unsigned char *prepareNonServerSharedMemory() {
     }
 }
 
+/*
+ * Write a snapshot of the rule cache into its own shared memory.
+ * A snapshot is never modified once written, so that agents can use it in place.
+ * The data is stored from the start of the shared memory and the pointers at the end.
+ */
+int writeSharedMemorySnapshot( unsigned int version, unsigned char *data, size_t dataSize, unsigned char *pointers, size_t pointersSize ) {
+    std::string snapshot_name;
+    irods::error ret = getSharedMemorySnapshotName( version, snapshot_name );
+    if ( !ret.ok() || dataSize + pointersSize > SHMMAX ) {
+        return -1;
+    }
+
+    /* agents which still map a snapshot by the same name keep their copy */
+    boost::interprocess::shared_memory_object::remove( snapshot_name.c_str() );
+    try {
+        boost::interprocess::shared_memory_object shm( boost::interprocess::create_only, snapshot_name.c_str(), boost::interprocess::read_write, 0600 );
+        shm.truncate( SHMMAX );
+        boost::interprocess::mapped_region region( shm, boost::interprocess::read_write );
+        unsigned char *buf = ( unsigned char * ) region.get_address();
+        memcpy( buf, data, dataSize );
+        memcpy( buf + SHMMAX - pointersSize, pointers, pointersSize );
+    }
+    catch ( const boost::interprocess::interprocess_exception &e ) {
+        rodsLog( LOG_ERROR, "writeSharedMemorySnapshot: failed to write shared memory [%s]. Exception caught [%s]", snapshot_name.c_str(), e.what() );
+        boost::interprocess::shared_memory_object::remove( snapshot_name.c_str() );
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Map a snapshot of the rule cache.
+ * If address is not NULL, the snapshot is mapped copy on write at that address, so that it can be used
+ * in place, and NULL is returned if the address is not available. Otherwise it is mapped read only anywhere.
+ */
+unsigned char *mapSharedMemorySnapshot( unsigned int version, void *address ) {
+    std::string snapshot_name;
+    irods::error ret = getSharedMemorySnapshotName( version, snapshot_name );
+    if ( !ret.ok() ) {
+        return NULL;
+    }
+
+    try {
+        boost::interprocess::shared_memory_object shm( boost::interprocess::open_only, snapshot_name.c_str(), boost::interprocess::read_only );
+        boost::interprocess::mapped_region *region = new boost::interprocess::mapped_region(
+            shm,
+            address != NULL ? boost::interprocess::copy_on_write : boost::interprocess::read_only,
+            0, 0, address );
+        unsigned char *buf = ( unsigned char * ) region->get_address();
+        snapshots[buf] = region;
+        return buf;
+    }
+    catch ( const boost::interprocess::interprocess_exception &e ) {
+        rodsLog( LOG_DEBUG, "mapSharedMemorySnapshot: failed to map shared memory [%s] at %p. Exception caught [%s]", snapshot_name.c_str(), address, e.what() );
+        return NULL;
+    }
+}
+
+/* returns 0 if buf is a snapshot mapped by mapSharedMemorySnapshot */
+int unmapSharedMemorySnapshot( unsigned char *buf ) {
+    std::map<unsigned char *, boost::interprocess::mapped_region *>::iterator it = snapshots.find( buf );
+    if ( it == snapshots.end() ) {
+        return -1;
+    }
+    delete it->second;
+    snapshots.erase( it );
+    return 0;
+}
+
+void removeSharedMemorySnapshot( unsigned int version ) {
+    std::string snapshot_name;
+    irods::error ret = getSharedMemorySnapshotName( version, snapshot_name );
+    if ( ret.ok() ) {
+        boost::interprocess::shared_memory_object::remove( snapshot_name.c_str() );
+    }
+}
+
+irods::error getSharedMemorySnapshotName( unsigned int version, std::string &snapshot_name ) {
+    irods::error ret = getSharedMemoryName( snapshot_name );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    std::stringstream ss;
+    ss << snapshot_name << "_" << version;
+    snapshot_name = ss.str();
+
+    return SUCCESS();
+}
+
 irods::error getSharedMemoryName( std::string &shared_memory_name ) {
     std::string shared_memory_name_salt;
     irods::error ret = irods::server_properties::getInstance().get_property<std::string>( RE_CACHE_SALT_KW, shared_memory_name_salt );
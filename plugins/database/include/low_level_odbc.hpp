@@ -35,6 +35,7 @@ int cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql
 int cllExecSqlWithResultBV( icatSessionStruct *icss, int *stmtNum, const char *sql,
                             std::vector<std::string> &bindVars );
 int cllGetRow( icatSessionStruct *icss, int statementNumber );
+int cllSetRowArraySize( icatSessionStruct *icss, int statementNumber, int rows );
 int cllFreeStatement( icatSessionStruct *icss, int statementNumber );
 int cllNextValueString( const char *itemName, char *outString, int maxSize );
 extern "C" int cllTest( const char *userArg, const char *pwArg );
@@ -42,5 +43,6 @@ int cllCurrentValueString( const char *itemName, char *outString, int maxSize );
 int cllGetRowCount( icatSessionStruct *icss, int statementNumber );
 int cllCheckPending( const char *sql, int option, int dbType );
 int cllGetLastErrorMessage( char *msg, int maxChars );
+int cllGetStmtCacheStats( icatSessionStruct *icss, rodsLong_t *hits, rodsLong_t *misses );
 
 #endif	/* CLL_PSQ_H */
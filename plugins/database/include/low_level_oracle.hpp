@@ -28,6 +28,7 @@ int cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql
 int cllExecSqlWithResultBV( icatSessionStruct *icss, int *stmtNum, const char *sql,
                             std::vector<std::string> &bindVars );
 int cllGetRow( icatSessionStruct *icss, int statementNumber );
+int cllSetRowArraySize( icatSessionStruct *icss, int statementNumber, int rows );
 int cllFreeStatement( icatSessionStruct *icss, int statementNumber );
 int cllNextValueString( const char *itemName, char *outString, int maxSize );
 extern "C" int cllTest( const char *userArg, const char *pwArg );
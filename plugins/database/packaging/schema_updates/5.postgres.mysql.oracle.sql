@@ -0,0 +1 @@
+insert into R_GRID_CONFIGURATION values ( 'database', 'resource_generation', '0' );
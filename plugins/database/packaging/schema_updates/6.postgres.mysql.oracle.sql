@@ -0,0 +1 @@
+update R_RULE_EXEC set exe_time = lpad(exe_time, 11, '0') where length(exe_time) < 11;
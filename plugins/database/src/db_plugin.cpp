@@ -44,7 +44,11 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
 #include <boost/regex.hpp>
+#include <boost/lexical_cast.hpp>
 
 extern int get64RandomBytes( char *buf );
 extern int icatApplyRule( rsComm_t *rsComm, char *ruleName, char *arg1 );
@@ -77,6 +81,10 @@ static rodsLong_t MAX_PASSWORDS = 40;
 
 #define MAX_HOST_STR 2700
 
+/* rows inserted by each statement of a bulk registration, bounded by the
+   number of bind variables a statement may have */
+#define BULK_REG_ROWS_PER_STMT 100
+
 // =-=-=-=-=-=-=-
 // local variables externed for config file setting in
 bool irods_pam_auth_no_extend = false;
@@ -755,6 +763,82 @@ irods::error _get_resc_obj_count(
     return result;
 }
 
+/**
+ * @brief Replaces the resource generation recorded in R_GRID_CONFIGURATION
+ *        so agents know their snapshot of the resource table is stale.
+ *        Agents only compare the value for equality, so a unique token is
+ *        enough and no read-modify-write of the old value is needed.
+ */
+int
+_bumpRescGeneration() {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+
+    char generation[NAME_LEN];
+    snprintf( generation, sizeof( generation ), "%ld.%06ld.%d",
+              ( long )tv.tv_sec, ( long )tv.tv_usec, ( int )getpid() );
+
+    if ( logSQL != 0 ) {
+        rodsLog( LOG_SQL, "_bumpRescGeneration SQL 1" );
+    }
+    cllBindVars[cllBindVarCount++] = generation;
+    int status = cmlExecuteNoAnswerSql(
+                     "update R_GRID_CONFIGURATION set option_value = ? where namespace = 'database' and option_name = 'resource_generation'",
+                     &icss );
+
+    // a catalog without the row simply has no snapshots to invalidate
+    if ( status == CAT_SUCCESS_BUT_WITH_NO_INFO ) {
+        status = 0;
+    }
+    return status;
+
+} // _bumpRescGeneration
+
+/**
+ * @brief The bind variable values of one object of a bulk registration
+ */
+struct bulk_reg_row_t {
+    dataObjInfo_t* info;
+    std::string    data_id;
+    std::string    coll_id;
+    std::string    data_name;
+    std::string    repl_num;
+    std::string    data_size;
+    std::string    repl_status;
+    bool           inherit;
+};
+
+/**
+ * @brief Builds an insert of _rows rows into _table, for statements whose
+ *        bind variables hold the values of many rows at once.
+ *        _table is the table with its column list, _row the values of one
+ *        row, e.g. "(?, ?)".
+ */
+std::string
+_multiRowInsertSql(
+    const std::string& _table,
+    const std::string& _row,
+    size_t             _rows ) {
+    std::string sql;
+#if ORA_ICAT
+    sql = "insert all";
+    for ( size_t i = 0; i < _rows; ++i ) {
+        sql += " into " + _table + " values " + _row;
+    }
+    sql += " select * from dual";
+#else
+    sql = "insert into " + _table + " values ";
+    for ( size_t i = 0; i < _rows; ++i ) {
+        if ( i > 0 ) {
+            sql += ", ";
+        }
+        sql += _row;
+    }
+#endif
+    return sql;
+
+} // _multiRowInsertSql
+
 /**
  * @brief Returns true if the specified resource has associated data objects
  */
@@ -1344,6 +1428,21 @@ icatScramble( char *pw ) {
     return 0;
 }
 
+/*
+   Zero pad the exe_time of a delayed rule to the width of getNowStr, so
+   that exe_time values compare and sort as strings.  The rule engine
+   server selects and orders the rules which are due on exe_time.
+*/
+static void
+padRuleExecTime( char *exeTime, char *paddedTime, int len ) {
+    if ( exeTime[0] != '\0' && isInteger( exeTime ) ) {
+        snprintf( paddedTime, len, "%011lld", strtoll( exeTime, 0, 10 ) );
+    }
+    else {
+        snprintf( paddedTime, len, "%s", exeTime );
+    }
+}
+
 /*
   de-scramble a password sent from the client.
   This isn't real encryption, but does obfuscate the pw on the network.
@@ -3174,6 +3273,307 @@ extern "C" {
 
     } // db_reg_data_obj_op
 
+    // =-=-=-=-=-=-=-
+    // register a list of data objects, linked through next, into the
+    // catalog.  the checks of db_reg_data_obj_op are made once per
+    // collection and data type, and the R_DATA_MAIN and R_OBJT_ACCESS
+    // rows are inserted many at a time.  the caller commits.
+    irods::error db_reg_data_obj_bulk_op(
+        irods::plugin_context& _ctx,
+        dataObjInfo_t*         _data_obj_info ) {
+        // =-=-=-=-=-=-=-
+        // check the context
+        irods::error ret = _ctx.valid();
+        if ( !ret.ok() ) {
+            return PASS( ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // check the params
+        if ( !_data_obj_info ) {
+            return ERROR(
+                       CAT_INVALID_ARGUMENT,
+                       "null parameter" );
+        }
+
+        if ( logSQL != 0 ) {
+            rodsLog( LOG_SQL, "chlRegDataObjBulk" );
+        }
+        if ( !icss.status ) {
+            return ERROR( CATALOG_NOT_CONNECTED, "catalog not connected" );
+        }
+
+        char myTime[50];
+        char data_expiry_ts[] = { "00000000000" };
+        getNowStr( myTime );
+
+        std::vector< bulk_reg_row_t > rows;
+        std::map< std::string, std::pair< rodsLong_t, int > > colls; // coll name to id and inherit flag
+        std::set< std::string > data_types;
+        std::map< std::string, int > hier_counts;
+        int status = 0;
+
+        for ( dataObjInfo_t* info = _data_obj_info; info != NULL; info = info->next ) {
+            bulk_reg_row_t row;
+            row.info = info;
+
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 1 " );
+            }
+            rodsLong_t seqNum = cmlGetNextSeqVal( &icss );
+            if ( seqNum < 0 ) {
+                rodsLog( LOG_NOTICE, "chlRegDataObjBulk cmlGetNextSeqVal failure %d",
+                         seqNum );
+                _rollback( "chlRegDataObjBulk" );
+                return ERROR( seqNum, "chlRegDataObjBulk cmlGetNextSeqVal failure" );
+            }
+            info->dataId = seqNum; /* store as output parameter */
+            row.data_id = boost::lexical_cast< std::string >( seqNum );
+
+            char logicalFileName[MAX_NAME_LEN];
+            char logicalDirName[MAX_NAME_LEN];
+            splitPathByKey( info->objPath,
+                            logicalDirName, MAX_NAME_LEN, logicalFileName, MAX_NAME_LEN, '/' );
+            row.data_name = logicalFileName;
+
+            /* Check that collection exists and user has write permission,
+               once for every collection in the list */
+            std::map< std::string, std::pair< rodsLong_t, int > >::iterator coll_itr = colls.find( logicalDirName );
+            if ( coll_itr == colls.end() ) {
+                int inheritFlag = 0;
+                rodsLong_t iVal = cmlCheckDirAndGetInheritFlag( logicalDirName,
+                                  _ctx.comm()->clientUser.userName,
+                                  _ctx.comm()->clientUser.rodsZone,
+                                  ACCESS_MODIFY_OBJECT,
+                                  &inheritFlag,
+                                  mySessionTicket,
+                                  mySessionClientAddr,
+                                  &icss );
+                if ( iVal < 0 ) {
+                    if ( iVal == CAT_UNKNOWN_COLLECTION ) {
+                        std::stringstream errMsg;
+                        errMsg << "collection '" << logicalDirName << "' is unknown";
+                        addRErrorMsg( &_ctx.comm()->rError, 0, errMsg.str().c_str() );
+                    }
+                    else if ( iVal == CAT_NO_ACCESS_PERMISSION ) {
+                        std::stringstream errMsg;
+                        errMsg << "no permission to update collection '" << logicalDirName << "'";
+                        addRErrorMsg( &_ctx.comm()->rError, 0, errMsg.str().c_str() );
+                    }
+                    return ERROR( iVal, logicalDirName );
+                }
+                coll_itr = colls.insert( std::make_pair( std::string( logicalDirName ),
+                                         std::make_pair( iVal, inheritFlag ) ) ).first;
+            }
+            row.coll_id = boost::lexical_cast< std::string >( coll_itr->second.first );
+            row.inherit = coll_itr->second.second != 0;
+
+            /* Make sure no collection already exists by this name */
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 4" );
+            }
+            {
+                rodsLong_t iVal = 0;
+                std::vector<std::string> bindVars;
+                bindVars.push_back( info->objPath );
+                status = cmlGetIntegerValueFromSql(
+                             "select coll_id from R_COLL_MAIN where coll_name=?",
+                             &iVal, bindVars, &icss );
+            }
+            if ( status == 0 ) {
+                return ERROR( CAT_NAME_EXISTS_AS_COLLECTION, info->objPath );
+            }
+
+            if ( data_types.find( info->dataType ) == data_types.end() ) {
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 5" );
+                }
+                status = cmlCheckNameToken( "data_type",
+                                            info->dataType, &icss );
+                if ( status != 0 ) {
+                    return ERROR( CAT_INVALID_DATA_TYPE, info->dataType );
+                }
+                data_types.insert( info->dataType );
+            }
+
+            row.repl_num = boost::lexical_cast< std::string >( info->replNum );
+            row.repl_status = boost::lexical_cast< std::string >( info->replStatus );
+            row.data_size = boost::lexical_cast< std::string >( info->dataSize );
+            hier_counts[ info->rescHier ]++;
+
+            rows.push_back( row );
+
+        } // for info
+
+        // =-=-=-=-=-=-=-
+        // the data object rows, BULK_REG_ROWS_PER_STMT at a time
+        for ( size_t first = 0; first < rows.size(); first += BULK_REG_ROWS_PER_STMT ) {
+            size_t last = std::min( rows.size(), first + BULK_REG_ROWS_PER_STMT );
+            for ( size_t i = first; i < last; ++i ) {
+                bulk_reg_row_t& row = rows[ i ];
+                cllBindVars[cllBindVarCount++] = row.data_id.c_str();
+                cllBindVars[cllBindVarCount++] = row.coll_id.c_str();
+                cllBindVars[cllBindVarCount++] = row.data_name.c_str();
+                cllBindVars[cllBindVarCount++] = row.repl_num.c_str();
+                cllBindVars[cllBindVarCount++] = row.info->version;
+                cllBindVars[cllBindVarCount++] = row.info->dataType;
+                cllBindVars[cllBindVarCount++] = row.data_size.c_str();
+                cllBindVars[cllBindVarCount++] = row.info->rescName;
+                cllBindVars[cllBindVarCount++] = row.info->rescHier;
+                cllBindVars[cllBindVarCount++] = row.info->filePath;
+                cllBindVars[cllBindVarCount++] = _ctx.comm()->clientUser.userName;
+                cllBindVars[cllBindVarCount++] = _ctx.comm()->clientUser.rodsZone;
+                cllBindVars[cllBindVarCount++] = row.repl_status.c_str();
+                cllBindVars[cllBindVarCount++] = row.info->chksum;
+                cllBindVars[cllBindVarCount++] = row.info->dataMode;
+                cllBindVars[cllBindVarCount++] = myTime;
+                cllBindVars[cllBindVarCount++] = myTime;
+                cllBindVars[cllBindVarCount++] = data_expiry_ts;
+            }
+
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 6" );
+            }
+            std::string sql = _multiRowInsertSql(
+                                  "R_DATA_MAIN (data_id, coll_id, data_name, data_repl_num, data_version, data_type_name, data_size, resc_name, resc_hier, data_path, data_owner_name, data_owner_zone, data_is_dirty, data_checksum, data_mode, create_ts, modify_ts, data_expiry_ts)",
+                                  "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                                  last - first );
+            status = cmlExecuteNoAnswerSql( sql.c_str(), &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBulk cmlExecuteNoAnswerSql failure %d", status );
+                _rollback( "chlRegDataObjBulk" );
+                return ERROR( status, "chlRegDataObjBulk cmlExecuteNoAnswerSql failure" );
+            }
+
+        } // for first
+
+        std::string zone;
+        ret = getLocalZone(
+                  _ctx.prop_map(),
+                  &icss,
+                  zone );
+        if ( !ret.ok() ) {
+            rodsLog( LOG_ERROR, "chlRegDataObjBulk - failed in getLocalZone with status [%d]", ret.code() );
+            return PASS( ret );
+        }
+
+        // =-=-=-=-=-=-=-
+        // one object count update per resource in the hierarchies
+        for ( std::map< std::string, int >::iterator itr = hier_counts.begin(); itr != hier_counts.end(); ++itr ) {
+            if ( ( status = _updateObjCountOfResources( &icss, itr->first, zone.c_str(), itr->second ) ) != 0 ) {
+                return ERROR( status, "_updateObjCountOfResources failed" );
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // objects in collections with inheritance copy the collection's
+        // access rows, the rest are owned by the client user
+        std::vector< size_t > owned;
+        for ( size_t i = 0; i < rows.size(); ++i ) {
+            if ( !rows[ i ].inherit ) {
+                owned.push_back( i );
+                continue;
+            }
+
+            cllBindVars[0] = rows[ i ].data_id.c_str();
+            cllBindVars[1] = myTime;
+            cllBindVars[2] = myTime;
+            cllBindVars[3] = rows[ i ].coll_id.c_str();
+            cllBindVarCount = 4;
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 7" );
+            }
+            status =  cmlExecuteNoAnswerSql(
+                          "insert into R_OBJT_ACCESS (object_id, user_id, access_type_id, create_ts, modify_ts) (select ?, user_id, access_type_id, ?, ? from R_OBJT_ACCESS where object_id = ?)",
+                          &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBulk cmlExecuteNoAnswerSql insert access failure %d",
+                         status );
+                _rollback( "chlRegDataObjBulk" );
+                return ERROR( status, "cmlExecuteNoAnswerSql insert access failure" );
+            }
+        }
+
+        if ( !owned.empty() ) {
+            rodsLong_t user_id = 0;
+            rodsLong_t access_id = 0;
+            if ( logSQL != 0 ) {
+                rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 8" );
+            }
+            {
+                std::vector<std::string> bindVars;
+                bindVars.push_back( _ctx.comm()->clientUser.userName );
+                bindVars.push_back( _ctx.comm()->clientUser.rodsZone );
+                status = cmlGetIntegerValueFromSql(
+                             "select user_id from R_USER_MAIN where user_name=? and zone_name=?",
+                             &user_id, bindVars, &icss );
+            }
+            if ( status == 0 ) {
+                std::vector<std::string> bindVars;
+                bindVars.push_back( ACCESS_OWN );
+                status = cmlGetIntegerValueFromSql(
+                             "select token_id from R_TOKN_MAIN where token_namespace = 'access_type' and token_name = ?",
+                             &access_id, bindVars, &icss );
+            }
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBulk failed to get the owner access ids %d",
+                         status );
+                _rollback( "chlRegDataObjBulk" );
+                return ERROR( status, "failed to get the owner access ids" );
+            }
+
+            std::string user_id_str = boost::lexical_cast< std::string >( user_id );
+            std::string access_id_str = boost::lexical_cast< std::string >( access_id );
+            for ( size_t first = 0; first < owned.size(); first += BULK_REG_ROWS_PER_STMT ) {
+                size_t last = std::min( owned.size(), first + BULK_REG_ROWS_PER_STMT );
+                for ( size_t i = first; i < last; ++i ) {
+                    cllBindVars[cllBindVarCount++] = rows[ owned[ i ] ].data_id.c_str();
+                    cllBindVars[cllBindVarCount++] = user_id_str.c_str();
+                    cllBindVars[cllBindVarCount++] = access_id_str.c_str();
+                    cllBindVars[cllBindVarCount++] = myTime;
+                    cllBindVars[cllBindVarCount++] = myTime;
+                }
+
+                if ( logSQL != 0 ) {
+                    rodsLog( LOG_SQL, "chlRegDataObjBulk SQL 9" );
+                }
+                std::string sql = _multiRowInsertSql(
+                                      "R_OBJT_ACCESS (object_id, user_id, access_type_id, create_ts, modify_ts)",
+                                      "(?, ?, ?, ?, ?)",
+                                      last - first );
+                status = cmlExecuteNoAnswerSql( sql.c_str(), &icss );
+                if ( status != 0 ) {
+                    rodsLog( LOG_NOTICE,
+                             "chlRegDataObjBulk cmlExecuteNoAnswerSql insert access failure %d",
+                             status );
+                    _rollback( "chlRegDataObjBulk" );
+                    return ERROR( status, "cmlExecuteNoAnswerSql insert access failure" );
+                }
+
+            } // for first
+
+        } // if owned
+
+        for ( size_t i = 0; i < rows.size(); ++i ) {
+            status = cmlAudit3( AU_REGISTER_DATA_OBJ, rows[ i ].data_id.c_str(),
+                                _ctx.comm()->clientUser.userName,
+                                _ctx.comm()->clientUser.rodsZone, "", &icss );
+            if ( status != 0 ) {
+                rodsLog( LOG_NOTICE,
+                         "chlRegDataObjBulk cmlAudit3 failure %d",
+                         status );
+                _rollback( "chlRegDataObjBulk" );
+                return ERROR( status, "cmlAudit3 failure" );
+            }
+        }
+
+        return SUCCESS();
+
+    } // db_reg_data_obj_bulk_op
+
 
     // =-=-=-=-=-=-=-
     // register a data object into the catalog
@@ -3720,6 +4120,7 @@ extern "C" {
 //        _ctx.prop_map().get< icatSessionStruct >( ICSS_PROP, icss );
 
         char myTime[50];
+        char exeTime[TIME_LEN];
         rodsLong_t seqNum;
         char ruleExecIdNum[MAX_NAME_LEN];
         int status;
@@ -3747,13 +4148,14 @@ extern "C" {
         snprintf( _re_sub_inp->ruleExecId, NAME_LEN, "%s", ruleExecIdNum );
 
         getNowStr( myTime );
+        padRuleExecTime( _re_sub_inp->exeTime, exeTime, TIME_LEN );
 
         cllBindVars[0] = ruleExecIdNum;
         cllBindVars[1] = _re_sub_inp->ruleName;
         cllBindVars[2] = _re_sub_inp->reiFilePath;
         cllBindVars[3] = _re_sub_inp->userName;
         cllBindVars[4] = _re_sub_inp->exeAddress;
-        cllBindVars[5] = _re_sub_inp->exeTime;
+        cllBindVars[5] = exeTime;
         cllBindVars[6] = _re_sub_inp->exeFrequency;
         cllBindVars[7] = _re_sub_inp->priority;
         cllBindVars[8] = _re_sub_inp->estimateExeTime;
@@ -3844,6 +4246,7 @@ extern "C" {
         int i, j, status;
 
         char tSQL[MAX_SQL_SIZE];
+        char exeTime[TIME_LEN];
         char *theVal = 0;
 
         /* regParamNames has the argument names (in regParam) that this
@@ -3879,6 +4282,10 @@ extern "C" {
                 }
                 rstrcat( tSQL, colNames[i] , MAX_SQL_SIZE );
                 rstrcat( tSQL, "=? ", MAX_SQL_SIZE );
+                if ( strcmp( regParamNames[i], RULE_EXE_TIME_KW ) == 0 ) {
+                    padRuleExecTime( theVal, exeTime, TIME_LEN );
+                    theVal = exeTime;
+                }
                 cllBindVars[j++] = theVal;
             }
         }
@@ -4216,6 +4623,14 @@ extern "C" {
                         }  // IF CHILD HAZ DATA
 
 
+                        if ( ( status = _bumpRescGeneration() ) != 0 ) {
+                            std::stringstream ss;
+                            ss << func_name << " _bumpRescGeneration failure " << status;
+                            irods::log( LOG_NOTICE, ss.str() );
+                            _rollback( func_name );
+                            return ERROR( status, "_bumpRescGeneration failure" );
+                        }
+
                         /* Audit */
                         char commentStr[1024]; // this prolly should be better sized
                         snprintf(
@@ -4417,6 +4832,15 @@ extern "C" {
             return ERROR( status, "cmlExectuteNoAnswerSql(insert) failure" );
         }
 
+        status = _bumpRescGeneration();
+        if ( status != 0 ) {
+            rodsLog( LOG_NOTICE,
+                     "chlRegResc _bumpRescGeneration failure %d",
+                     status );
+            _rollback( "chlRegResc" );
+            return ERROR( status, "_bumpRescGeneration failure" );
+        }
+
         /* Audit */
         status = cmlAudit3( AU_REGISTER_RESOURCE,  idNum,
                             _ctx.comm()->clientUser.userName,
@@ -4600,6 +5024,14 @@ extern "C" {
 
                     }  // IF CHILD HAZ DATA
 
+                    if ( ( status = _bumpRescGeneration() ) != 0 ) {
+                        std::stringstream ss;
+                        ss << "chlDelChildResc _bumpRescGeneration failure " << status;
+                        irods::log( LOG_NOTICE, ss.str() );
+                        _rollback( "chlDelChildResc" );
+                        return ERROR( status, "_bumpRescGeneration failure" );
+                    }
+
                     /* Audit */
                     char commentStr[1024]; // this prolly should be better sized
                     snprintf( commentStr, sizeof commentStr, "%s %s", resc_input[irods::RESOURCE_NAME].c_str(), child_string.c_str() );
@@ -4782,6 +5214,15 @@ extern "C" {
         removeMetaMapAndAVU( rescId );
 
 
+        status = _bumpRescGeneration();
+        if ( status != 0 ) {
+            rodsLog( LOG_NOTICE,
+                     "chlDelResc _bumpRescGeneration failure %d",
+                     status );
+            _rollback( "chlDelResc" );
+            return ERROR( status, "_bumpRescGeneration failure" );
+        }
+
         /* Audit */
         status = cmlAudit3( AU_DELETE_RESOURCE,
                             rescId,
@@ -9142,6 +9583,15 @@ checkLevel:
             return ERROR( CAT_INVALID_ARGUMENT, "invalid option" );
         }
 
+        status = _bumpRescGeneration();
+        if ( status != 0 ) {
+            rodsLog( LOG_NOTICE,
+                     "chlModResc _bumpRescGeneration failure %d",
+                     status );
+            _rollback( "chlModResc" );
+            return ERROR( status, "_bumpRescGeneration failure" );
+        }
+
         /* Audit */
         snprintf( commentStr, sizeof commentStr, "%s %s", _option, _option_value );
         status = cmlAudit3( AU_MOD_RESC,
@@ -14807,7 +15257,8 @@ checkLevel:
         const std::string*     _parent,
         const std::string*     _child,
         int                    _limit,
-        dist_child_result_t*   _results ) {
+        dist_child_result_t*   _results,
+        rodsLong_t             _min_data_id ) {
         // =-=-=-=-=-=-=-
         // check the context
         irods::error ret = _ctx.valid();
@@ -14841,24 +15292,27 @@ checkLevel:
 //        _ctx.prop_map().get< icatSessionStruct >( ICSS_PROP, icss );
 
         // =-=-=-=-=-=-=-
-        // the basic query string
+        // the basic query string.  rows come back in order of data id,
+        // starting after _min_data_id, so a caller can page through them
         char query[ MAX_NAME_LEN ];
 #ifdef ORA_ICAT
-        std::string base_query = "select distinct data_id from R_DATA_MAIN where ( resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and data_id not in ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and rownum < %d";
+        std::string base_query = "select data_id from ( select distinct data_id from R_DATA_MAIN where ( resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and data_id > %lld and data_id not in ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) order by data_id ) where rownum <= %d";
 
 #elif MY_ICAT
-        std::string base_query = "select distinct data_id from R_DATA_MAIN where ( resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and data_id not in ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) limit %d;";
+        std::string base_query = "select distinct data_id from R_DATA_MAIN where ( resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and data_id > %lld and data_id not in ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) order by data_id limit %d;";
 
 #else
-        std::string base_query = "select distinct data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' except ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) limit %d";
+        std::string base_query = "select distinct data_id from R_DATA_MAIN where ( resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) and data_id > %lld except ( select data_id from R_DATA_MAIN where resc_hier like '%s;%s' or resc_hier like '%s;%s;%s' or resc_hier like '%s;%s' ) order by data_id limit %d";
 
 #endif
-        sprintf(
+        snprintf(
             query,
+            sizeof( query ),
             base_query.c_str(),
             _parent->c_str(), "%",      // root
             "%", _parent->c_str(), "%", // mid tier
             "%", _parent->c_str(),      // leaf
+            _min_data_id,
             _child->c_str(), "%",       // root
             "%", _child->c_str(), "%",  // mid tier
             "%", _child->c_str(),       // leaf
@@ -14888,7 +15342,7 @@ checkLevel:
                 return ERROR( status, "failed to get a row" );
             }
 
-            _results->push_back( atoi( icss.stmtPtr[ statement_num ]->resultValue[0] ) );
+            _results->push_back( strtoll( icss.stmtPtr[ statement_num ]->resultValue[0], 0, 0 ) );
 
         } // for i
 
@@ -16011,6 +16465,7 @@ checkLevel:
         pg->add_operation( irods::DATABASE_OP_UPDATE_RESC_OBJ_COUNT,    "db_update_resc_obj_count_op" );
         pg->add_operation( irods::DATABASE_OP_MOD_DATA_OBJ_META,        "db_mod_data_obj_meta_op" );
         pg->add_operation( irods::DATABASE_OP_REG_DATA_OBJ,             "db_reg_data_obj_op" );
+        pg->add_operation( irods::DATABASE_OP_REG_DATA_OBJ_BULK,        "db_reg_data_obj_bulk_op" );
         pg->add_operation( irods::DATABASE_OP_REG_REPLICA,              "db_reg_replica_op" );
         pg->add_operation( irods::DATABASE_OP_UNREG_REPLICA,            "db_unreg_replica_op" );
         pg->add_operation( irods::DATABASE_OP_REG_RULE_EXEC,            "db_reg_rule_exec_op" );
@@ -2187,6 +2187,7 @@ extern "C" int chl_gen_query_impl(
     int totalLen;
     int maxColSize;
     int currentMaxColSize;
+    int colLen[MAX_NUM_OF_SELECT_ITEMS];
     char *tResult, *tResult2;
     static int recursiveCall = 0;
 
@@ -2321,6 +2322,10 @@ extern "C" int chl_gen_query_impl(
             return status;
         }
     }
+
+    /* let the low level fetch the rows from the driver in blocks */
+    cllSetRowArraySize( icss, statementNum, genQueryInp.maxRows );
+
     for ( i = 0; i < genQueryInp.maxRows; i++ ) {
         if ( needToGetNextRow ) {
             status = cmlGetNextRowFromStatement( statementNum, icss );
@@ -2360,6 +2365,7 @@ extern "C" int chl_gen_query_impl(
 
         for ( k = 0; k < numOfCols; k++ ) {
             j = strlen( icss->stmtPtr[statementNum]->resultValue[k] );
+            colLen[k] = j;
             if ( maxColSize <= j ) {
                 maxColSize = j;
             }
@@ -2433,12 +2439,13 @@ extern "C" int chl_gen_query_impl(
         }
 
         /* Store the current row values into the appropriate spots in
-           the attribute string */
+           the attribute string.  The buffers were zeroed when allocated
+           and each value fits, so only the text itself is copied */
         for ( j = 0; j < numOfCols; j++ ) {
             tResult2 = result->sqlResult[j].value; // ptr to value str
             tResult2 += currentMaxColSize * ( result->rowCnt - 1 );  // skip forward for this row
-            strncpy( tResult2, icss->stmtPtr[statementNum]->resultValue[j],
-                     currentMaxColSize ); // copy in the value text
+            memcpy( tResult2, icss->stmtPtr[statementNum]->resultValue[j],
+                    colLen[j] ); // copy in the value text
         }
 
     }
@@ -179,6 +179,8 @@ icatGeneralQuerySetup() {
     sTable( "r_ticket_user_main", "R_USER_MAIN r_ticket_user_main", 1 );
     sTable( "r_ticket_data_coll_main", "R_COLL_MAIN r_ticket_data_coll_main", 1 );
 
+    sTable( "R_GRID_CONFIGURATION", "R_GRID_CONFIGURATION", 0 );
+
     /* Map the #define values to tables and columns */
 
     sColumn( COL_ZONE_ID, "R_ZONE_MAIN", "zone_id" );
@@ -575,6 +577,10 @@ icatGeneralQuerySetup() {
 
     sColumn( COL_TICKET_DATA_COLL_NAME, "r_ticket_data_coll_main", "coll_name" );
 
+    sColumn( COL_GRID_CONF_NAMESPACE, "R_GRID_CONFIGURATION", "namespace" );
+    sColumn( COL_GRID_CONF_OPTION_NAME, "R_GRID_CONFIGURATION", "option_name" );
+    sColumn( COL_GRID_CONF_OPTION_VALUE, "R_GRID_CONFIGURATION", "option_value" );
+
     /* Define the Foreign Key links between tables */
 
     sFklink( "R_COLL_MAIN", "R_DATA_MAIN", "R_COLL_MAIN.coll_id = R_DATA_MAIN.coll_id" );
@@ -19,6 +19,7 @@
    cllDoneWithDefaultResult
    cllGetRow
    cllGetRows
+   cllSetRowArraySize
    cllGetNumberOfColumns
    cllGetColumnInfo
    cllNextValueString
@@ -34,6 +35,8 @@
 #include "irods_stacktrace.hpp"
 
 int _cllFreeStatementColumns( icatSessionStruct *icss, int statementNumber );
+static void _cllStmtCacheInit( icatSessionStruct *icss );
+static void _cllStmtCacheDestroy( icatSessionStruct *icss );
 
 int
 _cllExecSqlNoResult( icatSessionStruct *icss, const char *sql, int option );
@@ -60,25 +63,17 @@ const static SQLLEN GLOBAL_SQL_NTS = SQL_NTS;
 
 #define TMP_STR_LEN 1040
 
-SQLINTEGER columnLength[MAX_TOKEN];  /* change me ! */
-
 #include <stdio.h>
 #include <pwd.h>
 #include <ctype.h>
 
 #include <vector>
 #include <string>
+#include <map>
 
 static int didBegin = 0;
 static int noResultRowCount = 0;
 
-// =-=-=-=-=-=-=-
-// JMC :: Needed to add this due to crash issues with the SQLBindCol + SQLFetch
-//     :: combination where the fetch fails if a var is not passed to the bind for
-//     :: the result data size
-static const short MAX_NUMBER_ICAT_COLUMS = 32;
-static SQLLEN resultDataSizeArray[ MAX_NUMBER_ICAT_COLUMS ];
-
 
 /*
   call SQLError to get error information and log it
@@ -204,6 +199,7 @@ cllConnect( icatSessionStruct *icss ) {
     }
 
     icss->connectPtr = myHdbc;
+    _cllStmtCacheInit( icss );
 
     if ( icss->databaseType == DB_TYPE_MYSQL ) {
         /* MySQL must be running in ANSI mode (or at least in
@@ -264,6 +260,7 @@ cllConnectRda( icatSessionStruct *icss ) {
     }
 
     icss->connectPtr = myHdbc;
+    _cllStmtCacheInit( icss );
 
     if ( icss->databaseType == DB_TYPE_MYSQL ) {
         /*
@@ -393,6 +390,8 @@ cllDisconnect( icatSessionStruct *icss ) {
         /* Nothing to do if it fails */
     }
 
+    _cllStmtCacheDestroy( icss );
+
     SQLRETURN stat = SQLDisconnect( icss->connectPtr );
     if ( stat != SQL_SUCCESS ) {
         rodsLog( LOG_ERROR, "cllDisconnect: SQLDisconnect failed: %d", stat );
@@ -596,96 +595,318 @@ _cllExecSqlNoResult(
     return result;
 }
 
+/* logBindVars
+   For when an error occurs, log the bind variables which were used
+   with the sql.
+*/
+void
+logBindVars(
+    int level,
+    std::vector<std::string> &bindVars ) {
+    for ( int i = 0; i < bindVars.size(); i++ ) {
+        if ( !bindVars[i].empty() ) {
+            rodsLog( level, "bindVar%d=%s", i + 1, bindVars[i].c_str() );
+        }
+    }
+}
+
 /*
-   Execute a SQL command that returns a result table, and
-   and bind the default row.
-   This version now uses the global array of bind variables.
+  Prepared statement cache.
+
+  The same statements are run through cllExecSqlWithResult and
+  cllExecSqlWithResultBV over and over for the life of a connection, so
+  rather than allocating a handle, parsing the SQL, describing the
+  columns and allocating the result buffers each time, the statement is
+  prepared once and kept, keyed by its SQL text, along with its column
+  names and bound result buffers.  Releasing a cached statement only
+  closes its cursor and resets its parameters.
+
+  A statement whose SQL is already in use by another open statement (or
+  which does not fit in a full cache) is run on a handle of its own which
+  is dropped when it is freed, as before.
+
+  The result columns are bound as arrays so that a caller reading many
+  rows (see cllSetRowArraySize) gets them a block at a time from the
+  driver; cllGetRow then steps through the block.
 */
-int
-cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
+#define STMT_CACHE_MAX_ENTRIES 256
+
+/* upper bound on the bytes bound for one block of rows */
+#define ROW_ARRAY_MAX_BYTES (4*1024*1024)
+
+typedef struct {
+    HSTMT   hstmt;
+    int     numOfCols;
+    char   *resultColName[MAX_NUM_OF_SELECT_ITEMS];
+    char   *resultValue[MAX_NUM_OF_SELECT_ITEMS];    /* rowArraySize values */
+    SQLLEN *resultDataSize[MAX_NUM_OF_SELECT_ITEMS]; /* rowArraySize lengths */
+    int     columnLength[MAX_NUM_OF_SELECT_ITEMS];
+    int     rowArraySize;        /* rows bound per fetch */
+    int     wantedRowArraySize;  /* rows to bind at the next fetch */
+    SQLULEN rowsFetched;         /* rows in the current block */
+    SQLULEN rowInx;              /* current row within the block */
+    int     described;   /* columns have been described and bound */
+    int     cached;      /* owned by the cache rather than the statement */
+    int     inUse;
+    unsigned long lastUsed;
+} cachedStmt_t;
+
+typedef std::map< std::string, cachedStmt_t* > stmtCacheMap_t;
+
+typedef struct {
+    stmtCacheMap_t stmts;
+    unsigned long  useCount;
+    unsigned long  hits;
+    unsigned long  misses;
+} stmtCache_t;
+
+static void
+_cllStmtCacheFreeEntry( cachedStmt_t *entry ) {
+    if ( entry->hstmt != NULL ) {
+        SQLRETURN stat = SQLFreeHandle( SQL_HANDLE_STMT, entry->hstmt );
+        if ( stat != SQL_SUCCESS ) {
+            rodsLog( LOG_ERROR, "_cllStmtCacheFreeEntry: SQLFreeHandle for statement error: %d", stat );
+        }
+    }
+    for ( int i = 0; i < entry->numOfCols; i++ ) {
+        free( entry->resultValue[i] );
+        free( entry->resultDataSize[i] );
+        free( entry->resultColName[i] );
+    }
+    delete entry;
+}
 
+static void
+_cllStmtCacheInit( icatSessionStruct *icss ) {
+    stmtCache_t *cache = new stmtCache_t;
+    cache->useCount = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    icss->stmtCache = cache;
+}
 
-    /* In 2.2 and some versions before, this would call
-       _cllExecSqlNoResult with "begin", similar to how cllExecSqlNoResult
-       does.  But since this function is called for 'select's, this is not
-       needed here, and in fact causes postgres processes to be in the
-       'idle in transaction' state which prevents some operations (such as
-       backup).  So this was removed. */
-    rodsLog( LOG_DEBUG1, sql );
+static void
+_cllStmtCacheDestroy( icatSessionStruct *icss ) {
+    stmtCache_t *cache = ( stmtCache_t * )icss->stmtCache;
+    if ( cache == NULL ) {
+        return;
+    }
 
-    HDBC myHdbc = icss->connectPtr;
-    HSTMT hstmt;
-    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &hstmt );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLAllocHandle failed for statement: %d",
-                 stat );
-        return -1;
+    rodsLog( LOG_DEBUG,
+             "prepared statement cache: %lu hits, %lu misses, %d entries",
+             cache->hits, cache->misses, ( int )cache->stmts.size() );
+
+    /* statements still open become uncached and are freed along with
+       their icatStmtStrct */
+    for ( stmtCacheMap_t::iterator itr = cache->stmts.begin();
+            itr != cache->stmts.end(); ++itr ) {
+        if ( itr->second->inUse ) {
+            itr->second->cached = 0;
+        }
+        else {
+            _cllStmtCacheFreeEntry( itr->second );
+        }
     }
 
-    int statementNumber = -1;
-    for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS && statementNumber < 0; i++ ) {
-        if ( icss->stmtPtr[i] == 0 ) {
-            statementNumber = i;
+    delete cache;
+    icss->stmtCache = NULL;
+}
+
+/*
+  Return the cached statement for this sql, or a new one if it is not
+  cached or the cached one is in use.  *isNew is set if the statement
+  still needs to be allocated and prepared.
+*/
+static cachedStmt_t *
+_cllStmtCacheAcquire( icatSessionStruct *icss, const char *sql, int *isNew ) {
+    stmtCache_t *cache = ( stmtCache_t * )icss->stmtCache;
+
+    cachedStmt_t *entry = new cachedStmt_t;
+    memset( entry, 0, sizeof( cachedStmt_t ) );
+    entry->inUse = 1;
+    *isNew = 1;
+    if ( cache == NULL ) {
+        return entry;
+    }
+
+    stmtCacheMap_t::iterator itr = cache->stmts.find( sql );
+    if ( itr != cache->stmts.end() && !itr->second->inUse ) {
+        delete entry;
+        cache->hits++;
+        itr->second->inUse = 1;
+        itr->second->lastUsed = ++cache->useCount;
+        *isNew = 0;
+        return itr->second;
+    }
+
+    cache->misses++;
+    if ( itr != cache->stmts.end() ) {
+        /* the cached copy is busy, e.g. a nested query on the same sql */
+        return entry;
+    }
+
+    if ( cache->stmts.size() >= STMT_CACHE_MAX_ENTRIES ) {
+        /* evict the least recently used idle statement */
+        stmtCacheMap_t::iterator lru = cache->stmts.end();
+        for ( stmtCacheMap_t::iterator i = cache->stmts.begin();
+                i != cache->stmts.end(); ++i ) {
+            if ( !i->second->inUse &&
+                    ( lru == cache->stmts.end() ||
+                      i->second->lastUsed < lru->second->lastUsed ) ) {
+                lru = i;
+            }
         }
+        if ( lru == cache->stmts.end() ) {
+            return entry;
+        }
+        _cllStmtCacheFreeEntry( lru->second );
+        cache->stmts.erase( lru );
     }
-    if ( statementNumber < 0 ) {
-        rodsLog( LOG_ERROR,
-                 "cllExecSqlWithResult: too many concurrent statements" );
-        return CAT_STATEMENT_TABLE_FULL;
+
+    entry->cached = 1;
+    entry->lastUsed = ++cache->useCount;
+    cache->stmts[ sql ] = entry;
+    return entry;
+}
+
+/*
+  (Re)bind the result columns of a described statement as arrays of
+  the given number of rows.
+*/
+static int
+_cllBindColumnArrays( cachedStmt_t *entry, int rows, const char *caller ) {
+    HSTMT hstmt = entry->hstmt;
+
+    SQLRETURN stat = SQLSetStmtAttr( hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                     ( SQLPOINTER )( SQLULEN )rows, 0 );
+    if ( stat == SQL_SUCCESS ) {
+        stat = SQLSetStmtAttr( hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                               &entry->rowsFetched, 0 );
+    }
+    if ( stat != SQL_SUCCESS ) {
+        rodsLog( LOG_ERROR, "%s: SQLSetStmtAttr failed: %d", caller, stat );
+        return -4;
     }
 
-    icatStmtStrct * myStatement = ( icatStmtStrct * )malloc( sizeof( icatStmtStrct ) );
-    icss->stmtPtr[statementNumber] = myStatement;
+    for ( int i = 0; i < entry->numOfCols; i++ ) {
+        int colLen = entry->columnLength[i];
+        char *values = ( char * )realloc( entry->resultValue[i], colLen * rows );
+        SQLLEN *sizes = ( SQLLEN * )realloc( entry->resultDataSize[i], sizeof( SQLLEN ) * rows );
+        if ( values != NULL ) {
+            entry->resultValue[i] = values;
+        }
+        if ( sizes != NULL ) {
+            entry->resultDataSize[i] = sizes;
+        }
+        if ( values == NULL || sizes == NULL ) {
+            return SYS_MALLOC_ERR;
+        }
+        values[0] = '\0';
 
-    myStatement->stmtPtr = hstmt;
+        // =-=-=-=-=-=-=-
+        // JMC :: the fetch fails if a var is not passed to the bind for
+        //     :: the result data size.  each statement keeps its own so
+        //     :: cached statements do not share them
+        stat = SQLBindCol( hstmt, i + 1, SQL_C_CHAR, values, colLen, sizes );
+        if ( stat != SQL_SUCCESS ) {
+            rodsLog( LOG_ERROR,
+                     "%s: SQLBindCol failed: %d",
+                     caller, stat );
+            return -4;
+        }
+    }
 
-    if ( bindTheVariables( hstmt, sql ) != 0 ) {
-        return -1;
+    entry->rowArraySize = rows;
+    entry->wantedRowArraySize = rows;
+    entry->rowsFetched = 0;
+    entry->rowInx = 0;
+    return 0;
+}
+
+/*
+  Give a statement back to the cache, or free it if it is not cached.  If
+  discard is set (e.g. the statement failed), a cached statement is
+  removed from the cache and freed as well.
+*/
+static void
+_cllStmtCacheRelease( icatSessionStruct *icss, cachedStmt_t *entry, int discard ) {
+    stmtCache_t *cache = ( stmtCache_t * )icss->stmtCache;
+
+    if ( entry->cached && ( discard || cache == NULL ) ) {
+        if ( cache != NULL ) {
+            for ( stmtCacheMap_t::iterator itr = cache->stmts.begin();
+                    itr != cache->stmts.end(); ++itr ) {
+                if ( itr->second == entry ) {
+                    cache->stmts.erase( itr );
+                    break;
+                }
+            }
+        }
+        entry->cached = 0;
     }
 
-    rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    if ( !entry->cached ) {
+        _cllStmtCacheFreeEntry( entry );
+        return;
+    }
 
-    switch ( stat ) {
-    case SQL_SUCCESS:
-        rodsLogSqlResult( "SUCCESS" );
-        break;
-    case SQL_SUCCESS_WITH_INFO:
-        rodsLogSqlResult( "SUCCESS_WITH_INFO" );
-        break;
-    case SQL_NO_DATA_FOUND:
-        rodsLogSqlResult( "NO_DATA" );
-        break;
-    case SQL_ERROR:
-        rodsLogSqlResult( "SQL_ERROR" );
-        break;
-    case SQL_INVALID_HANDLE:
-        rodsLogSqlResult( "HANDLE_ERROR" );
-        break;
-    default:
-        rodsLogSqlResult( "UNKNOWN" );
+    SQLRETURN stat = SQLFreeStmt( entry->hstmt, SQL_CLOSE );
+    if ( stat == SQL_SUCCESS ) {
+        stat = SQLFreeStmt( entry->hstmt, SQL_RESET_PARAMS );
+    }
+    if ( stat != SQL_SUCCESS ) {
+        rodsLog( LOG_ERROR, "_cllStmtCacheRelease: SQLFreeStmt error: %d", stat );
+        _cllStmtCacheRelease( icss, entry, 1 );
+        return;
     }
 
-    if ( stat != SQL_SUCCESS &&
-            stat != SQL_SUCCESS_WITH_INFO &&
-            stat != SQL_NO_DATA_FOUND ) {
-        logTheBindVariables( LOG_NOTICE );
-        rodsLog( LOG_NOTICE,
-                 "cllExecSqlWithResult: SQLExecDirect error: %d, sql:%s",
-                 stat, sql );
-        logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
-                     icss->databaseType );
-        return -1;
+    /* do not keep large blocks of rows bound while idle */
+    if ( entry->rowArraySize > 1 &&
+            _cllBindColumnArrays( entry, 1, "_cllStmtCacheRelease" ) != 0 ) {
+        _cllStmtCacheRelease( icss, entry, 1 );
+        return;
     }
+    entry->inUse = 0;
+}
+
+/*
+  Return the prepared statement cache counters for this connection, and
+  the number of statements currently cached.
+*/
+int
+cllGetStmtCacheStats( icatSessionStruct *icss, rodsLong_t *hits, rodsLong_t *misses ) {
+    stmtCache_t *cache = ( stmtCache_t * )icss->stmtCache;
+    if ( cache == NULL ) {
+        *hits = 0;
+        *misses = 0;
+        return 0;
+    }
+    *hits = cache->hits;
+    *misses = cache->misses;
+    return cache->stmts.size();
+}
+
+/*
+  Describe the result columns of a newly prepared statement and bind
+  a result buffer to each.
+*/
+static int
+_cllDescribeAndBindColumns( cachedStmt_t *entry, const char *caller ) {
+    HSTMT hstmt = entry->hstmt;
 
     SQLSMALLINT numColumns;
-    stat = SQLNumResultCols( hstmt, &numColumns );
+    SQLRETURN stat = SQLNumResultCols( hstmt, &numColumns );
     if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLNumResultCols failed: %d",
-                 stat );
+        rodsLog( LOG_ERROR, "%s: SQLNumResultCols failed: %d",
+                 caller, stat );
+        return -2;
+    }
+    if ( numColumns > MAX_NUM_OF_SELECT_ITEMS ) {
+        rodsLog( LOG_ERROR, "%s: too many result columns: %d",
+                 caller, numColumns );
         return -2;
     }
-    myStatement->numOfCols = numColumns;
+
     for ( int i = 0; i < numColumns; i++ ) {
         SQLCHAR colName[MAX_TOKEN] = "";
         SQLSMALLINT colNameLen;
@@ -695,92 +916,58 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
         stat = SQLDescribeCol( hstmt, i + 1, colName, sizeof( colName ),
                                &colNameLen, &colType, &precision, &scale, NULL );
         if ( stat != SQL_SUCCESS ) {
-            rodsLog( LOG_ERROR, "cllExecSqlWithResult: SQLDescribeCol failed: %d",
-                     stat );
+            rodsLog( LOG_ERROR, "%s: SQLDescribeCol failed: %d",
+                     caller, stat );
             return -3;
         }
-        /*  printf("colName='%s' precision=%d\n",colName, precision); */
-        columnLength[i] = precision;
         SQL_INT_OR_LEN displaysize;
         stat = SQLColAttribute( hstmt, i + 1, SQL_COLUMN_DISPLAY_SIZE,
                                 NULL, 0, NULL, &displaysize ); // JMC :: fixed for odbc
         if ( stat != SQL_SUCCESS ) {
             rodsLog( LOG_ERROR,
-                     "cllExecSqlWithResult: SQLColAttributes failed: %d",
-                     stat );
+                     "%s: SQLColAttributes failed: %d",
+                     caller, stat );
             return -3;
         }
 
+        int colLen;
         if ( displaysize > ( ( int )strlen( ( char * ) colName ) ) ) {
-            columnLength[i] = displaysize + 1;
+            colLen = displaysize + 1;
         }
         else {
-            columnLength[i] = strlen( ( char * ) colName ) + 1;
-        }
-        /*      printf("columnLength[%d]=%d\n",i,columnLength[i]); */
-
-        myStatement->resultValue[i] = ( char* )malloc( ( int )columnLength[i] );
-
-        strcpy( ( char * )myStatement->resultValue[i], "" );
-
-        // =-=-=-=-=-=-=-
-        // JMC :: added static array to catch the result set size.  this was necessary to
-        stat = SQLBindCol( hstmt, i + 1, SQL_C_CHAR, myStatement->resultValue[i], columnLength[i], &resultDataSizeArray[ i ] );
-        if ( stat != SQL_SUCCESS ) {
-            rodsLog( LOG_ERROR,
-                     "cllExecSqlWithResult: SQLColAttributes failed: %d",
-                     stat );
-            return -4;
+            colLen = strlen( ( char * ) colName ) + 1;
         }
 
+        entry->columnLength[i] = colLen;
+        entry->resultColName[i] = ( char* )malloc( colLen );
+        strncpy( entry->resultColName[i], ( char * )colName, colLen );
+        entry->numOfCols = i + 1;
+    }
 
-        myStatement->resultColName[i] = ( char* )malloc( ( int )columnLength[i] );
-        strncpy( myStatement->resultColName[i], ( char * )colName, columnLength[i] );
-
+    int status = _cllBindColumnArrays( entry, 1, caller );
+    if ( status != 0 ) {
+        return status;
     }
 
-    *stmtNum = statementNumber;
+    entry->described = 1;
     return 0;
 }
 
-/* logBindVars
-   For when an error occurs, log the bind variables which were used
-   with the sql.
-*/
-void
-logBindVars(
-    int level,
-    std::vector<std::string> &bindVars ) {
-    for ( int i = 0; i < bindVars.size(); i++ ) {
-        if ( !bindVars[i].empty() ) {
-            rodsLog( level, "bindVar%d=%s", i + 1, bindVars[i].c_str() );
-        }
-    }
-}
-
-
 /*
-   Execute a SQL command that returns a result table, and
-   and bind the default row; and allow optional bind variables.
+  Execute a SQL command that returns a result table, and bind the
+  default row, using the prepared statement cache.  If bindVars is
+  NULL, the global array of bind variables is used.
 */
-int
-cllExecSqlWithResultBV(
+static int
+_cllExecSqlWithResult(
     icatSessionStruct *icss,
     int *stmtNum,
     const char *sql,
-    std::vector< std::string > &bindVars ) {
+    std::vector< std::string > *bindVars,
+    const char *caller ) {
 
     rodsLog( LOG_DEBUG1, sql );
 
-    HDBC myHdbc = icss->connectPtr;
-    HSTMT hstmt;
-    SQLRETURN stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &hstmt );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLAllocHandle failed for statement: %d",
-                 stat );
-        return -1;
-    }
-
     int statementNumber = -1;
     for ( int i = 0; i < MAX_NUM_OF_CONCURRENT_STMTS && statementNumber < 0; i++ ) {
         if ( icss->stmtPtr[i] == 0 ) {
@@ -789,32 +976,61 @@ cllExecSqlWithResultBV(
     }
     if ( statementNumber < 0 ) {
         rodsLog( LOG_ERROR,
-                 "cllExecSqlWithResultBV: too many concurrent statements" );
+                 "%s: too many concurrent statements", caller );
         return CAT_STATEMENT_TABLE_FULL;
     }
 
-    icatStmtStrct * myStatement = ( icatStmtStrct * )malloc( sizeof( icatStmtStrct ) );
-    icss->stmtPtr[statementNumber] = myStatement;
-
-    myStatement->stmtPtr = hstmt;
-
-    for ( int i = 0; i < bindVars.size(); i++ ) {
-        if ( !bindVars[i].empty() ) {
+    HDBC myHdbc = icss->connectPtr;
+    int isNew = 0;
+    cachedStmt_t *entry = _cllStmtCacheAcquire( icss, sql, &isNew );
+    SQLRETURN stat;
+    if ( isNew ) {
+        stat = SQLAllocHandle( SQL_HANDLE_STMT, myHdbc, &entry->hstmt );
+        if ( stat != SQL_SUCCESS ) {
+            rodsLog( LOG_ERROR, "%s: SQLAllocHandle failed for statement: %d",
+                     caller, stat );
+            entry->hstmt = NULL;
+            _cllStmtCacheRelease( icss, entry, 1 );
+            return -1;
+        }
+    }
+    HSTMT hstmt = entry->hstmt;
 
-            stat = SQLBindParameter( hstmt, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR,
-                                     SQL_CHAR, 0, 0, const_cast<char*>( bindVars[i].c_str() ), bindVars[i].size(), const_cast<SQLLEN*>( &GLOBAL_SQL_NTS ) );
-            char tmpStr[TMP_STR_LEN];
-            snprintf( tmpStr, sizeof( tmpStr ), "bindVar%d=%s", i + 1, bindVars[i].c_str() );
-            rodsLogSql( tmpStr );
-            if ( stat != SQL_SUCCESS ) {
-                rodsLog( LOG_ERROR,
-                         "cllExecSqlWithResultBV: SQLBindParameter failed: %d", stat );
-                return -1;
+    if ( bindVars == NULL ) {
+        if ( bindTheVariables( hstmt, sql ) != 0 ) {
+            _cllStmtCacheRelease( icss, entry, 1 );
+            return -1;
+        }
+    }
+    else {
+        for ( size_t i = 0; i < bindVars->size(); i++ ) {
+            std::string& bindVar = ( *bindVars )[i];
+            if ( !bindVar.empty() ) {
+                stat = SQLBindParameter( hstmt, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                         SQL_CHAR, 0, 0, const_cast<char*>( bindVar.c_str() ), bindVar.size(), const_cast<SQLLEN*>( &GLOBAL_SQL_NTS ) );
+                char tmpStr[TMP_STR_LEN];
+                snprintf( tmpStr, sizeof( tmpStr ), "bindVar%d=%s", ( int )i + 1, bindVar.c_str() );
+                rodsLogSql( tmpStr );
+                if ( stat != SQL_SUCCESS ) {
+                    rodsLog( LOG_ERROR,
+                             "%s: SQLBindParameter failed: %d", caller, stat );
+                    _cllStmtCacheRelease( icss, entry, 1 );
+                    return -1;
+                }
             }
         }
     }
+
     rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    if ( isNew ) {
+        stat = SQLPrepare( hstmt, ( unsigned char * )sql, strlen( sql ) );
+        if ( stat == SQL_SUCCESS || stat == SQL_SUCCESS_WITH_INFO ) {
+            stat = SQLExecute( hstmt );
+        }
+    }
+    else {
+        stat = SQLExecute( hstmt );
+    }
 
     switch ( stat ) {
     case SQL_SUCCESS:
@@ -839,99 +1055,165 @@ cllExecSqlWithResultBV(
     if ( stat != SQL_SUCCESS &&
             stat != SQL_SUCCESS_WITH_INFO &&
             stat != SQL_NO_DATA_FOUND ) {
-        logBindVars( LOG_NOTICE, bindVars );
+        if ( bindVars == NULL ) {
+            logTheBindVariables( LOG_NOTICE );
+        }
+        else {
+            logBindVars( LOG_NOTICE, *bindVars );
+        }
         rodsLog( LOG_NOTICE,
-                 "cllExecSqlWithResultBV: SQLExecDirect error: %d, sql:%s",
-                 stat, sql );
+                 "%s: SQLExecute error: %d, sql:%s",
+                 caller, stat, sql );
         logPsgError( LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
                      icss->databaseType );
+        _cllStmtCacheRelease( icss, entry, 1 );
         return -1;
     }
 
-    SQLSMALLINT numColumns;
-    stat = SQLNumResultCols( hstmt, &numColumns );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLNumResultCols failed: %d",
-                 stat );
-        return -2;
+    if ( !entry->described ) {
+        int status = _cllDescribeAndBindColumns( entry, caller );
+        if ( status < 0 ) {
+            _cllStmtCacheRelease( icss, entry, 1 );
+            return status;
+        }
     }
-    myStatement->numOfCols = numColumns;
 
-    for ( int i = 0; i < numColumns; i++ ) {
-        SQLCHAR colName[MAX_TOKEN] = "";
-        SQLSMALLINT colNameLen;
-        SQLSMALLINT colType;
-        SQL_UINT_OR_ULEN precision;
-        SQLSMALLINT scale;
-        stat = SQLDescribeCol( hstmt, i + 1, colName, sizeof( colName ),
-                               &colNameLen, &colType, &precision, &scale, NULL );
-        if ( stat != SQL_SUCCESS ) {
-            rodsLog( LOG_ERROR, "cllExecSqlWithResultBV: SQLDescribeCol failed: %d",
-                     stat );
-            return -3;
-        }
-        /*  printf("colName='%s' precision=%d\n",colName, precision); */
-        columnLength[i] = precision;
-        SQL_INT_OR_LEN  displaysize;
-        stat = SQLColAttribute( hstmt, i + 1, SQL_COLUMN_DISPLAY_SIZE,
-                                NULL, 0, NULL, &displaysize ); // JMC :: changed to SQLColAttribute for odbc update
-        if ( stat != SQL_SUCCESS ) {
-            rodsLog( LOG_ERROR,
-                     "cllExecSqlWithResultBV: SQLColAttributes failed: %d",
-                     stat );
-            return -3;
-        }
+    icatStmtStrct * myStatement = ( icatStmtStrct * )malloc( sizeof( icatStmtStrct ) );
+    memset( myStatement, 0, sizeof( icatStmtStrct ) );
+    myStatement->stmtPtr = hstmt;
+    myStatement->cacheEntry = entry;
+    myStatement->numOfCols = entry->numOfCols;
+    entry->rowsFetched = 0;
+    entry->rowInx = 0;
+    for ( int i = 0; i < entry->numOfCols; i++ ) {
+        entry->resultValue[i][0] = '\0';
+        myStatement->resultValue[i] = entry->resultValue[i];
+        myStatement->resultColName[i] = entry->resultColName[i];
+    }
+    icss->stmtPtr[statementNumber] = myStatement;
 
-        if ( displaysize > ( ( int )strlen( ( char * ) colName ) ) ) {
-            columnLength[i] = displaysize + 1;
-        }
-        else {
-            columnLength[i] = strlen( ( char * ) colName ) + 1;
-        }
-        /*      printf("columnLength[%d]=%d\n",i,columnLength[i]); */
+    *stmtNum = statementNumber;
+    return 0;
+}
 
-        myStatement->resultValue[i] = ( char* )malloc( ( int )columnLength[i] );
+/*
+   Execute a SQL command that returns a result table, and
+   and bind the default row.
+   This version now uses the global array of bind variables.
+*/
+int
+cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
 
-        myStatement->resultValue[i][0] = '\0';
-        // =-=-=-=-=-=-=-
-        // JMC :: added static array to catch the result set size.  this was necessary to
-        stat = SQLBindCol( hstmt, i + 1, SQL_C_CHAR, myStatement->resultValue[i], columnLength[i], &resultDataSizeArray[i] );
+    /* In 2.2 and some versions before, this would call
+       _cllExecSqlNoResult with "begin", similar to how cllExecSqlNoResult
+       does.  But since this function is called for 'select's, this is not
+       needed here, and in fact causes postgres processes to be in the
+       'idle in transaction' state which prevents some operations (such as
+       backup).  So this was removed. */
+    return _cllExecSqlWithResult( icss, stmtNum, sql, NULL,
+                                  "cllExecSqlWithResult" );
+}
 
-        if ( stat != SQL_SUCCESS ) {
-            rodsLog( LOG_ERROR,
-                     "cllExecSqlWithResultBV: SQLColAttributes failed: %d",
-                     stat );
-            return -4;
-        }
+/*
+   Execute a SQL command that returns a result table, and
+   and bind the default row; and allow optional bind variables.
+*/
+int
+cllExecSqlWithResultBV(
+    icatSessionStruct *icss,
+    int *stmtNum,
+    const char *sql,
+    std::vector< std::string > &bindVars ) {
+
+    return _cllExecSqlWithResult( icss, stmtNum, sql, &bindVars,
+                                  "cllExecSqlWithResultBV" );
+}
+
+/*
+  Return a row from a previous cllExecSqlWithResult call.
+  The row is taken from the block of rows last fetched, if any are left,
+  otherwise the next block is fetched.
+*/
+int
+cllGetRow( icatSessionStruct *icss, int statementNumber ) {
+    icatStmtStrct *myStatement = icss->stmtPtr[statementNumber];
+    cachedStmt_t *entry = ( cachedStmt_t * )myStatement->cacheEntry;
 
+    if ( entry->rowInx + 1 < entry->rowsFetched ) {
+        entry->rowInx++;
+    }
+    else {
+        if ( entry->wantedRowArraySize != entry->rowArraySize &&
+                _cllBindColumnArrays( entry, entry->wantedRowArraySize, "cllGetRow" ) != 0 ) {
+            return -1;
+        }
 
-        myStatement->resultColName[i] = ( char* )malloc( ( int )columnLength[i] );
-        strncpy( myStatement->resultColName[i], ( char * )colName, columnLength[i] );
+        SQLRETURN stat =  SQLFetch( entry->hstmt );
+        if ( stat != SQL_SUCCESS && stat != SQL_NO_DATA_FOUND ) {
+            rodsLog( LOG_ERROR, "cllGetRow: SQLFetch failed: %d", stat );
+            return -1;
+        }
+        if ( stat == SQL_NO_DATA_FOUND ) {
+            entry->rowsFetched = 0;
+            _cllFreeStatementColumns( icss, statementNumber );
+            myStatement->numOfCols = 0;
+            return 0;
+        }
+        if ( entry->rowsFetched < 1 ) {
+            entry->rowsFetched = 1;
+        }
+        entry->rowInx = 0;
+    }
 
+    for ( int i = 0; i < myStatement->numOfCols; i++ ) {
+        char *value = entry->resultValue[i] + entry->rowInx * entry->columnLength[i];
+        if ( entry->resultDataSize[i][entry->rowInx] == SQL_NULL_DATA ) {
+            value[0] = '\0';
+        }
+        myStatement->resultValue[i] = value;
     }
-    *stmtNum = statementNumber;
     return 0;
 }
 
 /*
-  Return a row from a previous cllExecSqlWithResult call.
+  Tell the low level that the caller will read about this many rows
+  from the statement, so they can be fetched from the driver in blocks
+  rather than one at a time.  Takes effect at the next fetch.
+  The irodsOdbcRowArraySize environment variable can lower the limit
+  (1 fetches a row at a time).
 */
 int
-cllGetRow( icatSessionStruct *icss, int statementNumber ) {
+cllSetRowArraySize( icatSessionStruct *icss, int statementNumber, int rows ) {
+    static int maxRows = -1;
+    if ( maxRows < 0 ) {
+        char *rowsEnv = getenv( "irodsOdbcRowArraySize" );
+        maxRows = rowsEnv ? atoi( rowsEnv ) : MAX_SQL_ROWS;
+        if ( maxRows < 1 ) {
+            maxRows = 1;
+        }
+    }
+
     icatStmtStrct *myStatement = icss->stmtPtr[statementNumber];
+    if ( myStatement == NULL || myStatement->cacheEntry == NULL ) {
+        return 0;
+    }
+    cachedStmt_t *entry = ( cachedStmt_t * )myStatement->cacheEntry;
 
-    for ( int i = 0; i < myStatement->numOfCols; i++ ) {
-        strcpy( ( char * )myStatement->resultValue[i], "" );
+    int rowBytes = 0;
+    for ( int i = 0; i < entry->numOfCols; i++ ) {
+        rowBytes += entry->columnLength[i];
     }
-    SQLRETURN stat =  SQLFetch( myStatement->stmtPtr );
-    if ( stat != SQL_SUCCESS && stat != SQL_NO_DATA_FOUND ) {
-        rodsLog( LOG_ERROR, "cllGetRow: SQLFetch failed: %d", stat );
-        return -1;
+    if ( rows > maxRows ) {
+        rows = maxRows;
+    }
+    if ( rowBytes > 0 && rows > ROW_ARRAY_MAX_BYTES / rowBytes ) {
+        rows = ROW_ARRAY_MAX_BYTES / rowBytes;
     }
-    if ( stat == SQL_NO_DATA_FOUND ) {
-        _cllFreeStatementColumns( icss, statementNumber );
-        myStatement->numOfCols = 0;
+    if ( rows < 1 ) {
+        rows = 1;
     }
+
+    entry->wantedRowArraySize = rows;
     return 0;
 }
 
@@ -991,9 +1273,15 @@ cllFreeStatement( icatSessionStruct *icss, int statementNumber ) {
 
     _cllFreeStatementColumns( icss, statementNumber );
 
-    SQLRETURN stat = SQLFreeHandle( SQL_HANDLE_STMT, myStatement->stmtPtr );
-    if ( stat != SQL_SUCCESS ) {
-        rodsLog( LOG_ERROR, "cllFreeStatement SQLFreeHandle for statement error: %d", stat );
+    if ( myStatement->cacheEntry != NULL ) {
+        /* the handle and buffers go back to the prepared statement cache */
+        _cllStmtCacheRelease( icss, ( cachedStmt_t * )myStatement->cacheEntry, 0 );
+    }
+    else {
+        SQLRETURN stat = SQLFreeHandle( SQL_HANDLE_STMT, myStatement->stmtPtr );
+        if ( stat != SQL_SUCCESS ) {
+            rodsLog( LOG_ERROR, "cllFreeStatement SQLFreeHandle for statement error: %d", stat );
+        }
     }
 
     free( myStatement );
@@ -1013,9 +1301,12 @@ _cllFreeStatementColumns( icatSessionStruct *icss, int statementNumber ) {
     icatStmtStrct * myStatement = icss->stmtPtr[statementNumber];
 
     for ( int i = 0; i < myStatement->numOfCols; i++ ) {
-        free( myStatement->resultValue[i] );
+        /* cached statements own their buffers */
+        if ( myStatement->cacheEntry == NULL ) {
+            free( myStatement->resultValue[i] );
+            free( myStatement->resultColName[i] );
+        }
         myStatement->resultValue[i] = NULL;
-        free( myStatement->resultColName[i] );
         myStatement->resultColName[i] = NULL;
     }
     return 0;
@@ -1029,6 +1320,7 @@ extern "C" int cllTest( const char *userArg, const char *pwArg ) {
 
     icatSessionStruct icss;
     icss.stmtPtr[0] = 0;
+    icss.stmtCache = NULL;
     strncpy( icss.database_plugin_type, "postgres", DB_TYPENAME_LEN );
     icss.databaseType = DB_TYPE_POSTGRES; // JMC - backport 4712
 #ifdef MY_ICAT
@@ -620,6 +620,14 @@ cllGetRow( icatSessionStruct *icss, int statementNumber ) {
     return 0;
 }
 
+/*
+  Rows are fetched one at a time here, so the hint is ignored.
+*/
+int
+cllSetRowArraySize( icatSessionStruct *icss, int statementNumber, int rows ) {
+    return 0;
+}
+
 
 /*
    Execute a SQL command that returns a result table, and and bind the
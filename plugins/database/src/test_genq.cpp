@@ -5,6 +5,7 @@
 */
 
 #include <limits>
+#include <sys/time.h>
 #include <boost/lexical_cast.hpp>
 
 #include "rodsClient.h"
@@ -801,6 +802,71 @@ doTest15( char *testString, char *testString2, char *testString3 ) {
     return status;
 }
 
+/*
+  Benchmark: read every data object under a collection, maxRows at a
+  time, as a large iquest or ils -L would, and report rows/sec.  Run
+  with irodsOdbcRowArraySize=1 in the environment to compare against
+  fetching a row at a time from the driver.
+*/
+int
+doBench( char *collName, char *maxRowsStr ) {
+    genQueryInp_t genQueryInp;
+    genQueryOut_t genQueryOut;
+    char condStr[MAX_NAME_LEN];
+    struct timeval startTime, endTime;
+    rodsLong_t totalRows = 0;
+    int calls = 0;
+    int status;
+
+    rodsLogSqlReq( 0 ); /* less verbosity */
+
+    memset( &genQueryInp, 0, sizeof( genQueryInp ) );
+    addInxIval( &genQueryInp.selectInp, COL_D_DATA_ID, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_COLL_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_DATA_SIZE, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_D_OWNER_NAME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_D_MODIFY_TIME, 1 );
+    addInxIval( &genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1 );
+
+    snprintf( condStr, MAX_NAME_LEN, "like '%s%%'", collName );
+    addInxVal( &genQueryInp.sqlCondInp, COL_COLL_NAME, condStr );
+
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+    if ( maxRowsStr != NULL && *maxRowsStr != '\0' ) {
+        genQueryInp.maxRows = atoi( maxRowsStr );
+    }
+    genQueryInp.continueInx = 0;
+
+    gettimeofday( &startTime, NULL );
+    do {
+        memset( &genQueryOut, 0, sizeof( genQueryOut ) );
+        status = chlGenQuery( genQueryInp, &genQueryOut );
+        calls++;
+        if ( status == 0 ) {
+            totalRows += genQueryOut.rowCnt;
+        }
+        for ( int i = 0; i < genQueryOut.attriCnt; i++ ) {
+            free( genQueryOut.sqlResult[i].value );
+        }
+        genQueryInp.continueInx = genQueryOut.continueInx;
+    }
+    while ( status == 0 && genQueryInp.continueInx > 0 );
+    gettimeofday( &endTime, NULL );
+
+    if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
+        printf( "chlGenQuery status=%d\n", status );
+        return status;
+    }
+
+    double elapsed = ( endTime.tv_sec - startTime.tv_sec ) +
+                     ( endTime.tv_usec - startTime.tv_usec ) / 1000000.0;
+    printf( "rows=%lld calls=%d maxRows=%d seconds=%.3f rows/sec=%.0f\n",
+            totalRows, calls, genQueryInp.maxRows, elapsed,
+            elapsed > 0 ? totalRows / elapsed : 0.0 );
+    return 0;
+}
+
 
 int
 main( int argc, char **argv ) {
@@ -873,6 +939,9 @@ main( int argc, char **argv ) {
         if ( strcmp( argv[1], "gen15" ) == 0 ) {
             mode = 16;
         }
+        if ( strcmp( argv[1], "bench" ) == 0 ) {
+            mode = 17;
+        }
     }
 
     if ( argc == 3 && mode == 0 ) {
@@ -1085,6 +1154,17 @@ main( int argc, char **argv ) {
             }
             exit( 0 );
         }
+        if ( mode == 17 ) {
+            if ( argc < 3 ) {
+                printf( "usage: test_genq bench collection [maxRows]\n" );
+                exit( 1 );
+            }
+            status = doBench( argv[2], argc > 3 ? argv[3] : NULL );
+            if ( status < 0 ) {
+                exit( 2 );
+            }
+            exit( 0 );
+        }
 
         genQueryInp.maxRows = 2;
         i = chlGenQuery( genQueryInp, &result );
@@ -1,5 +1,7 @@
 #include "irods_create_write_replicator.hpp"
 
+#include "irods_repl_worker_pool.hpp"
+
 #include "dataObjRepl.h"
 #include "irods_stacktrace.hpp"
 
@@ -8,10 +10,12 @@ namespace irods {
     create_write_replicator::create_write_replicator(
         const std::string& _root_resource,
         const std::string& _current_resource,
-        const std::string& _child ) {
+        const std::string& _child,
+        int _fan_out ) {
         root_resource_ = _root_resource;
         current_resource_ = _current_resource;
         child_ = _child;
+        fan_out_ = _fan_out;
     }
 
     create_write_replicator::~create_write_replicator( void ) {
@@ -35,10 +39,10 @@ namespace irods {
             child_parser.str( sub_hier, current_resource_ );
 
             file_object object = _object_oper.object();
+            std::vector< std::string > hierarchies;
+            std::vector< dataObjInp_t > inps;
             child_list_t::const_iterator it;
-            int sibling_count = 0;
             for ( it = _siblings.begin(); it != _siblings.end(); ++it ) {
-                ++sibling_count;
                 hierarchy_parser sibling = *it;
                 std::string hierarchy_string;
                 error ret = sibling.str( hierarchy_string );
@@ -55,36 +59,48 @@ namespace irods {
                     addKeyVal( &dataObjInp.condInput, DEST_RESC_NAME_KW, root_resource_.c_str() );
                     addKeyVal( &dataObjInp.condInput, IN_PDMO_KW, sub_hier.c_str() );
 
-                    transferStat_t* trans_stat = NULL;
-                    int status = rsDataObjRepl( _ctx.comm(), &dataObjInp, &trans_stat );
-                    char* sys_error = NULL;
-                    const char* rods_error = rodsErrorName( status, &sys_error );
-                    result = ASSERT_ERROR( status >= 0, status, "Failed to replicate the data object: \"%s\" from resource: \"%s\" "
-                                           "to sibling: \"%s\" - %s %s.", object.logical_path().c_str(), child_.c_str(),
-                                           hierarchy_string.c_str(), rods_error, sys_error );
-                    free( sys_error );
-
-                    if ( trans_stat != NULL ) {
-                        free( trans_stat );
-                    }
-
-                    // cache last error to return, log it and add it to the
-                    // client side error stack
-                    if ( !result.ok() ) {
-                        last_error = result;
-                        irods::log( result );
-                        addRErrorMsg(
-                            &_ctx.comm()->rError,
-                            result.code(),
-                            result.result().c_str() );
-                        result = SUCCESS();
-
-                    }
+                    hierarchies.push_back( hierarchy_string );
+                    inps.push_back( dataObjInp );
 
                 } // if hier str
 
             } // for it
 
+            // =-=-=-=-=-=-=-
+            // replicate to up to fan_out_ siblings at once
+            std::vector< dataObjInp_t* > inp_ptrs;
+            for ( size_t i = 0; i < inps.size(); ++i ) {
+                inp_ptrs.push_back( &inps[ i ] );
+            }
+            std::vector< int > statuses;
+            repl_worker_pool pool( _ctx.comm(), inps.size() > 1 ? fan_out_ : 1 );
+            pool.replicate( inp_ptrs, statuses );
+
+            for ( size_t i = 0; i < inps.size(); ++i ) {
+                int status = statuses[ i ];
+                char* sys_error = NULL;
+                const char* rods_error = rodsErrorName( status, &sys_error );
+                result = ASSERT_ERROR( status >= 0, status, "Failed to replicate the data object: \"%s\" from resource: \"%s\" "
+                                       "to sibling: \"%s\" - %s %s.", object.logical_path().c_str(), child_.c_str(),
+                                       hierarchies[ i ].c_str(), rods_error, sys_error );
+                free( sys_error );
+                clearKeyVal( &inps[ i ].condInput );
+
+                // cache last error to return, log it and add it to the
+                // client side error stack
+                if ( !result.ok() ) {
+                    last_error = result;
+                    irods::log( result );
+                    addRErrorMsg(
+                        &_ctx.comm()->rError,
+                        result.code(),
+                        result.result().c_str() );
+                    result = SUCCESS();
+
+                }
+
+            } // for i
+
         } // if ok
 
         if ( !last_error.ok() ) {
@@ -15,7 +15,8 @@ namespace irods {
             create_write_replicator(
                 const std::string& _root_resource,    // The name of the resource at the root of the hierarchy
                 const std::string& _current_resource, // The name of the resource at this level of hierarchy
-                const std::string& _child );          // The hierarchy of the child.
+                const std::string& _child,            // The hierarchy of the child.
+                int _fan_out = 1 );                   // The number of siblings to replicate to at once.
             virtual ~create_write_replicator( void );
 
             error replicate( resource_plugin_context& _ctx, const child_list_t& _siblings, const object_oper& _object_oper );
@@ -24,6 +25,7 @@ namespace irods {
             std::string root_resource_;
             std::string current_resource_;
             std::string child_;
+            int         fan_out_;
     };
 }; // namespace irods
 
@@ -10,21 +10,29 @@
 // irods includes
 #include "dataObjRepl.h"
 #include "genQuery.h"
+#include "modAVUMetadata.h"
+#include "rcMisc.h"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <algorithm>
+#include <map>
+#include <sstream>
 
 namespace irods {
 /// =-=-=-=-=-=-=-
-/// @brief local function to replicate a new copy for
-///        proc_results_for_rebalance
+/// @brief local function to build the input to replicate a new
+///        copy for proc_results_for_rebalance
     static
-    error repl_for_rebalance(
-        rsComm_t*          _comm,
+    void make_repl_inp_for_rebalance(
         const std::string& _obj_path,
         const std::string& _current_resc,
         const std::string& _src_hier,
         const std::string& _dst_hier,
         const std::string& _src_resc,
         const std::string& _dst_resc,
-        int                _mode ) {
+        int                _mode,
+        dataObjInp_t&      _data_obj_inp ) {
         // =-=-=-=-=-=-=-
         // generate a resource hierachy that ends at this resource for pdmo
         hierarchy_parser parser;
@@ -35,33 +43,17 @@ namespace irods {
         // =-=-=-=-=-=-=-
         // create a data obj input struct to call rsDataObjRepl which given
         // the _stage_sync_kw will either stage or sync the data object
-        dataObjInp_t data_obj_inp;
-        bzero( &data_obj_inp, sizeof( data_obj_inp ) );
-        rstrcpy( data_obj_inp.objPath, _obj_path.c_str(), MAX_NAME_LEN );
-        data_obj_inp.createMode = _mode;
-        addKeyVal( &data_obj_inp.condInput, RESC_HIER_STR_KW,      _src_hier.c_str() );
-        addKeyVal( &data_obj_inp.condInput, DEST_RESC_HIER_STR_KW, _dst_hier.c_str() );
-        addKeyVal( &data_obj_inp.condInput, RESC_NAME_KW,          _src_resc.c_str() );
-        addKeyVal( &data_obj_inp.condInput, DEST_RESC_NAME_KW,     _dst_resc.c_str() );
-        addKeyVal( &data_obj_inp.condInput, IN_PDMO_KW,             sub_hier.c_str() );
-        addKeyVal( &data_obj_inp.condInput, ADMIN_KW,              "" );
-
-        // =-=-=-=-=-=-=-
-        // process the actual call for replication
-        transferStat_t* trans_stat = NULL;
-        int repl_stat = rsDataObjRepl( _comm, &data_obj_inp, &trans_stat );
-        free( trans_stat );
-        if ( repl_stat < 0 ) {
-            std::stringstream msg;
-            msg << "Failed to replicate the data object ["
-                << _obj_path
-                << "]";
-            return ERROR( repl_stat, msg.str() );
-        }
-
-        return SUCCESS();
-
-    } // repl_for_rebalance
+        bzero( &_data_obj_inp, sizeof( _data_obj_inp ) );
+        rstrcpy( _data_obj_inp.objPath, _obj_path.c_str(), MAX_NAME_LEN );
+        _data_obj_inp.createMode = _mode;
+        addKeyVal( &_data_obj_inp.condInput, RESC_HIER_STR_KW,      _src_hier.c_str() );
+        addKeyVal( &_data_obj_inp.condInput, DEST_RESC_HIER_STR_KW, _dst_hier.c_str() );
+        addKeyVal( &_data_obj_inp.condInput, RESC_NAME_KW,          _src_resc.c_str() );
+        addKeyVal( &_data_obj_inp.condInput, DEST_RESC_NAME_KW,     _dst_resc.c_str() );
+        addKeyVal( &_data_obj_inp.condInput, IN_PDMO_KW,             sub_hier.c_str() );
+        addKeyVal( &_data_obj_inp.condInput, ADMIN_KW,              "" );
+
+    } // make_repl_inp_for_rebalance
 
 /// =-=-=-=-=-=-=-
 /// @brief
@@ -70,6 +62,7 @@ namespace irods {
         const std::string& _parent_resc,
         const std::string& _child_resc,
         const int          _limit,
+        const rodsLong_t   _min_data_id,
         dist_child_result_t& _results ) {
         // =-=-=-=-=-=-=-
         // trap bad input
@@ -139,24 +132,33 @@ namespace irods {
                    "= '0'" );
 
         // =-=-=-=-=-=-=-
-        // request the resc hier
+        // add condition string to start after the last data id
+        std::stringstream id_cond;
+        id_cond << "> '" << _min_data_id << "'";
+        addInxVal( &gen_inp.sqlCondInp,
+                   COL_D_DATA_ID,
+                   id_cond.str().c_str() );
+
+        // =-=-=-=-=-=-=-
+        // request the data ids in order
         addInxIval( &gen_inp.selectInp,
-                    COL_D_DATA_ID, 1 );
+                    COL_D_DATA_ID, ORDER_BY );
 
         // =-=-=-=-=-=-=-
         // execute the query
         int status = rsGenQuery( _comm, &gen_inp, &gen_out );
-        clearGenQueryInp( &gen_inp );
         if ( CAT_NO_ROWS_FOUND == status ) {
             // =-=-=-=-=-=-=-
             // hopefully there are no dirty data objects
             // and this is the typical code path
-			freeGenQueryOut( &gen_out );
+            clearGenQueryInp( &gen_inp );
+            freeGenQueryOut( &gen_out );
             return SUCCESS();
 
         }
         else if ( status < 0 || 0 == gen_out ) {
-			freeGenQueryOut( &gen_out );
+            clearGenQueryInp( &gen_inp );
+            freeGenQueryOut( &gen_out );
             return ERROR( status, "genQuery failed." );
 
         }
@@ -165,7 +167,8 @@ namespace irods {
         // extract result
         sqlResult_t* data_id_results = getSqlResultByInx( gen_out, COL_D_DATA_ID );
         if ( !data_id_results ) {
-			freeGenQueryOut( &gen_out );
+            clearGenQueryInp( &gen_inp );
+            freeGenQueryOut( &gen_out );
             return ERROR(
                        SYS_INTERNAL_NULL_INPUT_ERR,
                        "null resc_hier result" );
@@ -177,14 +180,23 @@ namespace irods {
             // =-=-=-=-=-=-=-
             // get its value
             char* data_id_ptr = &data_id_results->value[ data_id_results->len * i ];
-            int data_id = atoi( data_id_ptr );
+            rodsLong_t data_id = strtoll( data_id_ptr, 0, 0 );
 
             // =-=-=-=-=-=-=-
             // capture the result
             _results.push_back( data_id );
 
         } // for i
-			
+
+        // =-=-=-=-=-=-=-
+        // only the first page is wanted, close the statement
+        if ( gen_out->continueInx > 0 ) {
+            gen_inp.continueInx = gen_out->continueInx;
+            gen_inp.maxRows     = 0;
+            freeGenQueryOut( &gen_out );
+            rsGenQuery( _comm, &gen_inp, &gen_out );
+        }
+        clearGenQueryInp( &gen_inp );
         freeGenQueryOut( &gen_out );
 
         return SUCCESS();
@@ -192,26 +204,40 @@ namespace irods {
     } // gather_dirty_replicas_for_child
 
 /// =-=-=-=-=-=-=-
-/// @brief
+/// @brief the attributes of a good replica from which to replicate
+    struct source_data_object {
+        std::string obj_path;
+        std::string resc_hier;
+        int         data_mode;
+        rodsLong_t  data_size;
+    };
+
+    typedef std::map< rodsLong_t, source_data_object > source_map_t;
+
+/// =-=-=-=-=-=-=-
+/// @brief number of data ids in each catalog query for source replicas
+    static const size_t SOURCE_QUERY_BATCH = 100;
+
+/// =-=-=-=-=-=-=-
+/// @brief query the source replica attributes for a batch of data ids
+///        at once rather than once per data object
     error get_source_data_object_attributes(
-        const int          _data_id,
-        const std::string& _parent,
-        rsComm_t*          _comm,
-        std::string&       _obj_path,
-        std::string&       _resc_hier,
-        int&               _data_mode ) {
+        const dist_child_result_t& _data_ids,
+        size_t                     _begin,
+        size_t                     _end,
+        const std::string&         _parent,
+        rsComm_t*                  _comm,
+        source_map_t&              _sources ) {
         // =-=-=-=-=-=-=-
         // param check
-        if ( _data_id <= 0 ) {
-            return ERROR(
-                       SYS_INVALID_INPUT_PARAM,
-                       "invalid data id" );
-        }
-        else if ( !_comm ) {
+        if ( !_comm ) {
             return ERROR(
                        SYS_INVALID_INPUT_PARAM,
                        "null comm pointer" );
         }
+        else if ( _begin >= _end ) {
+            return SUCCESS();
+        }
 
         // =-=-=-=-=-=-=-
         // gen query objects
@@ -222,17 +248,20 @@ namespace irods {
         gen_inp.maxRows = MAX_SQL_ROWS;
 
         // =-=-=-=-=-=-=-
-        // add condition string matching data id
+        // add condition string matching the data ids
         std::stringstream id_str;
-        id_str << _data_id;
-        std::string cond_str = "='" + id_str.str() + "'";
+        id_str << "in (";
+        for ( size_t i = _begin; i < _end; ++i ) {
+            id_str << ( i == _begin ? "'" : ", '" ) << _data_ids[ i ] << "'";
+        }
+        id_str << ")";
         addInxVal( &gen_inp.sqlCondInp,
                    COL_D_DATA_ID,
-                   cond_str.c_str() );
+                   id_str.str().c_str() );
 
         // =-=-=-=-=-=-=-
         // add condition string matching resc hier parent
-        cond_str = "like '" + _parent + ";%' || like '%;" + _parent + ";%' || like '%;" + _parent + "'";
+        std::string cond_str = "like '" + _parent + ";%' || like '%;" + _parent + ";%' || like '%;" + _parent + "'";
         addInxVal( &gen_inp.sqlCondInp,
                    COL_D_RESC_HIER,
                    cond_str.c_str() );
@@ -244,7 +273,9 @@ namespace irods {
                    "= '1'" );
 
         // =-=-=-=-=-=-=-
-        // request the data name, coll name, resc hier, mode
+        // request the data id, data name, coll name, resc hier, mode, size
+        addInxIval( &gen_inp.selectInp,
+                    COL_D_DATA_ID, 1 );
         addInxIval( &gen_inp.selectInp,
                     COL_DATA_NAME, 1 );
         addInxIval( &gen_inp.selectInp,
@@ -253,109 +284,66 @@ namespace irods {
                     COL_D_RESC_HIER, 1 );
         addInxIval( &gen_inp.selectInp,
                     COL_DATA_MODE, 1 );
+        addInxIval( &gen_inp.selectInp,
+                    COL_DATA_SIZE, 1 );
 
         // =-=-=-=-=-=-=-
-        // execute the query
+        // execute the query, paging through the results
         int status = rsGenQuery( _comm, &gen_inp, &gen_out );
-        clearGenQueryInp( &gen_inp );
-        if ( status < 0 || 0 == gen_out ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       status,
-                       "genQuery failed." );
-        }
-
-        // =-=-=-=-=-=-=-
-        // extract result
-        sqlResult_t* data_name_result = getSqlResultByInx( gen_out, COL_DATA_NAME );
-        if ( !data_name_result ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       UNMATCHED_KEY_OR_INDEX,
-                       "null data_name sql result" );
-        }
-
-        // =-=-=-=-=-=-=-
-        // get its value
-        char* data_name_ptr = &data_name_result->value[ 0 ];//data_name_result->len ];
-        if ( !data_name_ptr ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       SYS_INTERNAL_NULL_INPUT_ERR,
-                       "null data_name_ptr result" );
-        }
-        std::string data_name = data_name_ptr;
-
-        // =-=-=-=-=-=-=-
-        // extract result
-        sqlResult_t* coll_name_result = getSqlResultByInx( gen_out, COL_COLL_NAME );
-        if ( !coll_name_result ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       UNMATCHED_KEY_OR_INDEX,
-                       "null coll_name sql result" );
-        }
-
-        // =-=-=-=-=-=-=-
-        // get its value
-        char* coll_name_ptr = &coll_name_result->value[ 0 ];//coll_name_result->len ];
-        if ( !coll_name_ptr ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       SYS_INTERNAL_NULL_INPUT_ERR,
-                       "null coll_name_ptr result" );
-        }
-        std::string coll_name = coll_name_ptr;
+        while ( status >= 0 && gen_out ) {
+            sqlResult_t* data_id_result   = getSqlResultByInx( gen_out, COL_D_DATA_ID );
+            sqlResult_t* data_name_result = getSqlResultByInx( gen_out, COL_DATA_NAME );
+            sqlResult_t* coll_name_result = getSqlResultByInx( gen_out, COL_COLL_NAME );
+            sqlResult_t* resc_hier_result = getSqlResultByInx( gen_out, COL_D_RESC_HIER );
+            sqlResult_t* data_mode_result = getSqlResultByInx( gen_out, COL_DATA_MODE );
+            sqlResult_t* data_size_result = getSqlResultByInx( gen_out, COL_DATA_SIZE );
+            if ( !data_id_result   ||
+                    !data_name_result ||
+                    !coll_name_result ||
+                    !resc_hier_result ||
+                    !data_mode_result ||
+                    !data_size_result ) {
+                freeGenQueryOut( &gen_out );
+                clearGenQueryInp( &gen_inp );
+                return ERROR(
+                           UNMATCHED_KEY_OR_INDEX,
+                           "null sql result" );
+            }
 
-        // =-=-=-=-=-=-=-
-        // extract result
-        sqlResult_t* resc_hier_result = getSqlResultByInx( gen_out, COL_D_RESC_HIER );
-        if ( !resc_hier_result ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       UNMATCHED_KEY_OR_INDEX,
-                       "null resc_hier sql result" );
-        }
+            // =-=-=-=-=-=-=-
+            // keep the first good replica found for each data id
+            for ( int i = 0; i < gen_out->rowCnt; ++i ) {
+                rodsLong_t data_id = strtoll( &data_id_result->value[ data_id_result->len * i ], 0, 0 );
+                if ( _sources.find( data_id ) != _sources.end() ) {
+                    continue;
+                }
+
+                source_data_object& src = _sources[ data_id ];
+                src.obj_path  = std::string( &coll_name_result->value[ coll_name_result->len * i ] ) +
+                                get_virtual_path_separator() +
+                                &data_name_result->value[ data_name_result->len * i ];
+                src.resc_hier = &resc_hier_result->value[ resc_hier_result->len * i ];
+                src.data_mode = atoi( &data_mode_result->value[ data_mode_result->len * i ] );
+                src.data_size = strtoll( &data_size_result->value[ data_size_result->len * i ], 0, 0 );
+            }
 
-        // =-=-=-=-=-=-=-
-        // get its value
-        char* resc_hier_ptr = &resc_hier_result->value[ 0 ];//resc_hier_result->len ];
-        if ( !resc_hier_ptr ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       SYS_INTERNAL_NULL_INPUT_ERR,
-                       "null resc_hier_ptr result" );
-        }
+            gen_inp.continueInx = gen_out->continueInx;
+            freeGenQueryOut( &gen_out );
+            if ( gen_inp.continueInx <= 0 ) {
+                break;
+            }
 
-        // =-=-=-=-=-=-=-
-        // extract result
-        sqlResult_t* data_mode_result = getSqlResultByInx( gen_out, COL_DATA_MODE );
-        if ( !data_mode_result ) {
-			freeGenQueryOut( &gen_out );
-            return ERROR(
-                       UNMATCHED_KEY_OR_INDEX,
-                       "null data_mode sql result" );
+            status = rsGenQuery( _comm, &gen_inp, &gen_out );
         }
 
-        // =-=-=-=-=-=-=-
-        // get its value
-        char* data_mode_ptr = &data_mode_result->value[ 0 ];//data_mode_result->len ];
-        if ( !data_mode_ptr ) {
-			freeGenQueryOut( &gen_out );
+        clearGenQueryInp( &gen_inp );
+        freeGenQueryOut( &gen_out );
+        if ( status < 0 && CAT_NO_ROWS_FOUND != status ) {
             return ERROR(
-                       SYS_INTERNAL_NULL_INPUT_ERR,
-                       "null data_mode_ptr result" );
+                       status,
+                       "genQuery failed." );
         }
 
-        // =-=-=-=-=-=-=-
-        // set the out variables
-        _obj_path  = coll_name                    +
-                     get_virtual_path_separator() +
-                     data_name;
-        _resc_hier = resc_hier_ptr;
-        _data_mode = atoi( data_mode_ptr );
-
-        freeGenQueryOut( &gen_out );
         return SUCCESS();
 
     } // get_source_data_object_attributes
@@ -368,6 +356,7 @@ namespace irods {
         const std::string&   _parent_resc,
         const std::string&   _child_resc,
         const int            _limit,
+        const rodsLong_t     _min_data_id,
         dist_child_result_t& _results ) {
         // =-=-=-=-=-=-=-
         // clear incoming result set
@@ -380,34 +369,138 @@ namespace irods {
                         _parent_resc,
                         _child_resc,
                         _limit,
+                        _min_data_id,
                         _results );
         if ( !ret.ok() ) {
             return PASS( ret );
         }
 
-        // =-=-=-=-=-=-=-
-        // compute remaining limit as the difference between the
-        // original limit and the number of results;
-        int mod_limit = _limit - _results.size();
-
         // =-=-=-=-=-=-=-
         // query for remaining items which need re-replicated to this child
         int query_status = chlGetDistinctDataObjsMissingFromChildGivenParent(
                                _parent_resc,
                                _child_resc,
-                               mod_limit,
-                               _results );
+                               _limit,
+                               _results,
+                               _min_data_id );
         if ( CAT_NO_ROWS_FOUND != query_status ) {
             return ERROR(
                        query_status,
                        "chlGetDistinctDataObjsMissingFromChildGivenParent failed." );
         }
 
+        // =-=-=-=-=-=-=-
+        // both sets are in order of data id, so keep the lowest _limit
+        // of the two.  anything past the last kept data id is picked
+        // up by the next call
+        std::sort( _results.begin(), _results.end() );
+        _results.erase(
+            std::unique( _results.begin(), _results.end() ),
+            _results.end() );
+        if ( _results.size() > static_cast< size_t >( _limit ) ) {
+            _results.resize( _limit );
+        }
 
         return SUCCESS();
 
     } // gather_data_objects_for_rebalance
 
+/// =-=-=-=-=-=-=-
+/// @brief resolve the hierarchy in the child to which a source
+///        replica should be replicated
+    static
+    error resolve_dest_hier_for_rebalance(
+        rsComm_t*                 _comm,
+        const std::string&        _parent_resc_name,
+        const std::string&        _child_resc_name,
+        const source_data_object& _src,
+        std::string&              _root_resc,
+        std::string&              _dst_hier ) {
+        // =-=-=-=-=-=-=-
+        // create a file object so we can resolve a valid
+        // hierarchy to which to replicate
+        file_object_ptr f_ptr( new file_object(
+                                   _comm,
+                                   _src.obj_path,
+                                   "",
+                                   "",
+                                   0,
+                                   _src.data_mode,
+                                   0 ) );
+        // =-=-=-=-=-=-=-
+        // short circuit the magic re-repl
+        hierarchy_parser sub_parser;
+        sub_parser.set_string( _src.resc_hier );
+        std::string sub_hier;
+        sub_parser.str( sub_hier, _parent_resc_name );
+        f_ptr->in_pdmo( sub_hier );
+
+        // =-=-=-=-=-=-=-
+        // init the parser with the fragment of the
+        // upstream hierarchy not including the repl
+        // node as it should add itself
+        hierarchy_parser parser;
+        size_t pos = _src.resc_hier.find( _parent_resc_name );
+        if ( std::string::npos == pos ) {
+            std::stringstream msg;
+            msg << "missing repl name ["
+                << _parent_resc_name
+                << "] in source hier string ["
+                << _src.resc_hier
+                << "]";
+            return ERROR(
+                       SYS_INVALID_INPUT_PARAM,
+                       msg.str() );
+        }
+
+        // =-=-=-=-=-=-=-
+        // substring hier from the root to the parent resc
+        std::string src_frag = _src.resc_hier.substr(
+                                   0, pos + _parent_resc_name.size() + 1 );
+        parser.set_string( src_frag );
+
+        // =-=-=-=-=-=-=-
+        // handy reference to root resc name
+        parser.first_resc( _root_resc );
+
+        // =-=-=-=-=-=-=-
+        // resolve the target child resource plugin
+        resource_ptr dst_resc;
+        error r_err = resc_mgr.resolve(
+                          _child_resc_name,
+                          dst_resc );
+        if ( !r_err.ok() ) {
+            return PASS( r_err );
+        }
+
+        // =-=-=-=-=-=-=-
+        // then we need to query the target resource and ask
+        // it to determine a dest resc hier for the repl
+        std::string host_name;
+        float            vote = 0.0;
+        r_err = dst_resc->call < const std::string*,
+        const std::string*,
+        hierarchy_parser*,
+        float* > (
+            _comm,
+            RESOURCE_OP_RESOLVE_RESC_HIER,
+            f_ptr,
+            &CREATE_OPERATION,
+            &host_name,
+            &parser,
+            &vote );
+        if ( !r_err.ok() ) {
+            return PASS( r_err );
+        }
+
+        // =-=-=-=-=-=-=-
+        // extract the hier from the parser
+        parser.str( _dst_hier );
+
+        return SUCCESS();
+
+    } // resolve_dest_hier_for_rebalance
+
 /// =-=-=-=-=-=-=-
 /// @brief high level function which process a result set from
 ///        the above gathering function for a rebalancing operation
@@ -415,7 +508,9 @@ namespace irods {
         rsComm_t*                  _comm,
         const std::string&         _parent_resc_name,
         const std::string&         _child_resc_name,
-        const dist_child_result_t& _results ) {
+        const dist_child_result_t& _results,
+        repl_worker_pool&          _pool,
+        rebalance_stats&           _stats ) {
         // =-=-=-=-=-=-=-
         // check incoming params
         if ( !_comm ) {
@@ -440,130 +535,197 @@ namespace irods {
         }
 
         // =-=-=-=-=-=-=-
-        // iterate over the result set and repl the objects
-        dist_child_result_t::const_iterator r_itr = _results.begin();
-        for ( ; r_itr != _results.end(); ++r_itr ) {
-            // =-=-=-=-=-=-=-
-            // get a valid source object from which to replicate
-            int src_mode = 0;
-            std::string obj_path, src_hier;
+        // get a valid source replica for each data object, a batch
+        // of data ids per query
+        source_map_t sources;
+        for ( size_t i = 0; i < _results.size(); i += SOURCE_QUERY_BATCH ) {
             error ret = get_source_data_object_attributes(
-                            *r_itr,
+                            _results,
+                            i,
+                            std::min( i + SOURCE_QUERY_BATCH, _results.size() ),
                             _parent_resc_name,
                             _comm,
-                            obj_path,
-                            src_hier,
-                            src_mode );
+                            sources );
             if ( !ret.ok() ) {
                 return PASS( ret );
             }
+        }
 
-            // =-=-=-=-=-=-=-
-            // create a file object so we can resolve a valid
-            // hierarchy to which to replicate
-            file_object_ptr f_ptr( new file_object(
-                                       _comm,
-                                       obj_path,
-                                       "",
-                                       "",
-                                       0,
-                                       src_mode,
-                                       0 ) );
-            // =-=-=-=-=-=-=-
-            // short circuit the magic re-repl
-            hierarchy_parser sub_parser;
-            sub_parser.set_string( src_hier );
-            std::string sub_hier;
-            sub_parser.str( sub_hier, _parent_resc_name );
-            f_ptr->in_pdmo( sub_hier );
+        // =-=-=-=-=-=-=-
+        // build the replication inputs.  resolving the destination
+        // uses this agent's plugins so it is done here rather than
+        // in the workers
+        std::vector< dataObjInp_t > inps;
+        std::vector< rodsLong_t >   sizes;
+        inps.reserve( _results.size() );
+        dist_child_result_t::const_iterator r_itr = _results.begin();
+        for ( ; r_itr != _results.end(); ++r_itr ) {
+            source_map_t::const_iterator s_itr = sources.find( *r_itr );
+            if ( s_itr == sources.end() ) {
+                rodsLog(
+                    LOG_NOTICE,
+                    "proc_results_for_rebalance - no good replica of data id [%lld] in [%s]",
+                    *r_itr,
+                    _parent_resc_name.c_str() );
+                _stats.failures++;
+                _stats.status = SYS_INVALID_INPUT_PARAM;
+                continue;
+            }
+
+            std::string root_resc, dst_hier;
+            error ret = resolve_dest_hier_for_rebalance(
+                            _comm,
+                            _parent_resc_name,
+                            _child_resc_name,
+                            s_itr->second,
+                            root_resc,
+                            dst_hier );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                _stats.failures++;
+                _stats.status = ret.code();
+                continue;
+            }
 
             // =-=-=-=-=-=-=-
-            // init the parser with the fragment of the
-            // upstream hierarchy not including the repl
-            // node as it should add itself
-            hierarchy_parser parser;
-            size_t pos = src_hier.find( _parent_resc_name );
-            if ( std::string::npos == pos ) {
+            // now that we have all the pieces in place, set up
+            // the replication
+            inps.push_back( dataObjInp_t() );
+            make_repl_inp_for_rebalance(
+                s_itr->second.obj_path,
+                _parent_resc_name,
+                s_itr->second.resc_hier,
+                dst_hier,
+                root_resc,
+                root_resc,
+                s_itr->second.data_mode,
+                inps.back() );
+            sizes.push_back( s_itr->second.data_size );
+
+        } // for r_itr
+
+        // =-=-=-=-=-=-=-
+        // actually do the replication
+        std::vector< dataObjInp_t* > inp_ptrs;
+        for ( size_t i = 0; i < inps.size(); ++i ) {
+            inp_ptrs.push_back( &inps[ i ] );
+        }
+        std::vector< int > statuses;
+        _pool.replicate( inp_ptrs, statuses );
+
+        for ( size_t i = 0; i < inps.size(); ++i ) {
+            if ( statuses[ i ] < 0 ) {
                 std::stringstream msg;
-                msg << "missing repl name ["
-                    << _parent_resc_name
-                    << "] in source hier string ["
-                    << src_hier
+                msg << "Failed to replicate the data object ["
+                    << inps[ i ].objPath
                     << "]";
-                return ERROR(
-                           SYS_INVALID_INPUT_PARAM,
-                           msg.str() );
+                irods::log( ERROR( statuses[ i ], msg.str() ) );
+                _stats.failures++;
+                _stats.status = statuses[ i ];
             }
+            else {
+                _stats.objects++;
+                _stats.bytes += sizes[ i ];
+            }
+            clearKeyVal( &inps[ i ].condInput );
+        }
 
-            // =-=-=-=-=-=-=-
-            // substring hier from the root to the parent resc
-            std::string src_frag = src_hier.substr(
-                                       0, pos + _parent_resc_name.size() + 1 );
-            parser.set_string( src_frag );
+        return SUCCESS();
 
-            // =-=-=-=-=-=-=-
-            // handy reference to root resc name
-            std::string root_resc;
-            parser.first_resc( root_resc );
+    } // proc_results_for_rebalance
 
-            // =-=-=-=-=-=-=-
-            // resolve the target child resource plugin
-            resource_ptr dst_resc;
-            error r_err = resc_mgr.resolve(
-                              _child_resc_name,
-                              dst_resc );
-            if ( !r_err.ok() ) {
-                return PASS( r_err );
-            }
+/// =-=-=-=-=-=-=-
+/// @brief the resource metadata attribute holding the checkpoint
+///        for a child of a replication resource
+    static
+    std::string rebalance_checkpoint_attr(
+        const std::string& _child_resc_name ) {
+        return "irods::rebalance_checkpoint::" + _child_resc_name;
 
-            // =-=-=-=-=-=-=-
-            // then we need to query the target resource and ask
-            // it to determine a dest resc hier for the repl
-            std::string host_name;
-            float            vote = 0.0;
-            r_err = dst_resc->call < const std::string*,
-            const std::string*,
-            hierarchy_parser*,
-            float* > (
-                _comm,
-                RESOURCE_OP_RESOLVE_RESC_HIER,
-                f_ptr,
-                &CREATE_OPERATION,
-                &host_name,
-                &parser,
-                &vote );
-            if ( !r_err.ok() ) {
-                return PASS( r_err );
-            }
+    } // rebalance_checkpoint_attr
 
-            // =-=-=-=-=-=-=-
-            // extract the hier from the parser
-            std::string dst_hier;
-            parser.str( dst_hier );
+    error get_rebalance_checkpoint(
+        rsComm_t*          _comm,
+        const std::string& _parent_resc_name,
+        const std::string& _child_resc_name,
+        rodsLong_t&        _data_id ) {
+        _data_id = 0;
 
-            // =-=-=-=-=-=-=-
-            // now that we have all the pieces in place, actually
-            // do the replication
-            r_err = repl_for_rebalance(
-                        _comm,
-                        obj_path,
-                        _parent_resc_name,
-                        src_hier,
-                        dst_hier,
-                        root_resc,
-                        root_resc,
-                        src_mode );
-            if ( !r_err.ok() ) {
-                return PASS( r_err );
-            }
+        genQueryOut_t* gen_out = 0;
+        genQueryInp_t  gen_inp;
+        memset( &gen_inp, 0, sizeof( gen_inp ) );
+        gen_inp.maxRows = 1;
 
-        } // for r_itr
+        std::string resc_cond = "= '" + _parent_resc_name + "'";
+        addInxVal( &gen_inp.sqlCondInp,
+                   COL_R_RESC_NAME,
+                   resc_cond.c_str() );
+        std::string attr_cond = "= '" + rebalance_checkpoint_attr( _child_resc_name ) + "'";
+        addInxVal( &gen_inp.sqlCondInp,
+                   COL_META_RESC_ATTR_NAME,
+                   attr_cond.c_str() );
+        addInxIval( &gen_inp.selectInp,
+                    COL_META_RESC_ATTR_VALUE, 1 );
+
+        int status = rsGenQuery( _comm, &gen_inp, &gen_out );
+        clearGenQueryInp( &gen_inp );
+        if ( CAT_NO_ROWS_FOUND == status ) {
+            freeGenQueryOut( &gen_out );
+            return SUCCESS();
+        }
+        else if ( status < 0 || 0 == gen_out ) {
+            freeGenQueryOut( &gen_out );
+            return ERROR( status, "genQuery failed." );
+        }
+
+        sqlResult_t* value_result = getSqlResultByInx( gen_out, COL_META_RESC_ATTR_VALUE );
+        if ( value_result && gen_out->rowCnt > 0 ) {
+            _data_id = strtoll( value_result->value, 0, 0 );
+        }
+        freeGenQueryOut( &gen_out );
 
         return SUCCESS();
 
-    } // proc_results_for_rebalance
+    } // get_rebalance_checkpoint
 
-}; // namespace irods
+    error set_rebalance_checkpoint(
+        rsComm_t*          _comm,
+        const std::string& _parent_resc_name,
+        const std::string& _child_resc_name,
+        rodsLong_t         _data_id ) {
+        std::string attr = rebalance_checkpoint_attr( _child_resc_name );
+        std::stringstream value;
+        value << _data_id;
+
+        modAVUMetadataInp_t avu_inp;
+        memset( &avu_inp, 0, sizeof( avu_inp ) );
+        avu_inp.arg1 = strdup( "-R" );
+        avu_inp.arg2 = strdup( _parent_resc_name.c_str() );
+        avu_inp.arg3 = strdup( attr.c_str() );
+        if ( _data_id > 0 ) {
+            avu_inp.arg0 = strdup( "set" );
+            avu_inp.arg4 = strdup( value.str().c_str() );
+            avu_inp.arg5 = strdup( "" );
+        }
+        else {
+            avu_inp.arg0 = strdup( "rmw" );
+            avu_inp.arg4 = strdup( "%" );
+        }
 
+        int status = rsModAVUMetadata( _comm, &avu_inp );
+        clearModAVUMetadataInp( &avu_inp );
+        if ( status < 0 && !( _data_id <= 0 && CAT_SUCCESS_BUT_WITH_NO_INFO == status ) ) {
+            std::stringstream msg;
+            msg << "failed to update the rebalance checkpoint ["
+                << attr
+                << "] on ["
+                << _parent_resc_name
+                << "]";
+            return ERROR( status, msg.str() );
+        }
 
+        return SUCCESS();
 
+    } // set_rebalance_checkpoint
+
+}; // namespace irods
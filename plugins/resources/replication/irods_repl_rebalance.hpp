@@ -3,6 +3,7 @@
 
 // =-=-=-=-=-=-=-
 #include "irods_error.hpp"
+#include "irods_repl_worker_pool.hpp"
 
 // =-=-=-=-=-=-=-
 // irods includes
@@ -15,25 +16,55 @@
 #include <utility>
 
 namespace irods {
+/// =-=-=-=-=-=-=-
+/// @brief running totals of a rebalance for the final report
+    struct rebalance_stats {
+        rodsLong_t objects;  // replicas made
+        rodsLong_t bytes;    // bytes replicated
+        rodsLong_t failures; // replicas which could not be made
+        int        status;   // status of the last failure
+        rebalance_stats() : objects( 0 ), bytes( 0 ), failures( 0 ), status( 0 ) {}
+    };
+
 /// =-=-=-=-=-=-=-
 /// @brief gather a limit bound result set of all data objects
-///        which need re-replicated
+///        which need re-replicated, in order of data id starting
+///        after the given data id
     error gather_data_objects_for_rebalance(
         rsComm_t*,              // comm object
         const std::string&,     // parent name
         const std::string&,     // child name
         const int,              // query limit
+        const rodsLong_t,       // last data id already processed
         dist_child_result_t& ); // result set
 /// =-=-=-=-=-=-=-
 /// @brief refresh a limit bound result set of all data objects
-///        which need re-replicated
+///        which need re-replicated.  failures are counted in the
+///        stats rather than stopping the rebalance
     irods::error proc_results_for_rebalance(
         rsComm_t*,                        // comm object
         const std::string&,               // parent resc name
         const std::string&,               // child resc name
-        const dist_child_result_t& );     // query results
+        const dist_child_result_t&,       // query results
+        repl_worker_pool&,                // workers doing the replication
+        rebalance_stats& );               // running totals
+/// =-=-=-=-=-=-=-
+/// @brief read the last data id processed by an interrupted
+///        rebalance of the child, 0 if there is none
+    error get_rebalance_checkpoint(
+        rsComm_t*,              // comm object
+        const std::string&,     // parent resc name
+        const std::string&,     // child resc name
+        rodsLong_t& );          // last data id processed
+/// =-=-=-=-=-=-=-
+/// @brief record the last data id processed for the child, or
+///        remove the record when the data id is 0
+    error set_rebalance_checkpoint(
+        rsComm_t*,              // comm object
+        const std::string&,     // parent resc name
+        const std::string&,     // child resc name
+        rodsLong_t );           // last data id processed
 
 }; // namespace irods
 
 #endif // _IRODS_REPL_REBALANCE_HPP_
-
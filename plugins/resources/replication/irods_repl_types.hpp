@@ -30,6 +30,7 @@ const std::string object_list_prop = "object_list";
 const std::string need_pdmo_prop = "Need_PDMO";
 const std::string hierarchy_prop = "hierarchy";
 const std::string operation_type_prop = "operation_type";
+const std::string fan_out_prop = "fan_out"; // also the context string key
 
 const std::string write_oper  = irods::WRITE_OPERATION;
 const std::string unlink_oper = irods::RESOURCE_OP_UNLINK;
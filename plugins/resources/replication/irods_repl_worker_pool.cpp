@@ -0,0 +1,203 @@
+// =-=-=-=-=-=-=-
+#include "irods_repl_worker_pool.hpp"
+
+// =-=-=-=-=-=-=-
+// irods includes
+#include "dataObjRepl.h"
+#include "rsGlobalExtern.hpp"
+#include "rodsLog.h"
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace irods {
+
+/// =-=-=-=-=-=-=-
+/// @brief the workers log in as the service account on behalf of the
+///        client user, which only gives the same permissions as this
+///        agent when the session is the service account itself.  a
+///        proxied session or one holding a ticket replicates in the agent
+    static bool plain_service_session(
+        rsComm_t* _comm ) {
+        return strcmp( _comm->clientUser.userName, _comm->proxyUser.userName ) == 0 &&
+               strcmp( _comm->clientUser.rodsZone, _comm->proxyUser.rodsZone ) == 0 &&
+               strcmp( _comm->clientUser.userName, _comm->myEnv.rodsUserName ) == 0 &&
+               strcmp( _comm->clientUser.rodsZone, _comm->myEnv.rodsZone ) == 0;
+
+    } // plain_service_session
+
+/// =-=-=-=-=-=-=-
+/// @brief take replications off the shared list until it is empty
+    static void repl_worker(
+        rcComm_t*                     _conn,
+        int&                          _failed,
+        std::vector< dataObjInp_t* >& _inps,
+        std::vector< int >&           _status,
+        size_t&                       _next,
+        boost::mutex&                 _mutex ) {
+        while ( true ) {
+            size_t idx = 0;
+            {
+                boost::mutex::scoped_lock lock( _mutex );
+                if ( _next >= _inps.size() ) {
+                    break;
+                }
+                idx = _next++;
+            }
+
+            transferStat_t* trans_stat = NULL;
+            int status = _rcDataObjRepl( _conn, _inps[ idx ], &trans_stat );
+            free( trans_stat );
+
+            boost::mutex::scoped_lock lock( _mutex );
+            _status[ idx ] = status;
+            if ( status < 0 ) {
+                // =-=-=-=-=-=-=-
+                // the connection may be out of step with its agent,
+                // leave the rest to the other workers
+                _failed = 1;
+                break;
+            }
+        }
+
+    } // repl_worker
+
+    repl_worker_pool::repl_worker_pool(
+        rsComm_t* _comm,
+        int       _size ) :
+        comm_( _comm ) {
+        if ( _size < 2 ) {
+            return;
+        }
+
+        if ( !plain_service_session( comm_ ) ) {
+            rodsLog( LOG_DEBUG, "repl_worker_pool - session is not the service account, replicating in this agent" );
+            return;
+        }
+
+        zoneInfo_t* zone_info = NULL;
+        int status = getLocalZoneInfo( &zone_info );
+        if ( status < 0 || LocalServerHost == NULL || LocalServerHost->hostName == NULL ) {
+            rodsLog( LOG_NOTICE, "repl_worker_pool - cannot connect to the local server, replicating in this agent" );
+            return;
+        }
+
+        // =-=-=-=-=-=-=-
+        // connect the same way as the server-to-server connections.
+        // this is done here rather than in the workers as the
+        // authentication plugins are not thread safe
+        for ( int i = 0; i < _size; ++i ) {
+            rErrMsg_t err_msg;
+            memset( &err_msg, 0, sizeof( err_msg ) );
+            rcComm_t* conn = _rcConnect(
+                                 LocalServerHost->hostName->name,
+                                 zone_info->portNum,
+                                 comm_->myEnv.rodsUserName,
+                                 comm_->myEnv.rodsZone,
+                                 comm_->clientUser.userName,
+                                 comm_->clientUser.rodsZone,
+                                 &err_msg,
+                                 comm_->connectCnt,
+                                 NO_RECONN );
+            if ( conn == NULL ) {
+                rodsLog( LOG_NOTICE, "repl_worker_pool - _rcConnect failed, status = %d", err_msg.status );
+                break;
+            }
+
+            status = clientLogin( conn );
+            if ( status < 0 ) {
+                rodsLog( LOG_NOTICE, "repl_worker_pool - clientLogin failed, status = %d", status );
+                rcDisconnect( conn );
+                break;
+            }
+
+            conns_.push_back( conn );
+        }
+
+        if ( conns_.size() < 2 ) {
+            disconnect();
+        }
+
+    } // ctor
+
+    repl_worker_pool::~repl_worker_pool( void ) {
+        // =-=-=-=-=-=-=-
+        // the connections live as long as the operation using the pool
+        disconnect();
+
+    } // dtor
+
+    void repl_worker_pool::disconnect( void ) {
+        for ( size_t i = 0; i < conns_.size(); ++i ) {
+            rcDisconnect( conns_[ i ] );
+        }
+        conns_.clear();
+
+    } // disconnect
+
+    size_t repl_worker_pool::size( void ) const {
+        return conns_.empty() ? 1 : conns_.size();
+
+    } // size
+
+    void repl_worker_pool::replicate(
+        std::vector< dataObjInp_t* >& _inps,
+        std::vector< int >&           _status ) {
+        _status.assign( _inps.size(), 0 );
+
+        if ( conns_.empty() || _inps.size() < 2 ) {
+            for ( size_t i = 0; i < _inps.size(); ++i ) {
+                transferStat_t* trans_stat = NULL;
+                _status[ i ] = rsDataObjRepl( comm_, _inps[ i ], &trans_stat );
+                free( trans_stat );
+            }
+            return;
+        }
+
+        size_t next = 0;
+        boost::mutex mutex;
+        boost::thread_group threads;
+        std::vector< int > failed( conns_.size(), 0 );
+        for ( size_t i = 1; i < conns_.size() && i < _inps.size(); ++i ) {
+            try {
+                threads.create_thread(
+                    boost::bind( repl_worker, conns_[ i ], boost::ref( failed[ i ] ), boost::ref( _inps ),
+                                 boost::ref( _status ), boost::ref( next ), boost::ref( mutex ) ) );
+            }
+            catch ( const boost::thread_resource_error& ) {
+                rodsLog( LOG_NOTICE, "repl_worker_pool - failed to create a replication thread" );
+                break;
+            }
+        }
+
+        // =-=-=-=-=-=-=-
+        // the first connection is worked from this thread
+        repl_worker( conns_[ 0 ], failed[ 0 ], _inps, _status, next, mutex );
+        threads.join_all();
+
+        // =-=-=-=-=-=-=-
+        // replications left when every worker stopped on a failure
+        for ( ; next < _inps.size(); ++next ) {
+            transferStat_t* trans_stat = NULL;
+            _status[ next ] = rsDataObjRepl( comm_, _inps[ next ], &trans_stat );
+            free( trans_stat );
+        }
+
+        // =-=-=-=-=-=-=-
+        // later calls do not use a connection a replication failed on
+        for ( size_t i = conns_.size(); i > 0; --i ) {
+            if ( failed[ i - 1 ] ) {
+                rcDisconnect( conns_[ i - 1 ] );
+                conns_.erase( conns_.begin() + ( i - 1 ) );
+            }
+        }
+        if ( conns_.size() < 2 ) {
+            disconnect();
+        }
+
+    } // replicate
+
+}; // namespace irods
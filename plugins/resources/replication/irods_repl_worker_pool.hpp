@@ -0,0 +1,52 @@
+#ifndef _IRODS_REPL_WORKER_POOL_HPP_
+#define _IRODS_REPL_WORKER_POOL_HPP_
+
+// =-=-=-=-=-=-=-
+// irods includes
+#include "rcConnect.h"
+#include "dataObjInpOut.h"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <string>
+#include <vector>
+
+namespace irods {
+
+    /**
+     * @brief Runs a set of replications over a pool of connections back to
+     *        the local server so they proceed concurrently.  The agent's own
+     *        rsComm and descriptor tables are not thread safe, so each
+     *        worker drives a separate agent.  The connections are closed
+     *        with the pool.  The workers log in as the service account, so
+     *        only a session of the service account itself uses them.  For
+     *        any other session, or with fewer than two connections, the
+     *        replications are run one at a time in this agent instead.
+     */
+    class repl_worker_pool {
+        public:
+            /// @brief ctor. Connects up to _size workers to the local server
+            repl_worker_pool(
+                rsComm_t* _comm,   // The comm of this agent
+                int       _size ); // The number of replications to run at once
+            ~repl_worker_pool( void );
+
+            /// @brief the number of replications that run at once
+            size_t size( void ) const;
+
+            /// @brief replicate each data object input, setting the status
+            ///        of each replication at the same index of _status
+            void replicate(
+                std::vector< dataObjInp_t* >& _inps,
+                std::vector< int >&           _status );
+
+        private:
+            void disconnect( void );
+
+            rsComm_t*                comm_;
+            std::vector< rcComm_t* > conns_;
+    };
+
+}; // namespace irods
+
+#endif // _IRODS_REPL_WORKER_POOL_HPP_
@@ -45,6 +45,7 @@
 #ifndef _WIN32
 #include <sys/file.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #endif
 #include <errno.h>
 #include <sys/stat.h>
@@ -95,6 +96,10 @@ extern "C" {
     /// @brief limit of the number of repls to operate upon during rebalance
     const int DEFAULT_LIMIT = 500;
 
+    /// =-=-=-=-=-=-=-
+    /// @brief number of repls to run at once during rebalance
+    const int DEFAULT_WORKERS = 1;
+
     // =-=-=-=-=-=-=-
     // 2. Define operations which will be called by the file*
     //    calls declared in server/driver/include/fileDriver.h
@@ -283,8 +288,12 @@ extern "C" {
                     std::string name;
                     ret = _ctx.prop_map().get<std::string>( irods::RESOURCE_NAME, name );
                     if ( ( result = ASSERT_PASS( ret, "Could not determine resource name." ) ).ok() ) {
+                        // replicate to up to fan_out siblings at once
+                        int fan_out = 1;
+                        _ctx.prop_map().get<int>( fan_out_prop, fan_out );
+
                         // create a create/write replicator
-                        irods::create_write_replicator oper_repl( root_resc, name, child );
+                        irods::create_write_replicator oper_repl( root_resc, name, child, fan_out );
 
                         // create a replicator
                         irods::replicator replicator( &oper_repl );
@@ -1582,8 +1591,9 @@ extern "C" {
         }
 
         // =-=-=-=-=-=-=-
-        // determine limit size
-        int limit = DEFAULT_LIMIT;
+        // determine limit size and number of workers
+        int limit   = DEFAULT_LIMIT;
+        int workers = DEFAULT_WORKERS;
         if ( !_ctx.rule_results().empty() ) {
             irods::kvp_map_t kvp;
             irods::error kvp_err = irods::parse_kvp_string(
@@ -1610,6 +1620,23 @@ extern "C" {
                 }
             }
 
+            std::string workers_str = kvp[ irods::REPL_WORKERS_KEY ];
+            if ( !workers_str.empty() ) {
+                try {
+                    workers = boost::lexical_cast<int>( workers_str );
+
+                }
+                catch ( const boost::bad_lexical_cast& ) {
+                    std::stringstream msg;
+                    msg << "failed to cast value ["
+                        << workers_str
+                        << "] to an integer";
+                    return ERROR(
+                               SYS_INVALID_INPUT_PARAM,
+                               msg.str() );
+                }
+            }
+
         } // if rule results not empty
 
         // =-=-=-=-=-=-=-
@@ -1627,6 +1654,13 @@ extern "C" {
             return ERROR( status, msg.str().c_str() );
         }
 
+        // =-=-=-=-=-=-=-
+        // the workers are shared by all of the children
+        irods::repl_worker_pool pool( _ctx.comm(), workers );
+        irods::rebalance_stats  stats;
+        struct timeval start_time;
+        gettimeofday( &start_time, NULL );
+
         // =-=-=-=-=-=-=-
         // iterate over the children, if one does not have a matching
         // distinct count then we need to rebalance
@@ -1635,8 +1669,30 @@ extern "C" {
                 c_itr != _ctx.child_map().end();
                 ++c_itr ) {
             // =-=-=-=-=-=-=-
-            // get list of distinct missing data ids or dirty repls, iterate
-            // until query fails - no more repls necessary for child
+            // pick up where an interrupted rebalance of this child
+            // left off
+            rodsLong_t last_data_id = 0;
+            irods::error cp_ret = irods::get_rebalance_checkpoint(
+                                      _ctx.comm(),
+                                      resc_name,
+                                      c_itr->first,
+                                      last_data_id );
+            if ( !cp_ret.ok() ) {
+                irods::log( PASS( cp_ret ) );
+            }
+            else if ( last_data_id > 0 ) {
+                rodsLog(
+                    LOG_NOTICE,
+                    "replRebalance - resuming rebalance of [%s] in [%s] after data id [%lld]",
+                    c_itr->first.c_str(),
+                    resc_name.c_str(),
+                    last_data_id );
+            }
+
+            // =-=-=-=-=-=-=-
+            // get list of distinct missing data ids or dirty repls in
+            // order of data id, until query fails - no more repls
+            // necessary for child
             dist_child_result_t results( 1 );
             while ( !results.empty() ) {
                 irods::error ga_ret = irods::gather_data_objects_for_rebalance(
@@ -1644,6 +1700,7 @@ extern "C" {
                                           resc_name,
                                           c_itr->first,
                                           limit,
+                                          last_data_id,
                                           results );
                 if ( ga_ret.ok() ) {
                     if ( !results.empty() ) {
@@ -1653,11 +1710,25 @@ extern "C" {
                                                     _ctx.comm(),  // comm ptr
                                                     resc_name,    // parent resc name
                                                     c_itr->first, // child resc name
-                                                    results );    // result set
+                                                    results,      // result set
+                                                    pool,         // workers
+                                                    stats );      // running totals
                         if ( !proc_ret.ok() ) {
                             return PASS( proc_ret );
                         }
 
+                        // =-=-=-=-=-=-=-
+                        // record how far we got
+                        last_data_id = results.back();
+                        cp_ret = irods::set_rebalance_checkpoint(
+                                     _ctx.comm(),
+                                     resc_name,
+                                     c_itr->first,
+                                     last_data_id );
+                        if ( !cp_ret.ok() ) {
+                            irods::log( PASS( cp_ret ) );
+                        }
+
                     } // if results
 
                 }
@@ -1668,8 +1739,51 @@ extern "C" {
 
             } // while
 
+            // =-=-=-=-=-=-=-
+            // this child is done, the next rebalance starts over
+            cp_ret = irods::set_rebalance_checkpoint(
+                         _ctx.comm(),
+                         resc_name,
+                         c_itr->first,
+                         0 );
+            if ( !cp_ret.ok() ) {
+                irods::log( PASS( cp_ret ) );
+            }
+
         } // for c_itr
 
+        // =-=-=-=-=-=-=-
+        // report the throughput
+        struct timeval end_time;
+        gettimeofday( &end_time, NULL );
+        double elapsed = ( end_time.tv_sec - start_time.tv_sec ) +
+                         ( end_time.tv_usec - start_time.tv_usec ) / 1000000.0;
+        double rate_elapsed = elapsed > 0.0 ? elapsed : 1.0;
+        std::stringstream report;
+        report << "rebalance of ["
+               << resc_name
+               << "] replicated "
+               << stats.objects
+               << " objects, "
+               << stats.bytes
+               << " bytes in "
+               << elapsed
+               << " seconds ( "
+               << stats.objects / rate_elapsed
+               << " objects/s, "
+               << stats.bytes / rate_elapsed
+               << " bytes/s ) with "
+               << pool.size()
+               << " workers, "
+               << stats.failures
+               << " failed";
+        rodsLog( LOG_NOTICE, "replRebalance - %s", report.str().c_str() );
+        addRErrorMsg( &_ctx.comm()->rError, 0, report.str().c_str() );
+
+        if ( stats.failures > 0 ) {
+            return ERROR( stats.status, report.str() );
+        }
+
         return SUCCESS();
 
     } // replRebalance
@@ -1728,6 +1842,36 @@ extern "C" {
                 const std::string& _inst_name,
                 const std::string& _context ) :
                 irods::resource( _inst_name, _context ) {
+                irods::kvp_map_t kvp_map;
+                if ( !_context.empty() ) {
+                    irods::error ret = irods::parse_kvp_string(
+                                           _context,
+                                           kvp_map );
+                    if ( !ret.ok() ) {
+                        irods::log( PASS( ret ) );
+
+                    }
+
+                    // =-=-=-=-=-=-=-
+                    // number of siblings a create or write is replicated
+                    // to at once, by default they are done one at a time
+                    if ( kvp_map.find( fan_out_prop ) != kvp_map.end() ) {
+                        try {
+                            int fan_out = boost::lexical_cast< int >( kvp_map[ fan_out_prop ] );
+                            properties_.set< int >( fan_out_prop, fan_out );
+                        }
+                        catch ( const boost::bad_lexical_cast& ) {
+                            std::stringstream msg;
+                            msg << "failed to cast fan_out ["
+                                << kvp_map[ fan_out_prop ]
+                                << "]";
+                            irods::log(
+                                ERROR(
+                                    SYS_INVALID_INPUT_PARAM,
+                                    msg.str() ) );
+                        }
+                    }
+                }
             } // ctor
 
             irods::error post_disconnect_maintenance_operation(
@@ -1549,6 +1549,11 @@ extern "C" {
         resc->set_property< int >( irods::RESOURCE_CHECK_PATH_PERM, 2 );//DO_CHK_PATH_PERM );
         resc->set_property< int >( irods::RESOURCE_CREATE_PATH,     1 );//CREATE_PATH );
 
+        // =-=-=-=-=-=-=-
+        // the file descriptor is a real unix fd, parallel transfers
+        // may move data with sendfile/splice rather than read/write
+        resc->set_property< int >( irods::RESOURCE_NATIVE_FD,       1 );
+
         // =-=-=-=-=-=-=-
         // 4c. return the pointer through the generic interface of an
         //     irods::resource pointer
@@ -184,6 +184,28 @@ class Test_Catalog(ResourceBase, unittest.TestCase):
         self.admin.assert_icommand("iquest \"%s %s\" \"select COLL_NAME where COLL_NAME like '%home%'\"",
                                    'STDERR_SINGLELINE', 'boost::too_few_args: format-string referred to more arguments than were passed')
 
+    def test_iquest_streamed_pages(self):
+        # more rows than one batch, so the server streams several batches
+        file_count = 600
+        dir_name = 'iquest_stream_dir'
+        dir_path = os.path.join(self.admin.local_session_dir, dir_name)
+        local_files = lib.make_large_local_tmp_dir(dir_path, file_count, 1)
+        self.admin.assert_icommand("iput -br " + dir_path)
+        query = "select DATA_NAME where COLL_NAME = '%s/%s'" % (self.admin.session_collection, dir_name)
+
+        # every row once, in as many batches as it takes
+        rc, stdout, stderr = self.admin.run_icommand(['iquest', '--no-page', '%s', query])
+        assert rc == 0, stderr
+        assert sorted(stdout.split()) == sorted(local_files)
+
+        # stop after the first batch, the rest of the stream is cancelled
+        rc, stdout, stderr = self.admin.run_icommand(['iquest', '%s', query], stdin_string='n\n')
+        assert rc == 0, stderr
+        assert 'Continue?' in stdout
+        assert 0 < len(stdout.replace('Continue? [Y/n]', '').split()) < file_count
+
+        self.admin.assert_icommand("irm -rf " + dir_name)
+
     ###################
     # isysmeta
     ###################
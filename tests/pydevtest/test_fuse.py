@@ -11,6 +11,7 @@ import stat
 import subprocess
 import sys
 import tempfile
+import time
 
 if sys.version_info < (2, 7):
     import unittest2 as unittest
@@ -164,3 +165,91 @@ class Test_Fuse(resource_suite.ResourceBase, unittest.TestCase):
                 with tempfile.NamedTemporaryFile(prefix='test_fuse.test_parallel_copy_get') as fget:
                     self.admin.assert_icommand(['iget', '-f', os.path.basename(f.name), fget.name])
                     assert lib.md5_hex_file(fget.name) == h
+
+@unittest.skipIf(configuration.RUN_IN_TOPOLOGY, 'Skip for Topology Testing')
+class Test_Fuse_Metadata_Cache(resource_suite.ResourceBase, unittest.TestCase):
+    # long enough for the steps of a test to run before anything expires
+    metadata_cache_timeout = 10
+
+    def setUp(self):
+        super(Test_Fuse_Metadata_Cache, self).setUp()
+        self.mount_point = tempfile.mkdtemp(prefix='irods-testing-fuse-mount-point')
+        self.admin.assert_icommand(['irodsFs', '-ometacache', '-ometacachetimeout', str(self.metadata_cache_timeout), self.mount_point])
+
+    def tearDown(self):
+        lib.assert_command(['fusermount', '-uz', self.mount_point])
+        shutil.rmtree(self.mount_point)
+        super(Test_Fuse_Metadata_Cache, self).tearDown()
+
+    def wait_for_expiry(self):
+        time.sleep(self.metadata_cache_timeout + 2)
+
+    def iput_new_file(self, basename, filesize):
+        with tempfile.NamedTemporaryFile(prefix=sys._getframe().f_code.co_name) as f:
+            lib.make_file(f.name, filesize, 'arbitrary')
+            self.admin.assert_icommand(['iput', f.name, os.path.join(self.admin.session_collection, basename)])
+
+    def test_cached_attributes_are_used_until_they_expire(self):
+        basename = 'test_cached_attributes_are_used_until_they_expire'
+        fullpath = os.path.join(self.mount_point, basename)
+        self.iput_new_file(basename, 100)
+        assert os.stat(fullpath).st_size == 100
+        assert basename in os.listdir(self.mount_point)
+
+        # removed behind the back of the mount, the cached entries are still used
+        self.admin.assert_icommand(['irm', '-f', basename])
+        assert os.stat(fullpath).st_size == 100
+        assert basename in os.listdir(self.mount_point)
+
+        self.wait_for_expiry()
+        assert not os.path.exists(fullpath)
+        assert basename not in os.listdir(self.mount_point)
+
+    def test_negative_entries_are_used_until_they_expire(self):
+        basename = 'test_negative_entries_are_used_until_they_expire'
+        fullpath = os.path.join(self.mount_point, basename)
+        assert not os.path.exists(fullpath)
+
+        self.iput_new_file(basename, 100)
+        assert not os.path.exists(fullpath)
+
+        self.wait_for_expiry()
+        assert os.stat(fullpath).st_size == 100
+
+    def test_local_rename_is_visible_at_once(self):
+        src = os.path.join(self.mount_point, 'test_local_rename_is_visible_at_once_src')
+        dst = os.path.join(self.mount_point, 'test_local_rename_is_visible_at_once_dst')
+        with open(src, 'w') as f:
+            f.write('x' * 100)
+        assert not os.path.exists(dst)
+        assert os.stat(src).st_size == 100
+
+        os.rename(src, dst)
+        assert not os.path.exists(src)
+        assert os.stat(dst).st_size == 100
+        entries = os.listdir(self.mount_point)
+        assert os.path.basename(src) not in entries
+        assert os.path.basename(dst) in entries
+
+    def test_local_unlink_is_visible_at_once(self):
+        fullpath = os.path.join(self.mount_point, 'test_local_unlink_is_visible_at_once')
+        with open(fullpath, 'w') as f:
+            f.write('x' * 100)
+        assert os.stat(fullpath).st_size == 100
+        assert os.path.basename(fullpath) in os.listdir(self.mount_point)
+
+        os.unlink(fullpath)
+        assert not os.path.exists(fullpath)
+        assert os.path.basename(fullpath) not in os.listdir(self.mount_point)
+        self.admin.assert_icommand_fail(['ils'], 'STDOUT_SINGLELINE', os.path.basename(fullpath))
+
+    def test_local_write_is_visible_at_once(self):
+        fullpath = os.path.join(self.mount_point, 'test_local_write_is_visible_at_once')
+        with open(fullpath, 'w') as f:
+            f.write('x' * 100)
+        assert os.stat(fullpath).st_size == 100
+
+        with open(fullpath, 'a') as f:
+            f.write('x' * 100)
+        assert os.stat(fullpath).st_size == 200
+        self.admin.assert_icommand(['ils', '-l'], 'STDOUT_SINGLELINE', [os.path.basename(fullpath), '200'])
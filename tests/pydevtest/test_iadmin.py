@@ -10,6 +10,7 @@ import getpass
 import imp
 import json
 import os
+import re
 import shutil
 import socket
 import stat
@@ -1114,3 +1115,58 @@ acSetNumThreads() {
 
         self.admin.assert_icommand(['iadmin', 'rmresc', name_of_bogus_resource])
         os.remove(path_of_corrupt_so)
+
+    def test_resource_snapshot_is_used_and_counters_are_current(self):
+        def load_times(log_contents, source):
+            # init_from_catalog logs 'resource table loaded from the <source> ... in <ms> ms'
+            pattern = r'resource table loaded from the {0}.* in ([0-9.]+) ms'.format(source)
+            return [float(ms) for ms in re.findall(pattern, log_contents)]
+
+        def reported_free_space(resource_name):
+            _, out, _ = self.admin.run_icommand(['izonereport'])
+            zone = json.loads(out)['zones'][0]
+            for server in [zone['icat_server']] + zone['resource_servers']:
+                for resource in server['resources']:
+                    if resource['name'] == resource_name:
+                        return resource['free_space']
+            return None
+
+        server_config_filename = os.path.join(lib.get_irods_config_dir(), 'server_config.json')
+        with lib.file_backed_up(server_config_filename):
+            server_config_update = {
+                'environment_variables': {
+                    'spLogLevel': '11'
+                }
+            }
+            lib.update_json_file_from_dict(server_config_filename, server_config_update)
+            lib.restart_irods_server()
+
+            # a new resource generation, the first agent queries the catalog
+            # and saves the snapshot, the agents after it load the snapshot
+            name_of_resource = 'snapshot_resc'
+            initial_size_of_server_log = lib.get_log_size('server')
+            self.admin.assert_icommand(['iadmin', 'mkresc', name_of_resource, 'passthru'], 'STDOUT_SINGLELINE', 'passthru')
+            for i in range(10):
+                self.admin.assert_icommand(['ils'], 'STDOUT_SINGLELINE', self.admin.zone_name)
+
+            with open(lib.get_log_path('server')) as f:
+                f.seek(initial_size_of_server_log)
+                log_contents = f.read()
+            catalog_times = load_times(log_contents, 'catalog')
+            snapshot_times = load_times(log_contents, 'snapshot')
+            print('catalog load times (ms):', catalog_times)
+            print('snapshot load times (ms):', snapshot_times)
+            assert len(catalog_times) > 0, catalog_times
+            assert len(snapshot_times) > 0, snapshot_times
+            assert sum(snapshot_times) / len(snapshot_times) < sum(catalog_times) / len(catalog_times)
+
+            # the free space does not change the generation, it is read again
+            # when the agent which loaded the snapshot reports it
+            self.admin.assert_icommand(['iadmin', 'modresc', name_of_resource, 'freespace', '12345'])
+            assert '12345' == reported_free_space(name_of_resource)
+            self.admin.assert_icommand(['iadmin', 'modresc', name_of_resource, 'freespace', '54321'])
+            assert '54321' == reported_free_space(name_of_resource)
+
+            self.admin.assert_icommand(['iadmin', 'rmresc', name_of_resource])
+
+        lib.restart_irods_server()
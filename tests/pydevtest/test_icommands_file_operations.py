@@ -586,3 +586,33 @@ acPostProcForPut { writeLine("serverLog", "acPostProcForPut called for $objPath"
         with tempfile.NamedTemporaryFile(prefix='test_large_irods_maximum_size_for_single_buffer_in_megabytes_2880') as f:
             lib.make_file(f.name, 800*1000*1000, contents='arbitrary')
             self.admin.assert_icommand(['iput', f.name, '-v'], 'STDOUT_SINGLELINE', '0 thr')
+
+    def test_ichksum_N_matches_serial(self):
+        base_name = 'test_ichksum_N_matches_serial'
+        local_dir = os.path.join(self.testing_tmp_dir, base_name)
+        local_files = lib.make_large_local_tmp_dir(local_dir, 20, 1000)
+        self.user0.assert_icommand(['iput', '-r', local_dir])
+
+        # one object fails, its file is missing from the vault
+        failed_file = sorted(local_files)[7]
+        os.unlink(os.path.join(lib.get_vault_session_path(self.user0), base_name, failed_file))
+
+        def chksum_lines(args):
+            rc, out, err = self.user0.run_icommand(['ichksum', '-f', '-r'] + args + [base_name])
+            lines = [l for l in out.splitlines() if l.startswith('    ') or l.startswith('Total checksum performed')]
+            return rc, lines, err
+
+        serial_rc, serial_lines, serial_err = chksum_lines([])
+        pooled_rc, pooled_lines, pooled_err = chksum_lines(['-N', '4'])
+        assert serial_rc != 0, serial_rc
+        assert pooled_rc == serial_rc, (pooled_rc, serial_rc)
+        assert pooled_lines == serial_lines, (pooled_lines, serial_lines)
+        assert 'Total checksum performed = 20, Failed checksum = 1' in serial_lines, serial_lines
+        assert failed_file in serial_err, serial_err
+        assert failed_file in pooled_err, pooled_err
+        assert not any(failed_file in l for l in pooled_lines), pooled_lines
+
+        # -v prints the timing of each object in both
+        _, out, _ = self.user0.run_icommand(['ichksum', '-v', '-r', '-N', '4', base_name])
+        timed_files = [l.split()[0] for l in out.splitlines() if l.strip().endswith(' sec')]
+        assert len(timed_files) == 19, out
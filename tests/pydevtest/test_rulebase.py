@@ -4,11 +4,13 @@ if sys.version_info >= (2, 7):
 else:
     import unittest2 as unittest
 import os
+import re
 import socket
 import time  # remove once file hash fix is commited #2279
 import lib
 import time
 import copy
+import json
 
 import configuration
 from resource_suite import ResourceBase
@@ -140,6 +142,193 @@ replicateMultiple(*destRgStr) {
         os.system("cp " + origcorefile + " " + corefile)
         time.sleep(1)  # remove once file hash fix is commited #2279
 
+    def test_flattened_rules_match_tree_walk(self):
+        rule_file = 'flat_rules.r'
+        rule_string = """
+test_flat_rules {
+    writeLine("stdout", "cut " ++ str(errorcode(cut_rule)));
+    writeLine("stdout", "alternative " ++ str(errorcode(alt_rule)));
+    writeLine("stdout", "succeed " ++ str(errorcode(succeed_rule)));
+    writeLine("stdout", "fail " ++ str(errorcode(fail_rule)));
+    writeLine("stdout", "recovery " ++ str(errorcode(recovery_rule)));
+}
+cut_rule {
+    writeLine("stdout", "cut_rule first");
+    cut;
+    fail;
+}
+cut_rule {
+    writeLine("stdout", "cut_rule second");
+}
+alt_rule {
+    writeLine("stdout", "alt_rule first");
+    fail;
+}
+alt_rule {
+    writeLine("stdout", "alt_rule second");
+}
+succeed_rule {
+    writeLine("stdout", "before succeed");
+    succeed;
+    writeLine("stdout", "after succeed");
+}
+fail_rule {
+    writeLine("stdout", "before fail");
+    fail;
+    writeLine("stdout", "after fail");
+}
+recovery_rule {
+    writeLine("stdout", "action 1"); ::: writeLine("stdout", "recover 1");
+    writeLine("stdout", "action 2"); ::: writeLine("stdout", "recover 2");
+    fail; ::: writeLine("stdout", "recover 3");
+    writeLine("stdout", "action 4"); ::: writeLine("stdout", "recover 4");
+}
+INPUT null
+OUTPUT ruleExecOut
+"""
+        with open(rule_file, 'w') as f:
+            f.write(rule_string)
+
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            outputs = []
+            for flatten in [0, 1]:
+                with open(server_config_filename) as f:
+                    server_config = json.load(f)
+                server_config['advanced_settings']['rule_engine_flatten_rules'] = flatten
+                with open(server_config_filename, 'w') as f:
+                    json.dump(server_config, f, indent=4)
+
+                rc, stdout, stderr = self.admin.run_icommand(['irule', '-F', rule_file])
+                assert rc == 0, stderr
+                outputs.append(stdout)
+
+        os.unlink(rule_file)
+
+        # the tree walker is the reference
+        lines = outputs[0].splitlines()
+        assert 'cut_rule second' not in lines
+        assert 'alt_rule second' in lines
+        assert 'after succeed' not in lines
+        assert 'after fail' not in lines
+        assert 'action 4' not in lines
+        assert lines.index('recover 3') < lines.index('recover 2') < lines.index('recover 1')
+        assert outputs[1] == outputs[0]
+
+    def test_flattened_rules_benchmark(self):
+        rule_file = 'flat_rules_benchmark.r'
+        rule_string = """
+bench_flat {
+    for(*i = 0; *i < 5000; *i = *i + 1) {
+        bench_step(*i);
+    }
+    writeLine("stdout", "done");
+}
+bench_step(*i) {
+    msiStrlen("bench", *a);
+    msiStrlen("bench_step", *b);
+    bench_leaf(*a, *b);
+    msiStrlen("bench_flat", *c);
+    bench_leaf(*b, *c);
+    msiStrlen("flattened", *d);
+    bench_leaf(*c, *d);
+    msiStrlen("tree walk", *e);
+}
+bench_leaf(*x, *y) {
+    msiStrlen(*x, *l);
+    msiStrlen(*y, *m);
+}
+INPUT null
+OUTPUT ruleExecOut
+"""
+        with open(rule_file, 'w') as f:
+            f.write(rule_string)
+
+        # the best of three runs of the same rule, walked and flattened
+        server_config_filename = lib.get_irods_config_dir() + '/server_config.json'
+        with lib.file_backed_up(server_config_filename):
+            best_times = []
+            for flatten in [0, 1]:
+                with open(server_config_filename) as f:
+                    server_config = json.load(f)
+                server_config['advanced_settings']['rule_engine_flatten_rules'] = flatten
+                with open(server_config_filename, 'w') as f:
+                    json.dump(server_config, f, indent=4)
+
+                times = []
+                for i in range(3):
+                    start = time.time()
+                    self.admin.assert_icommand(['irule', '-F', rule_file], 'STDOUT_SINGLELINE', 'done')
+                    times.append(time.time() - start)
+                best_times.append(min(times))
+
+        os.unlink(rule_file)
+
+        print('tree walk: {0:.3f} s, flattened: {1:.3f} s, speedup {2:.2f}x'.format(
+            best_times[0], best_times[1], best_times[0] / best_times[1]))
+        assert best_times[1] < best_times[0], best_times
+
+    @unittest.skipIf(configuration.TOPOLOGY_FROM_RESOURCE_SERVER, 'Skip for topology testing from resource server: reads server log')
+    def test_empty_pep_is_skipped_and_pep_with_body_fires(self):
+        corefile = os.path.join(lib.get_core_re_dir(), 'core.re')
+        server_config_filename = os.path.join(lib.get_irods_config_dir(), 'server_config.json')
+        put_rule = '\nacPostProcForPut { writeLine("serverLog", "TEST_PEP_PUT_FIRED"); }\n'
+        create_rule = '\nacPostProcForCreate { writeLine("serverLog", "TEST_PEP_CREATE_FIRED"); }\n'
+
+        def put_and_read_log(file_name):
+            initial_size_of_server_log = lib.get_log_size('server')
+            lib.make_file(file_name, 10)
+            self.admin.assert_icommand(['iput', file_name])
+            os.unlink(file_name)
+            time.sleep(2)  # the agent logs its pep counts when it exits
+            with open(lib.get_log_path('server')) as f:
+                f.seek(initial_size_of_server_log)
+                log_contents = f.read()
+            counts = [(int(fired), int(skipped)) for fired, skipped in
+                      re.findall(r'finalizeRuleEngine: (\d+) policy enforcement points fired, (\d+) skipped', log_contents)]
+            counts = [c for c in counts if c != (0, 0)]
+            assert len(counts) == 1, counts
+            return log_contents, counts[0]
+
+        with lib.file_backed_up(server_config_filename):
+            server_config_update = {
+                'environment_variables': {
+                    'spLogLevel': '11'
+                }
+            }
+            lib.update_json_file_from_dict(server_config_filename, server_config_update)
+
+            with lib.file_backed_up(corefile):
+                # the rule base loaded at startup, acPostProcForCreate is
+                # left empty as shipped
+                lib.prepend_string_to_file(put_rule, corefile)
+                lib.restart_irods_server()
+                log_contents, counts_put_body = put_and_read_log('pep_test_1')
+                assert 'TEST_PEP_PUT_FIRED' in log_contents
+                assert 'TEST_PEP_CREATE_FIRED' not in log_contents
+
+            with lib.file_backed_up(corefile):
+                # the rule base reloaded, now acPostProcForPut is empty
+                time.sleep(2)  # remove once file hash fix is commited #2279
+                lib.prepend_string_to_file(create_rule, corefile)
+                time.sleep(2)  # remove once file hash fix is commited #2279
+                log_contents, counts_create_body = put_and_read_log('pep_test_2')
+                assert 'TEST_PEP_CREATE_FIRED' in log_contents
+                assert 'TEST_PEP_PUT_FIRED' not in log_contents
+                assert counts_create_body == counts_put_body, (counts_create_body, counts_put_body)
+
+                # reloaded again with both bodies, the pep which was
+                # skipped is now fired
+                time.sleep(2)  # remove once file hash fix is commited #2279
+                lib.prepend_string_to_file(put_rule, corefile)
+                time.sleep(2)  # remove once file hash fix is commited #2279
+                log_contents, counts_both_bodies = put_and_read_log('pep_test_3')
+                assert 'TEST_PEP_CREATE_FIRED' in log_contents
+                assert 'TEST_PEP_PUT_FIRED' in log_contents
+                assert counts_both_bodies == (counts_put_body[0] + 1, counts_put_body[1] - 1), (counts_both_bodies, counts_put_body)
+
+        lib.restart_irods_server()
+
     @unittest.skipIf(configuration.TOPOLOGY_FROM_RESOURCE_SERVER, 'Skip for topology testing from resource server: reads re server log')
     def test_rulebase_update__2585(self):
         rule_file = 'my_rule.r'